@@ -0,0 +1,178 @@
+#include "common/DelimiterScan.hpp"
+#include "common/StringView.hpp"
+#include "common/Timer.hpp"
+#include "common/Tokenizer.hpp"
+#include "fileformats/vcf/Entry.hpp"
+#include "fileformats/vcf/Header.hpp"
+
+#include <boost/format.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Times delimiter scanning at each simd level on VCF lines, either read
+// from a file or made up to look like 1000 genomes data (1,000 samples
+// with GT:AD:DP:GQ:PL).
+
+using boost::format;
+
+struct IBenchmark {
+    virtual ~IBenchmark() {}
+
+    virtual std::string name() const = 0;
+    // returns a checksum so that the work is not optimized away
+    virtual size_t run(Vcf::Header const& header, std::vector<std::string> const& lines) const = 0;
+};
+
+struct SplitColumns : public IBenchmark {
+    std::string name() const { return "split columns"; }
+
+    size_t run(Vcf::Header const&, std::vector<std::string> const& lines) const {
+        std::vector<StringView> fields;
+        size_t rv(0);
+        for (auto i = lines.begin(); i != lines.end(); ++i) {
+            fields.clear();
+            Tokenizer<char>::split(*i, '\t', std::back_inserter(fields));
+            rv += fields.size();
+        }
+        return rv;
+    }
+};
+
+struct SplitSamples : public IBenchmark {
+    std::string name() const { return "split columns and samples"; }
+
+    size_t run(Vcf::Header const&, std::vector<std::string> const& lines) const {
+        std::vector<StringView> fields;
+        std::vector<StringView> values;
+        size_t rv(0);
+        for (auto i = lines.begin(); i != lines.end(); ++i) {
+            fields.clear();
+            Tokenizer<char>::split(*i, '\t', std::back_inserter(fields));
+            for (size_t f = 9; f < fields.size(); ++f) {
+                values.clear();
+                Tokenizer<char>::split(fields[f], ':', std::back_inserter(values));
+                rv += values.size();
+            }
+        }
+        return rv;
+    }
+};
+
+struct ParseEntries : public IBenchmark {
+    std::string name() const { return "parse entries with sample data"; }
+
+    size_t run(Vcf::Header const& header, std::vector<std::string> const& lines) const {
+        Vcf::Entry entry;
+        std::string line;
+        size_t rv(0);
+        for (auto i = lines.begin(); i != lines.end(); ++i) {
+            line = *i;
+            Vcf::Entry::parseLine(&header, line, entry);
+            rv += entry.sampleData().size();
+        }
+        return rv;
+    }
+};
+
+namespace {
+    size_t const SAMPLES = 1000;
+    size_t const LINES = 2000;
+
+    std::string makeHeader() {
+        std::stringstream ss;
+        ss << "##fileformat=VCFv4.1\n"
+            << "##INFO=<ID=AC,Number=A,Type=Integer,Description=\"Allele count\">\n"
+            << "##INFO=<ID=AF,Number=A,Type=Float,Description=\"Allele frequency\">\n"
+            << "##INFO=<ID=DP,Number=1,Type=Integer,Description=\"Total depth\">\n"
+            << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n"
+            << "##FORMAT=<ID=AD,Number=.,Type=Integer,Description=\"Allelic depths\">\n"
+            << "##FORMAT=<ID=DP,Number=1,Type=Integer,Description=\"Read depth\">\n"
+            << "##FORMAT=<ID=GQ,Number=1,Type=Integer,Description=\"Genotype quality\">\n"
+            << "##FORMAT=<ID=PL,Number=G,Type=Integer,Description=\"Phred likelihoods\">\n"
+            << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT";
+        for (size_t i = 0; i < SAMPLES; ++i)
+            ss << "\tS" << i;
+        ss << "\n";
+        return ss.str();
+    }
+
+    std::string makeLine(size_t n) {
+        static char const* const genotypes[] = {"0/0", "0/0", "0/0", "0/1", "1/1", "./."};
+        std::stringstream ss;
+        ss << "1\t" << 10000 + 17 * n << "\trs" << n << "\tA\tG\t" << rand() % 1000
+            << "\tPASS\tAC=" << rand() % 100 << ";AF=0." << rand() % 1000
+            << ";DP=" << rand() % 30000 << "\tGT:AD:DP:GQ:PL";
+        for (size_t i = 0; i < SAMPLES; ++i) {
+            int ref = rand() % 40;
+            int alt = rand() % 10;
+            ss << "\t" << genotypes[rand() % 6] << ":" << ref << "," << alt << ":" << ref + alt
+                << ":" << rand() % 99 << ":0," << rand() % 200 << "," << rand() % 2000;
+        }
+        return ss.str();
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        std::cerr << "Usage: " << argv[0] << " [input_vcf_file]\n";
+        return 1;
+    }
+
+    std::string headerText;
+    std::vector<std::string> lines;
+    if (argc == 2) {
+        std::ifstream in(argv[1]);
+        if (!in) {
+            std::cerr << "Failed to open " << argv[1] << "\n";
+            return 1;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty())
+                continue;
+            if (line[0] == '#')
+                headerText += line + "\n";
+            else
+                lines.push_back(line);
+        }
+    }
+    else {
+        srand(42);
+        headerText = makeHeader();
+        for (size_t i = 0; i < LINES; ++i)
+            lines.push_back(makeLine(i));
+    }
+
+    Vcf::Header header = Vcf::Header::fromString(headerText);
+    uint64_t bytes(0);
+    for (auto i = lines.begin(); i != lines.end(); ++i)
+        bytes += i->size() + 1;
+
+    boost::ptr_vector<IBenchmark> tests;
+    tests.push_back(new SplitColumns);
+    tests.push_back(new SplitSamples);
+    tests.push_back(new ParseEntries);
+
+    std::cout << lines.size() << " lines, " << bytes << " bytes\n";
+    for (auto iter = tests.begin(); iter != tests.end(); ++iter) {
+        for (int level = SIMD_SCALAR; level <= maxSimdLevel(); ++level) {
+            setSimdLevel(SimdLevel(level));
+            WallTimer timer;
+            size_t check = iter->run(header, lines);
+            double secs = timer.elapsed_as<boost::chrono::duration<double>>().count();
+            std::cout << format("%1% (%2%): %3$.3fs, %4$.1f MB/s, checksum %5%\n")
+                % iter->name() % simdLevelName(SimdLevel(level))
+                % secs % (bytes / secs / 1e6) % check;
+        }
+    }
+
+    return 0;
+}
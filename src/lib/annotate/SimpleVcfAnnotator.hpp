@@ -85,10 +85,10 @@ public:
             rv.setNumAlts(e.alt().size());
             // TODO: make this more efficient instead of using intermediate strings
             // TODO: assert that v is of type flag or number=1
-            auto const* existingValue = v.getAny(0);
-            if (existingValue) {
+            if (!v.missing(0)) {
+                auto existingValue = v.getAny(0);
                 for (auto i = altMatches.begin(); i != altMatches.end(); ++i) {
-                    rv.set(i->first, *existingValue);
+                    rv.set(i->first, existingValue);
                 }
             } 
             e.setInfo(txl.newType->id(), rv);
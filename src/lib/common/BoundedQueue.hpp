@@ -0,0 +1,130 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+// A blocking FIFO queue holding at most a fixed number of items, used to
+// hand work between a producer and a consumer thread.
+//
+// push() blocks while the queue is full and pop() blocks while it is
+// empty. After close(), push() fails immediately and pop() fails once the
+// remaining items have been drained. The number of times each side had
+// to wait is counted so that callers can tell which one is the
+// bottleneck.
+template<typename T>
+class BoundedQueue : public boost::noncopyable {
+public:
+    explicit BoundedQueue(std::size_t capacity)
+        : _capacity(capacity > 0 ? capacity : 1)
+        , _closed(false)
+        , _pushWaits(0)
+        , _popWaits(0)
+    {
+    }
+
+    // Returns false (without taking value) if the queue has been closed
+    bool push(T value) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (!_closed && _items.size() >= _capacity) {
+                ++_pushWaits;
+                while (!_closed && _items.size() >= _capacity)
+                    _notFull.wait(lock);
+            }
+
+            if (_closed)
+                return false;
+
+            _items.push_back(std::move(value));
+        }
+        _notEmpty.notify_one();
+        return true;
+    }
+
+    // Like push, but returns false rather than waiting when the queue is
+    // full
+    bool tryPush(T value) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_closed || _items.size() >= _capacity)
+                return false;
+
+            _items.push_back(std::move(value));
+        }
+        _notEmpty.notify_one();
+        return true;
+    }
+
+    // Returns false if the queue has been closed and is empty
+    bool pop(T& value) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (!_closed && _items.empty()) {
+                ++_popWaits;
+                while (!_closed && _items.empty())
+                    _notEmpty.wait(lock);
+            }
+
+            if (_items.empty())
+                return false;
+
+            value = std::move(_items.front());
+            _items.pop_front();
+        }
+        _notFull.notify_one();
+        return true;
+    }
+
+    // Like pop, but returns false rather than waiting when there is
+    // nothing to take
+    bool tryPop(T& value) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_items.empty())
+                return false;
+
+            value = std::move(_items.front());
+            _items.pop_front();
+        }
+        _notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _notFull.notify_all();
+        _notEmpty.notify_all();
+    }
+
+    std::size_t capacity() const {
+        return _capacity;
+    }
+
+    std::size_t pushWaits() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _pushWaits;
+    }
+
+    std::size_t popWaits() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _popWaits;
+    }
+
+private:
+    std::size_t _capacity;
+    std::deque<T> _items;
+    mutable std::mutex _mutex;
+    std::condition_variable _notFull;
+    std::condition_variable _notEmpty;
+    bool _closed;
+    std::size_t _pushWaits;
+    std::size_t _popWaits;
+};
@@ -0,0 +1,107 @@
+#include "ContigDictionary.hpp"
+
+#include <utility>
+
+uint64_t const ContigDictionary::KEY_STEP;
+
+ContigDictionary& ContigDictionary::instance() {
+    static ContigDictionary dict;
+    return dict;
+}
+
+ContigDictionary::ContigDictionary()
+    : _generation(1)
+{
+}
+
+ContigRank ContigDictionary::rank(std::string const& name) {
+    static thread_local ThreadCache cache;
+
+    // Keys only change when the generation does, so cached ranks stay
+    // right until then
+    uint32_t generation = _generation.load(std::memory_order_acquire);
+    if (cache.generation != generation) {
+        cache.generation = generation;
+        cache.keys.clear();
+        cache.lastRank = ContigRank();
+    }
+    else if (cache.lastRank.generation == generation && cache.lastName == name) {
+        return cache.lastRank;
+    }
+    else {
+        auto found = cache.keys.find(name);
+        if (found != cache.keys.end()) {
+            cache.lastName = name;
+            cache.lastRank = ContigRank(found->second, generation);
+            return cache.lastRank;
+        }
+    }
+
+    return lookup(name, cache);
+}
+
+ContigRank ContigDictionary::lookup(std::string const& name, ThreadCache& cache) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto found = _index.find(name);
+    OrderedNames::iterator iter = found != _index.end()
+        ? found->second
+        : insert(name);
+
+    uint32_t generation = _generation.load(std::memory_order_relaxed);
+    if (cache.generation != generation) {
+        // inserting name renumbered everything
+        cache.generation = generation;
+        cache.keys.clear();
+    }
+    cache.keys[name] = iter->second;
+    cache.lastName = name;
+    cache.lastRank = ContigRank(iter->second, generation);
+    return cache.lastRank;
+}
+
+void ContigDictionary::add(std::vector<std::string> const& names) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool added = false;
+    for (auto i = names.begin(); i != names.end(); ++i) {
+        if (_index.count(*i))
+            continue;
+        _index[*i] = _names.insert(std::make_pair(*i, 0)).first;
+        added = true;
+    }
+
+    if (added)
+        renumber();
+}
+
+std::size_t ContigDictionary::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _names.size();
+}
+
+ContigDictionary::OrderedNames::iterator ContigDictionary::insert(std::string const& name) {
+    OrderedNames::iterator iter = _names.insert(std::make_pair(name, 0)).first;
+    _index[name] = iter;
+
+    uint64_t lo = 0;
+    if (iter != _names.begin()) {
+        OrderedNames::iterator prev = iter;
+        lo = (--prev)->second;
+    }
+
+    OrderedNames::iterator next = iter;
+    uint64_t hi = ++next != _names.end() ? next->second : lo + 2 * KEY_STEP;
+
+    if (hi - lo > 1)
+        iter->second = lo + (hi - lo) / 2;
+    else
+        renumber();
+
+    return iter;
+}
+
+void ContigDictionary::renumber() {
+    uint64_t key = 0;
+    for (auto i = _names.begin(); i != _names.end(); ++i)
+        i->second = key += KEY_STEP;
+    _generation.fetch_add(1, std::memory_order_release);
+}
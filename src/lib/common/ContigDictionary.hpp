@@ -0,0 +1,151 @@
+#pragma once
+
+#include "cstdint.hpp"
+
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Rank of a sequence name in the ContigDictionary. Ranks from the same
+// generation of the dictionary order like strverscmp orders the names.
+// A default constructed rank is not comparable to anything.
+struct ContigRank {
+    ContigRank()
+        : key(0)
+        , generation(0)
+    {}
+
+    ContigRank(uint64_t key, uint32_t generation)
+        : key(key)
+        , generation(generation)
+    {}
+
+    bool comparable(ContigRank const& rhs) const {
+        return generation != 0 && generation == rhs.generation;
+    }
+
+    uint64_t key;
+    uint32_t generation;
+};
+
+// Process wide dictionary of sequence names. Names are given ranks in
+// version sort order so that records carrying the rank of their
+// chromosome can be compared with integer comparisons rather than
+// strverscmp.
+//
+// The dictionary is seeded from vcf ##contig lines and fasta indexes and
+// extended as unseen names turn up. New names are given keys between
+// those of their neighbors; when there is no room left, all names are
+// renumbered and the generation changes. Ranks handed out before that
+// are still valid but only comparable to each other, compare() falls
+// back to strverscmp for ranks of different generations.
+//
+// rank() is called for every record parsed, possibly from several parser
+// threads at once. Each thread keeps the ranks it has looked up in the
+// current generation (and the last one on its own, since records mostly
+// come in runs of the same chromosome), so the mutex is only taken the
+// first time a thread sees a name and when adding names.
+class ContigDictionary : boost::noncopyable {
+public:
+    static ContigDictionary& instance();
+
+    // Returns the rank of name, adding it to the dictionary if needed
+    ContigRank rank(std::string const& name);
+
+    // Add several names at once (e.g., all the contigs of a reference)
+    void add(std::vector<std::string> const& names);
+
+    std::size_t size() const;
+
+    // strverscmp order of the names a and b with ranks ra and rb
+    static int compare(
+            std::string const& a, ContigRank const& ra,
+            std::string const& b, ContigRank const& rb);
+
+    static bool same(
+            std::string const& a, ContigRank const& ra,
+            std::string const& b, ContigRank const& rb);
+
+protected:
+    struct VersionLess {
+        bool operator()(std::string const& a, std::string const& b) const {
+            return strverscmp(a.c_str(), b.c_str()) < 0;
+        }
+    };
+
+    typedef std::map<std::string, uint64_t, VersionLess> OrderedNames;
+
+    // Space between the keys of consecutive names after renumbering
+    static uint64_t const KEY_STEP = uint64_t(1) << 32;
+
+    ContigDictionary();
+
+    // The ranks a thread has looked up in one generation
+    struct ThreadCache {
+        ThreadCache()
+            : generation(0)
+        {}
+
+        uint32_t generation;
+        std::string lastName;
+        ContigRank lastRank;
+        boost::unordered_map<std::string, uint64_t> keys;
+    };
+
+    ContigRank lookup(std::string const& name, ThreadCache& cache);
+
+    // These expect _mutex to be held
+    OrderedNames::iterator insert(std::string const& name);
+    void renumber();
+
+protected:
+    mutable std::mutex _mutex;
+    // Only changed with _mutex held, read without it by rank()
+    std::atomic<uint32_t> _generation;
+    OrderedNames _names;
+    boost::unordered_map<std::string, OrderedNames::iterator> _index;
+};
+
+inline int ContigDictionary::compare(
+        std::string const& a, ContigRank const& ra,
+        std::string const& b, ContigRank const& rb)
+{
+    if (ra.comparable(rb))
+        return ra.key < rb.key ? -1 : (rb.key < ra.key ? 1 : 0);
+    return strverscmp(a.c_str(), b.c_str());
+}
+
+inline bool ContigDictionary::same(
+        std::string const& a, ContigRank const& ra,
+        std::string const& b, ContigRank const& rb)
+{
+    if (ra.comparable(rb))
+        return ra.key == rb.key;
+    return a == b;
+}
+
+namespace detail {
+    template<typename T>
+    auto contigRankOf(T const& x, int) -> decltype(x.chromRank()) {
+        return x.chromRank();
+    }
+
+    template<typename T>
+    ContigRank contigRankOf(T const&, long) {
+        return ContigRank();
+    }
+}
+
+// The chromosome rank cached by x if its type has one (i.e., provides a
+// chromRank() method), otherwise an unset rank
+template<typename T>
+ContigRank contigRankOf(T const& x) {
+    return detail::contigRankOf(x, 0);
+}
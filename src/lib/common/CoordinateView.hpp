@@ -1,8 +1,15 @@
 #pragma once
 
+#include "ContigDictionary.hpp"
+
 #include <string>
 
-struct CoordinateViewBaseTag {};
+struct CoordinateViewBaseTag {
+    template<typename T>
+    ContigRank chromRank(T const& x) const {
+        return contigRankOf(x);
+    }
+};
 
 struct DefaultCoordinateView : CoordinateViewBaseTag {
     template<typename T>
@@ -0,0 +1,144 @@
+#include "DelimiterScan.hpp"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#   define JOINX_X86_SIMD 1
+#   include <immintrin.h>
+#endif
+
+namespace {
+    uint64_t scalarTail(char const* p, std::size_t len, char delim) {
+        uint64_t rv = 0;
+        for (std::size_t i = 0; i < len; ++i)
+            rv |= uint64_t(p[i] == delim) << i;
+        return rv;
+    }
+
+    uint64_t scalarMask(char const* p, char delim) {
+        return scalarTail(p, DELIMITER_BLOCK, delim);
+    }
+
+#ifdef JOINX_X86_SIMD
+    uint64_t sse2Mask(char const* p, char delim) {
+        __m128i const d = _mm_set1_epi8(delim);
+        uint64_t rv = 0;
+        for (std::size_t i = 0; i < DELIMITER_BLOCK; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+            uint64_t bits = uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d)));
+            rv |= bits << i;
+        }
+        return rv;
+    }
+
+    uint64_t sse2Tail(char const* p, std::size_t len, char delim) {
+        if (len < 16)
+            return scalarTail(p, len, delim);
+
+        __m128i const d = _mm_set1_epi8(delim);
+        uint64_t rv = 0;
+        std::size_t i = 0;
+        for (; i + 16 <= len; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + i));
+            uint64_t bits = uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d)));
+            rv |= bits << i;
+        }
+        if (i < len) {
+            // the last 16 bytes, overlapping the ones already done
+            __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p + len - 16));
+            uint64_t bits = uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, d)));
+            rv |= bits << (len - 16);
+        }
+        return rv;
+    }
+
+    __attribute__((target("avx2")))
+    uint64_t avx2Mask(char const* p, char delim) {
+        __m256i const d = _mm256_set1_epi8(delim);
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p + 32));
+        uint64_t loBits = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, d)));
+        uint64_t hiBits = uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, d)));
+        return loBits | (hiBits << 32);
+    }
+#endif
+
+    detail::DelimiterMaskFunc maskFunc(SimdLevel level) {
+#ifdef JOINX_X86_SIMD
+        switch (level) {
+            case SIMD_AVX2: return &avx2Mask;
+            case SIMD_SSE2: return &sse2Mask;
+            default: break;
+        }
+#endif
+        return &scalarMask;
+    }
+
+    // Tails are too short to gain from avx2
+    detail::DelimiterTailFunc tailFunc(SimdLevel level) {
+#ifdef JOINX_X86_SIMD
+        if (level >= SIMD_SSE2)
+            return &sse2Tail;
+#endif
+        return &scalarTail;
+    }
+
+    SimdLevel detectSimdLevel() {
+#ifdef JOINX_X86_SIMD
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SIMD_AVX2;
+        return SIMD_SSE2;
+#else
+        return SIMD_SCALAR;
+#endif
+    }
+
+    SimdLevel& currentLevel() {
+        static SimdLevel level = maxSimdLevel();
+        return level;
+    }
+
+    // The first calls pick the implementations, so that tokenizing works
+    // during static initialization too
+    uint64_t resolveMask(char const* p, char delim) {
+        detail::DelimiterMaskFunc func = maskFunc(currentLevel());
+        detail::delimiterMaskBlock.store(func, std::memory_order_relaxed);
+        return func(p, delim);
+    }
+
+    uint64_t resolveTail(char const* p, std::size_t len, char delim) {
+        detail::DelimiterTailFunc func = tailFunc(currentLevel());
+        detail::delimiterMaskTail.store(func, std::memory_order_relaxed);
+        return func(p, len, delim);
+    }
+}
+
+namespace detail {
+    std::atomic<DelimiterMaskFunc> delimiterMaskBlock(&resolveMask);
+
+    std::atomic<DelimiterTailFunc> delimiterMaskTail(&resolveTail);
+}
+
+SimdLevel maxSimdLevel() {
+    static SimdLevel const level = detectSimdLevel();
+    return level;
+}
+
+SimdLevel simdLevel() {
+    return currentLevel();
+}
+
+SimdLevel setSimdLevel(SimdLevel level) {
+    SimdLevel best = maxSimdLevel();
+    currentLevel() = level < best ? level : best;
+    detail::delimiterMaskBlock.store(maskFunc(currentLevel()), std::memory_order_relaxed);
+    detail::delimiterMaskTail.store(tailFunc(currentLevel()), std::memory_order_relaxed);
+    return currentLevel();
+}
+
+char const* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2: return "avx2";
+        case SIMD_SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common/cstdint.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+// Vectorized search for delimiters, used by Tokenizer<char>.
+//
+// delimiterMask() looks at the (up to) DELIMITER_BLOCK bytes starting at
+// p and returns a mask with bit i set if p[i] is delim. Whole blocks are
+// scanned with SSE2, or AVX2 when the cpu has it; the implementation is
+// picked on first use. Bytes at or past end are never read.
+//
+// setSimdLevel() is there for tests and benchmarks that compare the
+// implementations. It must not be called while other threads are
+// tokenizing.
+
+std::size_t const DELIMITER_BLOCK = 64;
+
+enum SimdLevel {
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2
+};
+
+// The best level the cpu supports
+SimdLevel maxSimdLevel();
+SimdLevel simdLevel();
+// Use level (or the best one supported, if it is higher). Returns the
+// level in use.
+SimdLevel setSimdLevel(SimdLevel level);
+
+char const* simdLevelName(SimdLevel level);
+
+namespace detail {
+    typedef uint64_t (*DelimiterMaskFunc)(char const* p, char delim);
+    typedef uint64_t (*DelimiterTailFunc)(char const* p, std::size_t len, char delim);
+
+    // Scans a whole block
+    extern std::atomic<DelimiterMaskFunc> delimiterMaskBlock;
+
+    // Scans the last len < DELIMITER_BLOCK bytes of a string
+    extern std::atomic<DelimiterTailFunc> delimiterMaskTail;
+}
+
+inline uint64_t delimiterMask(char const* p, char const* end, char delim) {
+    std::size_t len = end - p;
+    if (len >= DELIMITER_BLOCK)
+        return detail::delimiterMaskBlock.load(std::memory_order_relaxed)(p, delim);
+    return detail::delimiterMaskTail.load(std::memory_order_relaxed)(p, len, delim);
+}
+
+// The index of the lowest bit set in mask, which must not be 0
+inline unsigned lowestBit(uint64_t mask) {
+    return __builtin_ctzll(mask);
+}
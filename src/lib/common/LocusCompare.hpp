@@ -1,6 +1,7 @@
 #pragma once
 
 #include "RelOps.hpp"
+#include "ContigDictionary.hpp"
 #include "CoordinateView.hpp"
 
 #include <boost/tti/has_type.hpp>
@@ -43,7 +44,8 @@ struct LocusCompare<
     template<typename ValueType>
     typename std::enable_if<!std::is_pointer<ValueType>::value, int>::type
     operator()(ValueType const& x, ValueType const& y) const {
-        int chr = strverscmp(cv.chrom(x).c_str(), cv.chrom(y).c_str());
+        int chr = ContigDictionary::compare(
+            cv.chrom(x), cv.chromRank(x), cv.chrom(y), cv.chromRank(y));
         if (chr != 0)
             return chr;
 
@@ -82,7 +84,8 @@ struct LocusCompare<
     template<typename ValueType>
     typename std::enable_if<!std::is_pointer<ValueType>::value, int>::type
     operator()(ValueType const& x, ValueType const& y) const {
-        int chr = strverscmp(cv.chrom(x).c_str(), cv.chrom(y).c_str());
+        int chr = ContigDictionary::compare(
+            cv.chrom(x), cv.chromRank(x), cv.chrom(y), cv.chromRank(y));
         if (chr != 0)
             return chr;
 
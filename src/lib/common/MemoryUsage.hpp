@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Estimates of the heap memory owned by objects, used to keep buffers of
+// records within a byte budget.
+//
+// heapBytes(x) is the memory x owns through its members, not counting
+// sizeof(x) itself (which is part of whatever holds x). Classes take part
+// by providing a heapBytes() method. The figures include allocator
+// bookkeeping but are necessarily approximate.
+
+// Per allocation overhead of the allocator (glibc malloc chunk header plus
+// alignment)
+std::size_t const ALLOC_OVERHEAD = 2 * sizeof(void*);
+
+// Bookkeeping in each node of a std::set/std::map (color, parent, left,
+// right)
+std::size_t const TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+
+// Bytes taken from the heap by an allocation of n bytes
+inline std::size_t allocationBytes(std::size_t n) {
+    return n ? n + ALLOC_OVERHEAD : 0;
+}
+
+template<typename T>
+typename std::enable_if<
+    std::is_arithmetic<T>::value || std::is_pointer<T>::value || std::is_enum<T>::value,
+    std::size_t>::type
+heapBytes(T const&) {
+    return 0;
+}
+
+template<typename T>
+auto heapBytes(T const& x) -> decltype(x.heapBytes()) {
+    return x.heapBytes();
+}
+
+inline std::size_t heapBytes(std::string const& x) {
+#if defined(_GLIBCXX_USE_CXX11_ABI) && _GLIBCXX_USE_CXX11_ABI
+    // short strings live inside the object
+    std::size_t const localCapacity = 15;
+    return x.capacity() > localCapacity ? allocationBytes(x.capacity() + 1) : 0;
+#else
+    // reference counted representation: length, capacity and count
+    return x.capacity() ? allocationBytes(x.capacity() + 1 + 3 * sizeof(std::size_t)) : 0;
+#endif
+}
+
+template<typename T, typename U>
+std::size_t heapBytes(std::pair<T, U> const& x) {
+    return heapBytes(x.first) + heapBytes(x.second);
+}
+
+template<typename T, typename Alloc>
+std::size_t heapBytes(std::vector<T, Alloc> const& x) {
+    std::size_t rv = allocationBytes(x.capacity() * sizeof(T));
+    for (auto i = x.begin(); i != x.end(); ++i)
+        rv += heapBytes(*i);
+    return rv;
+}
+
+template<typename T, typename Cmp, typename Alloc>
+std::size_t heapBytes(std::set<T, Cmp, Alloc> const& x) {
+    std::size_t rv = x.size() * allocationBytes(TREE_NODE_OVERHEAD + sizeof(T));
+    for (auto i = x.begin(); i != x.end(); ++i)
+        rv += heapBytes(*i);
+    return rv;
+}
+
+template<typename K, typename V, typename Cmp, typename Alloc>
+std::size_t heapBytes(std::map<K, V, Cmp, Alloc> const& x) {
+    typedef typename std::map<K, V, Cmp, Alloc>::value_type value_type;
+    std::size_t rv = x.size() * allocationBytes(TREE_NODE_OVERHEAD + sizeof(value_type));
+    for (auto i = x.begin(); i != x.end(); ++i)
+        rv += heapBytes(*i);
+    return rv;
+}
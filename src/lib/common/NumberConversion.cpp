@@ -0,0 +1,331 @@
+#include "NumberConversion.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+    // Powers of ten that are exact doubles
+    double const POW10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    int const MAX_EXACT_POW10 = 22;
+
+    uint64_t const UINT_POW10[] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+        10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+        100000000000ull, 1000000000000ull, 10000000000000ull,
+        100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+        100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+    };
+
+    // Above this precision the rounding of the scaled value in
+    // formatDouble can not be trusted, and printf is used
+    int const MAX_FAST_PRECISION = 15;
+
+    char const DIGIT_PAIRS[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    bool isDigit(char c) {
+        return unsigned(c) - '0' < 10;
+    }
+
+    bool equalsNoCase(char const* beg, char const* end, char const* word) {
+        std::size_t n = strlen(word);
+        if (std::size_t(end - beg) != n)
+            return false;
+        for (std::size_t i = 0; i < n; ++i) {
+            if ((beg[i] | 0x20) != word[i])
+                return false;
+        }
+        return true;
+    }
+
+    // Correctly rounded conversion of a string that is known to be a
+    // valid decimal number
+    double slowParseDouble(char const* beg, char const* end) {
+        std::size_t n = end - beg;
+        char buf[64];
+        if (n < sizeof(buf)) {
+            memcpy(buf, beg, n);
+            buf[n] = 0;
+            return strtod(buf, 0);
+        }
+        return strtod(std::string(beg, end).c_str(), 0);
+    }
+
+    char* printfDouble(char* out, double value, int precision) {
+        int n = snprintf(out, MAX_DOUBLE_CHARS, "%.*g", precision, value);
+        return out + n;
+    }
+
+    // Writes the n digits of value (which has exactly n digits)
+    char* writeDigits(char* out, uint64_t value, int n) {
+        char* p = out + n;
+        while (value >= 100) {
+            unsigned pair = unsigned(value % 100) * 2;
+            value /= 100;
+            *--p = DIGIT_PAIRS[pair + 1];
+            *--p = DIGIT_PAIRS[pair];
+        }
+        if (value >= 10) {
+            unsigned pair = unsigned(value) * 2;
+            *--p = DIGIT_PAIRS[pair + 1];
+            *--p = DIGIT_PAIRS[pair];
+        }
+        else {
+            *--p = char('0' + value);
+        }
+        return out + n;
+    }
+
+    int countDigits(uint64_t value) {
+        int n = 1;
+        while (n < 20 && value >= UINT_POW10[n])
+            ++n;
+        return n;
+    }
+
+    // Lays out digits (with no trailing zeros) with decimal exponent
+    // exp10 as %g does
+    char* writeGeneral(char* out, char const* digits, int n, int exp10, int precision) {
+        if (exp10 < -4 || exp10 >= precision) {
+            *out++ = digits[0];
+            if (n > 1) {
+                *out++ = '.';
+                memcpy(out, digits + 1, n - 1);
+                out += n - 1;
+            }
+            *out++ = 'e';
+            *out++ = exp10 < 0 ? '-' : '+';
+            unsigned e = exp10 < 0 ? -exp10 : exp10;
+            // at least two exponent digits
+            if (e < 10)
+                *out++ = '0';
+            return writeDigits(out, e, e < 10 ? 1 : e < 100 ? 2 : 3);
+        }
+
+        if (exp10 < 0) {
+            *out++ = '0';
+            *out++ = '.';
+            for (int i = -1; i > exp10; --i)
+                *out++ = '0';
+            memcpy(out, digits, n);
+            return out + n;
+        }
+
+        int intDigits = exp10 + 1;
+        if (n <= intDigits) {
+            memcpy(out, digits, n);
+            out += n;
+            for (int i = n; i < intDigits; ++i)
+                *out++ = '0';
+            return out;
+        }
+
+        memcpy(out, digits, intDigits);
+        out += intDigits;
+        *out++ = '.';
+        memcpy(out, digits + intDigits, n - intDigits);
+        return out + n - intDigits;
+    }
+}
+
+bool parseDouble(char const* beg, char const* end, double& value) {
+    char const* p = beg;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    if (p == end)
+        return false;
+
+    if (!isDigit(*p) && *p != '.') {
+        if (equalsNoCase(p, end, "nan"))
+            value = std::numeric_limits<double>::quiet_NaN();
+        else if (equalsNoCase(p, end, "inf") || equalsNoCase(p, end, "infinity"))
+            value = std::numeric_limits<double>::infinity();
+        else
+            return false;
+
+        if (negative)
+            value = -value;
+        return true;
+    }
+
+    // up to 19 significant digits are kept in mantissa, the value is
+    // mantissa * 10^exp10 unless digits were dropped
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exp10 = 0;
+    bool sawDigit = false;
+    bool dropped = false;
+
+    for (; p != end && isDigit(*p); ++p) {
+        sawDigit = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        }
+        else {
+            ++exp10;
+            dropped |= *p != '0';
+        }
+    }
+
+    if (p != end && *p == '.') {
+        for (++p; p != end && isDigit(*p); ++p) {
+            sawDigit = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                --exp10;
+            }
+            else {
+                dropped |= *p != '0';
+            }
+        }
+    }
+
+    if (!sawDigit)
+        return false;
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExp = false;
+        if (p != end && (*p == '-' || *p == '+'))
+            negativeExp = *p++ == '-';
+        if (p == end)
+            return false;
+
+        int e = 0;
+        for (; p != end && isDigit(*p); ++p) {
+            // anything this large is 0 or infinity anyway
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+        }
+        exp10 += negativeExp ? -e : e;
+    }
+
+    if (p != end)
+        return false;
+
+    // Clinger's fast path: both the mantissa and the power of ten are
+    // exact, so one multiplication or division rounds correctly
+    if (!dropped && mantissa <= (uint64_t(1) << 53)
+        && exp10 >= -MAX_EXACT_POW10 && exp10 <= MAX_EXACT_POW10)
+    {
+        double m = double(mantissa);
+        value = exp10 < 0 ? m / POW10[-exp10] : m * POW10[exp10];
+        if (negative)
+            value = -value;
+        return true;
+    }
+
+    value = slowParseDouble(beg, end);
+    return true;
+}
+
+char* formatInteger(char* out, uint64_t value) {
+    return writeDigits(out, value, countDigits(value));
+}
+
+char* formatDouble(char* out, double value, int precision) {
+    // %g treats a precision of 0 as 1
+    if (precision <= 0)
+        precision = 1;
+
+    if (precision > MAX_FAST_PRECISION || !std::isfinite(value))
+        return printfDouble(out, value, precision);
+
+    if (value == 0) {
+        if (std::signbit(value))
+            *out++ = '-';
+        *out++ = '0';
+        return out;
+    }
+
+    char* const start = out;
+    double const original = value;
+    if (value < 0) {
+        *out++ = '-';
+        value = -value;
+    }
+
+    uint64_t sig;
+    int exp10;
+    if (value < POW10[precision] && value == double(uint64_t(value))) {
+        // whole numbers that fit are exact
+        sig = uint64_t(value);
+        exp10 = countDigits(sig) - 1;
+    }
+    else {
+        // scale the value to precision digits before the point, and round
+        exp10 = int(std::floor(std::log10(value)));
+        double scaled = 0;
+        for (int tries = 0; tries < 3; ++tries) {
+            int shift = precision - 1 - exp10;
+            if (shift > MAX_EXACT_POW10 || shift < -MAX_EXACT_POW10)
+                return printfDouble(start, original, precision);
+
+            scaled = shift >= 0 ? value * POW10[shift] : value / POW10[-shift];
+            if (scaled >= POW10[precision])
+                ++exp10;
+            else if (scaled < POW10[precision - 1])
+                --exp10;
+            else
+                break;
+        }
+
+        double whole = std::floor(scaled);
+        double frac = scaled - whole;
+        // the scaling rounded, so the exact value might be on the other
+        // side of a tie
+        if (std::fabs(frac - 0.5) <= scaled * 4.5e-16 || scaled >= POW10[precision]
+            || scaled < POW10[precision - 1])
+        {
+            return printfDouble(start, original, precision);
+        }
+
+        sig = uint64_t(whole) + (frac > 0.5 ? 1 : 0);
+        if (sig == UINT_POW10[precision]) {
+            sig /= 10;
+            ++exp10;
+        }
+    }
+
+    // %g drops trailing zeros
+    int n = countDigits(sig);
+    while (sig % 10 == 0 && n > 1) {
+        sig /= 10;
+        --n;
+    }
+
+    char digits[24];
+    writeDigits(digits, sig, n);
+    return writeGeneral(out, digits, n, exp10, precision);
+}
+
+void writeDouble(std::ostream& s, double value) {
+    std::ios_base::fmtflags const special = std::ios_base::floatfield
+        | std::ios_base::showpoint | std::ios_base::showpos | std::ios_base::uppercase;
+    if (s.width() != 0 || (s.flags() & special) || s.precision() > MAX_DOUBLE_PRECISION) {
+        s << value;
+        return;
+    }
+
+    char buf[MAX_DOUBLE_CHARS];
+    char* end = formatDouble(buf, value, int(s.precision()));
+    s.write(buf, end - buf);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "common/cstdint.hpp"
+
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+// Conversions between numbers and text for record fields, used instead
+// of boost::spirit and iostreams when parsing and writing records.
+//
+// The parse functions take the whole of [beg, end) or fail, so they can
+// be used on fields that are not null terminated. Integers may have a
+// leading + (or - if T is signed) and fail on overflow. Doubles take
+// the forms strtod does apart from hex floats and leading blanks, and
+// are correctly rounded.
+//
+// The format functions write to a caller owned buffer and return the
+// end of what they wrote (no terminating null). formatDouble() gives
+// exactly what printf's %.<precision>g does, which is also what an
+// ostream with default flags writes.
+
+// Buffer sizes that are large enough for any value
+std::size_t const MAX_INTEGER_CHARS = 24;
+std::size_t const MAX_DOUBLE_CHARS = 32;
+
+// The largest precision formatDouble() accepts
+int const MAX_DOUBLE_PRECISION = 17;
+
+template<typename T>
+bool parseInteger(char const* beg, char const* end, T& value);
+
+bool parseDouble(char const* beg, char const* end, double& value);
+
+char* formatInteger(char* out, uint64_t value);
+char* formatInteger(char* out, int64_t value);
+
+char* formatDouble(char* out, double value, int precision = 6);
+
+// Write value to s as s << value would
+template<typename T>
+void writeInteger(std::ostream& s, T value);
+
+void writeDouble(std::ostream& s, double value);
+
+
+template<typename T>
+inline bool parseInteger(char const* beg, char const* end, T& value) {
+    static_assert(std::is_integral<T>::value, "parseInteger needs an integer type");
+    typedef typename std::make_unsigned<T>::type Unsigned;
+
+    bool negative = false;
+    if (beg != end && (*beg == '-' || *beg == '+')) {
+        negative = *beg++ == '-';
+        if (negative && !std::is_signed<T>::value)
+            return false;
+    }
+    if (beg == end)
+        return false;
+
+    Unsigned rv = 0;
+    if (end - beg <= std::numeric_limits<T>::digits10) {
+        // too few digits to overflow
+        for (; beg != end; ++beg) {
+            unsigned digit = unsigned(*beg) - '0';
+            if (digit > 9)
+                return false;
+            rv = rv * 10 + digit;
+        }
+    }
+    else {
+        Unsigned limit = Unsigned(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+        for (; beg != end; ++beg) {
+            unsigned digit = unsigned(*beg) - '0';
+            if (digit > 9 || rv > (limit - digit) / 10)
+                return false;
+            rv = rv * 10 + digit;
+        }
+    }
+
+    value = negative ? T(Unsigned(0) - rv) : T(rv);
+    return true;
+}
+
+inline char* formatInteger(char* out, int64_t value) {
+    if (value < 0) {
+        *out++ = '-';
+        return formatInteger(out, uint64_t(0) - uint64_t(value));
+    }
+    return formatInteger(out, uint64_t(value));
+}
+
+template<typename T>
+inline void writeInteger(std::ostream& s, T value) {
+    static_assert(std::is_integral<T>::value, "writeInteger needs an integer type");
+    std::ios_base::fmtflags const special = std::ios_base::showpos
+        | (std::ios_base::basefield & ~std::ios_base::dec);
+    if (s.width() != 0 || (s.flags() & special)) {
+        s << value;
+        return;
+    }
+
+    char buf[MAX_INTEGER_CHARS];
+    char* end = std::is_signed<T>::value
+        ? formatInteger(buf, int64_t(value))
+        : formatInteger(buf, uint64_t(value));
+    s.write(buf, end - buf);
+}
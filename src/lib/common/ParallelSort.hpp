@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <iterator>
+#include <vector>
+
+// Sort [first, last) on a thread pool: the range is cut into one piece per
+// thread, the pieces are sorted concurrently and then merged pairwise
+// (also concurrently) with std::inplace_merge. Stable sorts stay stable
+// since inplace_merge is.
+template<typename Iter, typename LessThanCmp>
+void parallelSort(
+        Iter first,
+        Iter last,
+        LessThanCmp cmp,
+        bool stable,
+        ThreadPool& pool);
+
+namespace detail {
+    // Ranges shorter than this are not worth splitting up
+    std::size_t const MIN_PARALLEL_SORT_SIZE = 1 << 14;
+
+    template<typename Iter, typename LessThanCmp>
+    struct SortTask {
+        Iter first;
+        Iter last;
+        LessThanCmp cmp;
+        bool stable;
+
+        void operator()() {
+            if (stable)
+                std::stable_sort(first, last, cmp);
+            else
+                std::sort(first, last, cmp);
+        }
+    };
+
+    template<typename Iter, typename LessThanCmp>
+    struct MergeTask {
+        Iter first;
+        Iter middle;
+        Iter last;
+        LessThanCmp cmp;
+
+        void operator()() {
+            std::inplace_merge(first, middle, last, cmp);
+        }
+    };
+
+    inline void waitAll(std::deque<std::future<void>>& tasks) {
+        // get() rethrows exceptions from the tasks, but everything has to
+        // finish before the caller's range can be touched again
+        for (auto i = tasks.begin(); i != tasks.end(); ++i)
+            i->wait();
+        while (!tasks.empty()) {
+            std::future<void> task = std::move(tasks.front());
+            tasks.pop_front();
+            task.get();
+        }
+    }
+}
+
+template<typename Iter, typename LessThanCmp>
+void parallelSort(
+        Iter first,
+        Iter last,
+        LessThanCmp cmp,
+        bool stable,
+        ThreadPool& pool)
+{
+    std::size_t size = std::distance(first, last);
+    std::size_t pieces = std::min(pool.size(),
+        size / detail::MIN_PARALLEL_SORT_SIZE);
+
+    if (pieces <= 1) {
+        detail::SortTask<Iter, LessThanCmp> task = {first, last, cmp, stable};
+        task();
+        return;
+    }
+
+    std::vector<Iter> bounds;
+    bounds.reserve(pieces + 1);
+    for (std::size_t i = 0; i < pieces; ++i)
+        bounds.push_back(first + i * (size / pieces));
+    bounds.push_back(last);
+
+    std::deque<std::future<void>> tasks;
+    for (std::size_t i = 0; i < pieces; ++i) {
+        detail::SortTask<Iter, LessThanCmp> task = {
+            bounds[i], bounds[i + 1], cmp, stable};
+        tasks.push_back(pool.submit(task));
+    }
+    detail::waitAll(tasks);
+
+    // merge neighbouring pieces until only one is left
+    while (bounds.size() > 2) {
+        std::vector<Iter> merged;
+        merged.reserve(bounds.size() / 2 + 1);
+        std::size_t i = 0;
+        for (; i + 2 < bounds.size(); i += 2) {
+            detail::MergeTask<Iter, LessThanCmp> task = {
+                bounds[i], bounds[i + 1], bounds[i + 2], cmp};
+            tasks.push_back(pool.submit(task));
+            merged.push_back(bounds[i]);
+        }
+        // an odd piece out is carried to the next round as is
+        for (; i < bounds.size(); ++i)
+            merged.push_back(bounds[i]);
+
+        detail::waitAll(tasks);
+        bounds.swap(merged);
+    }
+}
@@ -123,7 +123,7 @@ bool StringView::operator==(StringView const& rhs) const {
 
 inline
 bool StringView::operator==(std::string const& rhs) const {
-    return rhs.size() == _size && rhs.compare(0, _size, _beg) == 0;
+    return rhs.size() == _size && rhs.compare(0, _size, _beg, _size) == 0;
 }
 
 inline
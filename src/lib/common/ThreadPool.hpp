@@ -0,0 +1,90 @@
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed size pool of worker threads executing tasks in submission order.
+//
+// submit() returns a std::future for the result of the task. Exceptions
+// thrown by a task are rethrown from future::get(). Callers that need
+// results in order (e.g., block decompression) can simply keep the futures
+// in a queue and wait on the front one.
+class ThreadPool : public boost::noncopyable {
+public:
+    explicit ThreadPool(std::size_t nThreads)
+        : _stop(false)
+    {
+        if (nThreads == 0)
+            nThreads = 1;
+
+        _threads.reserve(nThreads);
+        for (std::size_t i = 0; i < nThreads; ++i)
+            _threads.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cond.notify_all();
+        for (auto i = _threads.begin(); i != _threads.end(); ++i)
+            i->join();
+    }
+
+    template<typename Func>
+    std::future<typename std::result_of<Func()>::type> submit(Func func) {
+        typedef typename std::result_of<Func()>::type ResultType;
+        // std::function requires copyable targets, packaged_task isn't
+        auto task = std::make_shared<std::packaged_task<ResultType()>>(
+            std::move(func));
+
+        std::future<ResultType> rv = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push_back([task]() { (*task)(); });
+        }
+        _cond.notify_one();
+        return rv;
+    }
+
+    std::size_t size() const {
+        return _threads.size();
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                while (!_stop && _tasks.empty())
+                    _cond.wait(lock);
+
+                if (_tasks.empty())
+                    return;
+
+                task = std::move(_tasks.front());
+                _tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+private:
+    std::vector<std::thread> _threads;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _stop;
+};
@@ -1,11 +1,11 @@
 #pragma once
 
+#include "DelimiterScan.hpp"
+#include "NumberConversion.hpp"
 #include "StringView.hpp"
 #include "common/cstdint.hpp"
 
 #include <boost/format.hpp>
-#include <boost/spirit/home/qi/numeric.hpp>
-#include <boost/spirit/home/qi/parse.hpp>
 
 #include <algorithm>
 #include <cstdlib>
@@ -44,13 +44,8 @@ namespace detail {
         , typename std::enable_if<std::is_integral<T>::value>::type
         >
     {
-        template<typename Iter>
-        bool operator()(Iter beg, Iter end, T& attr) {
-            boost::spirit::qi::any_int_parser<T> parser;
-            if (boost::spirit::qi::parse(beg, end, parser, attr)) {
-                return beg == end;
-            }
-            return false;
+        bool operator()(char const* beg, char const* end, T& attr) {
+            return parseInteger(beg, end, attr);
         }
     };
 
@@ -60,13 +55,12 @@ namespace detail {
         , typename std::enable_if<std::is_floating_point<T>::value>::type
         >
     {
-        template<typename Iter>
-        bool operator()(Iter beg, Iter end, T& attr) {
-            boost::spirit::qi::any_real_parser<T> parser;
-            if (boost::spirit::qi::parse(beg, end, parser, attr)) {
-                return beg == end;
-            }
-            return false;
+        bool operator()(char const* beg, char const* end, T& attr) {
+            double value;
+            if (!parseDouble(beg, end, value))
+                return false;
+            attr = T(value);
+            return true;
         }
     };
 
@@ -118,6 +112,8 @@ public:
         , _end(0)
         , _eofCalls(0) // to support the last field being empty, see eof()
         , _lastDelim(0)
+        , _maskBase(std::string::npos)
+        , _mask(0)
     {
         rewind();
     }
@@ -131,6 +127,8 @@ public:
         , _end(0)
         , _eofCalls(0) // to support the last field being empty, see eof()
         , _lastDelim(0)
+        , _maskBase(std::string::npos)
+        , _mask(0)
     {
         rewind();
     }
@@ -144,6 +142,8 @@ public:
         , _end(0)
         , _eofCalls(0) // to support the last field being empty, see eof()
         , _lastDelim(0)
+        , _maskBase(std::string::npos)
+        , _mask(0)
     {
         rewind();
     }
@@ -232,6 +232,10 @@ protected:
     std::string::size_type _end;
     uint32_t _eofCalls;
     char _lastDelim;
+    // Tokenizer<char> finds delimiters a block at a time: _mask has the
+    // delimiters at or after _pos in the block starting at _maskBase
+    std::string::size_type _maskBase;
+    uint64_t _mask;
 };
 
 template<typename DelimType>
@@ -279,6 +283,8 @@ inline bool Tokenizer<DelimType>::advance() {
 template<typename DelimType>
 inline void Tokenizer<DelimType>::rewind() {
     _pos = 0;
+    _maskBase = std::string::npos;
+    _mask = 0;
     _end = std::min(_totalLen, nextDelim());
     _eofCalls = 0;
 }
@@ -327,9 +333,24 @@ inline bool Tokenizer<std::string>::eof() const {
 template<>
 inline size_t Tokenizer<char>::nextDelim() {
     if (_totalLen == 0) return 0;
-    char const* rv(0);
-    rv = strchr(_sbeg+_pos, _delim);
-    return rv == 0 ? std::string::npos : rv-_sbeg;
+    if (_pos >= _totalLen) return std::string::npos;
+
+    if (_pos < _maskBase || _pos - _maskBase >= DELIMITER_BLOCK) {
+        _maskBase = _pos;
+        _mask = delimiterMask(_sbeg + _pos, _send, _delim);
+    }
+    else {
+        // drop the delimiters before _pos
+        _mask &= ~uint64_t(0) << (_pos - _maskBase);
+    }
+
+    while (_mask == 0) {
+        _maskBase += DELIMITER_BLOCK;
+        if (_maskBase >= _totalLen)
+            return std::string::npos;
+        _mask = delimiterMask(_sbeg + _maskBase, _send, _delim);
+    }
+    return _maskBase + lowestBit(_mask);
 }
 
 template<>
@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <type_traits>
+#include <utility>
 
 // these are just for static_assert tests
 #include <iterator>
@@ -25,4 +26,40 @@ static_assert(
         >::value
     , "is a unique ptr");
 
+// True if a TypedStream parser can be called with a line of type Line, i.e.,
+// parser(HeaderType const*, Line const&, ValueType&) is well formed.
+template<typename Parser, typename Line>
+struct parses_line {
+private:
+    template<typename P>
+    static auto test(int) -> decltype(
+        std::declval<P&>()(
+              std::declval<typename P::HeaderType const*>()
+            , std::declval<Line const&>()
+            , std::declval<typename P::ValueType&>()
+            )
+        , std::true_type());
+
+    template<typename P>
+    static std::false_type test(...);
+
+public:
+    static bool const value = decltype(test<Parser>(0))::value;
+};
+
+// True if func(Arg const&) is well formed for an object func of type Func
+template<typename Func, typename Arg>
+struct is_callable_with {
+private:
+    template<typename F>
+    static auto test(int) -> decltype(
+        std::declval<F&>()(std::declval<Arg const&>()), std::true_type());
+
+    template<typename F>
+    static std::false_type test(...);
+
+public:
+    static bool const value = decltype(test<Func>(0))::value;
+};
+
 END_NAMESPACE(traits)
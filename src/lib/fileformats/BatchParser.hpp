@@ -0,0 +1,252 @@
+#pragma once
+
+#include "common/BoundedQueue.hpp"
+#include "common/StringView.hpp"
+#include "common/ThreadPool.hpp"
+#include "common/compat.hpp"
+#include "common/cstdint.hpp"
+#include "common/traits.hpp"
+#include "io/InputStream.hpp"
+
+#include <boost/format.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Parses the records of a stream on several threads, handing them out in
+// input order. Used by TypedStream in batch mode (TypedStream::parallel).
+//
+// A reader thread cuts the input into batches of batchSize data lines
+// (header lines and blank lines are skipped) and queues each one to be
+// parsed on a pool of worker threads. The consumer takes the batches in
+// the order they were read. Batches are recycled, so the records in them
+// (and whatever they allocated) are reused: next() swaps the consumer's
+// value with a slot in the batch.
+//
+// prepare, if set, is called on each record after it is parsed on the
+// worker thread, e.g., to parse fields that would otherwise be parsed
+// lazily by the consumer.
+//
+// Errors are reported when the consumer gets to the record that failed,
+// with the file name and line number as TypedStream gives them. The
+// parser and header are shared by the workers, so the parser must be
+// safe to call from several threads at once and must not modify the
+// header.
+template<typename Parser>
+class BatchParser : boost::noncopyable {
+public:
+    typedef typename Parser::ValueType ValueType;
+    typedef typename ValueType::HeaderType HeaderType;
+    typedef std::function<void(ValueType&)> PrepareFunc;
+
+    static std::size_t const DEFAULT_BATCH_SIZE = 1024;
+
+    BatchParser(
+            Parser& parser,
+            HeaderType const& header,
+            InputStream& in,
+            std::size_t threads,
+            std::size_t batchSize = DEFAULT_BATCH_SIZE,
+            PrepareFunc prepare = PrepareFunc()
+            )
+        : _parser(parser)
+        , _header(header)
+        , _in(in)
+        , _batchSize(batchSize > 0 ? batchSize : 1)
+        , _prepare(prepare)
+        , _ready(2 * (threads > 0 ? threads : 1) + 1)
+        , _free(2 * (threads > 0 ? threads : 1) + 2)
+        , _pos(0)
+        , _lineNum(0)
+        , _done(false)
+        , _pool(threads)
+    {
+        _reader = std::thread(&BatchParser::readLoop, this);
+    }
+
+    ~BatchParser() {
+        // unblocks the reader if it is waiting for space in the queue, the
+        // pool finishes the batches already queued when it is destroyed
+        _ready.close();
+        if (_reader.joinable())
+            _reader.join();
+    }
+
+    bool next(ValueType& value);
+
+    // True once next() has returned false
+    bool eof() const {
+        return _done;
+    }
+
+    // The line number of the last record returned by next()
+    uint64_t lineNum() const {
+        return _lineNum;
+    }
+
+private:
+    struct Batch {
+        // lines stored back to back, ends[i] is one past the end of line i
+        std::string data;
+        std::vector<std::size_t> ends;
+        std::vector<uint64_t> lineNums;
+        std::vector<ValueType> values;
+        // records [0, size) were parsed, record size failed if error is set
+        std::size_t size;
+        std::exception_ptr error;
+    };
+    typedef std::shared_ptr<Batch> BatchPtr;
+
+    struct Pending {
+        BatchPtr batch;
+        std::future<void> parsed;
+    };
+
+    struct ParseTask {
+        BatchParser* owner;
+        BatchPtr batch;
+
+        void operator()() {
+            owner->parseBatch(*batch);
+        }
+    };
+
+    typedef std::integral_constant<bool,
+        traits::parses_line<Parser, StringView>::value> ParsesView;
+
+    void readLoop();
+    void parseBatch(Batch& batch);
+
+    void parseLine(char const* beg, char const* end, std::string&, ValueType& value, std::true_type) {
+        _parser(&_header, StringView(beg, end), value);
+    }
+
+    void parseLine(char const* beg, char const* end, std::string& line, ValueType& value, std::false_type) {
+        line.assign(beg, end);
+        _parser(&_header, line, value);
+    }
+
+private:
+    Parser& _parser;
+    HeaderType const& _header;
+    InputStream& _in;
+    std::size_t _batchSize;
+    PrepareFunc _prepare;
+    BoundedQueue<Pending> _ready;
+    BoundedQueue<BatchPtr> _free;
+    std::exception_ptr _readError;
+    BatchPtr _current;
+    std::size_t _pos;
+    uint64_t _lineNum;
+    bool _done;
+    std::thread _reader;
+    // destroyed first, so that queued batches are parsed while everything
+    // they use is still there
+    ThreadPool _pool;
+};
+
+template<typename Parser>
+std::size_t const BatchParser<Parser>::DEFAULT_BATCH_SIZE;
+
+template<typename Parser>
+void BatchParser<Parser>::readLoop() {
+    try {
+        StringView line;
+        bool more = true;
+        while (more) {
+            BatchPtr batch;
+            if (!_free.tryPop(batch))
+                batch = std::make_shared<Batch>();
+            batch->data.clear();
+            batch->ends.clear();
+            batch->lineNums.clear();
+            batch->size = 0;
+            batch->error = std::exception_ptr();
+
+            while (batch->ends.size() < _batchSize && (more = _in.getline(line))) {
+                if (line.empty() || line[0] == '#')
+                    continue;
+                batch->data.append(line.begin(), line.end());
+                batch->ends.push_back(batch->data.size());
+                batch->lineNums.push_back(_in.lineNum());
+            }
+
+            if (batch->ends.empty())
+                break;
+
+            ParseTask task = {this, batch};
+            Pending pending = {batch, _pool.submit(task)};
+            if (!_ready.push(std::move(pending)))
+                return;
+        }
+    }
+    catch (...) {
+        _readError = std::current_exception();
+    }
+    _ready.close();
+}
+
+template<typename Parser>
+void BatchParser<Parser>::parseBatch(Batch& batch) {
+    using boost::format;
+
+    std::size_t n = batch.ends.size();
+    if (batch.values.size() < n)
+        batch.values.resize(n);
+
+    std::string line;
+    std::size_t beg = 0;
+    for (std::size_t i = 0; i < n; beg = batch.ends[i++]) {
+        try {
+            char const* data = batch.data.data();
+            parseLine(data + beg, data + batch.ends[i], line, batch.values[i], ParsesView());
+            if (_prepare)
+                _prepare(batch.values[i]);
+        }
+        catch (std::exception const& e) {
+            batch.error = std::make_exception_ptr(std::runtime_error(
+                str(format("Error at %1%:%2%: %3%"
+                    ) % _in.name() % batch.lineNums[i] % e.what())));
+            return;
+        }
+        batch.size = i + 1;
+    }
+}
+
+template<typename Parser>
+bool BatchParser<Parser>::next(ValueType& value) {
+    while (!_current || _pos == _current->size) {
+        if (_current) {
+            if (_current->error)
+                std::rethrow_exception(_current->error);
+            _free.tryPush(std::move(_current));
+            _current.reset();
+        }
+
+        Pending pending;
+        if (!_ready.pop(pending)) {
+            _done = true;
+            if (_readError)
+                std::rethrow_exception(_readError);
+            return false;
+        }
+
+        pending.parsed.get();
+        _current = std::move(pending.batch);
+        _pos = 0;
+    }
+
+    value.swap(_current->values[_pos]);
+    _lineNum = _current->lineNums[_pos];
+    ++_pos;
+    return true;
+}
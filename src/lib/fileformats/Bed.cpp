@@ -1,4 +1,5 @@
 #include "Bed.hpp"
+#include "common/MemoryUsage.hpp"
 #include "common/Tokenizer.hpp"
 
 #include <boost/format.hpp>
@@ -21,6 +22,7 @@ Bed::Bed()
 
 Bed::Bed(const Bed& b)
     : _chrom(b._chrom)
+    , _chromRank(b._chromRank)
     , _start(b._start)
     , _stop(b._stop)
     , _extraFields(b._extraFields)
@@ -30,6 +32,7 @@ Bed::Bed(const Bed& b)
 
 Bed::Bed(Bed&& b)
     : _chrom(std::move(b._chrom))
+    , _chromRank(b._chromRank)
     , _start(b._start)
     , _stop(b._stop)
     , _extraFields(std::move(b._extraFields))
@@ -39,6 +42,7 @@ Bed::Bed(Bed&& b)
 
 Bed& Bed::operator=(Bed&& b) {
     _chrom = std::move(b._chrom);
+    _chromRank = b._chromRank;
     _start = std::move(b._start);
     _stop = std::move(b._stop);
     _extraFields = std::move(b._extraFields);
@@ -48,6 +52,7 @@ Bed& Bed::operator=(Bed&& b) {
 
 Bed& Bed::operator=(Bed const& b) {
     _chrom = b._chrom;
+    _chromRank = b._chromRank;
     _start = b._start;
     _stop = b._stop;
     _extraFields = b._extraFields;
@@ -57,6 +62,7 @@ Bed& Bed::operator=(Bed const& b) {
 
 Bed::Bed(const std::string& chrom, int64_t start, int64_t stop)
     : _chrom(chrom)
+    , _chromRank(ContigDictionary::instance().rank(chrom))
     , _start(start)
     , _stop(stop)
 {
@@ -64,6 +70,7 @@ Bed::Bed(const std::string& chrom, int64_t start, int64_t stop)
 
 Bed::Bed(const std::string& chrom, int64_t start, int64_t stop, const ExtraFieldsType& extraFields)
     : _chrom(chrom)
+    , _chromRank(ContigDictionary::instance().rank(chrom))
     , _start(start)
     , _stop(stop)
     , _extraFields(extraFields)
@@ -72,9 +79,20 @@ Bed::Bed(const std::string& chrom, int64_t start, int64_t stop, const ExtraField
 
 
 void Bed::parseLine(const BedHeader*, std::string& line, Bed& bed, int maxExtraFields) {
+    parseFields(StringView(line.data(), line.data() + line.size()), bed, maxExtraFields);
+    bed._line.swap(line);
+}
+
+void Bed::parseLine(const BedHeader*, StringView const& line, Bed& bed, int maxExtraFields) {
+    parseFields(line, bed, maxExtraFields);
+    bed._line.assign(line.begin(), line.end());
+}
+
+void Bed::parseFields(StringView const& line, Bed& bed, int maxExtraFields) {
     Tokenizer<char> tokenizer(line);
     if (!tokenizer.extract(bed._chrom))
         throw runtime_error(str(format("Failed to extract chromosome from bed line '%1%'") %line));
+    bed._chromRank = ContigDictionary::instance().rank(bed._chrom);
 
     if (!tokenizer.extract(bed._start))
         throw runtime_error(str(format("Failed to extract start position from bed line '%1%'") %line));
@@ -83,10 +101,13 @@ void Bed::parseLine(const BedHeader*, std::string& line, Bed& bed, int maxExtraF
         throw runtime_error(str(format("Failed to extract stop position from bed line '%1%'") %line));
 
 
-    bed._extraFields.clear();
+    // reuse the strings left over from the previous line
+    size_t nExtra = 0;
     int fields = 0;
     while ((maxExtraFields == -1 || fields++ < maxExtraFields) && !tokenizer.eof()) {
-        string extra;
+        if (nExtra == bed._extraFields.size())
+            bed._extraFields.push_back(string());
+        string& extra = bed._extraFields[nExtra++];
         tokenizer.extract(extra);
         // make ref/call uppercase and translate 0,- meaning "no data" to *
         if (fields == 1) {
@@ -96,20 +117,23 @@ void Bed::parseLine(const BedHeader*, std::string& line, Bed& bed, int maxExtraF
             if (boost::ends_with(extra, "/0") || boost::ends_with(extra, "/-"))
                 extra[extra.size()-1] = '*';
         }
-        bed._extraFields.push_back(std::move(extra));
     }
-
-    bed._line.swap(line);
+    bed._extraFields.resize(nExtra);
 }
 
 void Bed::swap(Bed& rhs) {
     _chrom.swap(rhs._chrom);
+    std::swap(_chromRank, rhs._chromRank);
     std::swap(_start, rhs._start);
     std::swap(_stop, rhs._stop);
     _line.swap(rhs._line);
     _extraFields.swap(rhs._extraFields);
 }
 
+std::size_t Bed::heapBytes() const {
+    return ::heapBytes(_chrom) + ::heapBytes(_extraFields) + ::heapBytes(_line);
+}
+
 const std::string& Bed::toString() const {
     if (_line.empty()) {
         stringstream ss;
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "common/ContigDictionary.hpp"
 #include "common/CoordinateView.hpp"
 #include "common/LocusCompare.hpp"
+#include "common/StringView.hpp"
 #include "common/cstdint.hpp"
 
 #include <boost/lexical_cast.hpp>
@@ -48,9 +50,15 @@ public:
     Bed& operator=(Bed&& b);
 
     static void parseLine(const BedHeader*, std::string& line, Bed& bed, int maxExtraFields = -1);
+    // Same as above, but copies the line rather than taking it over
+    static void parseLine(const BedHeader*, StringView const& line, Bed& bed, int maxExtraFields = -1);
     void swap(Bed& rhs);
 
+    // Approximate heap memory used by the record (see common/MemoryUsage.hpp)
+    std::size_t heapBytes() const;
+
     const std::string& chrom() const;
+    ContigRank const& chromRank() const;
     int64_t start() const;
     int64_t stop() const;
     int64_t length() const;
@@ -77,8 +85,12 @@ public:
             ;
     }
 
+protected:
+    static void parseFields(StringView const& line, Bed& bed, int maxExtraFields);
+
 protected:
     std::string _chrom;
+    ContigRank _chromRank;
     int64_t _start;
     int64_t _stop;
     ExtraFieldsType _extraFields;
@@ -90,6 +102,10 @@ inline const std::string& Bed::chrom() const {
     return _chrom;
 }
 
+inline ContigRank const& Bed::chromRank() const {
+    return _chromRank;
+}
+
 inline int64_t Bed::start() const {
     return _start;
 }
@@ -117,6 +133,7 @@ inline void Bed::setExtra(size_t idx, T const& value, std::string const& filler
 
 inline void Bed::chrom(std::string chrom) {
     _chrom = std::move(chrom);
+    _chromRank = ContigDictionary::instance().rank(_chrom);
     _line.clear();
 }
 
@@ -143,6 +160,7 @@ struct BedParser {
     BedParser();
     explicit BedParser(int maxExtraFields);
     void operator()(BedHeader const* h, std::string& line, Bed& bed);
+    void operator()(BedHeader const* h, StringView const& line, Bed& bed);
 };
 
 std::ostream& operator<<(std::ostream& s, const Bed& bed);
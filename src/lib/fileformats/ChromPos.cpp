@@ -1,4 +1,5 @@
 #include "ChromPos.hpp"
+#include "common/MemoryUsage.hpp"
 #include "common/Tokenizer.hpp"
 
 #include <boost/format.hpp>
@@ -20,6 +21,7 @@ ChromPos::ChromPos()
 
 ChromPos::ChromPos(const ChromPos& b)
     : _chrom(b._chrom)
+    , _chromRank(b._chromRank)
     , _start(b._start)
     , _line(b._line)
 {
@@ -27,6 +29,7 @@ ChromPos::ChromPos(const ChromPos& b)
 
 ChromPos::ChromPos(ChromPos&& b)
     : _chrom(std::move(b._chrom))
+    , _chromRank(b._chromRank)
     , _start(b._start)
     , _line(std::move(b._line))
 {
@@ -34,6 +37,7 @@ ChromPos::ChromPos(ChromPos&& b)
 
 ChromPos& ChromPos::operator=(ChromPos const& b) {
     _chrom = b._chrom;
+    _chromRank = b._chromRank;
     _start = b._start;
     _line = b._line;
     return *this;
@@ -41,6 +45,7 @@ ChromPos& ChromPos::operator=(ChromPos const& b) {
 
 ChromPos& ChromPos::operator=(ChromPos&& b) {
     _chrom = std::move(b._chrom);
+    _chromRank = b._chromRank;
     _start = std::move(b._start);
     _line = std::move(b._line);
     return *this;
@@ -52,6 +57,7 @@ void ChromPos::parseLine(const ChromPosHeader*, std::string& line, ChromPos& cp)
     Tokenizer<char> tokenizer(line);
     if (!tokenizer.extract(cp._chrom))
         throw runtime_error(str(format("Failed to extract chromosome from ChromPos line '%1%'") %line));
+    cp._chromRank = ContigDictionary::instance().rank(cp._chrom);
 
     if (!tokenizer.extract(cp._start))
         throw runtime_error(str(format("Failed to extract start position from ChromPos line '%1%'") %line));
@@ -61,10 +67,15 @@ void ChromPos::parseLine(const ChromPosHeader*, std::string& line, ChromPos& cp)
 
 void ChromPos::swap(ChromPos& rhs) {
     _chrom.swap(rhs._chrom);
+    std::swap(_chromRank, rhs._chromRank);
     std::swap(_start, rhs._start);
     _line.swap(rhs._line);
 }
 
+std::size_t ChromPos::heapBytes() const {
+    return ::heapBytes(_chrom) + ::heapBytes(_line);
+}
+
 const std::string& ChromPos::toString() const {
     return _line;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/ContigDictionary.hpp"
 #include "common/CoordinateView.hpp"
 #include "common/LocusCompare.hpp"
 #include "common/cstdint.hpp"
@@ -40,13 +41,18 @@ public:
     static void parseLine(const ChromPosHeader*, std::string& line, ChromPos& cp);
     void swap(ChromPos& rhs);
 
+    // Approximate heap memory used by the record (see common/MemoryUsage.hpp)
+    std::size_t heapBytes() const;
+
     const std::string& chrom() const;
+    ContigRank const& chromRank() const;
     int64_t start() const;
     int64_t stop() const;
     const std::string& toString() const;
 
 protected:
     std::string _chrom;
+    ContigRank _chromRank;
     int64_t _start;
 
     mutable std::string _line;
@@ -56,6 +62,10 @@ inline const std::string& ChromPos::chrom() const {
     return _chrom;
 }
 
+inline ContigRank const& ChromPos::chromRank() const {
+    return _chromRank;
+}
+
 inline int64_t ChromPos::start() const {
     return _start;
 }
@@ -1,5 +1,6 @@
 #include "FastaIndex.hpp"
 
+#include "common/ContigDictionary.hpp"
 #include "common/Tokenizer.hpp"
 
 #include <boost/format.hpp>
@@ -40,6 +41,7 @@ FastaIndex::FastaIndex(std::istream& in) {
         _sequenceOrder.push_back(e.name);
         _entries[e.name] = e;
     }
+    ContigDictionary::instance().add(_sequenceOrder);
 }
 
 std::vector<std::string> const& FastaIndex::sequenceOrder() const {
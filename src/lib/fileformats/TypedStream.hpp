@@ -1,6 +1,9 @@
 #pragma once
 
+#include "BatchParser.hpp"
+#include "common/StringView.hpp"
 #include "common/compat.hpp"
+#include "common/traits.hpp"
 #include "io/InputStream.hpp"
 
 #include <boost/format.hpp>
@@ -11,6 +14,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -34,6 +38,7 @@ public:
     typedef typename Parser::ValueType ValueType;
     typedef typename ValueType::HeaderType HeaderType;
     typedef std::unique_ptr<TypedStream<Parser>> ptr;
+    typedef BatchParser<Parser> BatchParserType;
 
     TypedStream(Parser& parser, InputStream& in)
         : parser_(parser)
@@ -69,12 +74,35 @@ public:
     void checkEof() const;
     uint64_t lineNum() const;
 
+    // Switch to batch mode: records are parsed on threads worker threads
+    // ahead of the consumer and returned in input order (see BatchParser,
+    // which also describes prepare). Must be called before any records are
+    // read. The input stream must not be used directly after this.
+    void parallel(
+        std::size_t threads,
+        typename BatchParser<Parser>::PrepareFunc prepare =
+            typename BatchParser<Parser>::PrepareFunc(),
+        std::size_t batchSize = BatchParser<Parser>::DEFAULT_BATCH_SIZE);
+
     Parser& parser() {
         return parser_;
     }
 
 protected:
-    std::string nextLine();
+    // Parsers that accept a StringView are handed lines straight out of
+    // the input buffers, the rest get a line buffer that is reused from
+    // one record to the next.
+    typedef std::integral_constant<bool,
+        traits::parses_line<Parser, StringView>::value> ParsesView;
+
+    bool readValue(ValueType& value, std::true_type);
+    bool readValue(ValueType& value, std::false_type);
+
+    template<typename Line>
+    bool nextLine(Line& line);
+
+    template<typename Line>
+    void parse(Line& line, ValueType& value);
 
 protected:
     HeaderType header_;
@@ -88,6 +116,9 @@ protected:
     bool cached_;
     bool cachedRv_;
     ValueType cachedValue_;
+    std::string line_;
+    // set in batch mode, declared last so that it goes before the rest
+    std::unique_ptr<BatchParser<Parser>> batch_;
 };
 
 template<typename Parser>
@@ -99,6 +130,8 @@ template<typename Parser>
 inline bool TypedStream<Parser>::eof() const {
     if (cached_)
         return !cachedRv_;
+    else if (batch_)
+        return batch_->eof();
     else
         return in_.eof();
 }
@@ -107,8 +140,9 @@ template<typename Parser>
 inline bool TypedStream<Parser>::peek(ValueType** value) {
     // already peeked and have a value to return
     if (cached_) {
-        // we peeked but got EOF
-        if (in_.eof())
+        // we peeked but got EOF (in batch mode, the input is read ahead
+        // so only the result of the peek says)
+        if (batch_ ? !cachedRv_ : in_.eof())
             return false;
 
         *value = &cachedValue_;
@@ -134,10 +168,45 @@ inline bool TypedStream<Parser>::next(ValueType& value) {
         return cachedRv_;
     }
 
-    std::string line = nextLine();
-    if (line.empty())
+    if (batch_ ? !batch_->next(value) : !readValue(value, ParsesView()))
+        return false;
+
+    ++valueCount_;
+    return true;
+}
+
+template<typename Parser>
+inline bool TypedStream<Parser>::readValue(ValueType& value, std::true_type) {
+    StringView line;
+    if (!nextLine(line))
+        return false;
+
+    parse(line, value);
+    return true;
+}
+
+template<typename Parser>
+inline bool TypedStream<Parser>::readValue(ValueType& value, std::false_type) {
+    if (!nextLine(line_))
         return false;
 
+    parse(line_, value);
+    return true;
+}
+
+template<typename Parser>
+template<typename Line>
+inline bool TypedStream<Parser>::nextLine(Line& line) {
+    do {
+        line.clear();
+        in_.getline(line);
+    } while (!eof() && (line.empty() || line[0] == '#'));
+    return !line.empty();
+}
+
+template<typename Parser>
+template<typename Line>
+inline void TypedStream<Parser>::parse(Line& line, ValueType& value) {
     try {
         parser_(&header_, line, value);
     }
@@ -147,17 +216,6 @@ inline bool TypedStream<Parser>::next(ValueType& value) {
             str(format("Error at %1%:%2%: %3%"
                 ) % name() % in_.lineNum() % e.what()));
     }
-    ++valueCount_;
-    return true;
-}
-
-template<typename Parser>
-inline std::string TypedStream<Parser>::nextLine() {
-    std::string line;
-    do {
-        in_.getline(line);
-    } while (!eof() && (line.empty() || line[0] == '#'));
-    return line;
 }
 
 template<typename Parser>
@@ -173,7 +231,22 @@ inline void TypedStream<Parser>::checkEof() const {
 
 template<typename Parser>
 inline uint64_t TypedStream<Parser>::lineNum() const {
-    return in_.lineNum();
+    return batch_ ? batch_->lineNum() : in_.lineNum();
+}
+
+template<typename Parser>
+inline void TypedStream<Parser>::parallel(
+        std::size_t threads,
+        typename BatchParser<Parser>::PrepareFunc prepare,
+        std::size_t batchSize)
+{
+    if (batch_)
+        throw std::runtime_error("Batch mode already enabled for stream " + name());
+    if (cached_ || valueCount_ > 0)
+        throw std::runtime_error("Batch mode enabled after reading from stream " + name());
+
+    batch_ = std::make_unique<BatchParser<Parser>>(
+        parser_, header_, in_, threads, batchSize, prepare);
 }
 
 
@@ -189,6 +262,7 @@ struct DefaultParser {
 
 template<typename Parser>
 struct TypedStreamFactory {
+    typedef Parser ParserType;
     typedef typename Parser::ValueType ValueType;
     typedef TypedStream<Parser> StreamType;
     typedef typename StreamType::ptr StreamPtr;
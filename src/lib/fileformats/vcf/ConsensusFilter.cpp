@@ -20,7 +20,8 @@ void ConsensusFilter::apply(Entry& entry, std::vector<size_t> const* counts) con
     auto sourceCounts = _header->sampleSourceCounts();
     if (_percent > 0.0 && !_filterName.empty()) {
         for (auto i = sdata.begin(); i != sdata.end(); ++i) {
-            auto const& sampleName = entry.header().sampleNames()[i->first];
+            uint32_t sampleIdx = *i;
+            auto const& sampleName = entry.header().sampleNames()[sampleIdx];
             size_t mergedIndex = _header->sampleIndex(sampleName);
 
             if (mergedIndex >= sourceCounts.size())
@@ -31,11 +32,11 @@ void ConsensusFilter::apply(Entry& entry, std::vector<size_t> const* counts) con
             if (counts)
                 actual = (*counts)[mergedIndex];
             else
-                actual = i->second != 0;
+                actual = sdata.count(sampleIdx);
 
             double pct = actual/double(total);
             if (pct < _percent) {
-                sdata.addFilter(i->first, _filterName);
+                sdata.addFilter(sampleIdx, _filterName);
                 entry.addFilter(_filterName);
             }
         }
@@ -58,6 +58,7 @@ CustomType::CustomType(const string& raw) {
             _description = value;
         }
     }
+    _symbol = Symbol(_id);
 }
 
 CustomType::CustomType(
@@ -68,6 +69,7 @@ CustomType::CustomType(
         const string& description
         )
     : _id(id)
+    , _symbol(id)
     , _numberType(numberType)
     , _number(number)
     , _type(type)
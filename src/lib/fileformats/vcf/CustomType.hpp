@@ -1,5 +1,6 @@
 #pragma once
 
+#include "SymbolTable.hpp"
 #include "common/namespaces.hpp"
 #include "common/cstdint.hpp"
 
@@ -46,6 +47,8 @@ public:
     }
 
     const std::string& id() const;
+    // The id in the SymbolTable
+    Symbol symbol() const;
     NumberType numberType() const;
     uint32_t number() const;
     DataType type() const;
@@ -83,6 +86,7 @@ public:
 
 protected:
     std::string _id;
+    Symbol _symbol;
     NumberType _numberType;
     uint32_t _number;
     DataType _type;
@@ -93,6 +97,10 @@ inline const std::string& CustomType::id() const {
     return _id;
 }
 
+inline Symbol CustomType::symbol() const {
+    return _symbol;
+}
+
 inline CustomType::NumberType CustomType::numberType() const {
     return _numberType;
 }
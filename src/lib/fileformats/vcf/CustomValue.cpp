@@ -1,78 +1,173 @@
 #include "CustomValue.hpp"
+#include "common/MemoryUsage.hpp"
 
 #include <boost/format.hpp>
-#include <boost/lexical_cast.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
 #include <utility>
 
 using boost::format;
-using boost::lexical_cast;
 using namespace std;
 
 BEGIN_NAMESPACE(Vcf)
 
+uint32_t const CustomValue::INLINE_MISSING;
+
+namespace {
+    bool parseValue(char const* beg, char const* end, int64_t& value) {
+        return parseInteger(beg, end, value);
+    }
+
+    bool parseValue(char const* beg, char const* end, double& value) {
+        return parseDouble(beg, end, value);
+    }
+
+    bool parseValue(char const* beg, char const* end, char& value) {
+        if (end - beg != 1)
+            return false;
+        value = *beg;
+        return true;
+    }
+
+    bool parseValue(char const* beg, char const* end, bool& value) {
+        if (end - beg != 1 || (*beg != '0' && *beg != '1'))
+            return false;
+        value = *beg == '1';
+        return true;
+    }
+
+    bool parseValue(char const* beg, char const* end, std::string& value) {
+        value.assign(beg, end);
+        return true;
+    }
+
+    void writeValue(ostream& s, int64_t value) { writeInteger(s, value); }
+    void writeValue(ostream& s, double value) { writeDouble(s, value); }
+    void writeValue(ostream& s, char value) { s << value; }
+    void writeValue(ostream& s, bool value) { s << value; }
+    void writeValue(ostream& s, std::string const& value) { s << value; }
+
+    std::string invalidType() {
+        return "Invalid custom VCF type!";
+    }
+}
+
 CustomValue::CustomValue()
     : _type(0)
+    , _storage(CustomType::INTEGER)
+    , _size(0)
+    , _capacity(0)
 {
+    _values.integer = 0;
+    _missing.bits = 0;
 }
 
 CustomValue::CustomValue(CustomValue const& other)
     : _type(other._type)
-    , _values(other._values)
+    , _storage(other._storage)
+    , _size(0)
+    , _capacity(0)
 {
+    _values.integer = 0;
+    _missing.bits = 0;
+
+    switch (_storage) {
+        case CustomType::INTEGER: copyFrom<int64_t>(other); break;
+        case CustomType::FLOAT: copyFrom<double>(other); break;
+        case CustomType::CHAR: copyFrom<char>(other); break;
+        case CustomType::STRING: copyFrom<std::string>(other); break;
+        case CustomType::FLAG: copyFrom<bool>(other); break;
+    }
 }
 
 CustomValue::CustomValue(CustomValue&& other)
     : _type(other._type)
-    , _values(std::move(other._values))
+    , _storage(other._storage)
+    , _size(other._size)
+    , _capacity(other._capacity)
+    , _values(other._values)
+    , _missing(other._missing)
 {
+    other._size = 0;
+    other._capacity = 0;
+    other._missing.bits = 0;
 }
 
 CustomValue::CustomValue(const CustomType* type, const std::vector<ValueType>&& values)
     : _type(type)
-    , _values(std::move(values))
+    , _storage(type->type())
+    , _size(0)
+    , _capacity(0)
 {
+    _values.integer = 0;
+    _missing.bits = 0;
+    setRaw(values);
+}
+
+CustomValue::~CustomValue() {
+    switch (_storage) {
+        case CustomType::INTEGER: release<int64_t>(); break;
+        case CustomType::FLOAT: release<double>(); break;
+        case CustomType::CHAR: release<char>(); break;
+        case CustomType::STRING: release<std::string>(); break;
+        case CustomType::FLAG: release<bool>(); break;
+    }
 }
 
 CustomValue& CustomValue::operator=(CustomValue const& other) {
-    _type = other._type;
-    _values = other._values;
+    if (this != &other) {
+        CustomValue tmp(other);
+        swap(tmp);
+    }
     return *this;
 }
 
 CustomValue& CustomValue::operator=(CustomValue&& other) {
-    _type = other._type;
-    _values.swap(other._values);
+    swap(other);
     return *this;
 }
 
 CustomValue::CustomValue(const CustomType* type)
     : _type(type)
+    , _storage(type ? type->type() : CustomType::INTEGER)
+    , _size(0)
+    , _capacity(0)
 {
+    _values.integer = 0;
+    _missing.bits = 0;
 }
 
 CustomValue::CustomValue(const CustomType* type, const string& value)
-    : _type(type)
+    : CustomValue(type, value.data(), value.data() + value.size())
+{
+}
+
+CustomValue::CustomValue(const CustomType* type, char const* beg, char const* end)
+    : CustomValue(type)
 {
-    if (value == ".")
+    if (end - beg == 1 && *beg == '.')
         return;
 
     bool rv = false;
     switch (type->type()) {
         case CustomType::INTEGER:
-            rv = set<int64_t>(value);
+            rv = parse<int64_t>(beg, end);
             break;
 
         case CustomType::FLOAT:
-            rv = set<double>(value);
+            rv = parse<double>(beg, end);
             break;
 
         case CustomType::CHAR:
-            rv = set<char>(value);
+            rv = parse<char>(beg, end);
             break;
 
         case CustomType::STRING:
-            rv = set<string>(value);
+            rv = parse<string>(beg, end);
             break;
 
         case CustomType::FLAG:
@@ -82,21 +177,333 @@ CustomValue::CustomValue(const CustomType* type, const string& value)
             break;
 
         default:
-            throw runtime_error("Invalid custom VCF type!");
+            throw runtime_error(invalidType());
             break;
     }
 
     if (rv == false)
         throw runtime_error(str(format("Failed to coerce value '%1%' into %2% for field '%3%'")
-            %value %CustomType::typeToString(type->type()) %type->id()));
+            %string(beg, end) %CustomType::typeToString(type->type()) %type->id()));
+}
+
+template<typename T>
+bool CustomValue::parse(char const* beg, char const* end) {
+    if (beg == end) {
+        clear();
+        return true;
+    }
+
+    type().typecheck<T>();
+    uint32_t nItems = std::count(beg, end, ',') + 1;
+    resizeValues<T>(nItems);
+
+    T* out = values<T>();
+    for (uint32_t idx = 0; ; ++idx) {
+        char const* next = static_cast<char const*>(memchr(beg, ',', end - beg));
+        if (!next)
+            next = end;
+
+        if (next == beg)
+            return false;
+
+        if (next - beg != 1 || *beg != '.') {
+            if (!parseValue(beg, next, out[idx]))
+                return false;
+            setMissing(idx, false);
+        }
+
+        if (next == end)
+            break;
+        beg = next + 1;
+    }
+    type().validateIndex(_size - 1);
+
+    return true;
 }
 
-const CustomValue::ValueType* CustomValue::getAny(SizeType idx) const {
+template<typename T>
+void CustomValue::reallocate(uint32_t capacity) {
+    T* oldValues = values<T>();
+    uint64_t const* oldMissing = missingWords();
+    uint32_t words = (_size + 63) / 64;
+
+    bool toInline = !std::is_same<T, std::string>::value && capacity <= 1;
+    T* array = 0;
+    T single = T();
+    if (toInline) {
+        if (_size)
+            single = oldValues[0];
+    }
+    else {
+        array = new T[capacity]();
+        std::move(oldValues, oldValues + _size, array);
+    }
+
+    uint64_t* missingWords = 0;
+    uint64_t missingBits = 0;
+    if (capacity > INLINE_MISSING) {
+        missingWords = new uint64_t[(capacity + 63) / 64]();
+        std::copy(oldMissing, oldMissing + words, missingWords);
+    }
+    else if (words) {
+        missingBits = oldMissing[0];
+    }
+
+    release<T>();
+    _capacity = capacity;
+    if (toInline)
+        *inlineValue(static_cast<T*>(0)) = single;
+    else
+        _values.array = array;
+
+    if (missingWords)
+        _missing.words = missingWords;
+    else
+        _missing.bits = missingBits;
+}
+
+template<typename T>
+void CustomValue::release() {
+    if (!inlineValues<T>() && _capacity > 0)
+        delete[] static_cast<T*>(_values.array);
+    if (_capacity > INLINE_MISSING)
+        delete[] _missing.words;
+    _capacity = 0;
+    _missing.bits = 0;
+}
+
+template<typename T>
+void CustomValue::resizeValues(uint32_t size) {
+    if (size > _capacity) {
+        uint32_t capacity = size;
+        if (_capacity > 0)
+            capacity = std::max(size, 2 * _capacity);
+        reallocate<T>(capacity);
+    }
+
+    // new values are missing
+    T* array = values<T>();
+    for (uint32_t i = _size; i < size; ++i) {
+        array[i] = T();
+        setMissing(i, true);
+    }
+    _size = size;
+}
+
+template<typename T>
+void CustomValue::copyFrom(CustomValue const& other) {
+    resizeValues<T>(other._size);
+    std::copy(other.values<T>(), other.values<T>() + other._size, values<T>());
+    uint64_t const* words = other.missingWords();
+    std::copy(words, words + (other._size + 63) / 64, missingWords());
+}
+
+template<typename T>
+void CustomValue::appendFrom(CustomValue const& other, uint32_t first, uint32_t count) {
+    uint32_t idx = _size;
+    resizeValues<T>(_size + count);
+    T const* src = other.values<T>();
+    T* dst = values<T>();
+    for (uint32_t i = first; i < first + count; ++i, ++idx) {
+        if (other.isMissing(i))
+            continue;
+        dst[idx] = src[i];
+        setMissing(idx, false);
+    }
+}
+
+template<typename T>
+bool CustomValue::equalValues(CustomValue const& rhs) const {
+    T const* a = values<T>();
+    T const* b = rhs.values<T>();
+    for (uint32_t i = 0; i < _size; ++i) {
+        bool missing = isMissing(i);
+        if (missing != rhs.isMissing(i) || (!missing && !(a[i] == b[i])))
+            return false;
+    }
+    return true;
+}
+
+template<typename T>
+void CustomValue::writeValues(ostream& s) const {
+    T const* array = values<T>();
+    for (uint32_t i = 0; i < _size; ++i) {
+        if (i > 0)
+            s << ',';
+        if (isMissing(i))
+            s << '.';
+        else
+            writeValue(s, array[i]);
+    }
+}
+
+template<typename T>
+std::size_t CustomValue::arrayBytes() const {
+    std::size_t rv = 0;
+    if (!inlineValues<T>())
+        rv += allocationBytes(_capacity * sizeof(T));
+    if (_capacity > INLINE_MISSING)
+        rv += allocationBytes((_capacity + 63) / 64 * sizeof(uint64_t));
+    return rv;
+}
+
+void CustomValue::setMissing(uint32_t idx, bool missing) {
+    uint64_t& word = missingWords()[idx / 64];
+    uint64_t bit = uint64_t(1) << (idx % 64);
+    if (missing)
+        word |= bit;
+    else
+        word &= ~bit;
+}
+
+void CustomValue::ensureCapacity(SizeType size) {
+    if (size > _size)
+        resize(size);
+}
+
+void CustomValue::resize(SizeType size) {
+    switch (_storage) {
+        case CustomType::INTEGER: resizeValues<int64_t>(size); break;
+        case CustomType::FLOAT: resizeValues<double>(size); break;
+        case CustomType::CHAR: resizeValues<char>(size); break;
+        case CustomType::STRING: resizeValues<std::string>(size); break;
+        case CustomType::FLAG: resizeValues<bool>(size); break;
+    }
+}
+
+void CustomValue::clear() {
+    _size = 0;
+}
+
+void CustomValue::swap(CustomValue& other) {
+    std::swap(_type, other._type);
+    std::swap(_storage, other._storage);
+    std::swap(_size, other._size);
+    std::swap(_capacity, other._capacity);
+    std::swap(_values, other._values);
+    std::swap(_missing, other._missing);
+}
+
+void CustomValue::setType(const CustomType* type) {
+    if (_capacity == 0 || type->type() == _storage) {
+        _type = type;
+        _storage = type->type();
+        return;
+    }
+
+    // the values have to be stored as a different type
+    std::vector<ValueType> values = getRaw();
+    CustomValue converted(type);
+    converted.setRaw(values);
+    swap(converted);
+}
+
+auto CustomValue::valueAt(uint32_t idx) const -> ValueType {
+    if (idx >= _size || isMissing(idx))
+        return ValueType();
+
+    switch (_storage) {
+        case CustomType::INTEGER: return values<int64_t>()[idx];
+        case CustomType::FLOAT: return values<double>()[idx];
+        case CustomType::CHAR: return values<char>()[idx];
+        case CustomType::STRING: return values<std::string>()[idx];
+        case CustomType::FLAG: return values<bool>()[idx];
+    }
+    return ValueType();
+}
+
+auto CustomValue::getAny(SizeType idx) const -> ValueType {
     type().validateIndex(idx);
-    if (idx >= _values.size() || _values[idx].which() == 0) {
-        return 0;
+    return valueAt(idx);
+}
+
+auto CustomValue::getRaw() const -> std::vector<ValueType> {
+    std::vector<ValueType> rv(_size);
+    for (uint32_t i = 0; i < _size; ++i)
+        rv[i] = valueAt(i);
+    return rv;
+}
+
+void CustomValue::setRaw(std::vector<ValueType> const& values) {
+    clear();
+    resize(values.size());
+    for (uint32_t i = 0; i < values.size(); ++i)
+        setAny(i, values[i]);
+}
+
+void CustomValue::setAny(uint32_t idx, ValueType const& value) {
+    if (value.which() == 0) {
+        setMissing(idx, true);
+        return;
     }
-    return &_values[idx];
+
+    bool ok = false;
+    switch (_storage) {
+        case CustomType::INTEGER:
+            if (int64_t const* v = boost::get<int64_t>(&value)) {
+                values<int64_t>()[idx] = *v;
+                ok = true;
+            }
+            else if (bool const* v = boost::get<bool>(&value)) {
+                values<int64_t>()[idx] = *v;
+                ok = true;
+            }
+            break;
+
+        case CustomType::FLOAT:
+            if (double const* v = boost::get<double>(&value)) {
+                values<double>()[idx] = *v;
+                ok = true;
+            }
+            else if (int64_t const* v = boost::get<int64_t>(&value)) {
+                values<double>()[idx] = *v;
+                ok = true;
+            }
+            break;
+
+        case CustomType::CHAR:
+            if (char const* v = boost::get<char>(&value)) {
+                values<char>()[idx] = *v;
+                ok = true;
+            }
+            break;
+
+        case CustomType::STRING:
+            if (std::string const* v = boost::get<std::string>(&value)) {
+                values<std::string>()[idx] = *v;
+                ok = true;
+            }
+            break;
+
+        case CustomType::FLAG:
+            if (bool const* v = boost::get<bool>(&value)) {
+                values<bool>()[idx] = *v;
+                ok = true;
+            }
+            break;
+    }
+
+    if (!ok) {
+        // fall back on the text of the value
+        stringstream ss;
+        boost::apply_visitor(CustomValueWriter(ss), value);
+        std::string text = ss.str();
+        char const* beg = text.data();
+        char const* end = beg + text.size();
+        switch (_storage) {
+            case CustomType::INTEGER: ok = parseValue(beg, end, values<int64_t>()[idx]); break;
+            case CustomType::FLOAT: ok = parseValue(beg, end, values<double>()[idx]); break;
+            case CustomType::CHAR: ok = parseValue(beg, end, values<char>()[idx]); break;
+            case CustomType::STRING: ok = parseValue(beg, end, values<std::string>()[idx]); break;
+            case CustomType::FLAG: ok = parseValue(beg, end, values<bool>()[idx]); break;
+        }
+
+        if (!ok) {
+            throw runtime_error(str(format("Value '%1%' of the wrong type for %2% field '%3%'")
+                %text %CustomType::typeToString(_storage) %type().id()));
+        }
+    }
+    setMissing(idx, false);
 }
 
 const CustomType& CustomValue::type() const {
@@ -105,14 +512,6 @@ const CustomType& CustomValue::type() const {
     return *_type;
 }
 
-CustomValue::SizeType CustomValue::size() const {
-    return _values.size();
-}
-
-bool CustomValue::empty() const {
-    return _values.empty();
-}
-
 // This gets called to notify existing values how many alleles there are.
 // This gives them the opportunity to throw an exception if there are more
 // values than there are supposed to be
@@ -125,7 +524,7 @@ void CustomValue::setNumAlts(uint32_t n) {
         maxValue = n + 1;
     }
 
-    if (_values.size() > maxValue) {
+    if (_size > maxValue) {
         std::stringstream ss;
         ss << (*this);
         throw std::runtime_error(str(format(
@@ -135,34 +534,34 @@ void CustomValue::setNumAlts(uint32_t n) {
     }
 
     if (type().numberType() == CustomType::PER_ALLELE) {
-        _values.resize(n);
+        resize(n);
     }
     else if (type().numberType() == CustomType::PER_ALLELE_REF) {
-        _values.resize(n + 1);
+        resize(n + 1);
     }
 }
 
 std::string CustomValue::getString(SizeType idx) const {
     type().validateIndex(idx);
-    if (idx >= _values.size() || _values[idx].empty())
+    if (idx >= _size || isMissing(idx))
         return ".";
 
-    stringstream ss;
+    char buf[MAX_DOUBLE_CHARS];
     switch (type().type()) {
         case CustomType::INTEGER:
-             ss << *get<int64_t>(idx);
+            return string(buf, formatInteger(buf, values<int64_t>()[idx]));
             break;
 
         case CustomType::FLOAT:
-            ss << *get<double>(idx);
+            return string(buf, formatDouble(buf, values<double>()[idx]));
             break;
 
         case CustomType::CHAR:
-            ss << *get<char>(idx);
+            return string(1, values<char>()[idx]);
             break;
 
         case CustomType::STRING:
-            return *get<string>(idx);
+            return values<std::string>()[idx];
             break;
 
         case CustomType::FLAG:
@@ -171,11 +570,11 @@ std::string CustomValue::getString(SizeType idx) const {
             break;
 
         default:
-            throw runtime_error("Invalid custom VCF type!");
+            throw runtime_error(invalidType());
             break;
     }
 
-    return ss.str();
+    return string();
 }
 
 void CustomValue::toStream(ostream& s) const {
@@ -186,27 +585,27 @@ void CustomValue::toStream(ostream& s) const {
 
     switch (type().type()) {
         case CustomType::INTEGER:
-            toStream_impl<int64_t>(s);
+            writeValues<int64_t>(s);
             break;
 
         case CustomType::FLOAT:
-            toStream_impl<double>(s);
+            writeValues<double>(s);
             break;
 
         case CustomType::CHAR:
-            toStream_impl<char>(s);
+            writeValues<char>(s);
             break;
 
         case CustomType::STRING:
-            toStream_impl<string>(s);
+            writeValues<string>(s);
             break;
 
         case CustomType::FLAG:
-            toStream_impl<bool>(s);
+            writeValues<bool>(s);
             break;
 
         default:
-            throw runtime_error("Invalid custom VCF type!");
+            throw runtime_error(invalidType());
             break;
     }
 }
@@ -218,15 +617,38 @@ std::string CustomValue::toString() const {
 }
 
 void CustomValue::append(const CustomValue& other) {
-    if (other.type() != type())
+    if (&other.type() != &type() && other.type() != type())
         throw runtime_error(str(format("Attempted to concatenate conflicting custom types: %1% and %2%")
             %type().toString() %other.type().toString()));
-    SizeType idx = size();
     SizeType newSize = size() + other.size();
     type().validateIndex(newSize-1);
-    ensureCapacity(newSize);
-    for (SizeType i = 0; i < other.size(); ++i)
-        _values[idx++] = other._values[i];
+
+    switch (_storage) {
+        case CustomType::INTEGER: appendFrom<int64_t>(other, 0, other._size); break;
+        case CustomType::FLOAT: appendFrom<double>(other, 0, other._size); break;
+        case CustomType::CHAR: appendFrom<char>(other, 0, other._size); break;
+        case CustomType::STRING: appendFrom<std::string>(other, 0, other._size); break;
+        case CustomType::FLAG: appendFrom<bool>(other, 0, other._size); break;
+    }
+}
+
+void CustomValue::append(const CustomValue& other, SizeType idx) {
+    if (&other.type() != &type() && other.type() != type())
+        throw runtime_error(str(format("Attempted to concatenate conflicting custom types: %1% and %2%")
+            %type().toString() %other.type().toString()));
+    other.type().validateIndex(idx);
+    type().validateIndex(size());
+    if (idx >= other.size())
+        throw runtime_error(str(format("Request for index %1% of a %2% value with %3% values")
+            %idx %type().id() %other.size()));
+
+    switch (_storage) {
+        case CustomType::INTEGER: appendFrom<int64_t>(other, idx, 1); break;
+        case CustomType::FLOAT: appendFrom<double>(other, idx, 1); break;
+        case CustomType::CHAR: appendFrom<char>(other, idx, 1); break;
+        case CustomType::STRING: appendFrom<std::string>(other, idx, 1); break;
+        case CustomType::FLAG: appendFrom<bool>(other, idx, 1); break;
+    }
 }
 
 CustomValue& CustomValue::operator+=(const CustomValue& rhs) {
@@ -264,6 +686,49 @@ CustomValue& CustomValue::operator+=(const CustomValue& rhs) {
     return *this;
 }
 
+bool CustomValue::operator==(const CustomValue& rhs) const {
+    if (_type != rhs._type && *_type != rhs.type())
+        return false;
+
+    // Values are equal when they print the same. Apart from Float values,
+    // which print rounded, and '.' compared to no values at all, that
+    // is when the typed values are equal.
+    if (_size == rhs._size) {
+        bool equal = false;
+        switch (_storage) {
+            case CustomType::INTEGER: equal = equalValues<int64_t>(rhs); break;
+            case CustomType::FLOAT: equal = equalValues<double>(rhs); break;
+            case CustomType::CHAR: equal = equalValues<char>(rhs); break;
+            case CustomType::STRING: equal = equalValues<std::string>(rhs); break;
+            case CustomType::FLAG: equal = equalValues<bool>(rhs); break;
+        }
+        if (equal || _storage != CustomType::FLOAT)
+            return equal;
+    }
+    else if (_size > 1 || rhs._size > 1) {
+        return false;
+    }
+
+    return toString() == rhs.toString();
+}
+
+std::size_t CustomValue::heapBytes() const {
+    switch (_storage) {
+        case CustomType::INTEGER: return arrayBytes<int64_t>();
+        case CustomType::FLOAT: return arrayBytes<double>();
+        case CustomType::CHAR: return arrayBytes<char>();
+        case CustomType::FLAG: return arrayBytes<bool>();
+        case CustomType::STRING: {
+            std::size_t rv = arrayBytes<std::string>();
+            std::string const* array = values<std::string>();
+            for (uint32_t i = 0; i < _size; ++i)
+                rv += ::heapBytes(array[i]);
+            return rv;
+        }
+    }
+    return 0;
+}
+
 END_NAMESPACE(Vcf)
 
 std::ostream& operator<<(std::ostream& s, const Vcf::CustomValue& v) {
@@ -2,41 +2,78 @@
 
 #include "CustomType.hpp"
 #include "common/cstdint.hpp"
-#include "common/Tokenizer.hpp"
+#include "common/NumberConversion.hpp"
 #include "common/namespaces.hpp"
 
 #include <boost/variant.hpp>
 
-#include <algorithm>
-#include <functional>
+#include <cstddef>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <ostream>
 
 BEGIN_NAMESPACE(Vcf)
 
+namespace detail {
+    // The type CustomValue stores a value of type T as
+    template<typename T, typename Enable = void>
+    struct CustomValueStorage {
+        typedef T type;
+    };
+
+    template<typename T>
+    struct CustomValueStorage<
+          T
+        , typename std::enable_if<
+                std::is_integral<T>::value
+                && !std::is_same<T, char>::value
+                && !std::is_same<T, bool>::value
+            >::type
+        >
+    {
+        typedef int64_t type;
+    };
+}
+
+// The values of an INFO or FORMAT field. Values are stored as the C++
+// type that goes with the data type of the field: int64_t for Integer,
+// double for Float, char for Character, bool for Flag and std::string for
+// String. A single Integer, Float, Character or Flag value (e.g., a
+// Number=1 DP field) is kept inside the object; more values, and String
+// values, are kept in an array on the heap. '.' values are marked in a
+// bitmap.
+//
+// ValueType, getAny() and getRaw()/setRaw() convert to and from a
+// variant per value for code that does not care about the type.
 class CustomValue {
 public:
     typedef boost::variant<boost::blank, int64_t, double, char, bool, std::string> ValueType;
-    typedef std::vector<ValueType>::size_type SizeType;
+    typedef std::size_t SizeType;
 
     CustomValue();
 
     CustomValue(CustomValue const& other);
     CustomValue(CustomValue&& other);
+    ~CustomValue();
 
     CustomValue& operator=(CustomValue const& other);
     CustomValue& operator=(CustomValue&& other);
 
     explicit CustomValue(const CustomType* type);
     CustomValue(const CustomType* type, const std::string& value);
+    CustomValue(const CustomType* type, char const* beg, char const* end);
     CustomValue(const CustomType* type, const std::vector<ValueType>&& values);
 
-    void setType(const CustomType* type) { _type = type; }
+    // Values are converted if the data type changes
+    void setType(const CustomType* type);
     const CustomType& type() const;
     SizeType size() const;
     bool empty() const;
-    const ValueType* getAny(SizeType idx) const;
+    // True if value idx is '.' or past the end
+    bool missing(SizeType idx) const;
+    // The value at idx, blank if it is missing
+    ValueType getAny(SizeType idx) const;
 
     template<typename T>
     const T* get(SizeType idx = 0) const;
@@ -44,13 +81,13 @@ public:
     template<typename T>
     void set(SizeType idx, const T& value);
 
-    std::vector<ValueType> const& getRaw() const {
-        return _values;
-    }
+    // All size() values for typed loops, T being the type the values are
+    // stored as. Missing values hold T().
+    template<typename T>
+    const T* data() const;
 
-    void setRaw(std::vector<ValueType> values) {
-        _values.swap(values);
-    }
+    std::vector<ValueType> getRaw() const;
+    void setRaw(std::vector<ValueType> const& values);
 
     std::string getString(SizeType idx) const;
     void toStream(std::ostream& s) const;
@@ -59,131 +96,200 @@ public:
     void setNumAlts(uint32_t n);
 
     void append(const CustomValue& other);
+    // Append value idx of other
+    void append(const CustomValue& other, SizeType idx);
+
+    void swap(CustomValue& other);
+
+    // Approximate heap memory used by the values (see common/MemoryUsage.hpp)
+    std::size_t heapBytes() const;
 
     CustomValue& operator+=(const CustomValue& rhs);
     bool operator==(const CustomValue& rhs) const;
     bool operator!=(const CustomValue& rhs) const;
 
 protected:
+    // Values past this many have their missing bits on the heap
+    static uint32_t const INLINE_MISSING = 64;
+
     template<typename T>
-    void add(const CustomValue& rhs) {
-        ensureCapacity(rhs.size());
-        for (SizeType i = 0; i < type().number(); ++i) {
-            T val(0);
-            const T* a = get<T>(i);
-            const T* b = rhs.get<T>(i);
-            if (a != NULL) val += *a;
-            if (b != NULL) val += *b;
-            _values[i] = val;
-        }
-    }
+    void add(const CustomValue& rhs);
 
     template<typename T>
-    bool set(const std::string& value) {
-        if (value.empty()) {
-            _values.clear();
-            return true;
-        }
-
-        type().typecheck<T>();
-        uint32_t nItems = std::count_if(value.begin(), value.end(),
-            std::bind1st(std::equal_to<char>(), ',')) + 1;
-        _values.resize(nItems);
-
-        Tokenizer<char> t(value, ',');
-
-        const static std::string nullString(".");
-        uint32_t idx(0);
-        while (!t.eof()) {
-            if (t.nextTokenMatches(""))
-                return false;
-
-            T tmp = T();
-            if (t.nextTokenMatches(nullString)) {
-                t.advance();
-            }
-            else if (t.extract(tmp)) {
-                _values[idx] = tmp;
-            }
-            else {
-                return false;
-            }
-            ++idx;
-        }
-        type().validateIndex(_values.size()-1);
-
-        return t.eof();
-    }
+    bool parse(char const* beg, char const* end);
 
+    // Grow to at least size values, the new ones missing
+    void ensureCapacity(SizeType size);
+    void resize(SizeType size);
+    void clear();
 
-    void ensureCapacity(uint32_t size);
+    bool isMissing(uint32_t idx) const;
+    void setMissing(uint32_t idx, bool missing);
+    uint64_t* missingWords();
+    uint64_t const* missingWords() const;
 
-protected:
     template<typename T>
-    void toStream_impl(std::ostream& s) const;
+    T* values();
+    template<typename T>
+    T const* values() const;
+
+    // The address of the inline value, or null for strings
+    int64_t* inlineValue(int64_t*) { return &_values.integer; }
+    double* inlineValue(double*) { return &_values.real; }
+    char* inlineValue(char*) { return &_values.character; }
+    bool* inlineValue(bool*) { return &_values.flag; }
+    std::string* inlineValue(std::string*) { return 0; }
+
+    template<typename T>
+    bool inlineValues() const;
+
+    template<typename T>
+    void reallocate(uint32_t capacity);
+    template<typename T>
+    void release();
+    template<typename T>
+    void copyFrom(CustomValue const& other);
+    template<typename T>
+    bool equalValues(CustomValue const& rhs) const;
+    template<typename T>
+    void writeValues(std::ostream& s) const;
+    template<typename T>
+    void appendFrom(CustomValue const& other, uint32_t first, uint32_t count);
+    template<typename T>
+    void resizeValues(uint32_t size);
+    template<typename T>
+    std::size_t arrayBytes() const;
+
+    ValueType valueAt(uint32_t idx) const;
+    void setAny(uint32_t idx, ValueType const& value);
 
 protected:
     const CustomType* _type;
-    std::vector<ValueType> _values;
+    // The data type the values are stored as
+    CustomType::DataType _storage;
+    uint32_t _size;
+    uint32_t _capacity;
+    union {
+        int64_t integer;
+        double real;
+        char character;
+        bool flag;
+        void* array;
+    } _values;
+    union {
+        uint64_t bits;
+        uint64_t* words;
+    } _missing;
 };
 
+template<typename T>
+inline bool CustomValue::inlineValues() const {
+    return !std::is_same<T, std::string>::value && _capacity <= 1;
+}
+
+template<typename T>
+inline T* CustomValue::values() {
+    if (inlineValues<T>())
+        return inlineValue(static_cast<T*>(0));
+    return static_cast<T*>(_values.array);
+}
+
+template<typename T>
+inline T const* CustomValue::values() const {
+    return const_cast<CustomValue*>(this)->values<T>();
+}
+
+inline uint64_t* CustomValue::missingWords() {
+    return _capacity <= INLINE_MISSING ? &_missing.bits : _missing.words;
+}
+
+inline uint64_t const* CustomValue::missingWords() const {
+    return _capacity <= INLINE_MISSING ? &_missing.bits : _missing.words;
+}
+
+inline CustomValue::SizeType CustomValue::size() const {
+    return _size;
+}
+
+inline bool CustomValue::empty() const {
+    return _size == 0;
+}
+
+inline bool CustomValue::isMissing(uint32_t idx) const {
+    return (missingWords()[idx / 64] >> (idx % 64)) & 1;
+}
+
+inline bool CustomValue::missing(SizeType idx) const {
+    type().validateIndex(idx);
+    return idx >= _size || isMissing(idx);
+}
+
+template<typename T>
+inline const T* CustomValue::data() const {
+    type().typecheck<T>();
+    return values<T>();
+}
+
 template<typename T>
 inline const T* CustomValue::get(SizeType idx) const {
     type().typecheck<T>();
-    type().validateIndex(idx);
-    if (idx >= _values.size())
+    if (missing(idx))
         return 0;
-    return boost::get<T>(&_values[idx]);
+    return values<T>() + idx;
 }
 
-
 template<>
 inline void CustomValue::set<CustomValue::ValueType>(SizeType idx, const ValueType& value) {
     // skip type checking
     type().validateIndex(idx);
     ensureCapacity(idx+1);
-    _values[idx] = value;
+    setAny(idx, value);
 }
 
 template<typename T>
 inline void CustomValue::set(SizeType idx, const T& value) {
+    typedef typename detail::CustomValueStorage<T>::type Stored;
     type().typecheck<T>();
     type().validateIndex(idx);
     ensureCapacity(idx+1);
-    _values[idx] = value;
-}
-
-inline void CustomValue::ensureCapacity(uint32_t size) {
-    if (size > _values.size())
-        _values.resize(size);
+    values<Stored>()[idx] = Stored(value);
+    setMissing(idx, false);
 }
 
-inline bool CustomValue::operator==(const CustomValue& rhs) const {
-    // TODO: make this more efficient instead of using toString
-    // the problem is you can't compare boost::any objects without casting to
-    // the proper type, which we'd have to switch for
-    return *_type == rhs.type() &&
-        toString() == rhs.toString();
+template<typename T>
+void CustomValue::add(const CustomValue& rhs) {
+    ensureCapacity(std::max<SizeType>(rhs.size(), type().number()));
+    for (SizeType i = 0; i < type().number(); ++i) {
+        T val(0);
+        const T* a = get<T>(i);
+        const T* b = rhs.get<T>(i);
+        if (a != NULL) val += *a;
+        if (b != NULL) val += *b;
+        values<T>()[i] = val;
+        setMissing(i, false);
+    }
 }
 
 inline bool CustomValue::operator!=(const CustomValue& rhs) const {
     return !(*this == rhs);
 }
 
-template<typename T>
-inline void CustomValue::toStream_impl(ostream& s) const {
-    if (empty()) {
-        type().emptyRepr(s);
-    }
-    for (SizeType i = 0; i < size(); ++i) {
-        if (i > 0)
-            s << ",";
-        if (_values[i].which() != 0)
-            s << _values[i];
-        else
-            s << '.';
-    }
-}
+// Writes values as operator<< does, with the numbers formatted by
+// common/NumberConversion.hpp
+struct CustomValueWriter : boost::static_visitor<> {
+    explicit CustomValueWriter(std::ostream& s)
+        : s(s)
+    {}
+
+    void operator()(boost::blank) const { s << '.'; }
+    void operator()(int64_t value) const { writeInteger(s, value); }
+    void operator()(double value) const { writeDouble(s, value); }
+    void operator()(char value) const { s << value; }
+    void operator()(bool value) const { s << value; }
+    void operator()(std::string const& value) const { s << value; }
+
+    std::ostream& s;
+};
 
 END_NAMESPACE(Vcf)
 
@@ -3,11 +3,11 @@
 #include "CustomValue.hpp"
 #include "Header.hpp"
 #include "MergeStrategy.hpp"
+#include "common/MemoryUsage.hpp"
+#include "common/NumberConversion.hpp"
 #include "common/String.hpp"
-#include "io/StreamJoin.hpp"
 
 #include <boost/format.hpp>
-#include <boost/lexical_cast.hpp>
 #include <algorithm>
 #include <cassert>
 #include <cstring>
@@ -18,11 +18,26 @@
 #include <utility>
 
 using boost::format;
-using boost::lexical_cast;
 using namespace std;
 
 namespace {
     std::string const MISSING_STRING = ".";
+
+    // Writes values as streamJoin does, "." if there are none
+    template<typename Container>
+    void joinToStream(std::ostream& s, Container const& values, char delim) {
+        if (values.empty()) {
+            s << '.';
+            return;
+        }
+
+        auto i = values.begin();
+        s.write(i->data(), i->size());
+        for (++i; i != values.end(); ++i) {
+            s << delim;
+            s.write(i->data(), i->size());
+        }
+    }
 }
 
 BEGIN_NAMESPACE(Vcf)
@@ -80,6 +95,8 @@ Entry::Entry()
     , _startWithoutPadding(0)
     , _stopWithoutPadding(0)
     , _qual(MISSING_QUALITY)
+    , _columnEnds()
+    , _dirtyColumns(0)
     , _parsedSamples(false)
 {
 }
@@ -87,6 +104,7 @@ Entry::Entry()
 Entry::Entry(Entry const& e)
     : _header(e._header)
     , _chrom(e._chrom)
+    , _chromRank(e._chromRank)
     , _pos(e._pos)
     , _startWithoutPadding(e._startWithoutPadding)
     , _stopWithoutPadding(e._stopWithoutPadding)
@@ -96,7 +114,9 @@ Entry::Entry(Entry const& e)
     , _qual(e._qual)
     , _failedFilters(e._failedFilters)
     , _info(e._info)
-    , _sampleString(e._sampleString)
+    , _line(e._line)
+    , _columnEnds(e._columnEnds)
+    , _dirtyColumns(e._dirtyColumns)
     , _parsedSamples(e._parsedSamples)
     , _sampleData(e._sampleData)
 {
@@ -105,6 +125,7 @@ Entry::Entry(Entry const& e)
 Entry::Entry(Entry&& e)
     : _header(e._header)
     , _chrom(std::move(e._chrom))
+    , _chromRank(e._chromRank)
     , _pos(e._pos)
     , _startWithoutPadding(e._startWithoutPadding)
     , _stopWithoutPadding(e._stopWithoutPadding)
@@ -114,7 +135,9 @@ Entry::Entry(Entry&& e)
     , _qual(e._qual)
     , _failedFilters(std::move(e._failedFilters))
     , _info(std::move(e._info))
-    , _sampleString(std::move(e._sampleString))
+    , _line(std::move(e._line))
+    , _columnEnds(e._columnEnds)
+    , _dirtyColumns(e._dirtyColumns)
     , _parsedSamples(e._parsedSamples)
     , _sampleData(std::move(e._sampleData))
 {
@@ -123,6 +146,7 @@ Entry::Entry(Entry&& e)
 Entry& Entry::operator=(Entry const& e) {
     _header = e._header;
     _chrom = e._chrom;
+    _chromRank = e._chromRank;
     _pos = e._pos;
     _startWithoutPadding = e._startWithoutPadding;
     _stopWithoutPadding = e._stopWithoutPadding;
@@ -132,7 +156,9 @@ Entry& Entry::operator=(Entry const& e) {
     _qual = e._qual;
     _failedFilters = e._failedFilters;
     _info = e._info;
-    _sampleString = e._sampleString;
+    _line = e._line;
+    _columnEnds = e._columnEnds;
+    _dirtyColumns = e._dirtyColumns;
     _parsedSamples = e._parsedSamples;
     _sampleData = e._sampleData;
     return *this;
@@ -141,6 +167,7 @@ Entry& Entry::operator=(Entry const& e) {
 Entry& Entry::operator=(Entry&& e) {
     _header = std::move(e._header);
     _chrom = std::move(e._chrom);
+    _chromRank = e._chromRank;
     _pos = e._pos;
     _startWithoutPadding = e._startWithoutPadding;
     _stopWithoutPadding = e._stopWithoutPadding;
@@ -150,7 +177,9 @@ Entry& Entry::operator=(Entry&& e) {
     _qual = std::move(e._qual);
     _failedFilters = std::move(e._failedFilters);
     _info = std::move(e._info);
-    _sampleString = std::move(e._sampleString);
+    _line = std::move(e._line);
+    _columnEnds = e._columnEnds;
+    _dirtyColumns = e._dirtyColumns;
     _parsedSamples = std::move(e._parsedSamples);
     _sampleData = std::move(e._sampleData);
     return *this;
@@ -162,6 +191,8 @@ Entry::Entry(const Header* h)
     , _startWithoutPadding(0)
     , _stopWithoutPadding(0)
     , _qual(MISSING_QUALITY)
+    , _columnEnds()
+    , _dirtyColumns(0)
     , _parsedSamples(false)
 {
 }
@@ -171,6 +202,8 @@ Entry::Entry(const Header* h, const string& s)
     , _startWithoutPadding(0)
     , _stopWithoutPadding(0)
     , _qual(MISSING_QUALITY)
+    , _columnEnds()
+    , _dirtyColumns(0)
     , _parsedSamples(false)
 {
     parse(h, s);
@@ -179,11 +212,14 @@ Entry::Entry(const Header* h, const string& s)
 Entry::Entry(EntryMerger&& merger)
     : _header(merger.mergedHeader())
     , _chrom(merger.chrom())
+    , _chromRank(ContigDictionary::instance().rank(_chrom))
     , _pos(merger.pos())
     , _identifiers(std::move(merger.identifiers()))
     , _ref(merger.ref())
     , _qual(merger.qual())
     , _failedFilters(std::move(merger.failedFilters()))
+    , _columnEnds()
+    , _dirtyColumns(0)
     , _parsedSamples(true)
 {
     if (!merger.merged()) {
@@ -221,6 +257,7 @@ void Entry::parse(const Header* h, const string& s) {
     _header = h;
 
     // clear containers
+    _line.clear();
     _info.clear();
     _sampleData.clear();
     _identifiers.clear();
@@ -230,6 +267,7 @@ void Entry::parse(const Header* h, const string& s) {
     Tokenizer<char> tok(s, '\t');
     if (!tok.extract(_chrom))
         throw runtime_error("Failed to extract chromosome from vcf entry: " + s);
+    _chromRank = ContigDictionary::instance().rank(_chrom);
     if (!tok.extract(_pos))
         throw runtime_error("Failed to extract position from vcf entry: " + s);
 
@@ -255,25 +293,28 @@ void Entry::parse(const Header* h, const string& s) {
         Tokenizer<char>::split(beg, end, ',', back_inserter(_alt));
 
     // phred quality
-    string qualstr;
-    if (!tok.extract(qualstr))
+    if (!tok.extract(&beg, &end))
         throw runtime_error("Failed to extract quality from vcf entry: " + s);
-    if (qualstr == ".")
+    if (end-beg == 1 && *beg == '.')
         _qual = MISSING_QUALITY;
-    else
-        _qual = lexical_cast<double>(qualstr);
+    else if (!parseDouble(beg, end, _qual))
+        throw runtime_error(str(format("Invalid quality '%1%' in vcf entry: %2%")
+            % std::string(beg, end) % s));
 
     // failed filters
     if (!tok.extract(&beg, &end))
         throw runtime_error("Failed to extract filters from vcf entry: " + s);
 
-    if (end-beg != 1 || *beg != '.')
-        Tokenizer<char>::split(beg, end, ';', inserter(_failedFilters,_failedFilters.end()));
-
+    if (end-beg != 1 || *beg != '.') {
+        Tokenizer<char> filters(beg, end, ';');
+        std::string name;
+        while (filters.extract(name))
+            _failedFilters.insert(h->filterSymbol(name));
+    }
 
     // If pass is present as well as other failed filters, remove pass
     if (_failedFilters.size() > 1) {
-        _failedFilters.erase("PASS");
+        _failedFilters.erase(Symbol::pass());
     }
 
     // info entries
@@ -282,13 +323,32 @@ void Entry::parse(const Header* h, const string& s) {
 
     _info = decltype(_info)(std::string(beg, end));
 
-    tok.remaining(_sampleString);
+    _line = s;
+    char const* col = s.data();
+    for (int field = CHROM; field < INFO; ++field) {
+        col = static_cast<char const*>(memchr(col, '\t', end - col));
+        _columnEnds[field] = col - s.data();
+        ++col;
+    }
+    _columnEnds[INFO] = end - s.data();
+    _dirtyColumns = 0;
+
     _parsedSamples = false;
     computeStartStop();
 }
 
+void Entry::setDirty(FieldName field) {
+    _dirtyColumns |= 1u << field;
+}
+
+void Entry::samplesText(char const** beg, char const** end) const {
+    std::size_t offset = std::min<std::size_t>(_line.size(), _columnEnds[INFO] + 1);
+    *beg = _line.data() + offset;
+    *end = _line.data() + _line.size();
+}
+
 void Entry::addIdentifier(const std::string& id) {
-    _identifiers.insert(id);
+    getIdentifiers_().insert(id);
 }
 
 void Entry::addFilter(const std::string& filterName) {
@@ -301,15 +361,29 @@ void Entry::addFilter(const std::string& filterName) {
             ) % filterName));
     }
 
-    if (_failedFilters.find("PASS") != _failedFilters.end()) {
-        _failedFilters.erase("PASS");
-    }
-
-    _failedFilters.insert(filterName);
+    SymbolSet& filters = getFailedFilters_();
+    filters.erase(Symbol::pass());
+    filters.insert(_header ? _header->filterSymbol(filterName) : Symbol(filterName));
 }
 
 void Entry::clearFilters() {
-    _failedFilters.clear();
+    getFailedFilters_().clear();
+}
+
+std::size_t Entry::heapBytes() const {
+    std::size_t identifierBytes = 0;
+    for (auto i = _identifiers.begin(); i != _identifiers.end(); ++i)
+        identifierBytes += ::heapBytes(*i);
+
+    return ::heapBytes(_chrom)
+        + allocationBytes(_identifiers.capacity() * sizeof(std::string))
+        + identifierBytes
+        + ::heapBytes(_ref)
+        + ::heapBytes(_alt)
+        + ::heapBytes(_failedFilters)
+        + _info.heapBytes()
+        + ::heapBytes(_line)
+        + _sampleData.heapBytes();
 }
 
 string Entry::toString() const {
@@ -320,6 +394,7 @@ string Entry::toString() const {
 
 void Entry::swap(Entry& other) {
     _chrom.swap(other._chrom);
+    std::swap(_chromRank, other._chromRank);
     std::swap(_pos, other._pos);
     std::swap(_startWithoutPadding, other._startWithoutPadding);
     std::swap(_stopWithoutPadding, other._stopWithoutPadding);
@@ -329,10 +404,12 @@ void Entry::swap(Entry& other) {
     std::swap(_qual, other._qual);
     _failedFilters.swap(other._failedFilters);
     _info.swap(other._info);
+    _line.swap(other._line);
+    std::swap(_columnEnds, other._columnEnds);
+    std::swap(_dirtyColumns, other._dirtyColumns);
     _sampleData.swap(other._sampleData);
     std::swap(_header, other._header);
     std::swap(_parsedSamples, other._parsedSamples);
-    _sampleString.swap(other._sampleString);
 }
 
 int32_t Entry::altIdx(const string& alt) const {
@@ -343,6 +420,17 @@ int32_t Entry::altIdx(const string& alt) const {
 }
 
 const CustomValue* Entry::info(const string& key) const {
+    // Declared fields get their symbol from the header's type. Only
+    // undeclared ones are looked up in the SymbolTable; names that were
+    // never added to it are in no record.
+    CustomType const* type = _header ? _header->infoType(key) : 0;
+    Symbol sym = type ? type->symbol() : Symbol::find(key);
+    if (sym.empty())
+        return 0;
+    return info(sym);
+}
+
+const CustomValue* Entry::info(Symbol const& key) const {
     auto const& inf = getInfo_();
     auto i = inf.find(key);
     if (i == inf.end())
@@ -351,15 +439,18 @@ const CustomValue* Entry::info(const string& key) const {
 }
 
 bool Entry::isFiltered() const {
-    return !_failedFilters.empty()
-        && !(_failedFilters.size() == 1 && *_failedFilters.begin() == "PASS");
+    auto const& filters = _failedFilters.symbols();
+    return !filters.empty()
+        && !(filters.size() == 1 && filters[0] == Symbol::pass());
 }
 
 void Entry::setInfo(std::string const& key, CustomValue const& value) {
     auto& inf = getInfo_();
-    auto i = inf.find(key);
+    CustomType const* type = _header ? _header->infoType(key) : 0;
+    Symbol sym = type ? type->symbol() : Symbol(key);
+    auto i = inf.find(sym);
     if (i == inf.end()) {
-        inf.insert(make_pair(key, value));
+        inf.insert(make_pair(sym, value));
     } else {
         i->second = std::move(value);
     }
@@ -367,7 +458,10 @@ void Entry::setInfo(std::string const& key, CustomValue const& value) {
 
 SampleData& Entry::sampleData() {
     if (!_parsedSamples) {
-        _sampleData.parse(_header, _sampleString);
+        char const* beg(0);
+        char const* end(0);
+        samplesText(&beg, &end);
+        _sampleData.parse(_header, beg, end);
         _parsedSamples = true;
     }
 
@@ -376,7 +470,10 @@ SampleData& Entry::sampleData() {
 
 const SampleData& Entry::sampleData() const {
     if (!_parsedSamples) {
-        _sampleData.parse(_header, _sampleString);
+        char const* beg(0);
+        char const* end(0);
+        samplesText(&beg, &end);
+        _sampleData.parse(_header, beg, end);
         _parsedSamples = true;
     }
 
@@ -418,7 +515,10 @@ std::vector<std::string> Entry::allelesForSample(size_t sampleIdx) const {
 
 void Entry::samplesToStream(std::ostream& s) const {
     if (!_parsedSamples) {
-        s << _sampleString;
+        char const* beg(0);
+        char const* end(0);
+        samplesText(&beg, &end);
+        s.write(beg, end - beg);
     }
     else {
         s << sampleData();
@@ -426,19 +526,59 @@ void Entry::samplesToStream(std::ostream& s) const {
 }
 
 void Entry::allButSamplesToStream(std::ostream& s) const {
-    s << _chrom << '\t' << _pos << '\t'
-        << streamJoin(identifiers()).delimiter(";").emptyString(".");
+    bool haveLine = !_line.empty();
+    if (haveLine && _dirtyColumns == 0) {
+        s.write(_line.data(), _columnEnds[INFO]);
+        return;
+    }
 
-    s << '\t' << _ref << '\t'
-        << streamJoin(_alt).delimiter(",").emptyString(".");
+    for (int field = CHROM; field <= INFO; ++field) {
+        if (field != CHROM)
+            s << '\t';
 
-    if (_qual <= Vcf::Entry::MISSING_QUALITY)
-        s << "\t.\t";
-    else
-        s << '\t' << _qual << '\t';
+        if (haveLine && !(_dirtyColumns & (1u << field))) {
+            uint32_t beg = field == CHROM ? 0 : _columnEnds[field - 1] + 1;
+            s.write(_line.data() + beg, _columnEnds[field] - beg);
+            continue;
+        }
 
-    s << streamJoin(_failedFilters).delimiter(";").emptyString(".");
-    s << '\t' << _info;
+        switch (field) {
+            case CHROM:
+                s << _chrom;
+                break;
+
+            case POS:
+                writeInteger(s, _pos);
+                break;
+
+            case ID:
+                joinToStream(s, identifiers(), ';');
+                break;
+
+            case REF:
+                s << _ref;
+                break;
+
+            case ALT:
+                joinToStream(s, _alt, ',');
+                break;
+
+            case QUAL:
+                if (_qual <= Vcf::Entry::MISSING_QUALITY)
+                    s << '.';
+                else
+                    writeDouble(s, _qual);
+                break;
+
+            case FILTER:
+                joinToStream(s, _failedFilters, ';');
+                break;
+
+            default:
+                s << _info;
+                break;
+        }
+    }
 }
 
 void Entry::replaceAlts(uint64_t pos, std::string ref, std::vector<std::string> alt) {
@@ -447,6 +587,9 @@ void Entry::replaceAlts(uint64_t pos, std::string ref, std::vector<std::string>
     _pos = pos;
     _ref = std::move(ref);
     _alt = std::move(alt);
+    setDirty(POS);
+    setDirty(REF);
+    setDirty(ALT);
 }
 
 void Entry::computeStartStop() {
@@ -463,9 +606,20 @@ InfoFields::MapType const& Entry::getInfo_() const {
 }
 
 InfoFields::MapType& Entry::getInfo_() {
+    setDirty(INFO);
     return *_info.get(*_header, _alt.size());
 }
 
+Entry::IdentifierSet& Entry::getIdentifiers_() {
+    setDirty(ID);
+    return _identifiers;
+}
+
+SymbolSet& Entry::getFailedFilters_() {
+    setDirty(FILTER);
+    return _failedFilters;
+}
+
 ostream& operator<<(ostream& s, const Entry& e) {
     e.allButSamplesToStream(s);
     s << '\t';
@@ -5,6 +5,8 @@
 #include "InfoFields.hpp"
 #include "LazyValue.hpp"
 #include "SampleData.hpp"
+#include "SymbolSet.hpp"
+#include "common/ContigDictionary.hpp"
 #include "common/CoordinateView.hpp"
 #include "common/LocusCompare.hpp"
 #include "common/Tokenizer.hpp"
@@ -12,7 +14,9 @@
 #include "common/namespaces.hpp"
 #include "fileformats/TypedStream.hpp"
 
+#include <boost/container/flat_set.hpp>
 #include <boost/lexical_cast.hpp>
+#include <array>
 #include <map>
 #include <ostream>
 #include <string>
@@ -49,6 +53,7 @@ public:
 
     typedef Header HeaderType;
     typedef InfoFields::MapType CustomValueMap;
+    typedef boost::container::flat_set<std::string> IdentifierSet;
 
     // static data
     static const double MISSING_QUALITY;
@@ -88,21 +93,26 @@ public:
     void clearFilters();
 
     const std::string& chrom() const { return _chrom; }
+    const ContigRank& chromRank() const { return _chromRank; }
     const uint64_t& pos() const { return _pos; }
-    const std::set<std::string>& identifiers() const { return _identifiers; }
+    const IdentifierSet& identifiers() const { return _identifiers; }
     const std::string& ref() const { return _ref; }
     const std::vector<std::string>& alt() const { return _alt; }
     const std::string& alt(GenotypeIndex const& idx) const;
     double qual() const { return _qual; }
-    const std::set<std::string>& failedFilters() const { return _failedFilters; }
+    const SymbolSet& failedFilters() const { return _failedFilters; }
     const CustomValueMap& info() const { return getInfo_(); }
     const CustomValue* info(std::string const& key) const;
+    const CustomValue* info(char const* key) const { return info(std::string(key)); }
+    const CustomValue* info(Symbol const& key) const;
     void setInfo(std::string const& key, CustomValue const& value);
     const SampleData& sampleData() const;
     SampleData& sampleData();
 
     bool isFiltered() const;
 
+    // whitelist may hold filter names or, for integer comparisons,
+    // symbols (e.g., a SymbolSet)
     template<typename T>
     bool isFilteredByAnythingExcept(T const& whitelist) {
         // Do the quick check first
@@ -110,9 +120,9 @@ public:
             return false;
         }
 
-        auto const& filters = failedFilters();
+        auto const& filters = _failedFilters.symbols();
         for (auto i = filters.begin(); i != filters.end(); ++i) {
-            if (*i != "PASS" && whitelist.count(*i) == 0) {
+            if (*i != Symbol::pass() && !whitelisted(whitelist, *i)) {
                 return true;
             }
         }
@@ -134,6 +144,9 @@ public:
 
     void swap(Entry& other);
 
+    // Approximate heap memory used by the entry (see common/MemoryUsage.hpp)
+    std::size_t heapBytes() const;
+
     void allButSamplesToStream(std::ostream& s) const;
     void samplesToStream(std::ostream& s) const;
 
@@ -141,22 +154,52 @@ public:
     void computeStartStop();
 
 private:
+    template<typename T>
+    static auto whitelisted(T const& whitelist, Symbol const& filter, int)
+        -> decltype(whitelist.count(filter) != 0)
+    {
+        return whitelist.count(filter) != 0;
+    }
+
+    template<typename T>
+    static bool whitelisted(T const& whitelist, Symbol const& filter, long) {
+        return whitelist.count(filter.name()) != 0;
+    }
+
+    template<typename T>
+    static bool whitelisted(T const& whitelist, Symbol const& filter) {
+        return whitelisted(whitelist, filter, 0);
+    }
+
+    // The non-const accessors mark the column as changed, so that it is
+    // written from the parsed value rather than from _line
     InfoFields::MapType const& getInfo_() const;
     InfoFields::MapType& getInfo_();
+    IdentifierSet& getIdentifiers_();
+    SymbolSet& getFailedFilters_();
+    void setDirty(FieldName field);
+    void samplesText(char const** beg, char const** end) const;
 
 protected:
     const Header* _header;
     std::string _chrom;
+    ContigRank _chromRank;
     uint64_t _pos;
     int64_t _startWithoutPadding;
     int64_t _stopWithoutPadding;
-    std::set<std::string> _identifiers;
+    IdentifierSet _identifiers;
     std::string _ref;
     std::vector<std::string> _alt;
     double _qual;
-    std::set<std::string> _failedFilters;
+    SymbolSet _failedFilters;
     LazyValue<InfoFields> _info;
-    std::string _sampleString;
+    // The line as it was parsed, the offset in it of the end of each
+    // column up to INFO and a bit per FieldName for those that have
+    // changed since. Unchanged columns are written out from the text, as
+    // are the samples until they are parsed.
+    std::string _line;
+    std::array<uint32_t, INFO + 1> _columnEnds;
+    uint32_t _dirtyColumns;
     mutable bool _parsedSamples;
     mutable SampleData _sampleData;
 };
@@ -170,6 +213,14 @@ inline bool containsInsertions(Vcf::Entry const& v) {
     return false;
 }
 
+// For TypedStream::parallel: parses the per sample data of entries on the
+// worker threads rather than when it is first used
+struct ParseSampleData {
+    void operator()(Entry& entry) const {
+        entry.sampleData();
+    }
+};
+
 struct ReheaderingParser {
     typedef Entry ValueType;
 
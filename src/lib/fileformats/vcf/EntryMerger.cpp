@@ -96,12 +96,13 @@ EntryMerger::EntryMerger(
         }
 
         // merge identifiers
-        const set<string>& idents = e->identifiers();
-        copy(idents.begin(), idents.end(), inserter(_identifiers, _identifiers.begin()));
+        auto const& idents = e->identifiers();
+        _identifiers.insert(idents.begin(), idents.end());
 
         // Merge filters
-        const set<string>& filters = e->failedFilters();
-        copy(filters.begin(), filters.end(), inserter(_filters, _filters.begin()));
+        auto const& filters = e->failedFilters().symbols();
+        for (auto i = filters.begin(); i != filters.end(); ++i)
+            _filters.insert(*i);
 
         const vector<string>& samples = e->header().sampleNames();
         for (auto i = samples.begin(); i != samples.end(); ++i) {
@@ -113,8 +114,9 @@ EntryMerger::EntryMerger(
         // Build set of all info fields present, validating as we go
         const CustomValueMap& info = e->info();
         for (auto i = info.begin(); i != info.end(); ++i) {
-            _infoFieldNames.insert(i->first);
-            if (!_mergedHeader->infoType(i->first)) {
+            if (!_infoFields.insert(i->first).second)
+                continue;
+            if (!_mergedHeader->infoType(i->first.name())) {
                 throw runtime_error(str(format(
                     "Invalid info field '%1%' while merging vcf entries in %2%"
                     ) % i->first % e->toString()));
@@ -124,7 +126,7 @@ EntryMerger::EntryMerger(
     if (mergeStrategy.clearFilters())
         _filters.clear();
     else if (_filters.size() > 1)
-        _filters.erase("PASS");
+        _filters.erase(Symbol::pass());
 }
 
 bool EntryMerger::merged() const {
@@ -147,7 +149,7 @@ uint64_t EntryMerger::pos() const {
     return _begin->pos();
 }
 
-set<string>& EntryMerger::identifiers() {
+auto EntryMerger::identifiers() -> IdentifierSet& {
     return _identifiers;
 }
 
@@ -155,7 +157,7 @@ const string& EntryMerger::ref() const {
     return _alleleMerger.ref();
 }
 
-set<string>& EntryMerger::failedFilters() {
+SymbolSet& EntryMerger::failedFilters() {
     return _filters;
 }
 
@@ -166,7 +168,7 @@ double EntryMerger::qual() const {
 
 void EntryMerger::setInfo(CustomValueMap& info) const {
     try {
-        for (auto i = _infoFieldNames.begin(); i != _infoFieldNames.end(); ++i) {
+        for (auto i = _infoFields.begin(); i != _infoFields.end(); ++i) {
             CustomValue v = _mergeStrategy.mergeInfo(
                 *i, _begin, _end, _alleleMerger.newAltIndices());
 
@@ -217,7 +219,7 @@ void EntryMerger::setAltAndGenotypeData(
     for (Entry const* e = _begin; e != _end; ++e) {
         SampleData const& samples = e->sampleData();
         for (auto si = samples.begin(); si != samples.end(); ++si) {
-            uint32_t sampleIdx = si->first;
+            uint32_t sampleIdx = *si;
             const string& sampleName = e->header().sampleNames()[sampleIdx];
 
             bool overridePreviousData = true;
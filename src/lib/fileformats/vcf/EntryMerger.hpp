@@ -2,9 +2,12 @@
 
 #include "AlleleMerger.hpp"
 #include "InfoFields.hpp"
+#include "SymbolSet.hpp"
 #include "common/cstdint.hpp"
 #include "common/namespaces.hpp"
 
+#include <boost/container/flat_set.hpp>
+
 #include <map>
 #include <set>
 #include <string>
@@ -22,6 +25,7 @@ class SampleData;
 class EntryMerger {
 public:
     typedef InfoFields::MapType CustomValueMap;
+    typedef boost::container::flat_set<std::string> IdentifierSet;
 
     EntryMerger(
         MergeStrategy const& mergeStrategy,
@@ -36,9 +40,9 @@ public:
 
     std::string const& chrom() const;
     uint64_t pos() const;
-    std::set<std::string>& identifiers();
+    IdentifierSet& identifiers();
     std::string const& ref() const;
-    std::set<std::string>& failedFilters();
+    SymbolSet& failedFilters();
     double qual() const;
     void setInfo(CustomValueMap& info) const;
     void setAltAndGenotypeData(std::vector<std::string>& alt, SampleData& sampleData) const;
@@ -60,10 +64,10 @@ protected:
     Entry const* _begin;
     Entry const* _end;
     double _qual;
-    std::set<std::string> _identifiers;
-    std::set<std::string> _filters;
+    IdentifierSet _identifiers;
+    SymbolSet _filters;
     std::set<std::string> _sampleNames;
-    std::set<std::string> _infoFieldNames;
+    boost::container::flat_set<Symbol> _infoFields;
     mutable std::vector<size_t> _sampleCounts;
 };
 
@@ -1,8 +1,11 @@
 #include "GenotypeCall.hpp"
 
+#include "common/NumberConversion.hpp"
 #include "common/Tokenizer.hpp"
 
 #include <boost/format.hpp>
+
+#include <algorithm>
 #include <limits>
 
 using boost::format;
@@ -12,6 +15,153 @@ BEGIN_NAMESPACE(Vcf)
 GenotypeCall GenotypeCall::Null;
 GenotypeIndex GenotypeIndex::Null{std::numeric_limits<GenotypeIndex::value_type>::max()};
 
+PackedGenotype PackedGenotype::parse(char const* beg, char const* end) {
+    PackedGenotype rv;
+    // special case: a lone null (".") is treated as empty
+    if (end - beg == 1 && *beg == '.')
+        return rv;
+
+    bool phasedSep = false;
+    char const* p = beg;
+    for (;;) {
+        char const* q = p;
+        while (q != end && *q != '/' && *q != '|')
+            ++q;
+
+        GenotypeIndex idx;
+        if (q - p == 1 && *p == '.') {
+            idx = GenotypeIndex::Null;
+        }
+        // digits only, and no leading zeros, so that format() gives the
+        // same text back
+        else if (p == q || *p < '0' || *p > '9' || (*p == '0' && q - p > 1)
+            || !parseInteger(p, q, idx.value) || idx.null())
+        {
+            return unpacked();
+        }
+
+        if (!rv.append(idx, phasedSep))
+            return unpacked();
+
+        if (q == end)
+            return rv;
+
+        phasedSep = *q == '|';
+        p = q + 1;
+    }
+}
+
+PackedGenotype PackedGenotype::fromCall(GenotypeCall const& call) {
+    PackedGenotype rv;
+    for (auto i = call.begin(); i != call.end(); ++i) {
+        if (!rv.append(*i, call.phased()))
+            return unpacked();
+    }
+    return rv;
+}
+
+bool PackedGenotype::pack(GenotypeIndex const* alleles, uint32_t n, uint32_t phaseBits) {
+    uint32_t w = n <= 2 ? 28 : 14;
+    uint64_t mask = (uint64_t(1) << w) - 1;
+    uint64_t code = n | (uint64_t(phaseBits) << 3);
+    for (uint32_t i = 0; i < n; ++i) {
+        uint64_t v = alleles[i].null() ? mask : alleles[i].value;
+        if (!alleles[i].null() && v >= mask)
+            return false;
+        code |= v << (8 + w * i);
+    }
+    _code = code;
+    return true;
+}
+
+bool PackedGenotype::append(GenotypeIndex idx, bool phased) {
+    uint32_t n = size();
+    if (!packed() || n == MAX_PLOIDY)
+        return false;
+
+    // the width of the indices changes at three alleles, so repack
+    GenotypeIndex alleles[MAX_PLOIDY];
+    indices(alleles);
+    alleles[n] = idx;
+
+    uint32_t phaseBits = (_code >> 3) & 7;
+    if (n > 0 && phased)
+        phaseBits |= 1 << (n - 1);
+    return pack(alleles, n + 1, phaseBits);
+}
+
+uint32_t PackedGenotype::indices(GenotypeIndex* out) const {
+    uint32_t n = size();
+    for (uint32_t i = 0; i < n; ++i)
+        out[i] = (*this)[i];
+    return n;
+}
+
+uint32_t PackedGenotype::distinctIndices(GenotypeIndex* out) const {
+    uint32_t n = indices(out);
+    std::sort(out, out + n);
+    return std::unique(out, out + n) - out;
+}
+
+bool PackedGenotype::null() const {
+    uint32_t n = size();
+    for (uint32_t i = 0; i < n; ++i) {
+        if (!(*this)[i].null())
+            return false;
+    }
+    return n > 0;
+}
+
+bool PackedGenotype::partial() const {
+    uint32_t n = size();
+    uint32_t nullCount = 0;
+    for (uint32_t i = 0; i < n; ++i)
+        nullCount += (*this)[i].null();
+    return nullCount > 0 && nullCount < n;
+}
+
+bool PackedGenotype::heterozygous() const {
+    return diploid() && !(*this)[0].null() && !(*this)[1].null() && (*this)[0] != (*this)[1];
+}
+
+bool PackedGenotype::homozygous() const {
+    return diploid() && !(*this)[0].null() && (*this)[0] == (*this)[1];
+}
+
+bool PackedGenotype::reference() const {
+    uint32_t n = size();
+    for (uint32_t i = 0; i < n; ++i) {
+        if ((*this)[i] != GenotypeIndex(0))
+            return false;
+    }
+    return n > 0;
+}
+
+char* PackedGenotype::format(char* out) const {
+    uint32_t n = size();
+    if (n == 0) {
+        *out++ = '.';
+        return out;
+    }
+
+    for (uint32_t i = 0; i < n; ++i) {
+        if (i > 0)
+            *out++ = (_code >> (3 + i - 1)) & 1 ? '|' : '/';
+
+        GenotypeIndex idx = (*this)[i];
+        if (idx.null())
+            *out++ = '.';
+        else
+            out = formatInteger(out, uint64_t(idx.value));
+    }
+    return out;
+}
+
+std::string PackedGenotype::toString() const {
+    char buf[MAX_CHARS];
+    return std::string(buf, format(buf));
+}
+
 GenotypeCall::GenotypeCall()
     : _phased(false)
     , _partial(false)
@@ -57,6 +207,17 @@ GenotypeCall::GenotypeCall(const std::string& call)
         _partial = true;
 }
 
+GenotypeCall::GenotypeCall(PackedGenotype const& call)
+    : _phased(call.phased())
+    , _partial(call.partial())
+    , _string(call.toString())
+{
+    GenotypeIndex indices[PackedGenotype::MAX_PLOIDY];
+    uint32_t n = call.indices(indices);
+    _indices.assign(indices, indices + n);
+    _indexSet.insert(indices, indices + n);
+}
+
 bool GenotypeCall::empty() const {
     return _indices.empty();
 }
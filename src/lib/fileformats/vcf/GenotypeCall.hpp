@@ -4,6 +4,7 @@
 #include "common/cstdint.hpp"
 #include "common/RelOps.hpp"
 
+#include <cstddef>
 #include <ostream>
 #include <set>
 #include <string>
@@ -11,6 +12,8 @@
 
 BEGIN_NAMESPACE(Vcf)
 
+class GenotypeCall;
+
 struct GenotypeIndex : ValueBasedRelOps<GenotypeIndex>  {
     typedef uint32_t value_type;
 
@@ -31,6 +34,80 @@ struct GenotypeIndex : ValueBasedRelOps<GenotypeIndex>  {
     value_type value;
 };
 
+// A genotype call packed into one 64 bit word: the allele indices, how
+// many there are, and whether each separator is '|'. Calls with up to
+// two alleles take indices up to MAX_DIPLOID_INDEX, calls with three or
+// four up to MAX_POLYPLOID_INDEX.
+//
+// Only calls whose text formats back exactly are packed; anything else
+// (more alleles, larger indices, leading zeros, parse errors) gives a
+// value that is not packed() and should be handled as a GenotypeCall.
+// Such a value is neither empty() nor diploid(); the other accessors
+// are meaningless for it.
+class PackedGenotype {
+public:
+    static uint32_t const MAX_PLOIDY = 4;
+    static uint32_t const MAX_DIPLOID_INDEX = (1u << 28) - 2;
+    static uint32_t const MAX_POLYPLOID_INDEX = (1u << 14) - 2;
+    // Buffer size that is large enough for format()
+    static std::size_t const MAX_CHARS = 24;
+
+    // An empty call
+    PackedGenotype()
+        : _code(0)
+    {}
+
+    static PackedGenotype unpacked();
+    static PackedGenotype parse(char const* beg, char const* end);
+    // Packs the indices of a call that was parsed some other way. If any
+    // separator in it was '|', all of them are.
+    static PackedGenotype fromCall(GenotypeCall const& call);
+
+    // Add an allele, separated from the previous one by '|' if phased.
+    // Returns false (leaving the call as it was) if it does not fit.
+    bool append(GenotypeIndex idx, bool phased);
+
+    bool packed() const;
+    uint64_t code() const;
+
+    uint32_t size() const;
+    bool empty() const;
+    GenotypeIndex operator[](uint32_t idx) const;
+    // Copies the indices to out, which has room for MAX_PLOIDY
+    uint32_t indices(GenotypeIndex* out) const;
+    // The distinct indices in increasing order, as GenotypeCall::indexSet()
+    uint32_t distinctIndices(GenotypeIndex* out) const;
+
+    bool phased() const;
+    bool null() const;
+    bool partial() const;
+    bool heterozygous() const;
+    bool homozygous() const;
+    bool diploid() const;
+    bool reference() const;
+
+    // Writes the call as text ("." if it is empty) and returns the end
+    char* format(char* out) const;
+    std::string toString() const;
+
+    bool operator==(PackedGenotype const& rhs) const;
+    bool operator!=(PackedGenotype const& rhs) const;
+
+protected:
+    explicit PackedGenotype(uint64_t code)
+        : _code(code)
+    {}
+
+    bool pack(GenotypeIndex const* alleles, uint32_t n, uint32_t phaseBits);
+    uint32_t width() const;
+
+protected:
+    // bits 0-2: number of alleles (7 if not packed)
+    // bits 3-5: separator i is '|' (i = 1..3)
+    // bits 8-63: the alleles, all ones for '.'
+    uint64_t _code;
+};
+
 
 class GenotypeCall {
 public:
@@ -41,6 +118,7 @@ public:
 
     GenotypeCall();
     explicit GenotypeCall(const std::string& call);
+    explicit GenotypeCall(PackedGenotype const& call);
 
     bool empty() const;
     bool null() const;
@@ -73,6 +151,53 @@ protected:
     std::string _string;
 };
 
+inline PackedGenotype PackedGenotype::unpacked() {
+    return PackedGenotype(7);
+}
+
+inline bool PackedGenotype::packed() const {
+    return (_code & 7) != 7;
+}
+
+inline uint64_t PackedGenotype::code() const {
+    return _code;
+}
+
+inline uint32_t PackedGenotype::size() const {
+    return _code & 7;
+}
+
+inline bool PackedGenotype::empty() const {
+    return size() == 0;
+}
+
+inline uint32_t PackedGenotype::width() const {
+    return size() <= 2 ? 28 : 14;
+}
+
+inline GenotypeIndex PackedGenotype::operator[](uint32_t idx) const {
+    uint32_t w = width();
+    uint32_t mask = (1u << w) - 1;
+    uint32_t v = (_code >> (8 + w * idx)) & mask;
+    return v == mask ? GenotypeIndex::Null : GenotypeIndex(v);
+}
+
+inline bool PackedGenotype::phased() const {
+    return (_code >> 3) & 7;
+}
+
+inline bool PackedGenotype::diploid() const {
+    return size() == 2;
+}
+
+inline bool PackedGenotype::operator==(PackedGenotype const& rhs) const {
+    return _code == rhs._code;
+}
+
+inline bool PackedGenotype::operator!=(PackedGenotype const& rhs) const {
+    return _code != rhs._code;
+}
+
 std::ostream& operator<<(std::ostream& os, GenotypeIndex const& gtidx);
 std::ostream& operator<<(std::ostream& os, GenotypeCall const& gt);
 
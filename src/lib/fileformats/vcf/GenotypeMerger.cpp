@@ -89,10 +89,29 @@ string GenotypeMerger::renumberGT(
     const std::vector<size_t>& alleleIndices
     ) const
 {
-    GenotypeCall const& oldGT = e->sampleData().genotype(sampleIdx);
-    if (oldGT.empty())
+    PackedGenotype packed = e->sampleData().packedGenotype(sampleIdx);
+    if (packed.empty())
         return ".";
 
+    if (packed.packed()) {
+        PackedGenotype newGT;
+        for (uint32_t i = 0; i < packed.size(); ++i) {
+            GenotypeIndex idx = packed[i];
+            if (!idx.null() && idx.value > 0) { // index > 0 => non-ref
+                assert(idx.value - 1 < alleleIndices.size());
+                auto newIdx = alleleIndices[idx.value - 1];
+                assert(newIdx <= _alleles.size());
+                idx = GenotypeIndex(newIdx + 1);
+            }
+            if (!newGT.append(idx, packed.phased()))
+                break;
+        }
+        if (newGT.size() == packed.size())
+            return newGT.toString();
+    }
+
+    GenotypeCall const& oldGT = e->sampleData().genotype(sampleIdx);
+
     char delim = oldGT.phased() ? '|' : '/';
 
     stringstream newGT;
@@ -1,5 +1,6 @@
 #include "Header.hpp"
 #include "Map.hpp"
+#include "common/ContigDictionary.hpp"
 #include "common/Tokenizer.hpp"
 
 #include <boost/format.hpp>
@@ -101,6 +102,7 @@ void Header::add(const string& line) {
                 desc = desc.substr(1, desc.size() - 2);
 
             _filters.insert(make_pair(m["ID"], desc));
+            _filterSymbols.insert(make_pair(m["ID"], Symbol(m["ID"])));
         } else if (p.first == "SAMPLE") {
             SampleTag st(p.second.substr(1, p.second.size()-2));
             auto inserted = _sampleTags.insert(
@@ -171,6 +173,17 @@ void Header::parseHeaderLine(const std::string& line) {
                 ) %tok));
         addSample(tok);
     }
+
+    // the ##contig lines are all in by now, rank them in one go
+    vector<string> contigs;
+    for (auto i = _metaInfoLines.begin(); i != _metaInfoLines.end(); ++i) {
+        // ##contig=<ID=name,...>
+        if (i->first == "contig" && i->second.compare(0, 4, "<ID=") == 0) {
+            size_t end = i->second.find_first_of(",>", 4);
+            contigs.push_back(i->second.substr(4, end - 4));
+        }
+    }
+    ContigDictionary::instance().add(contigs);
 }
 
 inline std::string Header::headerLine() const {
@@ -258,6 +271,15 @@ HeaderMap<std::string, std::string>::type const& Header::filters() const {
     return _filters;
 }
 
+Symbol Header::filterSymbol(std::string const& name) const {
+    auto found = _filterSymbols.find(name);
+    if (found != _filterSymbols.end())
+        return found->second;
+    if (name == "PASS")
+        return Symbol::pass();
+    return Symbol(name);
+}
+
 HeaderMap<std::string, SampleTag>::type const& Header::sampleTags() const {
     return _sampleTags;
 }
@@ -285,6 +307,31 @@ size_t Header::addSample(std::string const& name) {
     return idx;
 }
 
+void Header::readerOptions(ReaderOptions const& opts) {
+    std::vector<bool> parsedSamples;
+    if (!opts.samples.empty()) {
+        parsedSamples.resize(_sampleNames.size());
+        for (auto i = opts.samples.begin(); i != opts.samples.end(); ++i)
+            parsedSamples[sampleIndex(*i)] = true;
+    }
+
+    _readerOptions = opts;
+    _parsedSamples.swap(parsedSamples);
+}
+
+ReaderOptions const& Header::readerOptions() const {
+    return _readerOptions;
+}
+
+bool Header::parsesFormatField(std::string const& id) const {
+    return _readerOptions.formatFields.empty() || _readerOptions.formatFields.count(id);
+}
+
+bool Header::parsesSample(uint32_t sampleIdx) const {
+    return _parsedSamples.empty() || sampleIdx >= _parsedSamples.size()
+        || _parsedSamples[sampleIdx];
+}
+
 void Header::mirrorSample(std::string const& sampleName, std::string const& newName) {
     auto newExists = _sampleIndices.find(newName);
     if (newExists != _sampleIndices.end()) {
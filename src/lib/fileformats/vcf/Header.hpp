@@ -1,7 +1,9 @@
 #pragma once
 
 #include "CustomType.hpp"
+#include "ReaderOptions.hpp"
 #include "SampleTag.hpp"
+#include "SymbolTable.hpp"
 #include "common/namespaces.hpp"
 
 #include <boost/unordered_map.hpp>
@@ -71,6 +73,9 @@ public:
     HeaderMap<std::string, CustomType>::type const& infoTypes() const;
     HeaderMap<std::string, CustomType>::type const& formatTypes() const;
     HeaderMap<std::string, std::string>::type const& filters() const;
+    // The symbol of a filter name. Filters that are not declared in the
+    // header are added to the SymbolTable.
+    Symbol filterSymbol(std::string const& name) const;
     HeaderMap<std::string, SampleTag>::type const& sampleTags() const;
     std::vector<std::string> const& sampleNames() const;
 
@@ -94,6 +99,13 @@ public:
     void mirrorSample(std::string const& sampleName, std::string const& newName);
     HeaderMap<size_t, size_t>::type const& mirroredSamples() const;
 
+    // Limit the sample data that is parsed. Throws if a sample in opts is
+    // not in the header.
+    void readerOptions(ReaderOptions const& opts);
+    ReaderOptions const& readerOptions() const;
+    bool parsesFormatField(std::string const& id) const;
+    bool parsesSample(uint32_t sampleIdx) const;
+
     bool hasDuplicateSamples() const {
         return _hasDuplicateSamples;
     }
@@ -111,6 +123,7 @@ protected:
     HeaderMap<std::string, CustomType>::type _formatTypes;
     // filters = name -> description
     HeaderMap<std::string, std::string>::type _filters;
+    HeaderMap<std::string, Symbol>::type _filterSymbols;
     std::vector<RawLine> _metaInfoLines;
     std::vector<SampleName> _sampleNames;
     HeaderMap<SampleName, SampleTag>::type _sampleTags;
@@ -127,6 +140,10 @@ protected:
 
     HeaderMap<SampleName, size_t>::type _sampleIndices;
     bool _hasDuplicateSamples;
+
+    ReaderOptions _readerOptions;
+    // indexed by sample, empty if all samples are parsed
+    std::vector<bool> _parsedSamples;
 };
 
 std::ostream& operator<<(std::ostream& s, Header const& h);
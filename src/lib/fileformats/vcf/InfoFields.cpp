@@ -1,6 +1,7 @@
 #include "InfoFields.hpp"
 
 #include "Header.hpp"
+#include "common/MemoryUsage.hpp"
 #include "common/Tokenizer.hpp"
 
 #include <boost/format.hpp>
@@ -41,7 +42,7 @@ InfoFields::InfoFields(Header const& h, std::string const& s, std::size_t numAlt
         CustomValue cv(type, value);
         cv.setNumAlts(numAlts);
 
-        auto inserted = data_.insert(make_pair(key, cv));
+        auto inserted = data_.insert(make_pair(type->symbol(), cv));
         if (!inserted.second)
             throw std::runtime_error(str(format(
                 "Duplicate value for info field '%1%'"
@@ -57,4 +58,11 @@ auto InfoFields::operator*() -> MapType& {
     return data_;
 }
 
+std::size_t InfoFields::heapBytes() const {
+    std::size_t rv = allocationBytes(data_.capacity() * sizeof(MapType::value_type));
+    for (auto i = data_.begin(); i != data_.end(); ++i)
+        rv += ::heapBytes(i->second);
+    return rv;
+}
+
 END_NAMESPACE(Vcf)
@@ -1,23 +1,28 @@
 #pragma once
 
 #include "CustomValue.hpp"
+#include "SymbolTable.hpp"
 #include "common/namespaces.hpp"
 
 #include <boost/container/flat_map.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 BEGIN_NAMESPACE(Vcf)
 
 class Header;
 
+// The INFO column of a record. Values are keyed by the symbol of their
+// type and kept in id order; they are written out in name order.
 class InfoFields {
 public:
-    typedef std::map<std::string, CustomValue> MapType;
+    typedef boost::container::flat_map<Symbol, CustomValue> MapType;
 
     InfoFields(Header const& h, std::string const& s, std::size_t numAlts);
     MapType const& operator*() const;
@@ -27,6 +32,8 @@ public:
         data_.clear();
     }
 
+    std::size_t heapBytes() const;
+
     template<typename OS>
     friend OS& operator<<(OS& os, InfoFields const& info) {
         info.toStream(os);
@@ -36,6 +43,12 @@ public:
 private:
     void parse(Header const& header) const;
 
+    struct NameLess {
+        bool operator()(MapType::const_iterator a, MapType::const_iterator b) const {
+            return a->second.type().id() < b->second.type().id();
+        }
+    };
+
     template<typename OS>
     void printOne(OS& os, MapType::const_iterator iter) const {
         os << iter->second.type().id();
@@ -52,16 +65,24 @@ private:
             return;
         }
 
-        auto first = data_.begin();
-        auto last = data_.end();
-
-        if (first != last) {
-            printOne(os, first++);
+        if (data_.size() == 1) {
+            printOne(os, data_.begin());
+            return;
         }
 
+        std::vector<MapType::const_iterator> sorted;
+        sorted.reserve(data_.size());
+        for (auto i = data_.begin(); i != data_.end(); ++i)
+            sorted.push_back(i);
+        std::sort(sorted.begin(), sorted.end(), NameLess());
+
+        auto first = sorted.begin();
+        auto last = sorted.end();
+
+        printOne(os, *first++);
         for (; first != last; ++first) {
             os << ';';
-            printOne(os, first);
+            printOne(os, *first);
         }
     }
 private:
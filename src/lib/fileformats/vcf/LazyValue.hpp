@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/MemoryUsage.hpp"
 #include "common/compat.hpp"
 #include "common/namespaces.hpp"
 
@@ -97,6 +98,13 @@ public:
         return os;
     }
 
+    std::size_t heapBytes() const {
+        std::size_t rv = ::heapBytes(text_);
+        if (data_)
+            rv += allocationBytes(sizeof(T)) + data_->heapBytes();
+        return rv;
+    }
+
     void swap(LazyValue& rhs) {
         text_.swap(rhs.text_);
         data_.swap(rhs.data_);
@@ -3,6 +3,7 @@
 #include "Header.hpp"
 #include "CustomValue.hpp"
 #include "io/InputStream.hpp"
+#include "common/ContigDictionary.hpp"
 #include "common/Tokenizer.hpp"
 
 #include <boost/bind.hpp>
@@ -70,8 +71,7 @@ MergeStrategy::MergeStrategy(
 }
 
 bool MergeStrategy::canMerge(Entry const& a, Entry const& b) const {
-    int rv = strverscmp(a.chrom().c_str(), b.chrom().c_str());
-    if (rv != 0)
+    if (!ContigDictionary::same(a.chrom(), a.chromRank(), b.chrom(), b.chromRank()))
         return false;
 
     if (exactPos())
@@ -127,43 +127,49 @@ void MergeStrategy::setMerger(const std::string& id, const std::string& mergerNa
     }
 
     const ValueMergers::Base* merger = _registry->getMerger(mergerName);
-    auto inserted = _info.insert(make_pair(id, merger));
+    auto inserted = _info.insert(make_pair(Symbol(id), merger));
     if (!inserted.second) {
         inserted.first->second = merger;
     }
 }
 
-const ValueMergers::Base* MergeStrategy::infoMerger(const string& which) const {
-    const CustomValue* (Entry::*fetchInfo)(const string&) const = &Entry::info;
-    FetchFunc fetch = boost::bind(fetchInfo, _1, which);
-    const CustomType* type = _header->infoType(which);
+const CustomType* MergeStrategy::infoType(Symbol const& which) const {
+    const CustomType* type = _header->infoType(which.name());
     if (!type)
         throw runtime_error(str(format("Unknown datatype for info field '%1%'") %which));
+    return type;
+}
+
+const ValueMergers::Base* MergeStrategy::infoMerger(Symbol const& which) const {
+    return infoMerger(which, *infoType(which));
+}
 
+const ValueMergers::Base* MergeStrategy::infoMerger(
+        Symbol const& which,
+        CustomType const& type) const
+{
     auto iter = _info.find(which);
     if (iter != _info.end())
         return iter->second;
     else if (_default)
         return _default;
-    else if (type->numberType() == CustomType::VARIABLE_SIZE)
+    else if (type.numberType() == CustomType::VARIABLE_SIZE)
         return _registry->getMerger("uniq-concat");
     else
         return _registry->getMerger("enforce-equal");
 }
 
 CustomValue MergeStrategy::mergeInfo(
-        const string& which,
+        Symbol const& which,
         const Entry* begin,
         const Entry* end,
         AltIndices const& newAltIndices) const
 {
-    const CustomValue* (Entry::*fetchInfo)(const string&) const = &Entry::info;
+    const CustomValue* (Entry::*fetchInfo)(Symbol const&) const = &Entry::info;
     FetchFunc fetch = boost::bind(fetchInfo, _1, which);
-    const CustomType* type = _header->infoType(which);
-    if (!type)
-        throw runtime_error(str(format("Unknown datatype for info field '%1%'") %which));
+    const CustomType* type = infoType(which);
 
-    const ValueMergers::Base* merger = infoMerger(which);
+    const ValueMergers::Base* merger = infoMerger(which, *type);
     return (*merger)(type, fetch, begin, end, newAltIndices);
 }
 
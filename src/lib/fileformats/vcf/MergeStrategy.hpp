@@ -1,9 +1,12 @@
 #pragma once
 
 #include "AlleleMerger.hpp"
+#include "SymbolTable.hpp"
 #include "ValueMergers.hpp"
 #include "common/namespaces.hpp"
 
+#include <boost/container/flat_map.hpp>
+
 #include <cstddef>
 #include <map>
 #include <string>
@@ -56,7 +59,7 @@ public:
     /// Retrieve the ValueMerger object responsible for merging the named info field.
     /// \param id names an info field
     /// \exception runtime_error if no action can be found to handle the field
-    const ValueMergers::Base* infoMerger(const std::string& id) const;
+    const ValueMergers::Base* infoMerger(Symbol const& id) const;
     const ValueMergers::Base* defaultMerger() const {
         return _default;
     }
@@ -69,7 +72,7 @@ public:
     /// \exception runtime_error thrown if the info field is invalid, or if no action can
     ///   be found to handle the field named by 'which'
     CustomValue mergeInfo(
-            const std::string& which,
+            Symbol const& which,
             const Entry* begin,
             const Entry* end,
             AltIndices const& newAltIndices) const;
@@ -104,11 +107,16 @@ public:
     // \return the sample priority method, (order, unfiltered, or filtered)
     SamplePriority samplePriority() const;
 
+protected:
+    /// \exception runtime_error if the merged header has no type for the field
+    const CustomType* infoType(Symbol const& which) const;
+    const ValueMergers::Base* infoMerger(Symbol const& which, CustomType const& type) const;
+
 protected:
     /// The merged Vcf header for the final output file
     const Header* _header;
-    /// Map of info field names to ValueMergers (e.g., DP,sum to sum depth fields)
-    std::map<std::string, const ValueMergers::Base*> _info;
+    /// Map of info field symbols to ValueMergers (e.g., DP,sum to sum depth fields)
+    boost::container::flat_map<Symbol, const ValueMergers::Base*> _info;
     /// The default ValueMerger object to use when none is specified for a particular field
     const ValueMergers::Base* _default;
     /// This registry allows looking up ValueMergers by name 
@@ -8,9 +8,13 @@ using boost::format;
 
 BEGIN_NAMESPACE(Vcf)
 
-MultiWriter::MultiWriter(std::vector<std::string> const& filenames)
+MultiWriter::MultiWriter(
+        std::vector<std::string> const& filenames,
+        StreamHandler& streams
+        )
     : filenames_(filenames)
     , wroteHeader_(filenames.size(), false)
+    , streams_(streams)
 {
 }
 
@@ -13,14 +13,17 @@ BEGIN_NAMESPACE(Vcf)
 
 class MultiWriter {
 public:
-    MultiWriter(std::vector<std::string> const& filenames);
+    MultiWriter(
+        std::vector<std::string> const& filenames,
+        StreamHandler& streams
+        );
 
     void write(Entry const& e);
 
 private:
     std::vector<std::string> const& filenames_;
     std::vector<bool> wroteHeader_;
-    StreamHandler streams_;
+    StreamHandler& streams_;
 };
 
 END_NAMESPACE(Vcf)
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "common/namespaces.hpp"
+
+#include <set>
+#include <string>
+
+BEGIN_NAMESPACE(Vcf)
+
+// The parts of the sample data a reader of a stream uses, given to the
+// stream's Header (see Header::readerOptions). Sample values outside of
+// the projection are kept as text and written back out as they were
+// read; they are only parsed if something asks for them.
+struct ReaderOptions {
+    // FORMAT fields to parse, all of them if empty
+    std::set<std::string> formatFields;
+    // Samples to parse, all of them if empty
+    std::set<std::string> samples;
+};
+
+END_NAMESPACE(Vcf)
@@ -0,0 +1,515 @@
+#include "SampleColumn.hpp"
+
+#include "CustomType.hpp"
+#include "CustomValue.hpp"
+#include "common/MemoryUsage.hpp"
+#include "common/NumberConversion.hpp"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+using boost::format;
+using namespace std;
+
+BEGIN_NAMESPACE(Vcf)
+
+SampleColumn::SampleColumn()
+    : _type(0)
+    , _storage(TEXT)
+    , _slots(0)
+    , _genotypeField(false)
+{
+}
+
+void SampleColumn::reset(CustomType const* type, uint32_t sampleCount) {
+    _type = type;
+    switch (type->type()) {
+        case CustomType::INTEGER:
+        case CustomType::FLAG:
+            _storage = INTEGERS;
+            break;
+
+        case CustomType::FLOAT:
+            _storage = REALS;
+            break;
+
+        default:
+            _storage = TEXT;
+            break;
+    }
+
+    _genotypeField = type->type() == CustomType::STRING && type->id() == "GT";
+
+    _spans.assign(sampleCount, Span());
+    _slots = 0;
+    _integers.clear();
+    _reals.clear();
+    _text.clear();
+    _textEnds.clear();
+    _missing.clear();
+    _genotypes.clear();
+    _rawText.clear();
+    _rawEnds.clear();
+}
+
+void SampleColumn::resize(uint32_t sampleCount) {
+    _spans.resize(sampleCount);
+}
+
+CustomType const& SampleColumn::type() const {
+    if (!_type)
+        throw runtime_error("Attempted to use Vcf SampleColumn with uninitialized type");
+    return *_type;
+}
+
+void SampleColumn::appendSlot(bool missing) {
+    if (_slots % 64 == 0)
+        _missing.push_back(0);
+    if (missing)
+        _missing.back() |= uint64_t(1) << (_slots % 64);
+    ++_slots;
+}
+
+void SampleColumn::appendMissing() {
+    appendSlot(true);
+    switch (_storage) {
+        case INTEGERS: _integers.push_back(0); break;
+        case REALS: _reals.push_back(0); break;
+        case TEXT: _textEnds.push_back(_text.size()); break;
+    }
+    if (_genotypeField)
+        _genotypes.push_back(PackedGenotype());
+}
+
+void SampleColumn::appendText(char const* beg, char const* end) {
+    if (_genotypeField)
+        appendText(beg, end, PackedGenotype::parse(beg, end));
+    else {
+        appendSlot(false);
+        _text.append(beg, end);
+        _textEnds.push_back(_text.size());
+    }
+}
+
+void SampleColumn::appendText(char const* beg, char const* end, PackedGenotype const& genotype) {
+    appendSlot(false);
+    _text.append(beg, end);
+    _textEnds.push_back(_text.size());
+    if (_genotypeField)
+        _genotypes.push_back(genotype);
+}
+
+void SampleColumn::copySlot(uint32_t slot) {
+    appendSlot(isMissing(slot));
+
+    switch (_storage) {
+        case INTEGERS:
+            _integers.push_back(_integers[slot]);
+            break;
+
+        case REALS:
+            _reals.push_back(_reals[slot]);
+            break;
+
+        case TEXT: {
+            uint32_t beg = slot ? _textEnds[slot - 1] : 0;
+            uint32_t len = _textEnds[slot] - beg;
+            // the source is part of _text, so make room before taking
+            // a pointer to it
+            _text.reserve(_text.size() + len);
+            _text.append(_text.data() + beg, len);
+            _textEnds.push_back(_text.size());
+            if (_genotypeField)
+                _genotypes.push_back(_genotypes[slot]);
+            break;
+        }
+    }
+}
+
+void SampleColumn::truncate(uint32_t first) {
+    _slots = first;
+    _missing.resize((first + 63) / 64);
+    if (first % 64)
+        _missing.back() &= (uint64_t(1) << (first % 64)) - 1;
+
+    switch (_storage) {
+        case INTEGERS:
+            _integers.resize(first);
+            break;
+
+        case REALS:
+            _reals.resize(first);
+            break;
+
+        case TEXT:
+            _textEnds.resize(first);
+            _text.resize(first ? _textEnds.back() : 0);
+            if (_genotypeField)
+                _genotypes.resize(first);
+            break;
+    }
+}
+
+void SampleColumn::requireText() const {
+    if (_storage != TEXT)
+        type().typecheck<std::string>();
+}
+
+void SampleColumn::assign(uint32_t sampleIdx, char const* beg, char const* end) {
+    Span span;
+    span.first = _slots;
+
+    // '.', empty values and flags have no values
+    if (beg == end || (end - beg == 1 && *beg == '.') || type().type() == CustomType::FLAG) {
+        _spans[sampleIdx] = span;
+        return;
+    }
+
+    bool ok = true;
+    char const* p = beg;
+    while (ok) {
+        char const* q = static_cast<char const*>(memchr(p, ',', end - p));
+        if (!q)
+            q = end;
+
+        if (p == q) {
+            ok = false;
+        }
+        else if (q - p == 1 && *p == '.') {
+            appendMissing();
+        }
+        else {
+            switch (_storage) {
+                case INTEGERS: {
+                    int64_t value;
+                    if ((ok = parseInteger(p, q, value))) {
+                        _integers.push_back(value);
+                        appendSlot(false);
+                    }
+                    break;
+                }
+
+                case REALS: {
+                    double value;
+                    if ((ok = parseDouble(p, q, value))) {
+                        _reals.push_back(value);
+                        appendSlot(false);
+                    }
+                    break;
+                }
+
+                case TEXT:
+                    if ((ok = _type->type() == CustomType::STRING || q - p == 1))
+                        appendText(p, q);
+                    break;
+            }
+        }
+
+        if (q == end)
+            break;
+        p = q + 1;
+    }
+
+    if (!ok) {
+        truncate(span.first);
+        throw runtime_error(str(format("Failed to coerce value '%1%' into %2% for field '%3%'")
+            %std::string(beg, end) %CustomType::typeToString(_type->type()) %_type->id()));
+    }
+
+    span.count = _slots - span.first;
+    try {
+        _type->validateIndex(span.count - 1);
+    } catch (...) {
+        truncate(span.first);
+        throw;
+    }
+    _spans[sampleIdx] = span;
+}
+
+template<typename T, typename U>
+void SampleColumn::appendNumbers(CustomValue const& value, T const* values, std::vector<U>& out) {
+    for (CustomValue::SizeType i = 0; i < value.size(); ++i) {
+        bool missing = value.missing(i);
+        out.push_back(missing ? U() : U(values[i]));
+        appendSlot(missing);
+    }
+}
+
+void SampleColumn::assign(uint32_t sampleIdx, CustomValue const& value) {
+    Span span;
+    span.first = _slots;
+    if (value.empty()) {
+        _spans[sampleIdx] = span;
+        return;
+    }
+
+    CustomType::DataType from = value.type().type();
+    bool ok = false;
+    switch (_storage) {
+        case INTEGERS:
+            if (from == CustomType::INTEGER) {
+                appendNumbers(value, value.data<int64_t>(), _integers);
+                ok = true;
+            }
+            else if (from == CustomType::FLAG) {
+                appendNumbers(value, value.data<bool>(), _integers);
+                ok = true;
+            }
+            break;
+
+        case REALS:
+            if (from == CustomType::FLOAT) {
+                appendNumbers(value, value.data<double>(), _reals);
+                ok = true;
+            }
+            else if (from == CustomType::INTEGER) {
+                appendNumbers(value, value.data<int64_t>(), _reals);
+                ok = true;
+            }
+            break;
+
+        case TEXT:
+            if (from == CustomType::STRING || from == CustomType::CHAR) {
+                for (CustomValue::SizeType i = 0; i < value.size(); ++i) {
+                    if (value.missing(i)) {
+                        appendMissing();
+                    }
+                    else if (from == CustomType::STRING) {
+                        std::string const& v = value.data<std::string>()[i];
+                        appendText(v.data(), v.data() + v.size());
+                    }
+                    else {
+                        char const* v = value.data<char>() + i;
+                        appendText(v, v + 1);
+                    }
+                }
+                ok = true;
+            }
+            break;
+    }
+
+    if (!ok) {
+        truncate(span.first);
+        throw runtime_error(str(format("Value of the wrong type for %1% field '%2%'")
+            %CustomType::typeToString(type().type()) %type().id()));
+    }
+
+    span.count = _slots - span.first;
+    _spans[sampleIdx] = span;
+}
+
+void SampleColumn::assignRaw(uint32_t sampleIdx, char const* beg, char const* end) {
+    Span span;
+    // as in assign(), these have no values
+    if (beg != end && (end - beg != 1 || *beg != '.') && type().type() != CustomType::FLAG) {
+        span.first = _rawEnds.size();
+        span.count = 1;
+        span.raw = true;
+        _rawText.append(beg, end);
+        _rawEnds.push_back(_rawText.size());
+    }
+    _spans[sampleIdx] = span;
+}
+
+void SampleColumn::parseRaw() {
+    if (!hasRaw())
+        return;
+
+    std::string rawText;
+    std::vector<uint32_t> rawEnds;
+    rawText.swap(_rawText);
+    rawEnds.swap(_rawEnds);
+
+    // samples that share raw text (mirrored samples) share the parsed
+    // values too
+    std::vector<Span> parsed(rawEnds.size());
+    std::vector<bool> done(rawEnds.size());
+    uint32_t i = 0;
+    try {
+        for (; i < _spans.size(); ++i) {
+            Span const& span = _spans[i];
+            if (!span.raw)
+                continue;
+
+            uint32_t r = span.first;
+            if (!done[r]) {
+                char const* base = rawText.data();
+                assign(i, base + (r ? rawEnds[r - 1] : 0), base + rawEnds[r]);
+                parsed[r] = _spans[i];
+                done[r] = true;
+            }
+            else {
+                _spans[i] = parsed[r];
+            }
+        }
+    }
+    catch (...) {
+        // leave the samples that are still raw as they were
+        rawText.swap(_rawText);
+        rawEnds.swap(_rawEnds);
+        throw;
+    }
+}
+
+void SampleColumn::setString(uint32_t sampleIdx, uint32_t idx, StringView const& value) {
+    parseRaw();
+    requireText();
+    Span old = _spans[sampleIdx];
+    Span span;
+    span.first = _slots;
+    span.count = std::max(old.count, idx + 1);
+
+    for (uint32_t i = 0; i < span.count; ++i) {
+        if (i == idx)
+            appendText(value.begin(), value.end());
+        else if (i < old.count)
+            copySlot(old.first + i);
+        else
+            appendMissing();
+    }
+    _spans[sampleIdx] = span;
+}
+
+void SampleColumn::setGenotype(uint32_t sampleIdx, PackedGenotype const& value) {
+    parseRaw();
+    requireText();
+    Span old = _spans[sampleIdx];
+    Span span;
+    span.first = _slots;
+    span.count = std::max(old.count, 1u);
+
+    char buf[PackedGenotype::MAX_CHARS];
+    char* end = value.format(buf);
+    appendText(buf, end, value);
+    for (uint32_t i = 1; i < span.count; ++i)
+        copySlot(old.first + i);
+    _spans[sampleIdx] = span;
+}
+
+void SampleColumn::share(uint32_t targetIdx, uint32_t srcIdx) {
+    _spans[targetIdx] = _spans[srcIdx];
+}
+
+void SampleColumn::clear(uint32_t sampleIdx) {
+    _spans[sampleIdx] = Span();
+}
+
+void SampleColumn::reorder(std::vector<uint32_t> const& newIdx, uint32_t sampleCount) {
+    std::vector<Span> spans(sampleCount);
+    uint32_t n = std::min<size_t>(newIdx.size(), _spans.size());
+    for (uint32_t i = 0; i < n; ++i) {
+        if (newIdx[i] < sampleCount)
+            spans[newIdx[i]] = _spans[i];
+    }
+    _spans.swap(spans);
+}
+
+CustomValue SampleColumn::value(uint32_t sampleIdx) const {
+    Span const& span = _spans[sampleIdx];
+    std::vector<CustomValue::ValueType> values(span.count);
+    for (uint32_t i = 0; i < span.count; ++i) {
+        uint32_t s = span.first + i;
+        if (isMissing(s))
+            continue;
+
+        switch (_type->type()) {
+            case CustomType::INTEGER:
+                values[i] = _integers[s];
+                break;
+
+            case CustomType::FLAG:
+                values[i] = _integers[s] != 0;
+                break;
+
+            case CustomType::FLOAT:
+                values[i] = _reals[s];
+                break;
+
+            case CustomType::CHAR:
+                values[i] = *text(s).begin();
+                break;
+
+            default: {
+                StringView v = text(s);
+                values[i] = std::string(v.begin(), v.end());
+                break;
+            }
+        }
+    }
+    return CustomValue(_type, std::move(values));
+}
+
+void SampleColumn::toStream(std::ostream& s, uint32_t sampleIdx) const {
+    Span const& span = _spans[sampleIdx];
+    if (span.count == 0) {
+        s << '.';
+        return;
+    }
+
+    if (span.raw) {
+        uint32_t beg = span.first ? _rawEnds[span.first - 1] : 0;
+        s.write(_rawText.data() + beg, _rawEnds[span.first] - beg);
+        return;
+    }
+
+    for (uint32_t i = 0; i < span.count; ++i) {
+        uint32_t slot = span.first + i;
+        if (i > 0)
+            s << ',';
+
+        if (isMissing(slot)) {
+            s << '.';
+            continue;
+        }
+
+        switch (_storage) {
+            case INTEGERS:
+                writeInteger(s, _integers[slot]);
+                break;
+
+            case REALS:
+                writeDouble(s, _reals[slot]);
+                break;
+
+            case TEXT: {
+                StringView v = text(slot);
+                s.write(v.begin(), v.size());
+                break;
+            }
+        }
+    }
+}
+
+void SampleColumn::swap(SampleColumn& other) {
+    std::swap(_type, other._type);
+    std::swap(_storage, other._storage);
+    _spans.swap(other._spans);
+    std::swap(_slots, other._slots);
+    _integers.swap(other._integers);
+    _reals.swap(other._reals);
+    _text.swap(other._text);
+    _textEnds.swap(other._textEnds);
+    _missing.swap(other._missing);
+    std::swap(_genotypeField, other._genotypeField);
+    _genotypes.swap(other._genotypes);
+    _rawText.swap(other._rawText);
+    _rawEnds.swap(other._rawEnds);
+}
+
+std::size_t SampleColumn::heapBytes() const {
+    return allocationBytes(_spans.capacity() * sizeof(Span))
+        + ::heapBytes(_integers)
+        + ::heapBytes(_reals)
+        + ::heapBytes(_text)
+        + ::heapBytes(_textEnds)
+        + ::heapBytes(_missing)
+        + allocationBytes(_genotypes.capacity() * sizeof(PackedGenotype))
+        + ::heapBytes(_rawText)
+        + ::heapBytes(_rawEnds);
+}
+
+END_NAMESPACE(Vcf)
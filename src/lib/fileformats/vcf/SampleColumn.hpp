@@ -0,0 +1,197 @@
+#pragma once
+
+#include "GenotypeCall.hpp"
+#include "common/StringView.hpp"
+#include "common/cstdint.hpp"
+#include "common/namespaces.hpp"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(Vcf)
+
+class CustomType;
+class CustomValue;
+
+// The values of one FORMAT field for every sample in a record, stored
+// in a single array of the field's type (integers for Integer and Flag,
+// doubles for Float, and one string with end offsets for Character and
+// String). '.' values are marked in a bitmap rather than stored.
+//
+// Each sample refers to a run of slots in the arrays. Changing a sample
+// appends new slots and points the sample at them, so samples may share
+// a run (as mirrored samples do) and the old slots are only reclaimed by
+// reset().
+//
+// A String field with id GT also keeps each value as a PackedGenotype,
+// parsed once when the value is set.
+//
+// Values that a reader has no use for can be stored as raw text with
+// assignRaw(); they are written out as they were. Until parseRaw() is
+// called, only toStream() and the functions that move whole samples
+// around (assign, share, clear, reorder) may be used on such a column.
+class SampleColumn {
+public:
+    SampleColumn();
+
+    // Empty the column and give it a new type, keeping the memory
+    void reset(CustomType const* type, uint32_t sampleCount);
+    void resize(uint32_t sampleCount);
+
+    CustomType const& type() const;
+    uint32_t sampleCount() const;
+
+    // Parse the text of one sample's value as CustomValue(type, text)
+    // does
+    void assign(uint32_t sampleIdx, char const* beg, char const* end);
+    void assign(uint32_t sampleIdx, CustomValue const& value);
+    // Keep the text of one sample's value without parsing it
+    void assignRaw(uint32_t sampleIdx, char const* beg, char const* end);
+    bool hasRaw() const;
+    // Parse the values stored by assignRaw()
+    void parseRaw();
+    // Set value idx of a Character or String field, keeping the others
+    void setString(uint32_t sampleIdx, uint32_t idx, StringView const& value);
+    // Set the genotype of a GT field, keeping any other values
+    void setGenotype(uint32_t sampleIdx, PackedGenotype const& value);
+    // Make targetIdx refer to the values of srcIdx
+    void share(uint32_t targetIdx, uint32_t srcIdx);
+    void clear(uint32_t sampleIdx);
+
+    // Move sample i to newIdx[i] in a column of sampleCount samples.
+    // Samples that are mapped past the end are dropped.
+    void reorder(std::vector<uint32_t> const& newIdx, uint32_t sampleCount);
+
+    uint32_t size(uint32_t sampleIdx) const;
+    bool empty(uint32_t sampleIdx) const;
+    bool missing(uint32_t sampleIdx, uint32_t idx) const;
+
+    // Typed access to value idx, which must exist and not be missing
+    int64_t integer(uint32_t sampleIdx, uint32_t idx) const;
+    double real(uint32_t sampleIdx, uint32_t idx) const;
+    StringView string(uint32_t sampleIdx, uint32_t idx) const;
+
+    // True if this is a GT field with packed genotypes
+    bool genotypes() const;
+    // The first value of a GT field; empty if the sample has no value or
+    // it is '.'
+    PackedGenotype genotype(uint32_t sampleIdx) const;
+
+    CustomValue value(uint32_t sampleIdx) const;
+    // Writes the values as CustomValue::toStream does
+    void toStream(std::ostream& s, uint32_t sampleIdx) const;
+
+    void swap(SampleColumn& other);
+
+    // Approximate heap memory used by the values
+    std::size_t heapBytes() const;
+
+protected:
+    enum Storage {
+        INTEGERS,
+        REALS,
+        TEXT
+    };
+
+    struct Span {
+        Span() : first(0), count(0), raw(false) {}
+
+        uint32_t first;
+        uint32_t count;
+        // first is an index into _rawEnds
+        bool raw;
+    };
+
+    uint32_t slot(uint32_t sampleIdx, uint32_t idx) const;
+    bool isMissing(uint32_t slot) const;
+    void appendSlot(bool missing);
+    void appendMissing();
+    template<typename T, typename U>
+    void appendNumbers(CustomValue const& value, T const* values, std::vector<U>& out);
+    void appendText(char const* beg, char const* end);
+    void appendText(char const* beg, char const* end, PackedGenotype const& genotype);
+    void copySlot(uint32_t slot);
+    // Drop slots from first on, used to undo a failed assign
+    void truncate(uint32_t first);
+    StringView text(uint32_t slot) const;
+    void requireText() const;
+
+protected:
+    CustomType const* _type;
+    Storage _storage;
+    std::vector<Span> _spans;
+    uint32_t _slots;
+
+    std::vector<int64_t> _integers;
+    std::vector<double> _reals;
+    std::string _text;
+    std::vector<uint32_t> _textEnds;
+    std::vector<uint64_t> _missing;
+
+    bool _genotypeField;
+    std::vector<PackedGenotype> _genotypes;
+
+    std::string _rawText;
+    std::vector<uint32_t> _rawEnds;
+};
+
+inline uint32_t SampleColumn::sampleCount() const {
+    return _spans.size();
+}
+
+inline bool SampleColumn::hasRaw() const {
+    return !_rawEnds.empty();
+}
+
+inline uint32_t SampleColumn::size(uint32_t sampleIdx) const {
+    return _spans[sampleIdx].count;
+}
+
+inline bool SampleColumn::empty(uint32_t sampleIdx) const {
+    return _spans[sampleIdx].count == 0;
+}
+
+inline uint32_t SampleColumn::slot(uint32_t sampleIdx, uint32_t idx) const {
+    return _spans[sampleIdx].first + idx;
+}
+
+inline bool SampleColumn::isMissing(uint32_t slot) const {
+    return (_missing[slot / 64] >> (slot % 64)) & 1;
+}
+
+inline bool SampleColumn::missing(uint32_t sampleIdx, uint32_t idx) const {
+    return isMissing(slot(sampleIdx, idx));
+}
+
+inline int64_t SampleColumn::integer(uint32_t sampleIdx, uint32_t idx) const {
+    return _integers[slot(sampleIdx, idx)];
+}
+
+inline double SampleColumn::real(uint32_t sampleIdx, uint32_t idx) const {
+    return _reals[slot(sampleIdx, idx)];
+}
+
+inline StringView SampleColumn::text(uint32_t slot) const {
+    char const* base = _text.data();
+    return StringView(base + (slot ? _textEnds[slot - 1] : 0), base + _textEnds[slot]);
+}
+
+inline StringView SampleColumn::string(uint32_t sampleIdx, uint32_t idx) const {
+    requireText();
+    return text(slot(sampleIdx, idx));
+}
+
+inline bool SampleColumn::genotypes() const {
+    return _genotypeField;
+}
+
+inline PackedGenotype SampleColumn::genotype(uint32_t sampleIdx) const {
+    Span const& span = _spans[sampleIdx];
+    if (span.count == 0)
+        return PackedGenotype();
+    return _genotypes[span.first];
+}
+
+END_NAMESPACE(Vcf)
@@ -4,6 +4,7 @@
 #include "CustomValue.hpp"
 #include "GenotypeCall.hpp"
 #include "Header.hpp"
+#include "common/MemoryUsage.hpp"
 #include "common/Tokenizer.hpp"
 #include "io/StreamJoin.hpp"
 
@@ -15,7 +16,9 @@
 #include <functional>
 #include <iterator>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <utility>
@@ -28,91 +31,119 @@ namespace {
     bool customTypeIdMatches(string const& id, CustomType const* type) {
         return type && type->id() == id;
     }
+
+    // Guards the parsing of raw columns by SampleData::column(). That is
+    // rare (once per field left out of the reader options and read after
+    // all), so one lock is shared by every object.
+    std::mutex rawColumnsMutex;
 }
 
 SampleData& SampleData::operator=(SampleData const& other) {
-    freeValues();
+    if (this == &other)
+        return *this;
+
     _header = other._header;
     _format = other._format;
-    // deep copy values
-    for (auto i = other._values.begin(); i != other._values.end(); ++i)
-        _values.insert(_values.end(), make_pair(i->first, new ValueVector(*i->second)));
+    _columns.assign(other._columns.begin(), other._columns.begin() + other._format.size());
+    _fieldCounts = other._fieldCounts;
+    _rawColumns.store(other._rawColumns.load());
+    clearViews();
     return *this;
 }
 
 SampleData& SampleData::operator=(SampleData&& other) {
-    std::swap(_header, other._header);
-    _format.swap(other._format);
-    _values.swap(other._values);
+    swap(other);
     return *this;
 }
 
 
 SampleData::SampleData()
     : _header(0)
+    , _rawColumns(0)
 {
 }
 
-SampleData::SampleData(SampleData const& other) {
+SampleData::SampleData(SampleData const& other)
+    : _header(0)
+    , _rawColumns(0)
+{
     *this = other;
 }
 
 SampleData::SampleData(SampleData&& other)
     : _header(other._header)
     , _format(std::move(other._format))
-    , _values(std::move(other._values))
+    , _columns(std::move(other._columns))
+    , _rawColumns(other._rawColumns.load())
+    , _fieldCounts(std::move(other._fieldCounts))
+    , _views(std::move(other._views))
+    , _fieldViews(std::move(other._fieldViews))
 {
 }
 
-SampleData::SampleData(Header const* h, std::string const& raw) {
-    try {
-        parse(h, raw);
-    } catch (...) {
-        freeValues();
-        throw;
-    }
+SampleData::SampleData(Header const* h, std::string const& raw)
+    : _rawColumns(0)
+{
+    parse(h, raw);
 }
 
 void SampleData::parse(Header const* h, std::string const& raw) {
+    parse(h, raw.data(), raw.data() + raw.size());
+}
+
+void SampleData::parse(Header const* h, char const* rawBeg, char const* rawEnd) {
     _header = h;
+    _format.clear();
+    _fieldCounts.assign(_header->sampleNames().size(), -1);
+    _rawColumns.store(0);
+    clearViews();
 
-    Tokenizer<char> tok(raw, '\t');
+    Tokenizer<char> tok(rawBeg, rawEnd, '\t');
     char const* beg(0);
     char const* end(0);
 
-    vector<string> fmt;
     if (tok.extract(&beg, &end) && (end - beg != 1 || *beg != '.')) {
-        Tokenizer<char>::split(beg, end, ':', back_inserter(fmt));
-
-        _format.reserve(fmt.size());
-        for (auto i = fmt.begin(); i != fmt.end(); ++i) {
-            if (i->empty())
+        Tokenizer<char> fmt(beg, end, ':');
+        while (fmt.extract(&beg, &end)) {
+            if (beg == end)
                 continue;
 
-            appendFormatField(*i);
+            appendFormatField(string(beg, end));
         }
     }
 
+    // fields outside of the reader's projection are kept as text
+    _parsedFields.resize(_format.size());
+    bool parseAll = true;
+    for (size_t f = 0; f < _format.size(); ++f) {
+        _parsedFields[f] = _header->parsesFormatField(_format[f]->id());
+        parseAll &= _parsedFields[f];
+    }
+
     uint32_t sampleIdx(0);
     while (tok.extract(&beg, &end)) {
-        vector<string> data;
-
         // allow trailing tabs because our data has some :/
         if (tok.eof() && end-beg == 0)
             break;
 
-        if (end-beg != 1 || *beg != '.') {
-            Tokenizer<char>::split(beg, end, ':', back_inserter(data));
-
-            if (data.size() > _format.size())
-                throw runtime_error("More per-sample values than described in format section");
+        if (sampleIdx >= _fieldCounts.size())
+            resizeSamples(sampleIdx + 1);
 
-            std::auto_ptr<ValueVector> values(new ValueVector);
-            values->resize(data.size());
-            for (uint32_t i = 0; i < data.size(); ++i) {
-                (*values)[i] = CustomValue(_format[i], data[i]);
+        if (end-beg != 1 || *beg != '.') {
+            bool parseSample = _header->parsesSample(sampleIdx);
+            Tokenizer<char> data(beg, end, ':');
+            uint32_t n(0);
+            while (data.extract(&beg, &end)) {
+                if (n == _format.size())
+                    throw runtime_error("More per-sample values than described in format section");
+
+                if (parseSample && (parseAll || _parsedFields[n]))
+                    _columns[n].assign(sampleIdx, beg, end);
+                else
+                    _columns[n].assignRaw(sampleIdx, beg, end);
+                ++n;
             }
-            _values.insert(make_pair(sampleIdx, values.release()));
+            _fieldCounts[sampleIdx] = n;
         }
         ++sampleIdx;
     }
@@ -122,14 +153,24 @@ void SampleData::parse(Header const* h, std::string const& raw) {
         size_t targetIdx = i->first;
         size_t srcIdx = i->second;
 
-        auto src = _values.find(srcIdx);
-        if (src != _values.end()) {
-            auto inserted = _values.insert(make_pair(targetIdx, src->second));
-            if (!inserted.second)
+        if (srcIdx < _fieldCounts.size() && _fieldCounts[srcIdx] >= 0) {
+            if (targetIdx >= _fieldCounts.size())
+                resizeSamples(targetIdx + 1);
+            if (_fieldCounts[targetIdx] >= 0)
                 throw runtime_error("Internal error: column mirroring.");
+
+            // the columns copy on write, so the samples can share values
+            _fieldCounts[targetIdx] = _fieldCounts[srcIdx];
+            for (size_t f = 0; f < _format.size(); ++f)
+                _columns[f].share(targetIdx, srcIdx);
         }
     }
 
+    uint32_t rawColumns = 0;
+    for (size_t f = 0; f < _format.size(); ++f)
+        rawColumns += _columns[f].hasRaw();
+    _rawColumns.store(rawColumns);
+
 
     if (sampleIdx > _header->sampleNames().size()) {
         throw runtime_error(str(boost::format(
@@ -140,27 +181,46 @@ void SampleData::parse(Header const* h, std::string const& raw) {
 
 SampleData::SampleData(Header const* h, FormatType&& fmt, MapType&& values)
     : _header(h)
+    , _rawColumns(0)
 {
-    _format.swap(fmt);
-    _values.swap(values);
+    // Mirrored columns can lead to multiple copies of the same
+    // pointer appearing in the values map. We don't want to
+    // delete them twice.
+    boost::unordered_set<ValueVector*> uniqPtrs;
+    vector<unique_ptr<ValueVector>> owned;
+    uint32_t nSamples = _header->sampleNames().size();
+    for (auto i = values.begin(); i != values.end(); ++i) {
+        if (i->second && uniqPtrs.insert(i->second).second)
+            owned.emplace_back(i->second);
+        nSamples = std::max(nSamples, i->first + 1);
+    }
+    MapType sampleValues;
+    sampleValues.swap(values);
+
+    _fieldCounts.assign(nSamples, -1);
+    for (auto i = fmt.begin(); i != fmt.end(); ++i)
+        appendFormatField(*i);
+    fmt.clear();
+
+    for (auto i = sampleValues.begin(); i != sampleValues.end(); ++i) {
+        if (i->second == 0)
+            continue;
+
+        ValueVector const& sample = *i->second;
+        if (sample.size() > _format.size())
+            throw runtime_error("More per-sample values than described in format section");
+
+        for (size_t f = 0; f < sample.size(); ++f)
+            _columns[f].assign(i->first, sample[f]);
+        _fieldCounts[i->first] = sample.size();
+    }
 }
 
 SampleData::~SampleData() {
-    freeValues();
 }
 
-void SampleData::freeValues() {
-    // Mirrored columns can lead to multiple copies of the same
-    // pointer appearing in the _values map. We don't want to
-    // delete them twice.
-    boost::unordered_set<ValueVector*> uniqPtrs;
-    for (auto i = _values.begin(); i != _values.end(); ++i) {
-        auto seen = uniqPtrs.insert(i->second);
-        if (seen.second) {
-            delete i->second;
-        }
-    }
-    _values.clear();
+std::size_t SampleData::heapBytes() const {
+    return ::heapBytes(_format) + ::heapBytes(_columns) + ::heapBytes(_fieldCounts);
 }
 
 Header const& SampleData::header() const {
@@ -174,27 +234,63 @@ void SampleData::reheader(Header const* newHeader) {
     if (!newHeader)
         throw runtime_error("Attempted to reheader Vcf SampleData with null header!");
 
-    MapType newData;
-    for (auto i = _values.begin(); i != _values.end(); ++i) {
-        const string& sampleName = header().sampleNames()[i->first];
-        uint32_t newIdx = newHeader->sampleIndex(sampleName);
-        std::swap(newData[newIdx], i->second);
+    // samples without data are mapped past the end and dropped
+    vector<uint32_t> newIdx(_fieldCounts.size(), numeric_limits<uint32_t>::max());
+    vector<int32_t> newCounts(newHeader->sampleNames().size(), -1);
+    for (uint32_t i = 0; i < _fieldCounts.size(); ++i) {
+        if (_fieldCounts[i] < 0)
+            continue;
+
+        const string& sampleName = header().sampleNames()[i];
+        newIdx[i] = newHeader->sampleIndex(sampleName);
+        if (newIdx[i] >= newCounts.size())
+            newCounts.resize(newIdx[i] + 1, -1);
+        newCounts[newIdx[i]] = _fieldCounts[i];
     }
 
+    for (size_t f = 0; f < _format.size(); ++f)
+        _columns[f].reorder(newIdx, newCounts.size());
+
     _header = newHeader;
-    _values.swap(newData);
+    _fieldCounts.swap(newCounts);
+    clearViews();
 }
 
 void SampleData::clear() {
     _header = 0;
     _format.clear();
-    freeValues();
+    _rawColumns.store(0);
+    _fieldCounts.clear();
+    clearViews();
 }
 
 void SampleData::swap(SampleData& other) {
     std::swap(_header, other._header);
     _format.swap(other._format);
-    _values.swap(other._values);
+    _columns.swap(other._columns);
+    uint32_t rawColumns = _rawColumns.load();
+    _rawColumns.store(other._rawColumns.load());
+    other._rawColumns.store(rawColumns);
+    _fieldCounts.swap(other._fieldCounts);
+    _views.swap(other._views);
+    _fieldViews.swap(other._fieldViews);
+}
+
+void SampleData::resizeSamples(uint32_t sampleCount) {
+    _fieldCounts.resize(sampleCount, -1);
+    for (size_t f = 0; f < _format.size(); ++f)
+        _columns[f].resize(sampleCount);
+}
+
+bool SampleData::hasField(uint32_t sampleIdx, uint32_t formatIdx) const {
+    return sampleIdx < _fieldCounts.size() && _fieldCounts[sampleIdx] > int32_t(formatIdx);
+}
+
+void SampleData::extendFields(uint32_t sampleIdx, uint32_t n) {
+    int32_t& count = _fieldCounts[sampleIdx];
+    for (uint32_t f = std::max(count, 0); f < n; ++f)
+        _columns[f].clear(sampleIdx);
+    count = std::max(count, int32_t(n));
 }
 
 void SampleData::setSampleField(uint32_t sampleIdx, Vcf::CustomValue&& value) {
@@ -205,22 +301,17 @@ void SampleData::setSampleField(uint32_t sampleIdx, Vcf::CustomValue&& value) {
     }
 
     int ftIdx = appendFormatFieldIfNotExists(value.type().id());
+    if (sampleIdx >= _fieldCounts.size())
+        resizeSamples(sampleIdx + 1);
 
-    ValueVector*& values = _values[sampleIdx];
-    if (values == 0) {
-        values = new ValueVector(ftIdx + 1);
-    }
-    else if (int(values->size()) <= ftIdx) {
-        values->resize(ftIdx + 1);
-    }
-
-    (*values)[ftIdx] = std::move(value);
+    extendFields(sampleIdx, ftIdx + 1);
+    _columns[ftIdx].assign(sampleIdx, value);
+    clearViews();
 }
 
 
 void SampleData::addFilter(uint32_t sampleIdx, std::string const& filterName) {
-    auto sampleIter = _values.find(sampleIdx);
-    if (sampleIter == _values.end() || sampleIter->second == 0) {
+    if (fieldCount(sampleIdx) < 0) {
         cerr << "Warning: attempted to filter nonexistant sample\n";
         return;
     }
@@ -235,29 +326,28 @@ void SampleData::addFilter(uint32_t sampleIdx, std::string const& filterName) {
     int ftIdx = appendFormatFieldIfNotExists("FT");
     assert(ftIdx != -1);
 
-    if (int(sampleIter->second->size()) <= ftIdx) {
-        sampleIter->second->resize(ftIdx+1);
-    }
+    extendFields(sampleIdx, ftIdx + 1);
 
     // rt #97906
-    // copy sample data on write when adding consensus filter for mirrored
-    // columns
-    if (_header->isReflected(sampleIdx) || _header->isReflection(sampleIdx)) {
-        sampleIter->second = new ValueVector(*sampleIter->second);
-    }
-    ValueVector& values = *sampleIter->second;
+    // mirrored columns share values until one of them is written, so
+    // the consensus filter only lands on this sample
+    SampleColumn& column = _columns[ftIdx];
 
-    auto& prev = values[ftIdx];
     set<string> filters;
-    if (!prev.empty())
-        Tokenizer<char>::split(prev.toString(), ';', inserter(filters, filters.begin()));
+    if (!column.empty(sampleIdx)) {
+        stringstream prev;
+        column.toStream(prev, sampleIdx);
+        Tokenizer<char>::split(prev.str(), ';', inserter(filters, filters.begin()));
+    }
 
     filters.erase(".");
     filters.erase("PASS");
     filters.insert(filterName);
     stringstream ss;
     ss << streamJoin(filters).delimiter(";").emptyString(".");
-    values[ftIdx] = CustomValue(FT, ss.str());
+    string const value = ss.str();
+    column.assign(sampleIdx, value.data(), value.data() + value.size());
+    clearViews();
 }
 
 SampleData::FormatType const& SampleData::format() const {
@@ -272,46 +362,83 @@ int SampleData::formatKeyIndex(std::string const& key) const {
     return distance(_format.begin(), i);
 }
 
-CustomValue const* SampleData::get(uint32_t sampleIdx, std::string const& key) const {
-    ValueVector const* values = get(sampleIdx);
+SampleColumn const& SampleData::column(uint32_t formatIdx) const {
+    // values left as text by the reader options are parsed on first use,
+    // under a lock since readers may share the object
+    if (_rawColumns.load(std::memory_order_acquire) > 0) {
+        lock_guard<mutex> lock(rawColumnsMutex);
+        SampleColumn& rv = _columns[formatIdx];
+        if (rv.hasRaw()) {
+            rv.parseRaw();
+            _rawColumns.fetch_sub(1, std::memory_order_release);
+        }
+    }
+    return _columns[formatIdx];
+}
+
+void SampleData::clearViews() {
+    _views.clear();
+    _fieldViews.clear();
+}
+
+int32_t SampleData::fieldCount(uint32_t sampleIdx) const {
+    if (sampleIdx >= _fieldCounts.size())
+        return -1;
+    return _fieldCounts[sampleIdx];
+}
 
+CustomValue const* SampleData::get(uint32_t sampleIdx, std::string const& key) const {
     // no data for that sample
-    if (!values)
+    if (fieldCount(sampleIdx) < 0)
         return 0;
 
     // no info for that format key
     int offset = formatKeyIndex(key);
-    if (offset == -1)
-        return 0;
-
-    if (size_t(offset) >= values->size())
+    if (offset == -1 || !hasField(sampleIdx, offset))
         return 0;
 
-    return &(*values)[offset];
+    // only the requested field is made (and parsed if it was left as text)
+    auto field = make_pair(sampleIdx, uint32_t(offset));
+    auto i = _fieldViews.find(field);
+    if (i == _fieldViews.end())
+        i = _fieldViews.insert(make_pair(field, column(offset).value(sampleIdx))).first;
+    return &i->second;
 }
 
 SampleData::ValueVector const* SampleData::get(uint32_t sampleIdx) const {
-    auto iter = _values.find(sampleIdx);
-    if (iter == _values.end())
+    int32_t n = fieldCount(sampleIdx);
+    if (n < 0)
         return 0;
 
-    return iter->second;
+    auto inserted = _views.insert(make_pair(sampleIdx, ValueVector()));
+    if (inserted.second) {
+        ValueVector& values = inserted.first->second;
+        values.reserve(n);
+        for (int32_t f = 0; f < n; ++f)
+            values.push_back(column(f).value(sampleIdx));
+    }
+    return &inserted.first->second;
 }
 
 SampleData::const_iterator SampleData::begin() const {
-    return _values.begin();
+    return const_iterator(SampleHasData(&_fieldCounts),
+        boost::counting_iterator<uint32_t>(0),
+        boost::counting_iterator<uint32_t>(_fieldCounts.size()));
 }
 
 SampleData::const_iterator SampleData::end() const {
-    return _values.end();
+    return const_iterator(SampleHasData(&_fieldCounts),
+        boost::counting_iterator<uint32_t>(_fieldCounts.size()),
+        boost::counting_iterator<uint32_t>(_fieldCounts.size()));
 }
 
 SampleData::MapType::size_type SampleData::size() const {
-    return _values.size();
+    return count_if(_fieldCounts.begin(), _fieldCounts.end(),
+        boost::bind(greater_equal<int32_t>(), _1, 0));
 }
 
 SampleData::MapType::size_type SampleData::count(uint32_t idx) const {
-    return _values.count(idx);
+    return fieldCount(idx) >= 0;
 }
 
 bool SampleData::hasGenotypeData() const {
@@ -319,24 +446,59 @@ bool SampleData::hasGenotypeData() const {
 }
 
 GenotypeCall const& SampleData::genotype(uint32_t sampleIdx) const {
-    const string* gtString(0);
-    const CustomValue* v = get(sampleIdx, "GT");
-    if (!v || v->empty() || (gtString = v->get<string>(0)) == 0 || gtString->empty())
+    int gtIdx = formatKeyIndex("GT");
+    if (gtIdx == -1 || !hasField(sampleIdx, gtIdx))
+        return GenotypeCall::Null;
+
+    SampleColumn const& column = SampleData::column(gtIdx);
+    if (column.empty(sampleIdx) || column.missing(sampleIdx, 0))
         return GenotypeCall::Null;
 
-    auto inserted = _gtCache.insert(make_pair(*gtString, GenotypeCall()));
+    if (column.genotypes()) {
+        PackedGenotype packed = column.genotype(sampleIdx);
+        if (packed.packed()) {
+            auto inserted = _gtCache.insert(make_pair(packed.code(), GenotypeCall()));
+            // if it wasn't already in the cache
+            if (inserted.second)
+                inserted.first->second = GenotypeCall(packed);
+            return inserted.first->second;
+        }
+    }
+
+    StringView gtString = column.string(sampleIdx, 0);
+    if (gtString.empty())
+        return GenotypeCall::Null;
+
+    auto inserted = _gtTextCache.insert(make_pair(string(gtString.begin(), gtString.end()), GenotypeCall()));
     // if it wasn't already in the cache
     if (inserted.second)
-        inserted.first->second = GenotypeCall(*gtString);
+        inserted.first->second = GenotypeCall(inserted.first->first);
     return inserted.first->second;
 }
 
+PackedGenotype SampleData::packedGenotype(uint32_t sampleIdx) const {
+    int gtIdx = formatKeyIndex("GT");
+    if (gtIdx == -1 || !hasField(sampleIdx, gtIdx))
+        return PackedGenotype();
+
+    SampleColumn const& column = SampleData::column(gtIdx);
+    if (column.empty(sampleIdx) || column.missing(sampleIdx, 0))
+        return PackedGenotype();
+
+    if (column.genotypes()) {
+        PackedGenotype rv = column.genotype(sampleIdx);
+        if (rv.packed())
+            return rv;
+    }
+
+    // the text is not in the form format() writes (e.g., "01/1"), so go
+    // through GenotypeCall
+    return PackedGenotype::fromCall(genotype(sampleIdx));
+}
+
 uint32_t SampleData::samplesWithData() const {
-    uint32_t rv(0);
-    for (auto i = _values.begin(); i != _values.end(); ++i)
-        if (!i->second->empty())
-            ++rv;
-    return rv;
+    return count_if(_fieldCounts.begin(), _fieldCounts.end(),
+        boost::bind(greater<int32_t>(), _1, 0));
 }
 
 uint32_t SampleData::samplesWithoutGenotypes() const {
@@ -360,15 +522,19 @@ uint32_t SampleData::samplesWithGenotypes() const {
 }
 
 bool SampleData::isSampleFiltered(uint32_t idx, std::string* filterName) const {
-    CustomValue const* ft = get(idx, "FT");
-    if (!ft || ft->empty())
+    int offset = formatKeyIndex("FT");
+    if (offset == -1 || !hasField(idx, offset))
         return false;
 
-    for (size_t i = 0; i < ft->size(); ++i) {
-        string const& f = ft->getString(i);
-        if (!f.empty() && f != "." && f != "PASS") {
+    SampleColumn const& ft = column(offset);
+    for (uint32_t i = 0; i < ft.size(idx); ++i) {
+        if (ft.missing(idx, i))
+            continue;
+
+        StringView f = ft.string(idx, i);
+        if (!f.empty() && !(f == ".") && !(f == "PASS")) {
             if (filterName != 0)
-                *filterName = f;
+                filterName->assign(f.begin(), f.end());
             return true;
         }
     }
@@ -376,50 +542,34 @@ bool SampleData::isSampleFiltered(uint32_t idx, std::string* filterName) const {
 }
 
 int32_t SampleData::samplesFailedFilter() const {
-    auto i = find_if(_format.begin(), _format.end(),
-            boost::bind(&customTypeIdMatches, "FT", _1));
-
-    if (i == _format.end())
+    int offset = formatKeyIndex("FT");
+    if (offset == -1)
         return -1;
 
-    uint32_t offset = distance(_format.begin(), i);
+    SampleColumn const& ft = column(offset);
     uint32_t numFailedFilter = 0;
-    for (auto i = _values.begin(); i != _values.end(); ++i) {
-        if (i->second == 0)
-            continue;
-        auto const& values = *i->second;
-        if (values.size() > offset) {
-            //then we have some data
-            const std::string *filter;
-            //if it has a value (assume . is processed correctly) and we're able to get a value and it is not pass then failed
-            if (!values[offset].empty() && (filter = values[offset].get<std::string>(0)) != 0 && *filter != std::string("PASS")) {
-               numFailedFilter++;
-            }
+    for (uint32_t i = 0; i < _fieldCounts.size(); ++i) {
+        //if it has a value (assume . is processed correctly) and it is not pass then failed
+        if (hasField(i, offset) && !ft.empty(i) && !ft.missing(i, 0)
+            && !(ft.string(i, 0) == "PASS"))
+        {
+            numFailedFilter++;
         }
     }
     return numFailedFilter;
 }
 
 int32_t SampleData::samplesEvaluatedByFilter() const {
-    auto i = find_if(_format.begin(), _format.end(),
-            boost::bind(&customTypeIdMatches, "FT", _1));
-
-    if (i == _format.end())
+    int offset = formatKeyIndex("FT");
+    if (offset == -1)
         return -1;
 
-    uint32_t offset = distance(_format.begin(), i);
+    SampleColumn const& ft = column(offset);
     uint32_t numEvaluatedByFilter = 0;
-    for (auto i = _values.begin(); i != _values.end(); ++i) {
-        if (i->second == 0)
-            continue;
-        auto const& values = *i->second;
-        if (values.size() > offset) {
-            //then we have some data
-            //if it has a value (assume . is processed correctly) and we're able to get a value and it is not pass then failed
-            if (!values[offset].empty() && values[offset].get<std::string>(0) != 0) {
-               numEvaluatedByFilter++;
-            }
-        }
+    for (uint32_t i = 0; i < _fieldCounts.size(); ++i) {
+        //if it has a value (assume . is processed correctly) then it was evaluated
+        if (hasField(i, offset) && !ft.empty(i) && !ft.missing(i, 0))
+            numEvaluatedByFilter++;
     }
     return numEvaluatedByFilter;
 }
@@ -429,16 +579,39 @@ void SampleData::renumberGT(std::map<size_t, size_t> const& altMap) {
     if (gtIdx == -1)
         return;
 
-    for (auto iter = _values.begin(); iter != _values.end(); ++iter) {
-        ValueVector& vals = *iter->second;
-        if (vals.size() <= size_t(gtIdx))
-            continue;
-        CustomValue& gt = vals[gtIdx];
-        string const* gtStr = gt.get<string>();
-        if (gtStr == 0)
+    // parses the values if they were left as text
+    SampleData::column(gtIdx);
+    SampleColumn& column = _columns[gtIdx];
+    for (uint32_t i = 0; i < _fieldCounts.size(); ++i) {
+        if (!hasField(i, gtIdx) || column.empty(i) || column.missing(i, 0))
             continue;
 
-        GenotypeCall old(*gtStr);
+        if (column.genotypes()) {
+            PackedGenotype old = column.genotype(i);
+            if (old.packed() && !old.empty()) {
+                PackedGenotype renumbered;
+                bool fits = true;
+                for (uint32_t j = 0; j < old.size() && fits; ++j) {
+                    GenotypeIndex idx = old[j];
+                    if (!idx.null()) {
+                        auto remapped = altMap.find(idx.value);
+                        if (remapped != altMap.end()) {
+                            if (remapped->second > PackedGenotype::MAX_DIPLOID_INDEX)
+                                break;
+                            idx = GenotypeIndex(remapped->second);
+                        }
+                    }
+                    fits = renumbered.append(idx, old.phased());
+                }
+                if (fits && renumbered.size() == old.size()) {
+                    column.setGenotype(i, renumbered);
+                    continue;
+                }
+            }
+        }
+
+        StringView gtStr = column.string(i, 0);
+        GenotypeCall old(string(gtStr.begin(), gtStr.end()));
         char delim = old.phased() ? '|' : '/';
         stringstream newss;
         for (auto alt = old.begin(); alt != old.end(); ++alt) {
@@ -457,65 +630,70 @@ void SampleData::renumberGT(std::map<size_t, size_t> const& altMap) {
                 newss << remapped->second;
             }
         }
-        vals[gtIdx].set(0, newss.str());
+        string const newGT = newss.str();
+        column.setString(i, 0, StringView(newGT.data(), newGT.data() + newGT.size()));
     }
+    clearViews();
 }
 
 void SampleData::removeLowDepthGenotypes(uint32_t lowDepth) {
-    auto i = find_if(_format.begin(), _format.end(),
-            boost::bind(&customTypeIdMatches, "DP", _1));
-
-    if (i == _format.end())
+    int offset = formatKeyIndex("DP");
+    if (offset == -1)
         return;
 
-    uint32_t offset = distance(_format.begin(), i);
-    for (auto i = _values.begin(); i != _values.end(); ++i) {
-        if (i->second == 0)
+    SampleColumn const& dp = column(offset);
+    dp.type().typecheck<int64_t>();
+    for (uint32_t i = 0; i < _fieldCounts.size(); ++i) {
+        if (_fieldCounts[i] < 0)
             continue;
-        auto& values = *i->second;
-        const int64_t *v;
-        if (values[offset].empty() || (v = values[offset].get<int64_t>(0)) == 0 || *v < lowDepth)
-            values.clear();
+
+        if (!hasField(i, offset) || dp.empty(i) || dp.missing(i, 0) || dp.integer(i, 0) < lowDepth)
+            _fieldCounts[i] = 0;
     }
+    clearViews();
 }
 
 void SampleData::removeFilteredWhitelist(std::set<std::string> const& whitelist) {
     // Check if we even have filters
-    auto i = find_if(_format.begin(), _format.end(),
-            boost::bind(&customTypeIdMatches, "FT", _1));
-
-    if (i == _format.end())
+    int offset = formatKeyIndex("FT");
+    if (offset == -1)
         return;
 
-    uint32_t offset = distance(_format.begin(), i);
-
-    for (auto i = _values.begin(); i != _values.end(); ++i) {
-        if (i->second == 0)
-            continue;
-
-        auto& values = *i->second;
-        if (values.size() <= offset || values[offset].empty()) {
+    SampleColumn const& ft = column(offset);
+    for (uint32_t i = 0; i < _fieldCounts.size(); ++i) {
+        if (!hasField(i, offset))
             continue; // no filter here
-        }
 
-        for (size_t filtIdx = 0; filtIdx < values[offset].size(); ++filtIdx) {
-            std::string const* filterName = values[offset].get<std::string>(filtIdx);
-            if (filterName && *filterName != "PASS" && *filterName != "." &&
-                whitelist.count(*filterName) == 0)
+        for (uint32_t filtIdx = 0; filtIdx < ft.size(i); ++filtIdx) {
+            if (ft.missing(i, filtIdx))
+                continue;
+
+            StringView filterName = ft.string(i, filtIdx);
+            if (!(filterName == "PASS") && !(filterName == ".") &&
+                whitelist.count(string(filterName.begin(), filterName.end())) == 0)
             {
-                values.clear();
+                _fieldCounts[i] = 0;
+                break;
             }
         }
     }
+    clearViews();
+}
+
+void SampleData::writeSample(std::ostream& s, uint32_t sampleIdx) const {
+    for (int32_t f = 0; f < _fieldCounts[sampleIdx]; ++f) {
+        if (f > 0)
+            s << ':';
+        _columns[f].toStream(s, sampleIdx);
+    }
 }
 
 void SampleData::sampleToStream(std::ostream& s, size_t sampleIdx) const {
-    auto data = get(sampleIdx);
-    if (!data) {
+    if (fieldCount(sampleIdx) < 0) {
         s << ".";
     }
     else {
-        s << streamJoin(*data).delimiter(":");
+        writeSample(s, sampleIdx);
     }
 }
 
@@ -532,6 +710,13 @@ int SampleData::appendFormatField(std::string const& key) {
     if (!type) {
         throw runtime_error(str(boost::format("Unknown id in FORMAT field: %1%") % key));
     }
+    return appendFormatField(type);
+}
+
+int SampleData::appendFormatField(CustomType const* type) {
+    if (_columns.size() == _format.size())
+        _columns.push_back(SampleColumn());
+    _columns[_format.size()].reset(type, _fieldCounts.size());
     _format.push_back(type);
     return _format.size() - 1;
 }
@@ -550,28 +735,19 @@ void SampleData::formatToStream(std::ostream& s) const {
 }
 
 std::ostream& operator<<(std::ostream& s, SampleData const& sampleData) {
-    uint32_t sampleCounter(0);
     sampleData.formatToStream(s);
     uint32_t nSamples = sampleData.header().sampleCount();
-    for (auto i = sampleData.begin(); i != sampleData.end(); ++i) {
-        s << '\t';
-        while (sampleCounter < i->first) {
-            s << ".\t";
-            ++sampleCounter;
-        }
-
-        if (i->second == 0)
-            continue;
-        auto const& values = *i->second;
-        s << streamJoin(values).delimiter(":").emptyString(".");
-        ++sampleCounter;
-    }
+    for (auto i = sampleData.begin(); i != sampleData.end(); ++i)
+        nSamples = std::max(nSamples, *i + 1);
 
-    while (sampleCounter++ < nSamples) {
-        s << "\t.";
+    for (uint32_t i = 0; i < nSamples; ++i) {
+        s << '\t';
+        if (sampleData.fieldCount(i) > 0)
+            sampleData.sampleToStream(s, i);
+        else
+            s << '.';
     }
 
-
     return s;
 }
 
@@ -1,31 +1,58 @@
 #pragma once
 
+#include "CustomValue.hpp"
 #include "GenotypeCall.hpp"
+#include "SampleColumn.hpp"
 #include "common/namespaces.hpp"
 #include "common/cstdint.hpp"
 
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/filter_iterator.hpp>
 #include <boost/unordered_map.hpp>
 
+#include <atomic>
 #include <map>
 #include <ostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 BEGIN_NAMESPACE(Vcf)
 
 class CustomType;
-class CustomValue;
 class Header;
 
+// The per-sample columns of a VCF record. Values are kept in one
+// SampleColumn per FORMAT field; get() builds CustomValues from them on
+// demand, and those stay valid until the sample data is next changed.
 class SampleData {
 public:
     typedef std::vector<CustomValue> ValueVector;
     typedef std::map<uint32_t, ValueVector*> MapType;
     typedef std::vector<CustomType const*> FormatType;
-    typedef MapType::const_iterator const_iterator;
+
+    struct SampleHasData {
+        SampleHasData() : fieldCounts(0) {}
+        explicit SampleHasData(std::vector<int32_t> const* fieldCounts)
+            : fieldCounts(fieldCounts)
+        {}
+
+        bool operator()(uint32_t sampleIdx) const {
+            return (*fieldCounts)[sampleIdx] >= 0;
+        }
+
+        std::vector<int32_t> const* fieldCounts;
+    };
+
+    // Iterates over the indices of the samples that have data
+    typedef boost::filter_iterator<
+          SampleHasData
+        , boost::counting_iterator<uint32_t>
+        > const_iterator;
 
     SampleData();
     SampleData(Header const* h, std::string const& raw);
+    // Takes ownership of the vectors in values
     SampleData(Header const* h, FormatType&& fmt, MapType&& values);
     SampleData(SampleData const& other);
     SampleData(SampleData&& other);
@@ -43,6 +70,12 @@ public:
     void setSampleField(uint32_t sampleIdx, Vcf::CustomValue&& value);
 
     FormatType const& format() const;
+    // The values of format()[formatIdx] for all samples. Values the
+    // header's reader options left as text are parsed on first use.
+    SampleColumn const& column(uint32_t formatIdx) const;
+    // The number of FORMAT fields given for a sample, -1 if it has no data
+    int32_t fieldCount(uint32_t sampleIdx) const;
+
     const_iterator begin() const;
     const_iterator end() const;
     MapType::size_type size() const;
@@ -55,6 +88,10 @@ public:
     // returns true if GT is the first FORMAT entry
     bool hasGenotypeData() const;
     GenotypeCall const& genotype(uint32_t sampleIdx) const;
+    // The GT value of a sample without making a GenotypeCall. This is
+    // empty if the sample has no GT value, and not packed() if the call
+    // does not fit (genotype() should be used then).
+    PackedGenotype packedGenotype(uint32_t sampleIdx) const;
 
     uint32_t samplesWithData() const;
     uint32_t samplesWithGenotypes() const;
@@ -72,19 +109,46 @@ public:
     void sampleToStream(std::ostream& s, size_t sampleIdx) const;
 
     void parse(Header const* h, std::string const& raw);
+    void parse(Header const* h, char const* rawBeg, char const* rawEnd);
 
     int appendFormatFieldIfNotExists(std::string const& key);
 
+    // Approximate heap memory used by the parsed values (the genotype
+    // cache and the values made by get() are not counted)
+    std::size_t heapBytes() const;
+
 protected:
     int appendFormatField(std::string const& key);
-    void freeValues();
+    int appendFormatField(CustomType const* type);
+    void resizeSamples(uint32_t sampleCount);
+    bool hasField(uint32_t sampleIdx, uint32_t formatIdx) const;
+    // Give a sample at least n fields, the new ones empty
+    void extendFields(uint32_t sampleIdx, uint32_t n);
+    void writeSample(std::ostream& s, uint32_t sampleIdx) const;
+    // Drop the values made by get()
+    void clearViews();
 
 protected:
     Header const* _header;
     std::vector<CustomType const*> _format;
-    MapType _values;
-
-    mutable boost::unordered_map<std::string, GenotypeCall> _gtCache;
+    // Parallel to _format. Any columns past the end of _format are
+    // spares, kept for their memory when the object is reused.
+    //
+    // Values that the header's reader options leave unparsed are parsed
+    // by column() on first use, hence mutable. _rawColumns counts the
+    // columns that may still hold text; once it is 0, column() takes no
+    // lock.
+    mutable std::vector<SampleColumn> _columns;
+    mutable std::atomic<uint32_t> _rawColumns;
+    std::vector<int32_t> _fieldCounts;
+    // scratch space for parse()
+    std::vector<bool> _parsedFields;
+
+    mutable std::map<uint32_t, ValueVector> _views;
+    // single values made by get(sampleIdx, key), by sample and field
+    mutable std::map<std::pair<uint32_t, uint32_t>, CustomValue> _fieldViews;
+    mutable boost::unordered_map<uint64_t, GenotypeCall> _gtCache;
+    mutable boost::unordered_map<std::string, GenotypeCall> _gtTextCache;
 };
 
 std::ostream& operator<<(std::ostream& s, SampleData const& sampleData);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "SymbolTable.hpp"
+#include "common/MemoryUsage.hpp"
+#include "common/namespaces.hpp"
+
+#include <boost/iterator/transform_iterator.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(Vcf)
+
+// A small set of symbols (e.g., the failed filters of a record) kept in a
+// vector. The symbols are sorted by name, so iterating gives the names in
+// the order a std::set<std::string> would; lookups compare ids.
+class SymbolSet {
+public:
+    struct ToName {
+        typedef std::string const& result_type;
+        std::string const& operator()(Symbol const& sym) const {
+            return sym.name();
+        }
+    };
+
+    typedef std::vector<Symbol>::const_iterator SymbolIterator;
+    typedef boost::transform_iterator<ToName, SymbolIterator> const_iterator;
+    typedef const_iterator iterator;
+
+    bool empty() const { return _symbols.empty(); }
+    std::size_t size() const { return _symbols.size(); }
+
+    const_iterator begin() const { return const_iterator(_symbols.begin()); }
+    const_iterator end() const { return const_iterator(_symbols.end()); }
+
+    std::vector<Symbol> const& symbols() const { return _symbols; }
+
+    std::size_t count(Symbol const& sym) const {
+        return std::find(_symbols.begin(), _symbols.end(), sym) != _symbols.end();
+    }
+
+    const_iterator find(Symbol const& sym) const {
+        return const_iterator(std::find(_symbols.begin(), _symbols.end(), sym));
+    }
+
+    // Returns true if sym was not already in the set
+    bool insert(Symbol const& sym) {
+        if (count(sym))
+            return false;
+        _symbols.insert(
+            std::upper_bound(_symbols.begin(), _symbols.end(), sym, SymbolNameLess()),
+            sym);
+        return true;
+    }
+
+    std::size_t erase(Symbol const& sym) {
+        auto i = std::find(_symbols.begin(), _symbols.end(), sym);
+        if (i == _symbols.end())
+            return 0;
+        _symbols.erase(i);
+        return 1;
+    }
+
+    void clear() {
+        _symbols.clear();
+    }
+
+    void swap(SymbolSet& other) {
+        _symbols.swap(other._symbols);
+    }
+
+    bool operator==(SymbolSet const& rhs) const {
+        return _symbols == rhs._symbols;
+    }
+
+    bool operator!=(SymbolSet const& rhs) const {
+        return _symbols != rhs._symbols;
+    }
+
+    std::size_t heapBytes() const {
+        return allocationBytes(_symbols.capacity() * sizeof(Symbol));
+    }
+
+protected:
+    std::vector<Symbol> _symbols;
+};
+
+END_NAMESPACE(Vcf)
@@ -0,0 +1,80 @@
+#include "SymbolTable.hpp"
+
+#include <boost/format.hpp>
+
+#include <stdexcept>
+
+using boost::format;
+
+BEGIN_NAMESPACE(Vcf)
+
+uint32_t const SymbolTable::PASS_ID;
+uint32_t const SymbolTable::NO_ID;
+uint32_t const SymbolTable::CHUNK_BITS;
+uint32_t const SymbolTable::CHUNK_SIZE;
+uint32_t const SymbolTable::MAX_CHUNKS;
+
+SymbolTable& SymbolTable::instance() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolTable::SymbolTable()
+    : _size(0)
+{
+    for (uint32_t i = 0; i < MAX_CHUNKS; ++i)
+        _chunks[i].store(0, std::memory_order_relaxed);
+
+    intern("PASS");
+}
+
+SymbolTable::~SymbolTable() {
+    for (uint32_t i = 0; i < MAX_CHUNKS; ++i)
+        delete[] _chunks[i].load(std::memory_order_relaxed);
+}
+
+uint32_t SymbolTable::intern(std::string const& name) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto found = _index.find(name);
+    if (found != _index.end())
+        return found->second;
+
+    uint32_t id = _size;
+    uint32_t chunkIdx = id >> CHUNK_BITS;
+    if (chunkIdx >= MAX_CHUNKS) {
+        throw std::runtime_error(str(format(
+            "Too many distinct vcf ids (more than %1%) while adding '%2%'"
+            ) % (MAX_CHUNKS * CHUNK_SIZE) % name));
+    }
+
+    std::string* chunk = _chunks[chunkIdx].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new std::string[CHUNK_SIZE];
+        _chunks[chunkIdx].store(chunk, std::memory_order_release);
+    }
+
+    chunk[id & (CHUNK_SIZE - 1)] = name;
+    _index[name] = id;
+    ++_size;
+    return id;
+}
+
+uint32_t SymbolTable::find(std::string const& name) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto found = _index.find(name);
+    return found != _index.end() ? found->second : NO_ID;
+}
+
+std::size_t SymbolTable::size() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+std::string const& Symbol::name() const {
+    static std::string const none;
+    if (empty())
+        return none;
+    return SymbolTable::instance().name(_id);
+}
+
+END_NAMESPACE(Vcf)
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "common/cstdint.hpp"
+#include "common/namespaces.hpp"
+
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+BEGIN_NAMESPACE(Vcf)
+
+// Process wide table giving the FILTER, INFO and FORMAT ids of vcf files
+// small integer ids, so that records can store and compare them without
+// keeping strings. Headers add their ids as they are parsed; names that
+// turn up elsewhere (e.g., undeclared filters) are added when first seen.
+//
+// The table is shared by all headers rather than owned by one so that
+// records can be moved between headers (reheader, merge) and still be
+// compared. Names are never removed. Looking up the name of an id does
+// not lock, everything else does.
+class SymbolTable : boost::noncopyable {
+public:
+    // PASS is added first, so its id is known
+    static uint32_t const PASS_ID = 0;
+    static uint32_t const NO_ID = ~uint32_t(0);
+
+    static SymbolTable& instance();
+
+    // Returns the id of name, adding it to the table if needed
+    uint32_t intern(std::string const& name);
+    // Returns the id of name or NO_ID if it is not in the table
+    uint32_t find(std::string const& name) const;
+
+    // The name of an id returned by intern()
+    std::string const& name(uint32_t id) const;
+
+    std::size_t size() const;
+
+protected:
+    // Names are stored in chunks that never move, so name() can read
+    // them while other threads are adding to the table
+    static uint32_t const CHUNK_BITS = 10;
+    static uint32_t const CHUNK_SIZE = 1u << CHUNK_BITS;
+    static uint32_t const MAX_CHUNKS = 4096;
+
+    SymbolTable();
+    ~SymbolTable();
+
+protected:
+    mutable std::mutex _mutex;
+    boost::unordered_map<std::string, uint32_t> _index;
+    std::atomic<std::string*> _chunks[MAX_CHUNKS];
+    uint32_t _size;
+};
+
+// The id of an interned name. Symbols compare equal when their names do;
+// operator< orders them by id, not by name. A default constructed symbol
+// has an empty name and is not equal to any interned one.
+class Symbol {
+public:
+    static Symbol pass();
+    // The symbol of name if it is in the table, otherwise an empty one
+    static Symbol find(std::string const& name);
+
+    Symbol();
+    // These add name to the SymbolTable
+    Symbol(std::string const& name);
+    Symbol(char const* name);
+
+    uint32_t id() const;
+    bool empty() const;
+    std::string const& name() const;
+
+    friend bool operator==(Symbol const& a, Symbol const& b) {
+        return a._id == b._id;
+    }
+
+    friend bool operator!=(Symbol const& a, Symbol const& b) {
+        return a._id != b._id;
+    }
+
+    friend bool operator<(Symbol const& a, Symbol const& b) {
+        return a._id < b._id;
+    }
+
+    friend std::ostream& operator<<(std::ostream& s, Symbol const& sym) {
+        return s << sym.name();
+    }
+
+protected:
+    explicit Symbol(uint32_t id);
+
+protected:
+    uint32_t _id;
+};
+
+// Orders symbols by name
+struct SymbolNameLess {
+    bool operator()(Symbol const& a, Symbol const& b) const {
+        return a.name() < b.name();
+    }
+};
+
+inline std::string const& SymbolTable::name(uint32_t id) const {
+    std::string const* chunk = _chunks[id >> CHUNK_BITS].load(std::memory_order_acquire);
+    return chunk[id & (CHUNK_SIZE - 1)];
+}
+
+inline Symbol Symbol::pass() {
+    return Symbol(SymbolTable::PASS_ID);
+}
+
+inline Symbol Symbol::find(std::string const& name) {
+    return Symbol(SymbolTable::instance().find(name));
+}
+
+inline Symbol::Symbol()
+    : _id(SymbolTable::NO_ID)
+{
+}
+
+inline Symbol::Symbol(std::string const& name)
+    : _id(SymbolTable::instance().intern(name))
+{
+}
+
+inline Symbol::Symbol(char const* name)
+    : _id(SymbolTable::instance().intern(name))
+{
+}
+
+inline Symbol::Symbol(uint32_t id)
+    : _id(id)
+{
+}
+
+inline uint32_t Symbol::id() const {
+    return _id;
+}
+
+inline bool Symbol::empty() const {
+    return _id == SymbolTable::NO_ID;
+}
+
+END_NAMESPACE(Vcf)
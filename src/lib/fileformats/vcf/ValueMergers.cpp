@@ -121,8 +121,8 @@ CustomValue UniqueConcat::operator()(
                 for (CustomValue::SizeType i = 0; i < v->size(); ++i) {
                     string s = v->getString(i);
                     auto inserted = seen.insert(s);
-                    if (inserted.second) {
-                        rv.append(CustomValue(&v->type(), s));
+                    if (inserted.second && !v->missing(i)) {
+                        rv.append(*v, i);
                     }
                 }
             }
@@ -0,0 +1,255 @@
+#include "Bgzf.hpp"
+
+#include "common/Exceptions.hpp"
+#include "common/cstdint.hpp"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using boost::format;
+
+BEGIN_NAMESPACE(Bgzf)
+
+namespace {
+    // gzip fixed header (10 bytes) followed by XLEN (2 bytes)
+    std::size_t const GZIP_FIXED_HEADER_LENGTH = 12;
+
+    unsigned char const GZIP_ID1 = 31;
+    unsigned char const GZIP_ID2 = 139;
+    unsigned char const GZIP_CM_DEFLATE = 8;
+    unsigned char const GZIP_FLG_FEXTRA = 4;
+    unsigned char const GZIP_OS_UNKNOWN = 255;
+
+    unsigned char const BGZF_SI1 = 'B';
+    unsigned char const BGZF_SI2 = 'C';
+
+    inline uint16_t unpackUint16(char const* p) {
+        unsigned char const* u = reinterpret_cast<unsigned char const*>(p);
+        return u[0] | (u[1] << 8);
+    }
+
+    inline uint32_t unpackUint32(char const* p) {
+        unsigned char const* u = reinterpret_cast<unsigned char const*>(p);
+        return uint32_t(u[0])
+            | (uint32_t(u[1]) << 8)
+            | (uint32_t(u[2]) << 16)
+            | (uint32_t(u[3]) << 24);
+    }
+
+    inline void packUint16(char* p, uint16_t value) {
+        p[0] = value & 0xff;
+        p[1] = (value >> 8) & 0xff;
+    }
+
+    inline void packUint32(char* p, uint32_t value) {
+        p[0] = value & 0xff;
+        p[1] = (value >> 8) & 0xff;
+        p[2] = (value >> 16) & 0xff;
+        p[3] = (value >> 24) & 0xff;
+    }
+
+    // Read exactly len bytes unless end of file is reached first.
+    // Returns the number of bytes read.
+    std::size_t readFully(int fd, char* buf, std::size_t len) {
+        std::size_t total = 0;
+        while (total < len) {
+            ssize_t rv = ::read(fd, buf + total, len - total);
+            if (rv == 0)
+                break;
+
+            if (rv < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw IOError(str(format(
+                    "Error reading BGZF data: %1%") % strerror(errno)));
+            }
+            total += rv;
+        }
+        return total;
+    }
+
+    // Look for the BC subfield in a gzip extra field and return the block
+    // size, or 0 if it is not present.
+    std::size_t findBlockSize(char const* extra, std::size_t xlen) {
+        std::size_t pos = 0;
+        while (pos + 4 <= xlen) {
+            unsigned char si1 = extra[pos];
+            unsigned char si2 = extra[pos + 1];
+            uint16_t slen = unpackUint16(extra + pos + 2);
+            if (si1 == BGZF_SI1 && si2 == BGZF_SI2 && slen == 2 && pos + 6 <= xlen)
+                return std::size_t(unpackUint16(extra + pos + 4)) + 1;
+            pos += 4 + slen;
+        }
+        return 0;
+    }
+}
+
+char const EOF_BLOCK[28] = {
+    '\x1f', '\x8b', '\x08', '\x04', '\x00', '\x00', '\x00', '\x00',
+    '\x00', '\xff', '\x06', '\x00', '\x42', '\x43', '\x02', '\x00',
+    '\x1b', '\x00', '\x03', '\x00', '\x00', '\x00', '\x00', '\x00',
+    '\x00', '\x00', '\x00', '\x00'
+};
+
+bool isBgzfHeader(char const* data, std::size_t len) {
+    if (len < BLOCK_HEADER_LENGTH)
+        return false;
+
+    unsigned char const* u = reinterpret_cast<unsigned char const*>(data);
+    return u[0] == GZIP_ID1
+        && u[1] == GZIP_ID2
+        && u[2] == GZIP_CM_DEFLATE
+        && (u[3] & GZIP_FLG_FEXTRA) != 0
+        && findBlockSize(
+                data + GZIP_FIXED_HEADER_LENGTH,
+                std::min<std::size_t>(
+                    unpackUint16(data + 10),
+                    len - GZIP_FIXED_HEADER_LENGTH)
+                ) != 0;
+}
+
+bool isBgzfFile(std::string const& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    char buf[BLOCK_HEADER_LENGTH];
+    std::size_t len = 0;
+    try {
+        len = readFully(fd, buf, sizeof(buf));
+    }
+    catch (IOError const&) {
+    }
+    ::close(fd);
+    return isBgzfHeader(buf, len);
+}
+
+bool readBlock(int fd, std::vector<char>& block) {
+    block.resize(GZIP_FIXED_HEADER_LENGTH);
+    std::size_t got = readFully(fd, block.data(), GZIP_FIXED_HEADER_LENGTH);
+    if (got == 0) {
+        block.clear();
+        return false;
+    }
+
+    if (got < GZIP_FIXED_HEADER_LENGTH)
+        throw IOError("Truncated BGZF block header");
+
+    unsigned char const* u = reinterpret_cast<unsigned char const*>(block.data());
+    if (u[0] != GZIP_ID1 || u[1] != GZIP_ID2 || (u[3] & GZIP_FLG_FEXTRA) == 0)
+        throw IOError("Invalid BGZF block header");
+
+    std::size_t xlen = unpackUint16(block.data() + 10);
+    block.resize(GZIP_FIXED_HEADER_LENGTH + xlen);
+    if (readFully(fd, block.data() + GZIP_FIXED_HEADER_LENGTH, xlen) != xlen)
+        throw IOError("Truncated BGZF block header");
+
+    std::size_t blockSize = findBlockSize(block.data() + GZIP_FIXED_HEADER_LENGTH, xlen);
+    std::size_t headerLength = GZIP_FIXED_HEADER_LENGTH + xlen;
+    if (blockSize < headerLength + BLOCK_FOOTER_LENGTH)
+        throw IOError("Invalid BGZF block size");
+
+    block.resize(blockSize);
+    std::size_t remaining = blockSize - headerLength;
+    if (readFully(fd, block.data() + headerLength, remaining) != remaining)
+        throw IOError("Truncated BGZF block");
+
+    return true;
+}
+
+void inflateBlock(std::vector<char> const& block, std::vector<char>& out) {
+    std::size_t xlen = unpackUint16(block.data() + 10);
+    std::size_t headerLength = GZIP_FIXED_HEADER_LENGTH + xlen;
+    std::size_t footer = block.size() - BLOCK_FOOTER_LENGTH;
+    uint32_t expectedCrc = unpackUint32(block.data() + footer);
+    uint32_t isize = unpackUint32(block.data() + footer + 4);
+
+    if (isize > MAX_BLOCK_SIZE)
+        throw IOError(str(format("Invalid BGZF block: ISIZE = %1%") % isize));
+
+    out.resize(isize);
+    if (isize == 0)
+        return;
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data() + headerLength));
+    zs.avail_in = footer - headerLength;
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = isize;
+
+    // negative window bits: raw deflate data, we handle the gzip framing
+    if (inflateInit2(&zs, -15) != Z_OK)
+        throw IOError("Failed to initialize zlib inflate");
+
+    int rv = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+
+    if (rv != Z_STREAM_END || zs.total_out != isize)
+        throw IOError(str(format("Failed to inflate BGZF block (zlib status %1%)") % rv));
+
+    uint32_t crc = crc32(0L, reinterpret_cast<Bytef const*>(out.data()), isize);
+    if (crc != expectedCrc)
+        throw IOError("CRC mismatch in BGZF block");
+}
+
+void deflateBlock(
+        char const* data,
+        std::size_t len,
+        std::vector<char>& out,
+        int level
+        )
+{
+    if (len > DEFAULT_BLOCK_DATA_SIZE) {
+        throw std::runtime_error(str(format(
+            "Attempted to compress %1% bytes into a single BGZF block"
+            ) % len));
+    }
+
+    out.resize(MAX_BLOCK_SIZE);
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in = len;
+    zs.next_out = reinterpret_cast<Bytef*>(out.data() + BLOCK_HEADER_LENGTH);
+    zs.avail_out = MAX_BLOCK_SIZE - BLOCK_HEADER_LENGTH - BLOCK_FOOTER_LENGTH;
+
+    if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw IOError("Failed to initialize zlib deflate");
+
+    int rv = deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+
+    if (rv != Z_STREAM_END)
+        throw IOError(str(format("Failed to deflate BGZF block (zlib status %1%)") % rv));
+
+    std::size_t blockSize = BLOCK_HEADER_LENGTH + zs.total_out + BLOCK_FOOTER_LENGTH;
+    out.resize(blockSize);
+
+    char* p = out.data();
+    p[0] = GZIP_ID1;
+    p[1] = GZIP_ID2;
+    p[2] = GZIP_CM_DEFLATE;
+    p[3] = GZIP_FLG_FEXTRA;
+    packUint32(p + 4, 0); // MTIME
+    p[8] = 0; // XFL
+    p[9] = GZIP_OS_UNKNOWN;
+    packUint16(p + 10, 6); // XLEN
+    p[12] = BGZF_SI1;
+    p[13] = BGZF_SI2;
+    packUint16(p + 14, 2); // SLEN
+    packUint16(p + 16, blockSize - 1);
+
+    uint32_t crc = crc32(0L, reinterpret_cast<Bytef const*>(data), len);
+    packUint32(p + blockSize - 8, crc);
+    packUint32(p + blockSize - 4, len);
+}
+
+END_NAMESPACE(Bgzf)
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "common/namespaces.hpp"
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Helpers for the BGZF (blocked gzip) format used by bgzip/tabix.
+//
+// A BGZF file is a series of concatenated gzip members ("blocks"), each
+// holding at most 64KB of uncompressed data. The compressed size of each
+// block is stored in a gzip extra subfield, which makes it possible to
+// find block boundaries without inflating anything and therefore to
+// decompress (or compress) blocks independently of one another.
+BEGIN_NAMESPACE(Bgzf)
+
+// The size of the fixed header written by bgzip (including the BC subfield)
+std::size_t const BLOCK_HEADER_LENGTH = 18;
+// CRC32 + ISIZE
+std::size_t const BLOCK_FOOTER_LENGTH = 8;
+// Upper bound for the size of a block, compressed or not
+std::size_t const MAX_BLOCK_SIZE = 65536;
+// Amount of uncompressed data bgzip puts in each block. This is small
+// enough that the compressed block is guaranteed to fit in MAX_BLOCK_SIZE.
+std::size_t const DEFAULT_BLOCK_DATA_SIZE = 0xff00;
+
+// The empty block bgzip appends to mark the end of a file
+extern char const EOF_BLOCK[28];
+
+// Returns true if data (at least BLOCK_HEADER_LENGTH bytes) begins with a
+// BGZF block header.
+bool isBgzfHeader(char const* data, std::size_t len);
+
+// Returns true if the file at path is BGZF compressed.
+bool isBgzfFile(std::string const& path);
+
+// Read one complete compressed block from fd into block. Returns false
+// at end of input. Throws IOError on truncated or malformed blocks.
+bool readBlock(int fd, std::vector<char>& block);
+
+// Decompress a complete block (as returned by readBlock) into out.
+// The CRC of the decompressed data is verified.
+void inflateBlock(std::vector<char> const& block, std::vector<char>& out);
+
+// Compress len bytes (at most DEFAULT_BLOCK_DATA_SIZE) of data into a
+// single complete block stored in out.
+void deflateBlock(
+        char const* data,
+        std::size_t len,
+        std::vector<char>& out,
+        int level = Z_DEFAULT_COMPRESSION
+        );
+
+END_NAMESPACE(Bgzf)
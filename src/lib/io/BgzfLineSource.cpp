@@ -0,0 +1,188 @@
+#include "BgzfLineSource.hpp"
+
+#include "Bgzf.hpp"
+#include "common/Exceptions.hpp"
+#include "common/ThreadPool.hpp"
+#include "common/compat.hpp"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using boost::format;
+
+namespace {
+    static std::size_t const blocksPerThread_ = 4;
+
+    // Task for the decompression pool: owns one compressed block and
+    // returns its decompressed contents.
+    struct InflateTask {
+        std::vector<char> block;
+
+        std::vector<char> operator()() {
+            std::vector<char> rv;
+            Bgzf::inflateBlock(block, rv);
+            return rv;
+        }
+    };
+}
+
+BgzfLineSource::BgzfLineSource(std::string const& path, std::size_t nThreads)
+    : _path(path)
+    , _fd(::open(path.c_str(), O_RDONLY))
+    , _pool(std::make_unique<ThreadPool>(nThreads))
+    , _maxPending(_pool->size() * blocksPerThread())
+    , _readOffset(0)
+    , _blockOffset(0)
+    , _pos(0)
+    , _inputDone(false)
+    , _bad(_fd == -1)
+    , _eof(false)
+{
+}
+
+BgzfLineSource::~BgzfLineSource() {
+    // wait for outstanding work before the fd goes away
+    _pending.clear();
+    _pool.reset();
+    if (_fd != -1)
+        ::close(_fd);
+}
+
+void BgzfLineSource::fillQueue() {
+    while (!_inputDone && _pending.size() < _maxPending) {
+        InflateTask task;
+        if (!Bgzf::readBlock(_fd, task.block)) {
+            _inputDone = true;
+            break;
+        }
+        PendingBlock pending;
+        pending.offset = _readOffset;
+        _readOffset += task.block.size();
+        pending.data = _pool->submit(std::move(task));
+        _pending.push_back(std::move(pending));
+    }
+}
+
+bool BgzfLineSource::nextBlock() {
+    if (_bad)
+        return false;
+
+    // skip over empty blocks (e.g., the EOF marker)
+    do {
+        fillQueue();
+        if (_pending.empty()) {
+            _blockOffset = _readOffset;
+            _data.clear();
+            _pos = 0;
+            return false;
+        }
+
+        _blockOffset = _pending.front().offset;
+        _data = _pending.front().data.get();
+        _pending.pop_front();
+        _pos = 0;
+    } while (_data.empty());
+
+    return true;
+}
+
+bool BgzfLineSource::getline(std::string& line) {
+    line.erase();
+
+    while (_pos < _data.size() || nextBlock()) {
+        char const* first = _data.data() + _pos;
+        char const* last = _data.data() + _data.size();
+        char const* chPos = std::find(first, last, '\n');
+        line.append(first, chPos - first);
+        if (chPos != last) {
+            _pos = chPos - _data.data() + 1;
+            return true;
+        }
+        _pos = _data.size();
+    }
+
+    _eof = line.empty();
+    return !_eof;
+}
+
+bool BgzfLineSource::getline(StringView& line) {
+    if (_pos < _data.size()) {
+        char const* first = _data.data() + _pos;
+        char const* last = _data.data() + _data.size();
+        char const* chPos = std::find(first, last, '\n');
+        if (chPos != last) {
+            line.assign(first, chPos);
+            _pos = chPos - _data.data() + 1;
+            return true;
+        }
+    }
+
+    bool rv = getline(_spill);
+    line.assign(_spill.data(), _spill.data() + _spill.size());
+    return rv;
+}
+
+char BgzfLineSource::peek() {
+    if (_pos < _data.size() || nextBlock())
+        return _data[_pos];
+
+    return EOF;
+}
+
+void BgzfLineSource::seek(uint64_t virtualOffset) {
+    if (_bad)
+        return;
+
+    uint64_t blockOffset = virtualOffset >> 16;
+    std::size_t pos = virtualOffset & 0xffff;
+    _eof = false;
+
+    // no need to throw away read ahead blocks when seeking forward
+    // within the current one
+    if (blockOffset != _blockOffset || _data.empty()) {
+        _pending.clear();
+        if (::lseek(_fd, blockOffset, SEEK_SET) == -1) {
+            throw IOError(str(format(
+                "Failed to seek to offset %1% in %2%") % blockOffset % _path));
+        }
+        _readOffset = blockOffset;
+        _inputDone = false;
+        _data.clear();
+        nextBlock();
+    }
+
+    if (pos > _data.size() || (_blockOffset != blockOffset && pos != 0)) {
+        throw IOError(str(format(
+            "Invalid BGZF virtual offset %1%:%2% in %3%")
+            % blockOffset % pos % _path));
+    }
+    _pos = pos;
+}
+
+uint64_t BgzfLineSource::tell() {
+    if (_pos >= _data.size())
+        nextBlock();
+    return (_blockOffset << 16) | _pos;
+}
+
+bool BgzfLineSource::eof() const {
+    return _eof;
+}
+
+bool BgzfLineSource::good() const {
+    return !_bad && !eof();
+}
+
+BgzfLineSource::operator bool() const {
+    return good();
+}
+
+std::size_t BgzfLineSource::blocksPerThread() {
+    return blocksPerThread_;
+}
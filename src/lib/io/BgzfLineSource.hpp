@@ -0,0 +1,63 @@
+#pragma once
+
+#include "ILineSource.hpp"
+#include "common/cstdint.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+// Line source for BGZF compressed files. Compressed blocks are read
+// sequentially and inflated on a pool of worker threads; the decompressed
+// blocks are consumed strictly in file order.
+class BgzfLineSource : public ILineSource {
+public:
+    BgzfLineSource(std::string const& path, std::size_t nThreads);
+    ~BgzfLineSource();
+
+    operator bool() const;
+    char peek();
+    bool eof() const;
+    bool good() const;
+    bool getline(std::string& line);
+    bool getline(StringView& line);
+
+    // BGZF virtual file offsets: the offset of the compressed block in the
+    // upper 48 bits and the offset into the uncompressed block in the
+    // lower 16. tell() returns the position of the next unread byte.
+    void seek(uint64_t virtualOffset);
+    uint64_t tell();
+
+    // The maximum number of blocks queued for decompression per thread
+    static std::size_t blocksPerThread();
+
+private:
+    struct PendingBlock {
+        uint64_t offset;
+        std::future<std::vector<char>> data;
+    };
+
+    bool nextBlock();
+    void fillQueue();
+
+private:
+    std::string _path;
+    int _fd;
+    std::unique_ptr<ThreadPool> _pool;
+    std::size_t _maxPending;
+    std::deque<PendingBlock> _pending;
+    uint64_t _readOffset;
+    uint64_t _blockOffset;
+    std::vector<char> _data;
+    std::size_t _pos;
+    // holds lines that straddle block boundaries
+    std::string _spill;
+    bool _inputDone;
+    bool _bad;
+    bool _eof;
+};
@@ -0,0 +1,249 @@
+#include "BgzfOutputStream.hpp"
+
+#include "Bgzf.hpp"
+#include "common/Exceptions.hpp"
+#include "common/ThreadPool.hpp"
+#include "common/compat.hpp"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+using boost::format;
+
+namespace {
+    static std::size_t const blocksPerThread = 4;
+
+    struct DeflateTask {
+        std::vector<char> data;
+        int level;
+
+        std::vector<char> operator()() {
+            std::vector<char> rv;
+            Bgzf::deflateBlock(data.data(), data.size(), rv, level);
+            return rv;
+        }
+    };
+}
+
+class BgzfOutputStream::Buffer : public std::streambuf {
+public:
+    Buffer(std::ostream& out, std::size_t nThreads, int level)
+        : _out(out)
+        , _level(level)
+        , _maxPending(nThreads * blocksPerThread)
+        , _closed(false)
+        , _blocks(0)
+        , _bytesWritten(0)
+        , _lineStart(0)
+        , _lastEnd(0)
+    {
+        if (nThreads > 0)
+            _pool = std::make_unique<ThreadPool>(nThreads);
+        resetBuffer();
+    }
+
+    ~Buffer() {
+        // don't leave workers running against a dead stream
+        _pending.clear();
+        _pool.reset();
+    }
+
+    void writeIndex(std::string const& indexPath, TabixIndexBuilder::ptr builder) {
+        _indexPath = indexPath;
+        _index = std::move(builder);
+    }
+
+    void close() {
+        if (_closed)
+            return;
+
+        _closed = true;
+        submitBlock();
+        writePending(0);
+        _out.write(Bgzf::EOF_BLOCK, sizeof(Bgzf::EOF_BLOCK));
+        _out.flush();
+        checkOutput();
+
+        if (_index)
+            saveIndex();
+    }
+
+protected:
+    int_type overflow(int_type ch) {
+        if (_closed)
+            return traits_type::eof();
+
+        submitBlock();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() {
+        writePending(0);
+        _out.flush();
+        return _out ? 0 : -1;
+    }
+
+private:
+    void resetBuffer() {
+        _data.resize(Bgzf::DEFAULT_BLOCK_DATA_SIZE);
+        setp(_data.data(), _data.data() + _data.size());
+    }
+
+    void submitBlock() {
+        std::size_t len = pptr() - pbase();
+        if (len == 0)
+            return;
+
+        if (_index)
+            indexLines(_data.data(), len);
+        ++_blocks;
+
+        DeflateTask task;
+        _data.resize(len);
+        task.data.swap(_data);
+        task.level = _level;
+        resetBuffer();
+
+        if (!_pool) {
+            writeBlock(task());
+            return;
+        }
+
+        writePending(_maxPending - 1);
+        _pending.push_back(_pool->submit(std::move(task)));
+    }
+
+    // write completed blocks until at most maxPending remain in flight
+    void writePending(std::size_t maxPending) {
+        while (_pending.size() > maxPending) {
+            std::vector<char> block = _pending.front().get();
+            _pending.pop_front();
+            writeBlock(block);
+        }
+    }
+
+    void writeBlock(std::vector<char> const& block) {
+        if (_index)
+            _blockOffsets.push_back(_bytesWritten);
+        _bytesWritten += block.size();
+        _out.write(block.data(), block.size());
+        checkOutput();
+    }
+
+    // Add the lines completed in the block about to be submitted to the
+    // index. Positions are relative to the block number, see
+    // TabixIndexBuilder.
+    void indexLines(char const* data, std::size_t len) {
+        uint64_t blockPos = _blocks << 16;
+        char const* first = data;
+        char const* last = data + len;
+        for (char const* p; (p = std::find(first, last, '\n')) != last; first = p + 1) {
+            std::size_t next = p + 1 - data;
+            uint64_t end = blockPos | next;
+            if (_partialLine.empty()) {
+                _index->addLine(first, p, _lineStart, end);
+            }
+            else {
+                _partialLine.append(first, p);
+                _index->addLine(_partialLine.data(),
+                    _partialLine.data() + _partialLine.size(), _lineStart, end);
+                _partialLine.clear();
+            }
+            _lineStart = next == len ? (_blocks + 1) << 16 : end;
+        }
+        _partialLine.append(first, last);
+        _lastEnd = blockPos | len;
+    }
+
+    void saveIndex() {
+        // a final line without a newline
+        if (!_partialLine.empty()) {
+            _index->addLine(_partialLine.data(),
+                _partialLine.data() + _partialLine.size(), _lineStart, _lastEnd);
+        }
+
+        if (!_index->error().empty()) {
+            throw IOError(str(format("Not writing index %1%: %2%")
+                % _indexPath % _index->error()));
+        }
+
+        std::ofstream file(_indexPath.c_str(), std::ios::binary);
+        if (!file)
+            throw IOError(str(format("Failed to open file %1%") % _indexPath));
+
+        BgzfOutputStream out(file, 0);
+        _index->write(out, _blockOffsets);
+        out.close();
+        file.close();
+        if (!file)
+            throw IOError(str(format("Failed to write index %1%") % _indexPath));
+    }
+
+    void checkOutput() {
+        if (!_out)
+            throw IOError("Failed to write BGZF compressed output");
+    }
+
+private:
+    std::ostream& _out;
+    int _level;
+    std::size_t _maxPending;
+    bool _closed;
+    std::vector<char> _data;
+    std::unique_ptr<ThreadPool> _pool;
+    std::deque<std::future<std::vector<char>>> _pending;
+
+    uint64_t _blocks;
+    uint64_t _bytesWritten;
+    std::vector<uint64_t> _blockOffsets;
+    std::string _indexPath;
+    TabixIndexBuilder::ptr _index;
+    std::string _partialLine;
+    uint64_t _lineStart;
+    uint64_t _lastEnd;
+};
+
+BgzfOutputStream::BgzfOutputStream(
+        std::ostream& out,
+        std::size_t nThreads,
+        int level
+        )
+    : std::ostream(0)
+    , _buf(std::make_unique<Buffer>(out, nThreads, level))
+{
+    rdbuf(_buf.get());
+}
+
+BgzfOutputStream::~BgzfOutputStream() {
+    try {
+        close();
+    }
+    catch (std::exception const& e) {
+        std::cerr << "Error while closing BGZF output: " << e.what() << "\n";
+    }
+}
+
+void BgzfOutputStream::writeIndex(
+        std::string const& indexPath,
+        TabixIndexBuilder::ptr builder
+        )
+{
+    _buf->writeIndex(indexPath, std::move(builder));
+}
+
+void BgzfOutputStream::close() {
+    flush();
+    _buf->close();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "TabixIndexBuilder.hpp"
+
+#include <zlib.h>
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// An output stream that writes BGZF compressed data to another stream.
+//
+// Data is cut into blocks of Bgzf::DEFAULT_BLOCK_DATA_SIZE bytes which
+// are compressed on a pool of worker threads (or on the calling thread
+// when nThreads is 0) and written to the underlying stream in order.
+//
+// Flushing the stream writes all completed blocks but keeps a partially
+// filled block buffered so that frequent flushes don't produce tiny
+// blocks. close() (called by the destructor if needed) writes the final
+// block along with the BGZF end of file marker.
+//
+// When an index builder is attached, each line written is added to it and
+// the index is saved next to the output when the stream is closed.
+class BgzfOutputStream : public std::ostream {
+public:
+    typedef std::unique_ptr<BgzfOutputStream> ptr;
+
+    BgzfOutputStream(
+            std::ostream& out,
+            std::size_t nThreads,
+            int level = Z_DEFAULT_COMPRESSION
+            );
+    ~BgzfOutputStream();
+
+    // Must be called before anything is written to the stream
+    void writeIndex(std::string const& indexPath, TabixIndexBuilder::ptr builder);
+
+    void close();
+
+private:
+    class Buffer;
+    std::unique_ptr<Buffer> _buf;
+};
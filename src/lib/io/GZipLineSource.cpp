@@ -10,7 +10,7 @@
 using boost::format;
 
 namespace {
-    static int const bufsz = 4096;
+    static int const bufsz = 65536;
 }
 
 class GZipLineSource::LineBuffer {
@@ -76,6 +76,23 @@ public:
         return rv;
     }
 
+    // Point view at the data up to the next ch and consume it if the
+    // buffer contains a ch. The buffer is left untouched otherwise.
+    Status viewUntil(StringView& view, value_type ch) {
+        value_type const* first = _buf.data() + _beg;
+        value_type const* last = _buf.data() + _end;
+        value_type const* chPos = std::find(first, last, ch);
+        if (chPos == last)
+            return PARTIAL_LINE;
+
+        view.assign(first, chPos);
+        _beg = chPos - _buf.data() + 1;
+        if (_beg == _end) {
+            _beg = _end = 0u;
+        }
+        return WHOLE_LINE;
+    }
+
 private:
     std::vector<value_type> _buf;
     size_type _beg;
@@ -131,6 +148,15 @@ bool GZipLineSource::getline(std::string& line) {
     return !_eof;
 }
 
+bool GZipLineSource::getline(StringView& line) {
+    if (!_buffer->empty() && _buffer->viewUntil(line, '\n') == LineBuffer::WHOLE_LINE)
+        return true;
+
+    bool rv = getline(_spill);
+    line.assign(_spill.data(), _spill.data() + _spill.size());
+    return rv;
+}
+
 char GZipLineSource::peek() {
     if (!_buffer->empty()) {
         return _buffer->peek();
@@ -24,6 +24,7 @@ public:
     bool eof() const;
     bool good() const;
     bool getline(std::string& line);
+    bool getline(StringView& line);
 
     static size_t bufferSize();
 
@@ -31,6 +32,8 @@ private:
     std::string _path;
     gzFile _fp;
     std::unique_ptr<LineBuffer> _buffer;
+    // holds lines that straddle the end of the buffer
+    std::string _spill;
     bool _bad;
     bool _eof;
 };
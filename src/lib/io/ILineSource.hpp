@@ -1,5 +1,7 @@
 #pragma once
 
+#include "common/StringView.hpp"
+
 #include <istream>
 #include <memory>
 #include <string>
@@ -14,4 +16,17 @@ public:
     virtual char peek() = 0;
     virtual bool eof() const = 0;
     virtual bool good() const = 0;
+
+    // Read the next line without copying it out of the source's buffers
+    // where possible. The view is only valid until the next call to
+    // getline or peek. The default implementation reads into a buffer
+    // owned by the source.
+    virtual bool getline(StringView& line) {
+        bool rv = getline(_viewLine);
+        line.assign(_viewLine.data(), _viewLine.data() + _viewLine.size());
+        return rv;
+    }
+
+protected:
+    std::string _viewLine;
 };
@@ -78,6 +78,30 @@ bool InputStream::getline(string& line) {
     return _in;
 }
 
+bool InputStream::getline(StringView& line) {
+    if (_cacheIter != _cache.end()) {
+        string const& cached = *_cacheIter++;
+        line.assign(cached.data(), cached.data() + cached.size());
+        ++_lineNum;
+        return true;
+    }
+
+    // read until we get a line that isn't blank.
+    while (!_in.eof() && _in.getline(line) && line.empty())
+        ++_lineNum;
+
+    ++_lineNum;
+
+    if (_caching && _in) {
+        _cache.push_back(string(line.begin(), line.end()));
+        _cacheIter = _cache.end();
+        string const& cached = _cache.back();
+        line.assign(cached.data(), cached.data() + cached.size());
+    }
+
+    return _in;
+}
+
 char InputStream::peek() {
     if (_cacheIter != _cache.end())
         return (*_cacheIter)[0];
@@ -28,6 +28,10 @@ public:
     void caching(bool value);
     void rewind();
     bool getline(std::string& line);
+    // Like getline(std::string&), but without copying the line where the
+    // underlying source allows it. The view is only valid until the next
+    // call to getline or peek.
+    bool getline(StringView& line);
     bool eof() const;
     bool good() const;
     char peek();
@@ -0,0 +1,118 @@
+#include "MmapLineSource.hpp"
+
+#include "common/compat.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MmapLineSource::MmapLineSource(std::string const& path)
+    : _path(path)
+    , _data(0)
+    , _size(0)
+    , _pos(0)
+    , _bad(false)
+    , _eof(false)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) == -1) {
+        _bad = true;
+        return;
+    }
+
+    // empty files can't be mapped, but there is nothing to read anyway
+    if (st.st_size == 0)
+        return;
+
+    try {
+        _file = std::make_unique<boost::iostreams::mapped_file_source>(path);
+    }
+    catch (std::exception const&) {
+        _bad = true;
+        return;
+    }
+
+    _data = _file->data();
+    _size = _file->size();
+    // this is only advice, failure is harmless
+    ::madvise(const_cast<char*>(_data), _size, MADV_SEQUENTIAL);
+}
+
+MmapLineSource::~MmapLineSource() {
+}
+
+bool MmapLineSource::nextLine(char const** first, char const** last) {
+    if (_pos >= _size) {
+        _eof = true;
+        return false;
+    }
+
+    *first = _data + _pos;
+    char const* end = _data + _size;
+    *last = std::find(*first, end, '\n');
+    _pos = *last - _data;
+    if (*last != end)
+        ++_pos;
+    return true;
+}
+
+bool MmapLineSource::getline(std::string& line) {
+    char const* first;
+    char const* last;
+    if (!nextLine(&first, &last)) {
+        line.erase();
+        return false;
+    }
+    line.assign(first, last);
+    return true;
+}
+
+bool MmapLineSource::getline(StringView& line) {
+    char const* first;
+    char const* last;
+    if (!nextLine(&first, &last)) {
+        line.clear();
+        return false;
+    }
+    line.assign(first, last);
+    return true;
+}
+
+char MmapLineSource::peek() {
+    if (_pos < _size)
+        return _data[_pos];
+
+    return EOF;
+}
+
+bool MmapLineSource::eof() const {
+    return _eof;
+}
+
+bool MmapLineSource::good() const {
+    return !_bad && !eof();
+}
+
+MmapLineSource::operator bool() const {
+    return good();
+}
+
+bool MmapLineSource::canMap(std::string const& path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) == -1 || !S_ISREG(st.st_mode))
+        return false;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    unsigned char magic[2] = {0, 0};
+    ssize_t got = ::read(fd, magic, sizeof(magic));
+    ::close(fd);
+    return got != 2 || magic[0] != 0x1f || magic[1] != 0x8b;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ILineSource.hpp"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// Line source for uncompressed regular files. The whole file is memory
+// mapped (and the kernel told that we will read it sequentially) so that
+// getline(StringView&) can return views straight into the mapping.
+class MmapLineSource : public ILineSource {
+public:
+    explicit MmapLineSource(std::string const& path);
+    ~MmapLineSource();
+
+    operator bool() const;
+    char peek();
+    bool eof() const;
+    bool good() const;
+    bool getline(std::string& line);
+    bool getline(StringView& line);
+
+    // Returns true if path names a regular file that is not gzip
+    // compressed
+    static bool canMap(std::string const& path);
+
+private:
+    bool nextLine(char const** first, char const** last);
+
+private:
+    std::string _path;
+    std::unique_ptr<boost::iostreams::mapped_file_source> _file;
+    char const* _data;
+    std::size_t _size;
+    std::size_t _pos;
+    bool _bad;
+    bool _eof;
+};
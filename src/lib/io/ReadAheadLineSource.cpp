@@ -0,0 +1,126 @@
+#include "ReadAheadLineSource.hpp"
+
+#include "common/compat.hpp"
+
+#include <cstdio>
+#include <utility>
+
+std::size_t const ReadAheadLineSource::DEFAULT_CHUNK_BYTES;
+
+ReadAheadLineSource::ReadAheadLineSource(
+        ILineSource::ptr in,
+        std::size_t depth,
+        std::size_t chunkBytes
+        )
+    : _in(std::move(in))
+    , _chunkBytes(chunkBytes)
+    , _queue(depth)
+    , _free(depth + 1)
+    , _lineIdx(0)
+    , _bad(!*_in)
+    , _eof(false)
+{
+    if (_bad)
+        _queue.close();
+    else
+        _thread = std::thread(&ReadAheadLineSource::readLoop, this);
+}
+
+ReadAheadLineSource::~ReadAheadLineSource() {
+    // unblocks the reader if it is waiting for space in the queue
+    _queue.close();
+    if (_thread.joinable())
+        _thread.join();
+}
+
+void ReadAheadLineSource::readLoop() {
+    try {
+        StringView line;
+        bool more = true;
+        while (more) {
+            ChunkPtr chunk;
+            if (!_free.tryPop(chunk))
+                chunk = std::make_unique<Chunk>();
+            chunk->data.clear();
+            chunk->ends.clear();
+
+            while (chunk->data.size() < _chunkBytes && (more = _in->getline(line))) {
+                chunk->data.append(line.begin(), line.end());
+                chunk->ends.push_back(chunk->data.size());
+            }
+
+            if (!chunk->ends.empty() && !_queue.push(std::move(chunk)))
+                return;
+        }
+    }
+    catch (...) {
+        _error = std::current_exception();
+    }
+    _queue.close();
+}
+
+bool ReadAheadLineSource::nextLine() {
+    while (!_chunk || _lineIdx == _chunk->ends.size()) {
+        if (_chunk)
+            _free.tryPush(std::move(_chunk));
+
+        if (!_queue.pop(_chunk)) {
+            if (_error)
+                std::rethrow_exception(_error);
+            return false;
+        }
+        _lineIdx = 0;
+    }
+    return true;
+}
+
+bool ReadAheadLineSource::getline(StringView& line) {
+    if (!nextLine()) {
+        _eof = true;
+        line.clear();
+        return false;
+    }
+
+    char const* data = _chunk->data.data();
+    std::size_t begin = _lineIdx == 0 ? 0 : _chunk->ends[_lineIdx - 1];
+    line.assign(data + begin, data + _chunk->ends[_lineIdx]);
+    ++_lineIdx;
+    return true;
+}
+
+bool ReadAheadLineSource::getline(std::string& line) {
+    StringView view;
+    bool rv = getline(view);
+    line.assign(view.begin(), view.end());
+    return rv;
+}
+
+char ReadAheadLineSource::peek() {
+    if (!nextLine())
+        return EOF;
+
+    std::size_t begin = _lineIdx == 0 ? 0 : _chunk->ends[_lineIdx - 1];
+    if (begin == _chunk->ends[_lineIdx])
+        return '\n';
+    return _chunk->data[begin];
+}
+
+bool ReadAheadLineSource::eof() const {
+    return _eof;
+}
+
+bool ReadAheadLineSource::good() const {
+    return !_bad && !eof();
+}
+
+ReadAheadLineSource::operator bool() const {
+    return good();
+}
+
+uint64_t ReadAheadLineSource::consumerStalls() const {
+    return _queue.popWaits();
+}
+
+uint64_t ReadAheadLineSource::readerStalls() const {
+    return _queue.pushWaits();
+}
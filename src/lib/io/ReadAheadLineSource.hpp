@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ILineSource.hpp"
+#include "common/BoundedQueue.hpp"
+#include "common/cstdint.hpp"
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decorator that reads lines from another line source on a background
+// thread, so that waiting on the disk (or on decompression) overlaps with
+// whatever the consumer does with the lines.
+//
+// Lines are collected into chunks of roughly chunkBytes bytes and handed
+// over through a queue holding at most depth chunks. Exceptions thrown by
+// the underlying source are rethrown by getline/peek.
+class ReadAheadLineSource : public ILineSource {
+public:
+    static std::size_t const DEFAULT_CHUNK_BYTES = 256 * 1024;
+
+    ReadAheadLineSource(
+            ILineSource::ptr in,
+            std::size_t depth,
+            std::size_t chunkBytes = DEFAULT_CHUNK_BYTES
+            );
+    ~ReadAheadLineSource();
+
+    operator bool() const;
+    char peek();
+    bool eof() const;
+    bool good() const;
+    bool getline(std::string& line);
+    bool getline(StringView& line);
+
+    // Number of times the consumer had to wait for the reader thread
+    // (i.e., reading is the bottleneck)
+    uint64_t consumerStalls() const;
+    // Number of times the reader thread found the queue full (i.e., the
+    // consumer is the bottleneck)
+    uint64_t readerStalls() const;
+
+private:
+    // Lines stored back to back, without newlines. ends[i] is the offset
+    // one past the end of line i.
+    struct Chunk {
+        std::string data;
+        std::vector<std::size_t> ends;
+    };
+    typedef std::unique_ptr<Chunk> ChunkPtr;
+
+    void readLoop();
+    bool nextLine();
+
+private:
+    ILineSource::ptr _in;
+    std::size_t _chunkBytes;
+    BoundedQueue<ChunkPtr> _queue;
+    // chunks the consumer is done with, reused by the reader
+    BoundedQueue<ChunkPtr> _free;
+    std::exception_ptr _error;
+    ChunkPtr _chunk;
+    std::size_t _lineIdx;
+    bool _bad;
+    bool _eof;
+    std::thread _thread;
+};
@@ -0,0 +1,219 @@
+#include "RegionLineSource.hpp"
+
+#include "BgzfLineSource.hpp"
+#include "common/Exceptions.hpp"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+using boost::format;
+
+namespace {
+    // Parse a (possibly comma separated) position from a region string
+    bool parsePosition(std::string s, int64_t& value) {
+        s.erase(std::remove(s.begin(), s.end(), ','), s.end());
+        if (s.empty())
+            return false;
+
+        char* end = 0;
+        long long v = strtoll(s.c_str(), &end, 10);
+        if (*end != '\0' || v < 0)
+            return false;
+
+        value = v;
+        return true;
+    }
+}
+
+bool RegionLineSource::Target::operator<(Target const& rhs) const {
+    if (seqId != rhs.seqId)
+        return seqId < rhs.seqId;
+    return begin < rhs.begin;
+}
+
+RegionLineSource::RegionLineSource(
+        std::unique_ptr<BgzfLineSource> in,
+        TabixIndex::ptr index,
+        std::vector<std::string> const& regions
+        )
+    : _in(std::move(in))
+    , _index(std::move(index))
+    , _parser(_index->config())
+    , _targetIdx(0)
+    , _chunkIdx(0)
+    , _chunkActive(false)
+    , _inHeader(true)
+    , _headerLines(0)
+    , _emitted(false)
+    , _lastOffset(0)
+    , _haveNext(false)
+    , _bad(!*_in)
+    , _eof(false)
+{
+    for (auto i = regions.begin(); i != regions.end(); ++i) {
+        Target t = parseRegion(*i);
+        // like tabix, sequences missing from the index simply have no data
+        if (t.seqId >= 0)
+            _targets.push_back(t);
+    }
+
+    // merge overlapping targets
+    std::sort(_targets.begin(), _targets.end());
+    std::size_t last = 0;
+    for (std::size_t i = 1; i < _targets.size(); ++i) {
+        Target& prev = _targets[last];
+        if (_targets[i].seqId == prev.seqId && _targets[i].begin <= prev.end)
+            prev.end = std::max(prev.end, _targets[i].end);
+        else
+            _targets[++last] = _targets[i];
+    }
+    if (!_targets.empty())
+        _targets.resize(last + 1);
+
+    if (!_targets.empty())
+        _chunks = _index->chunks(_targets[0].seqId, _targets[0].begin, _targets[0].end);
+}
+
+RegionLineSource::~RegionLineSource() {
+}
+
+RegionLineSource::Target RegionLineSource::parseRegion(std::string const& region) const {
+    Target rv;
+    rv.begin = 0;
+    rv.end = std::numeric_limits<int64_t>::max();
+
+    // sequence names may contain ':', so check for an exact match first
+    rv.seqId = _index->sequenceId(region);
+    if (rv.seqId >= 0)
+        return rv;
+
+    std::size_t colon = region.rfind(':');
+    if (colon == std::string::npos)
+        return rv;
+
+    rv.seqId = _index->sequenceId(region.substr(0, colon));
+
+    std::string range = region.substr(colon + 1);
+    std::size_t dash = range.find('-');
+    int64_t begin = 0;
+    bool ok = parsePosition(range.substr(0, dash), begin) && begin > 0;
+    if (ok && dash != std::string::npos) {
+        ok = parsePosition(range.substr(dash + 1), rv.end) && rv.end >= begin;
+    }
+
+    if (!ok) {
+        throw std::runtime_error(str(format(
+            "Invalid region '%1%', expected seq, seq:begin or seq:begin-end"
+            ) % region));
+    }
+    rv.begin = begin - 1;
+    return rv;
+}
+
+bool RegionLineSource::fetchHeader() {
+    TabixIndex::Config const& cfg = _index->config();
+    char c = _in->peek();
+    if (c != EOF && (c == cfg.metaChar || _headerLines < cfg.skip)) {
+        _in->getline(_next);
+        ++_headerLines;
+        return true;
+    }
+    _inHeader = false;
+    return false;
+}
+
+bool RegionLineSource::fetch() {
+    if (_inHeader && fetchHeader())
+        return true;
+
+    while (_targetIdx < _targets.size()) {
+        Target const& target = _targets[_targetIdx];
+        if (_chunkIdx >= _chunks.size()) {
+            if (++_targetIdx < _targets.size()) {
+                Target const& t = _targets[_targetIdx];
+                _chunks = _index->chunks(t.seqId, t.begin, t.end);
+                _chunkIdx = 0;
+                _chunkActive = false;
+            }
+            continue;
+        }
+
+        TabixIndex::Chunk const& chunk = _chunks[_chunkIdx];
+        if (!_chunkActive) {
+            _in->seek(chunk.begin);
+            _chunkActive = true;
+        }
+
+        uint64_t offset = _in->tell();
+        if (offset >= chunk.end || !_in->getline(_line)) {
+            ++_chunkIdx;
+            _chunkActive = false;
+            continue;
+        }
+
+        if (_line.empty() || _line[0] == _index->config().metaChar)
+            continue;
+
+        if (!_parser(_line.data(), _line.data() + _line.size())) {
+            throw IOError(str(format(
+                "Failed to parse location from line '%1%'") % _line));
+        }
+
+        if (_parser.sequence() != _index->sequenceNames()[target.seqId])
+            continue;
+
+        // the file is sorted, nothing further in this region
+        if (_parser.begin() >= target.end) {
+            _chunkIdx = _chunks.size();
+            continue;
+        }
+
+        if (_parser.end() <= target.begin || (_emitted && offset <= _lastOffset))
+            continue;
+
+        _emitted = true;
+        _lastOffset = offset;
+        _next.swap(_line);
+        return true;
+    }
+    return false;
+}
+
+bool RegionLineSource::getline(std::string& line) {
+    if (!_haveNext && !fetch()) {
+        line.erase();
+        _eof = true;
+        return false;
+    }
+
+    _haveNext = false;
+    line.swap(_next);
+    return true;
+}
+
+char RegionLineSource::peek() {
+    if (!_haveNext) {
+        if (!fetch())
+            return EOF;
+        _haveNext = true;
+    }
+    return _next.empty() ? '\n' : _next[0];
+}
+
+bool RegionLineSource::eof() const {
+    return _eof;
+}
+
+bool RegionLineSource::good() const {
+    return !_bad && !_eof;
+}
+
+RegionLineSource::operator bool() const {
+    return good();
+}
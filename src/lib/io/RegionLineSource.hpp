@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ILineSource.hpp"
+#include "TabixIndex.hpp"
+#include "common/cstdint.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+class BgzfLineSource;
+
+// Line source that reads the header of an indexed BGZF file followed by
+// only those records that overlap a list of regions. Regions are given as
+// in samtools/tabix: "seq", "seq:begin" or "seq:begin-end", with 1-based
+// inclusive coordinates.
+//
+// Regions are visited in the order their sequences appear in the index so
+// that sorted input stays sorted. Records overlapping more than one region
+// are returned once.
+class RegionLineSource : public ILineSource {
+public:
+    struct Target {
+        int32_t seqId;
+        // 0-based, half open
+        int64_t begin;
+        int64_t end;
+
+        bool operator<(Target const& rhs) const;
+    };
+
+    RegionLineSource(
+            std::unique_ptr<BgzfLineSource> in,
+            TabixIndex::ptr index,
+            std::vector<std::string> const& regions
+            );
+    ~RegionLineSource();
+
+    operator bool() const;
+    char peek();
+    bool eof() const;
+    bool good() const;
+    using ILineSource::getline;
+    bool getline(std::string& line);
+
+    std::vector<Target> const& targets() const;
+
+private:
+    Target parseRegion(std::string const& region) const;
+    bool fetch();
+    bool fetchHeader();
+
+private:
+    std::unique_ptr<BgzfLineSource> _in;
+    TabixIndex::ptr _index;
+    TabixLocationParser _parser;
+    std::vector<Target> _targets;
+
+    std::size_t _targetIdx;
+    std::vector<TabixIndex::Chunk> _chunks;
+    std::size_t _chunkIdx;
+    bool _chunkActive;
+
+    bool _inHeader;
+    int32_t _headerLines;
+    bool _emitted;
+    uint64_t _lastOffset;
+
+    std::string _line;
+    std::string _next;
+    bool _haveNext;
+    bool _bad;
+    bool _eof;
+};
+
+inline std::vector<RegionLineSource::Target> const& RegionLineSource::targets() const {
+    return _targets;
+}
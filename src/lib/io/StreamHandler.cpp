@@ -2,11 +2,22 @@
 
 #include "common/Exceptions.hpp"
 #include "common/compat.hpp"
+#include "io/Bgzf.hpp"
+#include "io/BgzfLineSource.hpp"
+#include "io/BgzfOutputStream.hpp"
 #include "io/GZipLineSource.hpp"
+#include "io/MmapLineSource.hpp"
+#include "io/ReadAheadLineSource.hpp"
+#include "io/RegionLineSource.hpp"
+#include "io/TabixIndex.hpp"
+#include "io/TabixIndexBuilder.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/format.hpp>
 
 #include <cstdio>
+#include <stdexcept>
+#include <utility>
 
 using namespace std;
 using boost::format;
@@ -14,9 +25,29 @@ using boost::format;
 StreamHandler::StreamHandler()
     : _cinReferences(0)
     , _coutReferences(0)
+    , _decompressThreads(0)
+    , _readAhead(0)
+    , _outputCompression(AUTO_COMPRESSION)
+    , _compressThreads(0)
+    , _outputIndex(NO_INDEX)
 {
 }
 
+StreamHandler::OutputCompression StreamHandler::outputCompressionFromString(
+        std::string const& s)
+{
+    if (s == "auto")
+        return AUTO_COMPRESSION;
+    else if (s == "none")
+        return NO_COMPRESSION;
+    else if (s == "bgzf")
+        return BGZF_COMPRESSION;
+
+    throw std::runtime_error(str(format(
+        "Invalid output compression type '%1%', expected one of "
+        "auto, none, bgzf") % s));
+}
+
 std::vector<InputStream::ptr> StreamHandler::openForReading(
         std::vector<std::string> const& paths)
 {
@@ -28,17 +59,88 @@ std::vector<InputStream::ptr> StreamHandler::openForReading(
 }
 
 
+StreamHandler::OutputIndex StreamHandler::outputIndexFromString(
+        std::string const& s)
+{
+    if (s == "none")
+        return NO_INDEX;
+    else if (s == "tbi")
+        return TBI_INDEX;
+    else if (s == "csi")
+        return CSI_INDEX;
+
+    throw std::runtime_error(str(format(
+        "Invalid output index type '%1%', expected one of none, tbi, csi"
+        ) % s));
+}
+
 InputStream::ptr StreamHandler::openForReading(std::string const& path) {
     ILineSource::ptr lineSource;
     if (path == "-") {
         lineSource = std::make_unique<GZipLineSource>(fileno(stdin));
     }
+    else if (_decompressThreads > 0 && Bgzf::isBgzfFile(path)) {
+        lineSource = std::make_unique<BgzfLineSource>(path, _decompressThreads);
+    }
+    else if (MmapLineSource::canMap(path)) {
+        lineSource = std::make_unique<MmapLineSource>(path);
+    }
     else {
         lineSource = std::make_unique<GZipLineSource>(path);
     }
     if (!*lineSource) {
         throw IOError(str(format("Failed to open file %1%") %path));
     }
+    return createInput(path, std::move(lineSource));
+}
+
+std::vector<InputStream::ptr> StreamHandler::openForReading(
+        std::vector<std::string> const& paths,
+        std::vector<std::string> const& regions)
+{
+    std::vector<InputStream::ptr> rv;
+    for (auto i = paths.begin(); i != paths.end(); ++i) {
+        rv.push_back(openForReading(*i, regions));
+    }
+    return rv;
+}
+
+InputStream::ptr StreamHandler::openForReading(
+        std::string const& path,
+        std::vector<std::string> const& regions)
+{
+    if (regions.empty())
+        return openForReading(path);
+
+    if (path == "-") {
+        throw IOError("Reading regions requires an indexed file, not stdin");
+    }
+
+    TabixIndex::ptr index = TabixIndex::loadForFile(path);
+    if (!index) {
+        throw IOError(str(format(
+            "Reading regions requires an index, but neither %1%.tbi nor "
+            "%1%.csi exist") % path));
+    }
+
+    auto in = std::make_unique<BgzfLineSource>(path, _decompressThreads);
+    if (!*in) {
+        throw IOError(str(format("Failed to open file %1%") %path));
+    }
+
+    ILineSource::ptr lineSource = std::make_unique<RegionLineSource>(
+        std::move(in), std::move(index), regions);
+    return createInput(path, std::move(lineSource));
+}
+
+InputStream::ptr StreamHandler::createInput(
+        std::string const& path,
+        ILineSource::ptr lineSource)
+{
+    if (_readAhead > 0) {
+        lineSource = std::make_unique<ReadAheadLineSource>(
+            std::move(lineSource), _readAhead);
+    }
     return InputStream::create(path, lineSource);
 }
 
@@ -59,3 +161,55 @@ iostream* StreamHandler::getFile(const std::string& path, openmode mode) {
         return s.stream.get();
     }
 }
+
+bool StreamHandler::compressOutput(const std::string& path) const {
+    switch (_outputCompression) {
+        case BGZF_COMPRESSION:
+            return true;
+        case NO_COMPRESSION:
+            return false;
+        case AUTO_COMPRESSION:
+        default:
+            return path != "-" && boost::algorithm::ends_with(path, ".gz");
+    }
+}
+
+ostream* StreamHandler::getOutput(const std::string& path) {
+    auto i = _compressedOutputs.find(path);
+    if (i != _compressedOutputs.end()) {
+        if (path == "-")
+            ++_coutReferences;
+        return i->second.get();
+    }
+
+    ostream* out;
+    if (path == "-") {
+        ++_coutReferences;
+        out = &cout;
+    } else {
+        out = getFile(path, ios::out);
+    }
+
+    if (!compressOutput(path))
+        return out;
+
+    boost::shared_ptr<BgzfOutputStream> compressed(
+        new BgzfOutputStream(*out, _compressThreads));
+
+    if (_outputIndex != NO_INDEX && path != "-") {
+        TabixIndex::Config config;
+        if (!TabixIndex::Config::fromPath(path, config)) {
+            throw IOError(str(format(
+                "Unable to choose an index format for output file %1% "
+                "(expected a .vcf.gz or .bed.gz file name)") % path));
+        }
+
+        bool csi = _outputIndex == CSI_INDEX;
+        compressed->writeIndex(
+            path + (csi ? ".csi" : ".tbi"),
+            std::make_unique<TabixIndexBuilder>(config,
+                csi ? TabixIndexBuilder::CSI : TabixIndexBuilder::TBI));
+    }
+    _compressedOutputs[path] = compressed;
+    return compressed.get();
+}
@@ -13,16 +13,50 @@
 #include <string>
 #include <vector>
 
+class BgzfOutputStream;
+
 // Note: when path is "-", you will get &cin or &cout
 class StreamHandler {
 public:
     typedef std::ios_base::openmode openmode;
+
+    // How output streams returned by get<std::ostream> are compressed.
+    // AUTO_COMPRESSION uses BGZF for paths ending in ".gz" and writes
+    // everything else (including stdout) uncompressed.
+    enum OutputCompression {
+        AUTO_COMPRESSION,
+        NO_COMPRESSION,
+        BGZF_COMPRESSION
+    };
+
+    static OutputCompression outputCompressionFromString(std::string const& s);
+
+    // Index written alongside BGZF compressed output files. The index
+    // preset is chosen from the file name (.vcf.gz or .bed.gz).
+    enum OutputIndex {
+        NO_INDEX,
+        TBI_INDEX,
+        CSI_INDEX
+    };
+
+    static OutputIndex outputIndexFromString(std::string const& s);
+
     StreamHandler();
 
     InputStream::ptr openForReading(std::string const& path);
     std::vector<InputStream::ptr> openForReading(
             std::vector<std::string> const& paths);
 
+    // Open an indexed (.tbi or .csi) BGZF file, returning only its header
+    // and the records overlapping the given regions ("seq[:begin[-end]]",
+    // 1-based inclusive). An empty region list reads the whole file.
+    InputStream::ptr openForReading(
+            std::string const& path,
+            std::vector<std::string> const& regions);
+    std::vector<InputStream::ptr> openForReading(
+            std::vector<std::string> const& paths,
+            std::vector<std::string> const& regions);
+
     // T must be istream, ostream, or iostream
     // we can't just use iostream because that won't work for cin/cout
     template<typename T>
@@ -40,18 +74,51 @@ public:
     uint32_t cinReferences() const;
     uint32_t coutReferences() const;
 
+    // Number of worker threads used to decompress BGZF inputs. When 0
+    // (the default), all inputs are read with a single thread.
+    void decompressThreads(uint32_t n);
+    uint32_t decompressThreads() const;
+
+    // Number of chunks of input lines read ahead on a background thread
+    // for each input. When 0 (the default), inputs are read on demand by
+    // the calling thread.
+    void readAhead(uint32_t depth);
+    uint32_t readAhead() const;
+
+    void outputCompression(OutputCompression compression);
+    OutputCompression outputCompression() const;
+
+    // Number of worker threads used to compress BGZF outputs. When 0
+    // (the default), blocks are compressed on the writing thread.
+    void compressThreads(uint32_t n);
+    uint32_t compressThreads() const;
+
+    void outputIndex(OutputIndex index);
+    OutputIndex outputIndex() const;
+
 protected:
     struct Stream {
         boost::shared_ptr<std::iostream> stream;
         openmode mode;
     };
 
+    InputStream::ptr createInput(const std::string& path, ILineSource::ptr lineSource);
     std::iostream* getFile(const std::string& path, openmode mode);
+    std::ostream* getOutput(const std::string& path);
+    bool compressOutput(const std::string& path) const;
 
 protected:
     std::map<std::string, Stream> _streams;
+    // declared after _streams so that compressed outputs are closed
+    // before the files they write to
+    std::map<std::string, boost::shared_ptr<BgzfOutputStream>> _compressedOutputs;
     uint32_t _cinReferences;
     uint32_t _coutReferences;
+    uint32_t _decompressThreads;
+    uint32_t _readAhead;
+    OutputCompression _outputCompression;
+    uint32_t _compressThreads;
+    OutputIndex _outputIndex;
 };
 
 inline uint32_t StreamHandler::cinReferences() const {
@@ -62,6 +129,46 @@ inline uint32_t StreamHandler::coutReferences() const {
     return _coutReferences;
 }
 
+inline void StreamHandler::decompressThreads(uint32_t n) {
+    _decompressThreads = n;
+}
+
+inline uint32_t StreamHandler::decompressThreads() const {
+    return _decompressThreads;
+}
+
+inline void StreamHandler::readAhead(uint32_t depth) {
+    _readAhead = depth;
+}
+
+inline uint32_t StreamHandler::readAhead() const {
+    return _readAhead;
+}
+
+inline void StreamHandler::outputCompression(OutputCompression compression) {
+    _outputCompression = compression;
+}
+
+inline StreamHandler::OutputCompression StreamHandler::outputCompression() const {
+    return _outputCompression;
+}
+
+inline void StreamHandler::compressThreads(uint32_t n) {
+    _compressThreads = n;
+}
+
+inline uint32_t StreamHandler::compressThreads() const {
+    return _compressThreads;
+}
+
+inline void StreamHandler::outputIndex(OutputIndex index) {
+    _outputIndex = index;
+}
+
+inline StreamHandler::OutputIndex StreamHandler::outputIndex() const {
+    return _outputIndex;
+}
+
 template<>
 inline std::istream* StreamHandler::get<std::istream>(const std::string& path) {
     if (path == "-") {
@@ -74,12 +181,7 @@ inline std::istream* StreamHandler::get<std::istream>(const std::string& path) {
 
 template<>
 inline std::ostream* StreamHandler::get<std::ostream>(const std::string& path) {
-    if (path == "-") {
-        ++_coutReferences;
-        return &std::cout;
-    } else {
-        return getFile(path, std::ios::out);
-    }
+    return getOutput(path);
 }
 
 template<typename StreamType, typename WrapperType>
@@ -0,0 +1,451 @@
+#include "TabixIndex.hpp"
+
+#include "common/Exceptions.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/format.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <unistd.h>
+
+using boost::format;
+
+namespace {
+    // Sequential little endian reader over a decompressed index
+    class IndexReader {
+    public:
+        IndexReader(std::string const& path, std::vector<char> const& data)
+            : _path(path)
+            , _data(data)
+            , _pos(0)
+        {
+        }
+
+        char const* bytes(std::size_t len) {
+            if (_data.size() - _pos < len)
+                throw IOError(str(format("Truncated index file %1%") % _path));
+            char const* rv = _data.data() + _pos;
+            _pos += len;
+            return rv;
+        }
+
+        uint32_t uint32() {
+            unsigned char const* u = reinterpret_cast<unsigned char const*>(bytes(4));
+            return uint32_t(u[0])
+                | (uint32_t(u[1]) << 8)
+                | (uint32_t(u[2]) << 16)
+                | (uint32_t(u[3]) << 24);
+        }
+
+        int32_t int32() {
+            return int32_t(uint32());
+        }
+
+        uint64_t uint64() {
+            uint64_t lo = uint32();
+            uint64_t hi = uint32();
+            return lo | (hi << 32);
+        }
+
+        // number of entries to follow, checked for sanity
+        std::size_t count() {
+            int32_t n = int32();
+            if (n < 0)
+                throw IOError(str(format("Invalid count in index file %1%") % _path));
+            return n;
+        }
+
+    private:
+        std::string const& _path;
+        std::vector<char> const& _data;
+        std::size_t _pos;
+    };
+
+    std::vector<char> readCompressedFile(std::string const& path) {
+        gzFile fp = gzopen(path.c_str(), "rb");
+        if (!fp)
+            throw IOError(str(format("Failed to open index file %1%") % path));
+
+        std::vector<char> rv;
+        char buf[65536];
+        int n;
+        while ((n = gzread(fp, buf, sizeof(buf))) > 0)
+            rv.insert(rv.end(), buf, buf + n);
+        gzclose(fp);
+
+        if (n < 0)
+            throw IOError(str(format("Failed to decompress index file %1%") % path));
+        return rv;
+    }
+
+    inline uint32_t binFirst(int level) {
+        return ((1u << (3 * level)) - 1) / 7;
+    }
+
+    inline uint32_t binParent(uint32_t bin) {
+        return (bin - 1) >> 3;
+    }
+
+    bool fileExists(std::string const& path) {
+        return ::access(path.c_str(), R_OK) == 0;
+    }
+
+    // Parse the leading integer in [first, last)
+    bool parseInt(char const* first, char const* last, int64_t& value) {
+        bool negative = first != last && *first == '-';
+        if (negative)
+            ++first;
+
+        if (first == last || *first < '0' || *first > '9')
+            return false;
+
+        value = 0;
+        for (; first != last && *first >= '0' && *first <= '9'; ++first)
+            value = value * 10 + (*first - '0');
+
+        if (negative)
+            value = -value;
+        return true;
+    }
+}
+
+TabixIndex::Config::Config()
+    : format(GENERIC)
+    , seqCol(1)
+    , beginCol(2)
+    , endCol(3)
+    , metaChar('#')
+    , skip(0)
+{
+}
+
+TabixIndex::Config TabixIndex::Config::vcf() {
+    Config rv;
+    rv.format = VCF;
+    rv.endCol = 0;
+    return rv;
+}
+
+TabixIndex::Config TabixIndex::Config::bed() {
+    Config rv;
+    rv.format = GENERIC | UCSC_FLAG;
+    return rv;
+}
+
+bool TabixIndex::Config::fromPath(std::string const& path, Config& config) {
+    using boost::algorithm::ends_with;
+
+    std::string name = path;
+    if (ends_with(name, ".gz"))
+        name.erase(name.size() - 3);
+
+    if (ends_with(name, ".vcf")) {
+        config = vcf();
+        return true;
+    }
+    else if (ends_with(name, ".bed")) {
+        config = bed();
+        return true;
+    }
+    return false;
+}
+
+TabixIndex::TabixIndex()
+    : _csi(false)
+    , _minShift(TBI_MIN_SHIFT)
+    , _depth(TBI_DEPTH)
+{
+}
+
+TabixIndex::ptr TabixIndex::load(std::string const& path) {
+    ptr rv(new TabixIndex);
+    rv->parse(path, readCompressedFile(path));
+    return rv;
+}
+
+TabixIndex::ptr TabixIndex::loadForFile(std::string const& dataPath) {
+    std::string csi = dataPath + ".csi";
+    if (fileExists(csi))
+        return load(csi);
+
+    std::string tbi = dataPath + ".tbi";
+    if (fileExists(tbi))
+        return load(tbi);
+
+    return ptr();
+}
+
+void TabixIndex::parse(std::string const& path, std::vector<char> const& data) {
+    IndexReader in(path, data);
+    char const* magic = in.bytes(4);
+    std::size_t nameBytes = 0;
+    bool haveConfig = true;
+
+    if (memcmp(magic, "TBI\1", 4) == 0) {
+        _csi = false;
+    }
+    else if (memcmp(magic, "CSI\1", 4) == 0) {
+        _csi = true;
+        _minShift = in.int32();
+        _depth = in.int32();
+        if (_minShift <= 0 || _depth <= 0 || _minShift + 3 * _depth > 62) {
+            throw IOError(str(format(
+                "Unsupported binning scheme in index file %1%") % path));
+        }
+        // csi files only carry tabix configuration in the aux data
+        std::size_t auxBytes = in.count();
+        haveConfig = auxBytes >= 28;
+        if (!haveConfig)
+            in.bytes(auxBytes);
+    }
+    else {
+        throw IOError(str(format("%1% is not a tabix or csi index") % path));
+    }
+
+    std::size_t nRef = _csi ? 0 : in.count();
+    if (haveConfig) {
+        _config.format = in.int32();
+        _config.seqCol = in.int32();
+        _config.beginCol = in.int32();
+        _config.endCol = in.int32();
+        _config.metaChar = char(in.int32());
+        _config.skip = in.int32();
+        nameBytes = in.count();
+    }
+
+    char const* names = in.bytes(nameBytes);
+    for (std::size_t pos = 0; pos < nameBytes; ) {
+        std::size_t len = strnlen(names + pos, nameBytes - pos);
+        _sequenceIds[std::string(names + pos, len)] = _sequenceNames.size();
+        _sequenceNames.push_back(std::string(names + pos, len));
+        pos += len + 1;
+    }
+
+    if (_csi)
+        nRef = in.count();
+
+    if (nRef != _sequenceNames.size()) {
+        throw IOError(str(format(
+            "Index file %1% describes %2% sequences but names %3%")
+            % path % nRef % _sequenceNames.size()));
+    }
+
+    // the pseudo bin holds per sequence statistics rather than chunks
+    uint32_t pseudoBin = binFirst(_depth + 1) + 1;
+
+    _sequences.resize(nRef);
+    for (std::size_t i = 0; i < nRef; ++i) {
+        Sequence& seq = _sequences[i];
+        std::size_t nBin = in.count();
+        for (std::size_t j = 0; j < nBin; ++j) {
+            uint32_t binId = in.uint32();
+            Bin bin;
+            if (_csi)
+                bin.loffset = in.uint64();
+
+            std::size_t nChunk = in.count();
+            bin.chunks.reserve(nChunk);
+            for (std::size_t k = 0; k < nChunk; ++k) {
+                uint64_t begin = in.uint64();
+                uint64_t end = in.uint64();
+                bin.chunks.push_back(Chunk(begin, end));
+            }
+
+            if (binId != pseudoBin)
+                seq.bins[binId] = std::move(bin);
+        }
+
+        if (!_csi) {
+            std::size_t nIntervals = in.count();
+            seq.intervals.reserve(nIntervals);
+            for (std::size_t j = 0; j < nIntervals; ++j)
+                seq.intervals.push_back(in.uint64());
+        }
+    }
+}
+
+int32_t TabixIndex::sequenceId(std::string const& name) const {
+    auto i = _sequenceIds.find(name);
+    if (i == _sequenceIds.end())
+        return -1;
+    return i->second;
+}
+
+uint64_t TabixIndex::minOffset(Sequence const& seq, int64_t begin) const {
+    if (!_csi) {
+        if (seq.intervals.empty())
+            return 0;
+
+        std::size_t idx = begin >> _minShift;
+        if (idx >= seq.intervals.size())
+            return seq.intervals.back();
+        return seq.intervals[idx];
+    }
+
+    // csi: use the lowest offset of the smallest existing bin containing begin
+    for (uint32_t bin = binFirst(_depth) + (begin >> _minShift); bin; bin = binParent(bin)) {
+        auto i = seq.bins.find(bin);
+        if (i != seq.bins.end())
+            return i->second.loffset;
+    }
+    return 0;
+}
+
+std::vector<TabixIndex::Chunk> TabixIndex::chunks(
+        int32_t seqId,
+        int64_t begin,
+        int64_t end
+        ) const
+{
+    std::vector<Chunk> rv;
+    if (seqId < 0 || std::size_t(seqId) >= _sequences.size())
+        return rv;
+
+    begin = std::max<int64_t>(begin, 0);
+    end = std::min<int64_t>(end, int64_t(1) << (_minShift + 3 * _depth));
+    if (begin >= end)
+        return rv;
+
+    Sequence const& seq = _sequences[seqId];
+    uint64_t minOff = minOffset(seq, begin);
+
+    std::vector<uint32_t> bins;
+    reg2bins(begin, end, _minShift, _depth, bins);
+    for (auto b = bins.begin(); b != bins.end(); ++b) {
+        auto i = seq.bins.find(*b);
+        if (i == seq.bins.end())
+            continue;
+
+        auto const& binChunks = i->second.chunks;
+        for (auto c = binChunks.begin(); c != binChunks.end(); ++c) {
+            if (c->end > minOff)
+                rv.push_back(*c);
+        }
+    }
+
+    if (rv.empty())
+        return rv;
+
+    // merge overlapping chunks
+    std::sort(rv.begin(), rv.end());
+    std::size_t last = 0;
+    for (std::size_t i = 1; i < rv.size(); ++i) {
+        if (rv[i].begin <= rv[last].end)
+            rv[last].end = std::max(rv[last].end, rv[i].end);
+        else
+            rv[++last] = rv[i];
+    }
+    rv.resize(last + 1);
+    return rv;
+}
+
+uint32_t TabixIndex::reg2bin(int64_t begin, int64_t end, int minShift, int depth) {
+    int shift = minShift;
+    --end;
+    for (int level = depth; level > 0; --level, shift += 3) {
+        if (begin >> shift == end >> shift)
+            return binFirst(level) + (begin >> shift);
+    }
+    return 0;
+}
+
+void TabixIndex::reg2bins(
+        int64_t begin,
+        int64_t end,
+        int minShift,
+        int depth,
+        std::vector<uint32_t>& bins
+        )
+{
+    bins.clear();
+    int shift = minShift + 3 * depth;
+    if (begin >= end)
+        return;
+
+    if (end > int64_t(1) << shift)
+        end = int64_t(1) << shift;
+
+    --end;
+    for (int level = 0; level <= depth; ++level, shift -= 3) {
+        uint32_t first = binFirst(level);
+        for (int64_t b = begin >> shift; b <= end >> shift; ++b)
+            bins.push_back(first + b);
+    }
+}
+
+TabixLocationParser::TabixLocationParser(TabixIndex::Config const& config)
+    : _config(config)
+    , _begin(0)
+    , _end(0)
+{
+}
+
+bool TabixLocationParser::operator()(char const* first, char const* last) {
+    _fields.clear();
+    char const* fieldStart = first;
+    for (char const* p = first; ; ++p) {
+        if (p == last || *p == '\t') {
+            _fields.push_back(std::make_pair(fieldStart, p));
+            fieldStart = p + 1;
+        }
+        if (p == last)
+            break;
+    }
+
+    std::size_t nFields = _fields.size();
+    if (_config.seqCol < 1 || std::size_t(_config.seqCol) > nFields
+        || _config.beginCol < 1 || std::size_t(_config.beginCol) > nFields)
+    {
+        return false;
+    }
+
+    Field const& seq = _fields[_config.seqCol - 1];
+    _sequence.assign(seq.first, seq.second);
+
+    Field const& pos = _fields[_config.beginCol - 1];
+    if (!parseInt(pos.first, pos.second, _begin))
+        return false;
+
+    if (!(_config.format & TabixIndex::UCSC_FLAG))
+        --_begin;
+
+    int32_t format = _config.format & 0xffff;
+    _end = _begin + 1;
+    if (format == TabixIndex::VCF && nFields >= 4) {
+        Field const& ref = _fields[3];
+        _end = _begin + (ref.second - ref.first);
+
+        // symbolic alleles and the like record their extent in INFO/END
+        if (nFields >= 8) {
+            char const* infoEnd = _fields[7].second;
+            for (char const* p = _fields[7].first; p < infoEnd; ) {
+                if (infoEnd - p > 4 && memcmp(p, "END=", 4) == 0) {
+                    int64_t value;
+                    if (parseInt(p + 4, infoEnd, value))
+                        _end = value;
+                    break;
+                }
+                p = std::find(p, infoEnd, ';');
+                if (p != infoEnd)
+                    ++p;
+            }
+        }
+    }
+    else if (format != TabixIndex::VCF && _config.endCol > 0
+        && std::size_t(_config.endCol) <= nFields)
+    {
+        Field const& endField = _fields[_config.endCol - 1];
+        if (!parseInt(endField.first, endField.second, _end))
+            return false;
+    }
+
+    if (_end <= _begin)
+        _end = _begin + 1;
+
+    return true;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "common/cstdint.hpp"
+
+#include <boost/unordered_map.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Reader for tabix (.tbi) and coordinate sorted (.csi) indexes of BGZF
+// compressed, tab delimited files.
+//
+// Coordinates passed to and returned from this class are 0-based and
+// half open. File positions are BGZF virtual offsets (see
+// BgzfLineSource::seek).
+class TabixIndex {
+public: // types
+    typedef std::unique_ptr<TabixIndex> ptr;
+
+    enum Format {
+        GENERIC = 0,
+        SAM = 1,
+        VCF = 2
+    };
+
+    // Set in the format field when begin coordinates are 0-based (e.g., bed)
+    static int32_t const UCSC_FLAG = 0x10000;
+
+    // Binning scheme used by .tbi files
+    static int const TBI_MIN_SHIFT = 14;
+    static int const TBI_DEPTH = 5;
+
+    struct Config {
+        Config();
+
+        // Presets used by tabix -p
+        static Config vcf();
+        static Config bed();
+
+        // Guess the preset from a file name (e.g., x.vcf.gz or x.bed.gz).
+        // Returns false if the name is not recognized.
+        static bool fromPath(std::string const& path, Config& config);
+
+        int32_t format;
+        // 1-based column numbers, endCol is 0 when there is no end column
+        int32_t seqCol;
+        int32_t beginCol;
+        int32_t endCol;
+        char metaChar;
+        int32_t skip;
+    };
+
+    struct Chunk {
+        Chunk()
+            : begin(0)
+            , end(0)
+        {}
+
+        Chunk(uint64_t begin, uint64_t end)
+            : begin(begin)
+            , end(end)
+        {}
+
+        bool operator<(Chunk const& rhs) const {
+            return begin < rhs.begin;
+        }
+
+        uint64_t begin;
+        uint64_t end;
+    };
+
+public: // functions
+    static ptr load(std::string const& path);
+
+    // Load dataPath.csi or dataPath.tbi, whichever exists (preferring the
+    // former). Returns a null pointer if there is no index.
+    static ptr loadForFile(std::string const& dataPath);
+
+    Config const& config() const;
+    std::vector<std::string> const& sequenceNames() const;
+
+    // Returns -1 if name does not appear in the index
+    int32_t sequenceId(std::string const& name) const;
+
+    // Sorted, non-overlapping list of file chunks that may contain records
+    // overlapping [begin, end) on the given sequence.
+    std::vector<Chunk> chunks(int32_t seqId, int64_t begin, int64_t end) const;
+
+    // Binning scheme helpers shared with the index writer
+    static uint32_t reg2bin(int64_t begin, int64_t end, int minShift, int depth);
+    static void reg2bins(
+            int64_t begin,
+            int64_t end,
+            int minShift,
+            int depth,
+            std::vector<uint32_t>& bins
+            );
+
+private:
+    struct Bin {
+        Bin()
+            : loffset(0)
+        {}
+
+        // lowest file offset of records in the bin (csi only)
+        uint64_t loffset;
+        std::vector<Chunk> chunks;
+    };
+
+    struct Sequence {
+        std::map<uint32_t, Bin> bins;
+        // linear index (tbi only)
+        std::vector<uint64_t> intervals;
+    };
+
+    TabixIndex();
+
+    void parse(std::string const& path, std::vector<char> const& data);
+    uint64_t minOffset(Sequence const& seq, int64_t begin) const;
+
+private:
+    bool _csi;
+    int _minShift;
+    int _depth;
+    Config _config;
+    std::vector<std::string> _sequenceNames;
+    boost::unordered_map<std::string, int32_t> _sequenceIds;
+    std::vector<Sequence> _sequences;
+};
+
+inline TabixIndex::Config const& TabixIndex::config() const {
+    return _config;
+}
+
+inline std::vector<std::string> const& TabixIndex::sequenceNames() const {
+    return _sequenceNames;
+}
+
+// Extracts the sequence and 0-based, half open extent of a record from a
+// line according to an index configuration.
+class TabixLocationParser {
+public:
+    explicit TabixLocationParser(TabixIndex::Config const& config);
+
+    // Parse the line [first, last), returns false if the line does not
+    // contain the required fields
+    bool operator()(char const* first, char const* last);
+
+    std::string const& sequence() const {
+        return _sequence;
+    }
+
+    int64_t begin() const {
+        return _begin;
+    }
+
+    int64_t end() const {
+        return _end;
+    }
+
+private:
+    typedef std::pair<char const*, char const*> Field;
+
+    TabixIndex::Config _config;
+    std::vector<Field> _fields;
+    std::string _sequence;
+    int64_t _begin;
+    int64_t _end;
+};
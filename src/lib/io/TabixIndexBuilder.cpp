@@ -0,0 +1,195 @@
+#include "TabixIndexBuilder.hpp"
+
+#include <boost/format.hpp>
+
+#include <algorithm>
+
+using boost::format;
+
+namespace {
+    void writeInt32(std::ostream& out, int32_t value) {
+        char buf[4];
+        for (int i = 0; i < 4; ++i)
+            buf[i] = (uint32_t(value) >> (8 * i)) & 0xff;
+        out.write(buf, sizeof(buf));
+    }
+
+    void writeUint64(std::ostream& out, uint64_t value) {
+        char buf[8];
+        for (int i = 0; i < 8; ++i)
+            buf[i] = (value >> (8 * i)) & 0xff;
+        out.write(buf, sizeof(buf));
+    }
+
+    inline uint32_t binFirst(int level) {
+        return ((1u << (3 * level)) - 1) / 7;
+    }
+
+    inline int binLevel(uint32_t bin) {
+        int level = 0;
+        while (bin >= binFirst(level + 1))
+            ++level;
+        return level;
+    }
+
+    // Translate a block number based position to a virtual file offset
+    inline uint64_t resolve(uint64_t pos, std::vector<uint64_t> const& blockOffsets) {
+        std::size_t block = pos >> 16;
+        uint64_t offset = block < blockOffsets.size()
+            ? blockOffsets[block]
+            : (blockOffsets.empty() ? 0 : blockOffsets.back());
+        return (offset << 16) | (pos & 0xffff);
+    }
+}
+
+uint64_t const TabixIndexBuilder::UNSET;
+
+TabixIndexBuilder::TabixIndexBuilder(TabixIndex::Config const& config, IndexType type)
+    : _config(config)
+    , _type(type)
+    , _depth(type == CSI ? CSI_DEPTH : TabixIndex::TBI_DEPTH)
+    , _parser(config)
+    , _lines(0)
+    , _lastBegin(0)
+{
+}
+
+void TabixIndexBuilder::addLine(
+        char const* first,
+        char const* last,
+        uint64_t begin,
+        uint64_t end
+        )
+{
+    if (!_error.empty())
+        return;
+
+    if (++_lines <= uint64_t(_config.skip) || first == last || *first == _config.metaChar)
+        return;
+
+    if (!_parser(first, last)) {
+        _error = str(format("Failed to find the location of line %1% (%2%)")
+            % _lines % std::string(first, last));
+        return;
+    }
+
+    std::string const& name = _parser.sequence();
+    if (_sequenceNames.empty() || _sequenceNames.back() != name) {
+        if (_sequenceIds.count(name)) {
+            _error = str(format("Sequence %1% is not contiguous (line %2%)")
+                % name % _lines);
+            return;
+        }
+        _sequenceIds[name] = _sequenceNames.size();
+        _sequenceNames.push_back(name);
+        _sequences.push_back(Sequence());
+        _lastBegin = 0;
+    }
+
+    int64_t recBegin = std::max<int64_t>(_parser.begin(), 0);
+    int64_t recEnd = _parser.end();
+    if (recBegin < _lastBegin) {
+        _error = str(format("Output is not sorted at line %1% (%2%:%3%)")
+            % _lines % name % (recBegin + 1));
+        return;
+    }
+    _lastBegin = recBegin;
+
+    int64_t maxEnd = int64_t(1) << (TabixIndex::TBI_MIN_SHIFT + 3 * _depth);
+    if (recEnd > maxEnd) {
+        _error = str(format("Position %1%:%2% is too large for a %3% index")
+            % name % recEnd % (_type == CSI ? "csi" : "tbi"));
+        return;
+    }
+
+    Sequence& seq = _sequences.back();
+    uint32_t bin = TabixIndex::reg2bin(recBegin, recEnd, TabixIndex::TBI_MIN_SHIFT, _depth);
+    auto& chunks = seq.bins[bin];
+    // extend the last chunk when it ends in the same block
+    if (!chunks.empty() && (chunks.back().end >> 16) == (begin >> 16))
+        chunks.back().end = end;
+    else
+        chunks.push_back(TabixIndex::Chunk(begin, end));
+
+    std::size_t firstWindow = recBegin >> TabixIndex::TBI_MIN_SHIFT;
+    std::size_t lastWindow = (recEnd - 1) >> TabixIndex::TBI_MIN_SHIFT;
+    if (seq.intervals.size() <= lastWindow)
+        seq.intervals.resize(lastWindow + 1, UNSET);
+    for (std::size_t w = firstWindow; w <= lastWindow; ++w) {
+        if (seq.intervals[w] == UNSET)
+            seq.intervals[w] = begin;
+    }
+}
+
+void TabixIndexBuilder::write(
+        std::ostream& out,
+        std::vector<uint64_t> const& blockOffsets
+        ) const
+{
+    std::string names;
+    for (auto i = _sequenceNames.begin(); i != _sequenceNames.end(); ++i) {
+        names += *i;
+        names += '\0';
+    }
+
+    if (_type == CSI) {
+        out.write("CSI\1", 4);
+        writeInt32(out, TabixIndex::TBI_MIN_SHIFT);
+        writeInt32(out, _depth);
+        writeInt32(out, 28 + names.size());
+    }
+    else {
+        out.write("TBI\1", 4);
+        writeInt32(out, _sequenceNames.size());
+    }
+
+    writeInt32(out, _config.format);
+    writeInt32(out, _config.seqCol);
+    writeInt32(out, _config.beginCol);
+    writeInt32(out, _config.endCol);
+    writeInt32(out, _config.metaChar);
+    writeInt32(out, _config.skip);
+    writeInt32(out, names.size());
+    out.write(names.data(), names.size());
+
+    if (_type == CSI)
+        writeInt32(out, _sequenceNames.size());
+
+    for (auto seq = _sequences.begin(); seq != _sequences.end(); ++seq) {
+        // windows no line overlaps get the offset of the previous window
+        std::vector<uint64_t> intervals(seq->intervals);
+        uint64_t prev = 0;
+        for (auto i = intervals.begin(); i != intervals.end(); ++i) {
+            if (*i == UNSET)
+                *i = prev;
+            else
+                *i = prev = resolve(*i, blockOffsets);
+        }
+
+        writeInt32(out, seq->bins.size());
+        for (auto bin = seq->bins.begin(); bin != seq->bins.end(); ++bin) {
+            writeInt32(out, bin->first);
+            if (_type == CSI) {
+                int level = binLevel(bin->first);
+                std::size_t window = std::size_t(bin->first - binFirst(level))
+                    << (3 * (_depth - level));
+                uint64_t loffset = 0;
+                if (!intervals.empty())
+                    loffset = intervals[std::min(window, intervals.size() - 1)];
+                writeUint64(out, loffset);
+            }
+
+            writeInt32(out, bin->second.size());
+            for (auto c = bin->second.begin(); c != bin->second.end(); ++c) {
+                writeUint64(out, resolve(c->begin, blockOffsets));
+                writeUint64(out, resolve(c->end, blockOffsets));
+            }
+        }
+
+        if (_type == TBI) {
+            writeInt32(out, intervals.size());
+            for (auto i = intervals.begin(); i != intervals.end(); ++i)
+                writeUint64(out, *i);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "TabixIndex.hpp"
+#include "common/cstdint.hpp"
+
+#include <boost/unordered_map.hpp>
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Builds a tabix (.tbi) or csi index from the lines of a sorted file as it
+// is being written.
+//
+// Line positions are given with the BGZF block number (rather than its
+// file offset, which is not known until the block has been compressed) in
+// the upper 48 bits and the offset into the uncompressed block in the lower
+// 16. They are translated to virtual file offsets when the index is written.
+class TabixIndexBuilder {
+public:
+    typedef std::unique_ptr<TabixIndexBuilder> ptr;
+
+    enum IndexType {
+        TBI,
+        CSI
+    };
+
+    // csi indexes use a deeper binning scheme to support sequences longer
+    // than the 2^29 bases supported by tbi
+    static int const CSI_DEPTH = 6;
+
+    TabixIndexBuilder(TabixIndex::Config const& config, IndexType type);
+
+    // Record the line [first, last) (without its newline) which occupies
+    // positions [begin, end) in the output. Header lines are skipped.
+    void addLine(char const* first, char const* last, uint64_t begin, uint64_t end);
+
+    // Empty if all lines seen so far were sorted and could be indexed
+    std::string const& error() const;
+
+    // Write the (uncompressed) index data. blockOffsets[i] is the file
+    // offset of the i'th compressed block.
+    void write(std::ostream& out, std::vector<uint64_t> const& blockOffsets) const;
+
+private:
+    struct Sequence {
+        std::map<uint32_t, std::vector<TabixIndex::Chunk>> bins;
+        // lowest position of lines overlapping each window
+        std::vector<uint64_t> intervals;
+    };
+
+    static uint64_t const UNSET = std::numeric_limits<uint64_t>::max();
+
+private:
+    TabixIndex::Config _config;
+    IndexType _type;
+    int _depth;
+    TabixLocationParser _parser;
+    uint64_t _lines;
+    int64_t _lastBegin;
+    std::string _error;
+    std::vector<std::string> _sequenceNames;
+    boost::unordered_map<std::string, std::size_t> _sequenceIds;
+    std::vector<Sequence> _sequences;
+};
+
+inline std::string const& TabixIndexBuilder::error() const {
+    return _error;
+}
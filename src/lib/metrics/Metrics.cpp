@@ -4,6 +4,7 @@
 
 #include <boost/bind.hpp>
 
+#include <algorithm>
 #include <locale>
 #include <string>
 #include <boost/format.hpp>
@@ -44,12 +45,14 @@ void EntryMetrics::calculateGenotypeDistribution() {
     auto const& sd = _entry.sampleData();
 
     for (auto i = sd.begin(); i != sd.end(); ++i) {
-        auto const& sampleIdx = i->first;
+        uint32_t sampleIdx = *i;
 
         // skip filtered samples
         if (sd.isSampleFiltered(sampleIdx))
             continue;
 
+        // the distribution is keyed by GenotypeCall; genotype() makes
+        // those from the packed call when there is one
         Vcf::GenotypeCall const& gt = sd.genotype(sampleIdx);
         if(gt.size() == 0) {
             continue;
@@ -71,20 +74,6 @@ void EntryMetrics::calculateGenotypeDistribution() {
     }
 }
 
-bool EntryMetrics::singleton(const Vcf::GenotypeCall* geno) const {
-    for (auto i = geno->indexSet().begin(); i != geno->indexSet().end(); ++i) {
-        // FIXME: should we count these too?
-        if (*i == Vcf::GenotypeIndex::Null)
-            continue;
-
-        if(_allelicDistributionBySample[i->value] == 1) {
-            //at least one of the alleles is a singleton
-            return true;
-        }
-    }
-    return false;
-}
-
 /*
 bool EntryMetrics::novel(const Vcf::Entry& entry, const std::vector<std::string>& novelInfoFields, const Vcf::GenotypeCall* geno) {
     // grab alt allele index(es)
@@ -158,7 +147,8 @@ void EntryMetrics::calculateMutationSpectrum() {
                 if(complement) {
                     variant = Sequence::reverseComplement(variant);
                 }
-                if(singleton(&geno->first)) {
+                auto const& indexSet = geno->first.indexSet();
+                if(singleton(indexSet.begin(), indexSet.end())) {
                     _singletonMutationSpectrum(ref[0],variant[0]) += geno->second;
                 }
                 else {
@@ -190,7 +180,7 @@ void EntryMetrics::identifyNovelAlleles() {
             if(database->size() == numAlts) {
                 //we know we have the same number of values as alts
                 for(Vcf::CustomValue::SizeType j = 0; j != _novelByAlt.size(); ++j) {
-                    _novelByAlt[j] = _novelByAlt[j] && database->getAny(j) == 0;
+                    _novelByAlt[j] = _novelByAlt[j] && database->missing(j);
                 }
             }
             else {
@@ -311,48 +301,56 @@ void SampleMetrics::processEntry(Vcf::Entry& e, EntryMetrics& m) {
     }
 
     for (auto i = sd.begin(); i != sd.end(); ++i) {
-        auto const& sampleIdx = i->first;
-        if (i->second == 0)
-            continue;
-        auto const& values = *i->second;
+        uint32_t sampleIdx = *i;
 
-        if (values.size() > offset) {
-            const std::string *filter(values[offset].get<std::string>(0));
-            if (filter != 0 && *filter != "PASS") {
+        if (sd.fieldCount(sampleIdx) > int64_t(offset)) {
+            auto const& ft = sd.column(offset);
+            if (!ft.empty(sampleIdx) && !ft.missing(sampleIdx, 0)
+                && !(ft.string(sampleIdx, 0) == "PASS"))
+            {
                 ++_perSampleFilteredCall[sampleIdx];
                 continue;
             }
         }
 
         //if no FT then we assume all have passed :-(
-        Vcf::GenotypeCall const& gt = e.sampleData().genotype(sampleIdx);
-        if(gt.size() == 0) {
+        // calls that do not pack (more than 4 alleles, very large indices)
+        // are decoded as a GenotypeCall instead
+        Vcf::PackedGenotype gt = sd.packedGenotype(sampleIdx);
+        Vcf::GenotypeCall const* call = gt.packed() ? 0 : &sd.genotype(sampleIdx);
+        if(call ? call->empty() : gt.empty()) {
             //++_perSampleMissingCall[sampleIdx];
             continue;
         }
 
         ++_perSampleCalls[sampleIdx];
 
-        if (!gt.diploid()) {
+        if (!(call ? call->diploid() : gt.diploid())) {
             //anything but diploid is not supported until we understand a bit better how to represent them
             cerr << "Non-diploid genotype for sample " << e.header().sampleNames()[sampleIdx] << " skipped at position " << e.chrom() << "\t" << e.pos() << endl;
             ++_perSampleNonDiploidCall[sampleIdx];
             continue;
         }
         else {
-            if(gt.reference()) {
+            if(call ? call->reference() : gt.reference()) {
                 ++_perSampleRefCall[sampleIdx];
                 continue;
             }
-            else if(gt.heterozygous()) {
+            else if(call ? call->heterozygous() : gt.heterozygous()) {
                 ++_perSampleHetVariants[sampleIdx];
             }
             else {
                 ++_perSampleHomVariants[sampleIdx];
             }
 
+            // a diploid call has at most two distinct indices
+            Vcf::GenotypeIndex indices[Vcf::PackedGenotype::MAX_PLOIDY];
+            Vcf::GenotypeIndex* indicesEnd = call
+                ? std::copy(call->indexSet().begin(), call->indexSet().end(), indices)
+                : indices + gt.distinctIndices(indices);
+
             double maf = m.minorAlleleFrequency();
-            if(m.singleton(&gt)) {
+            if(m.singleton(indices, indicesEnd)) {
                 ++_perSampleSingletons[sampleIdx];
             }
             else if(maf < 0.01) {
@@ -366,7 +364,7 @@ void SampleMetrics::processEntry(Vcf::Entry& e, EntryMetrics& m) {
             }
 
             if(canCalcSpectrum) {
-                for(auto j = gt.indexSet().begin(); j != gt.indexSet().end(); ++j) {
+                for(auto j = indices; j != indicesEnd; ++j) {
                     if(isRefOrNull(*j))
                         continue;
                     std::string variant( e.alt()[j->value - 1] );
@@ -383,7 +381,7 @@ void SampleMetrics::processEntry(Vcf::Entry& e, EntryMetrics& m) {
 
             //determine if novel which is by allele
             std::vector<bool> novelByAlt = m.novelStatusByAlt();
-            for(auto j = gt.indexSet().begin(); j != gt.indexSet().end(); ++j) {
+            for(auto j = indices; j != indicesEnd; ++j) {
                 if(isRefOrNull(*j))
                     continue;
                 if(novelByAlt[j->value - 1]) {    //need to subtract one because reference is not an Alt
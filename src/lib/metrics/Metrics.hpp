@@ -31,7 +31,10 @@ public:
     const std::vector<bool>& transitionStatusByAlt() const;
     const std::vector<bool>& novelStatusByAlt() const;
     
-    bool singleton(const Vcf::GenotypeCall* geno) const;
+    // true if any of the distinct allele indices [first, last) of a call
+    // is carried by no other sample
+    template<typename IndexIter>
+    bool singleton(IndexIter first, IndexIter last) const;
     //bool novel(const Vcf::Entry& entry, const std::vector<std::string>& novelInfoFields, const Vcf::GenotypeCall* geno);
 
 protected:
@@ -93,4 +96,19 @@ protected:
 };
 
 
+template<typename IndexIter>
+bool EntryMetrics::singleton(IndexIter first, IndexIter last) const {
+    for (; first != last; ++first) {
+        // FIXME: should we count these too?
+        if (*first == Vcf::GenotypeIndex::Null)
+            continue;
+
+        if(_allelicDistributionBySample[first->value] == 1) {
+            //at least one of the alleles is a singleton
+            return true;
+        }
+    }
+    return false;
+}
+
 END_NAMESPACE(Metrics)
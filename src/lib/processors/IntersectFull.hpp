@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/ContigDictionary.hpp"
 #include "common/UnsortedDataError.hpp"
 
 #include <boost/format.hpp>
@@ -48,7 +49,8 @@ public: // code
         if (_adjacentInsertions)
             return compareWithAdjacentInsertions(a, b);
 
-        int rv = strverscmp(a.chrom().c_str(), b.chrom().c_str());
+        int rv = ContigDictionary::compare(
+            a.chrom(), contigRankOf(a), b.chrom(), contigRankOf(b));
         if (rv < 0)
             return BEFORE;
         if (rv > 0)
@@ -68,7 +70,8 @@ public: // code
 
     template<typename TA, typename TB>
     Compare compareWithAdjacentInsertions(const TA& a, const TB& b) const {
-        int rv = strverscmp(a.chrom().c_str(), b.chrom().c_str());
+        int rv = ContigDictionary::compare(
+            a.chrom(), contigRankOf(a), b.chrom(), contigRankOf(b));
         if (rv < 0)
             return BEFORE;
         if (rv > 0)
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Tournament (loser) tree for merging k sorted sources.
+//
+// The caller points the tree at the head of each source with set() (null
+// once the source is exhausted), calls build() once and then, each time the
+// head of the winning source top() changes, set()s it again and calls
+// replay(). Picking the next winner costs about log2(k) comparisons and no
+// allocation. Each internal node holds the source that lost the match
+// played there; tree_[0] holds the overall winner.
+//
+// Exhausted sources sort after everything else and ties go to the source
+// that comes first, so merging neighboring runs of a stable sort keeps it
+// stable.
+template<typename T, typename LessThanCmp>
+class LoserTree {
+public:
+    explicit LoserTree(std::size_t k, LessThanCmp cmp = LessThanCmp())
+        : cmp_(cmp)
+        , heads_(k, 0)
+        , tree_(k)
+    {}
+
+    std::size_t size() const {
+        return heads_.size();
+    }
+
+    void set(std::size_t idx, T const* head) {
+        heads_[idx] = head;
+    }
+
+    T const* head(std::size_t idx) const {
+        return heads_[idx];
+    }
+
+    // The source with the smallest head (only valid if size() > 0)
+    std::size_t top() const {
+        return tree_[0];
+    }
+
+    // True once every source is exhausted
+    bool done() const {
+        return tree_.empty() || !heads_[tree_[0]];
+    }
+
+    // Leaf i of the tree is node i + k, node n has children 2n and 2n + 1
+    void build() {
+        std::size_t k = tree_.size();
+        if (k == 0)
+            return;
+
+        std::vector<std::size_t> winners(2 * k);
+        for (std::size_t i = 0; i < k; ++i)
+            winners[k + i] = i;
+
+        for (std::size_t n = k - 1; n > 0; --n) {
+            std::size_t a = winners[2 * n];
+            std::size_t b = winners[2 * n + 1];
+            if (less(b, a))
+                std::swap(a, b);
+            winners[n] = a;
+            tree_[n] = b;
+        }
+        tree_[0] = winners[1];
+    }
+
+    // Replay the matches on the path from the leaf of source idx (whose
+    // head has just changed) to the root
+    void replay(std::size_t idx) {
+        std::size_t winner = idx;
+        for (std::size_t n = (idx + tree_.size()) / 2; n > 0; n /= 2) {
+            if (less(tree_[n], winner))
+                std::swap(tree_[n], winner);
+        }
+        tree_[0] = winner;
+    }
+
+protected:
+    bool less(std::size_t a, std::size_t b) const {
+        T const* pa = heads_[a];
+        T const* pb = heads_[b];
+        if (!pa || !pb)
+            return pa ? true : (pb ? false : a < b);
+
+        if (cmp_(*pa, *pb))
+            return true;
+        if (cmp_(*pb, *pa))
+            return false;
+        return a < b;
+    }
+
+protected:
+    LessThanCmp cmp_;
+    std::vector<T const*> heads_;
+    std::vector<std::size_t> tree_;
+};
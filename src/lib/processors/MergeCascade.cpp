@@ -0,0 +1,55 @@
+#include "MergeCascade.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+MergeCascade::MergeCascade(std::size_t fanIn)
+    : _fanIn(fanIn)
+{
+    if (fanIn == 1)
+        throw std::runtime_error("Merge fan-in must be at least 2");
+}
+
+void MergeCascade::add() {
+    _levels.push_back(0);
+}
+
+std::size_t MergeCascade::tailMerge() const {
+    if (_fanIn == 0 || _levels.size() < _fanIn)
+        return 0;
+
+    // levels never increase along the list, so the last fanIn runs are on
+    // the same level when the first and last of them are
+    std::size_t first = _levels.size() - _fanIn;
+    return _levels[first] == _levels.back() ? _fanIn : 0;
+}
+
+std::vector<MergeCascade::Group> MergeCascade::nextPass(std::size_t maxRuns) const {
+    std::vector<Group> groups;
+    if (_fanIn == 0 || _levels.size() <= maxRuns)
+        return groups;
+
+    // each merge of n runs leaves n - 1 fewer, later runs are smaller
+    std::size_t excess = _levels.size() - std::max<std::size_t>(maxRuns, 1);
+    std::size_t last = _levels.size();
+    while (excess > 0 && last >= 2) {
+        std::size_t n = std::min(std::min(_fanIn, excess + 1), last);
+        groups.push_back(Group(last - n, last));
+        excess -= n - 1;
+        last -= n;
+    }
+    return groups;
+}
+
+void MergeCascade::merged(std::vector<Group> const& groups) {
+    // later groups first so that the indices of earlier ones stay valid
+    std::vector<Group> sorted(groups);
+    std::sort(sorted.begin(), sorted.end());
+    for (auto i = sorted.rbegin(); i != sorted.rend(); ++i) {
+        auto first = _levels.begin() + i->first;
+        auto last = _levels.begin() + i->second;
+        unsigned level = *std::max_element(first, last) + 1;
+        _levels.erase(first + 1, last);
+        _levels[i->first] = level;
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Plans the merging of the sorted runs of an external sort so that no more
+// than fanIn runs are ever merged (or held open) at once.
+//
+// Runs are numbered in the order they were written and only neighboring
+// runs are merged, the result taking the place of its inputs, so records
+// with equal keys keep their input order.
+//
+// While input is being read, every fanIn runs of the same level (a run
+// written from a buffer is level 0, merging runs of level n gives one of
+// level n + 1) are merged into one. At the end, passes of non overlapping
+// merges (which can run in parallel) bring the number of runs down to what
+// the final merge can take. The smallest runs are merged first.
+class MergeCascade {
+public:
+    typedef std::pair<std::size_t, std::size_t> Group; // [first, last)
+
+    // fanIn = 0 means there is no limit
+    explicit MergeCascade(std::size_t fanIn);
+
+    std::size_t fanIn() const;
+    std::size_t size() const;
+
+    // Record a new run after the existing ones
+    void add();
+
+    // The number of runs at the end of the list to merge into one now, 0
+    // if there is nothing to do
+    std::size_t tailMerge() const;
+
+    // Groups to merge in the next pass so that at most maxRuns runs are
+    // left (perhaps after more passes). Empty when there are few enough.
+    std::vector<Group> nextPass(std::size_t maxRuns) const;
+
+    // Record that the runs of each (non overlapping) group were merged
+    void merged(std::vector<Group> const& groups);
+
+private:
+    std::size_t _fanIn;
+    std::vector<unsigned> _levels;
+};
+
+inline std::size_t MergeCascade::fanIn() const {
+    return _fanIn;
+}
+
+inline std::size_t MergeCascade::size() const {
+    return _levels.size();
+}
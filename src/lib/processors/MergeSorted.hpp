@@ -1,79 +1,60 @@
 #pragma once
 
+#include "LoserTree.hpp"
 #include "common/LocusCompare.hpp"
 #include "common/RelOps.hpp"
 
-#include <algorithm>
-#include <functional>
+#include <cstddef>
 #include <memory>
-#include <set>
-#include <utility>
 #include <vector>
 
-namespace {
-    template<typename StreamType, typename LessThanCmp>
-    struct StreamLessThan {
-        StreamLessThan(LessThanCmp cmp = LessThanCmp())
-            : cmp_(cmp)
-        {}
-
-        bool operator()(StreamType* a, StreamType* b) const {
-            typedef typename StreamType::ValueType ValueType;
-            ValueType* pa(0);
-            ValueType* pb(0);
-            if (a->eof()) return false;
-            if (b->eof()) return true;
-            a->peek(&pa);
-            b->peek(&pb);
-            return cmp_(*pa, *pb);
-        }
-
-        LessThanCmp cmp_;
-    };
-}
-
-
+// Merges sorted streams with a tournament (loser) tree (see LoserTree).
+//
+// The record at the head of each stream is peeked once when the stream
+// advances and the pointer is cached, so producing a record costs about
+// log2(k) comparisons of cached values and no allocation. Records that
+// compare equal are produced in input order.
 template<typename StreamType , typename LessThanCmp>
 class MergeSorted {
 public:
     typedef typename StreamType::ValueType ValueType;
     typedef std::unique_ptr<StreamType> StreamPtr;
-    typedef StreamLessThan<StreamType, LessThanCmp> StreamCmp;
 
     MergeSorted(std::vector<StreamPtr> const& inputs, LessThanCmp cmp = LessThanCmp())
         : inputs_(inputs)
-        , sortedInputs_(StreamCmp(cmp))
+        , tree_(inputs.size(), cmp)
     {
-        for (auto i = inputs_.begin(); i != inputs_.end(); ++i)
-            if (!(*i)->eof())
-                sortedInputs_.insert(i->get());
+        for (std::size_t i = 0; i < inputs_.size(); ++i)
+            fetch(i);
+        tree_.build();
     }
 
     bool next(ValueType& next) {
-        using namespace std;
-        if (sortedInputs_.empty())
-            return false;
-
-        bool rv = false;
-        while (rv == false && !sortedInputs_.empty()) {
-            StreamType* s = (*sortedInputs_.begin());
-            sortedInputs_.erase(sortedInputs_.begin());
-            if ((rv = s->next(next))) {
-                ValueType* p;
-                if (s->peek(&p))
-                    sortedInputs_.insert(s);
-            }
+        // the winner is only exhausted when all of the streams are
+        while (!tree_.done()) {
+            std::size_t s = tree_.top();
+            bool rv = inputs_[s]->next(next);
+            fetch(s);
+            tree_.replay(s);
+            if (rv)
+                return true;
         }
 
-        return rv;
+        return false;
+    }
+
+protected:
+    void fetch(std::size_t idx) {
+        StreamType& s = *inputs_[idx];
+        ValueType* p(0);
+        tree_.set(idx, !s.eof() && s.peek(&p) ? p : 0);
     }
 
 protected:
     std::vector<StreamPtr> const& inputs_;
-    std::multiset<StreamType*, StreamCmp> sortedInputs_;
+    LoserTree<ValueType, LessThanCmp> tree_;
 };
 
-
 template<
           typename StreamType
         , typename LessThanCmp = CompareToLessThan<
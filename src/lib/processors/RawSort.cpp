@@ -0,0 +1,201 @@
+#include "RawSort.hpp"
+
+#include "common/MemoryUsage.hpp"
+
+#include <boost/format.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+using boost::format;
+
+namespace {
+    // Find the end of the tab delimited field starting at first
+    char const* fieldEnd(char const* first, char const* last) {
+        char const* p = static_cast<char const*>(memchr(first, '\t', last - first));
+        return p ? p : last;
+    }
+
+    bool parseInt(char const* first, char const* last, int64_t& value) {
+        bool negative = first != last && *first == '-';
+        if (negative)
+            ++first;
+        if (first == last)
+            return false;
+
+        int64_t rv = 0;
+        for (; first != last; ++first) {
+            if (*first < '0' || *first > '9')
+                return false;
+            rv = rv * 10 + (*first - '0');
+        }
+        value = negative ? -rv : rv;
+        return true;
+    }
+
+    struct ContigLess {
+        ContigLess(std::vector<std::string> const& names)
+            : names(names)
+        {}
+
+        bool operator()(uint32_t a, uint32_t b) const {
+            return strverscmp(names[a].c_str(), names[b].c_str()) < 0;
+        }
+
+        std::vector<std::string> const& names;
+    };
+}
+
+std::size_t const RawSortBuffer::BLOCK_SIZE;
+
+RawSortBuffer::RawSortBuffer(FileType type)
+    : _type(type)
+    , _lastContig(0)
+    , _arenaBytes(0)
+    , _descents(0)
+{
+    if (type != BED && type != VCF && type != CHROMPOS)
+        throw std::runtime_error("Raw sorting is only supported for bed, vcf and chrom/pos files");
+}
+
+void RawSortBuffer::add(StringView const& line) {
+    char const* const last = line.end();
+    char const* chromEnd = fieldEnd(line.begin(), last);
+    if (chromEnd == line.begin() || chromEnd == last)
+        throw std::runtime_error(str(format("Failed to extract chromosome from line '%1%'") % line));
+
+    Record rec;
+    char const* p = chromEnd + 1;
+    char const* end = fieldEnd(p, last);
+    if (!parseInt(p, end, rec.start))
+        throw std::runtime_error(str(format("Failed to extract start position from line '%1%'") % line));
+
+    if (_type == BED) {
+        p = end == last ? last : end + 1;
+        end = fieldEnd(p, last);
+        if (p == last || !parseInt(p, end, rec.stop))
+            throw std::runtime_error(str(format("Failed to extract stop position from line '%1%'") % line));
+    }
+    else if (_type == VCF) {
+        // skip the id, the key is [pos - 1, pos - 1 + length of ref)
+        for (int i = 0; i < 2 && p != last; ++i) {
+            p = end == last ? last : end + 1;
+            end = fieldEnd(p, last);
+        }
+        if (p == last || p == end)
+            throw std::runtime_error(str(format("Failed to extract reference allele from line '%1%'") % line));
+        rec.start -= 1;
+        rec.stop = rec.start + (end - p);
+    }
+    else {
+        rec.stop = rec.start;
+    }
+
+    rec.contig = contigIndex(line.begin(), chromEnd);
+    rec.length = line.size();
+    if (!_records.empty() && descends(_records.back(), rec))
+        ++_descents;
+    char* dst = allocate(line.size(), rec.position);
+    memcpy(dst, line.begin(), line.size());
+    _records.push_back(rec);
+}
+
+bool RawSortBuffer::descends(Record const& prev, Record const& rec) const {
+    // contig numbers are not in sort order until sort()
+    if (prev.contig != rec.contig)
+        return strverscmp(_contigs[prev.contig].c_str(), _contigs[rec.contig].c_str()) > 0;
+    return rec.start < prev.start || (rec.start == prev.start && rec.stop < prev.stop);
+}
+
+uint32_t RawSortBuffer::contigIndex(char const* first, char const* last) {
+    // inputs are usually grouped by chromosome
+    if (!_contigs.empty()) {
+        std::string const& prev = _contigs[_lastContig];
+        if (prev.size() == std::size_t(last - first) && prev.compare(0, prev.size(), first, last - first) == 0)
+            return _lastContig;
+    }
+
+    std::string name(first, last);
+    auto inserted = _contigIndex.insert(std::make_pair(name, uint32_t(_contigs.size())));
+    if (inserted.second)
+        _contigs.push_back(name);
+    return _lastContig = inserted.first->second;
+}
+
+char* RawSortBuffer::allocate(std::size_t len, uint64_t& position) {
+    if (_blocks.empty() || _blocks.back().capacity() - _blocks.back().size() < len) {
+        _blocks.push_back(std::vector<char>());
+        _blocks.back().reserve(std::max(len, BLOCK_SIZE));
+        _arenaBytes += allocationBytes(_blocks.back().capacity());
+    }
+
+    std::vector<char>& block = _blocks.back();
+    position = (uint64_t(_blocks.size() - 1) << 32) | block.size();
+    block.resize(block.size() + len);
+    return &block[position & 0xffffffff];
+}
+
+void RawSortBuffer::sort() {
+    // renumber the chromosomes in version sort order
+    std::vector<uint32_t> order(_contigs.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), ContigLess(_contigs));
+
+    std::vector<uint32_t> ordinal(order.size());
+    std::vector<std::string> sortedContigs(order.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        ordinal[order[i]] = i;
+        sortedContigs[i].swap(_contigs[order[i]]);
+    }
+    _contigs.swap(sortedContigs);
+
+    _contigIndex.clear();
+    for (uint32_t i = 0; i < _contigs.size(); ++i)
+        _contigIndex[_contigs[i]] = i;
+    _lastContig = 0;
+
+    for (auto i = _records.begin(); i != _records.end(); ++i)
+        i->contig = ordinal[i->contig];
+
+    // lines that came in order are left as they are
+    if (_descents > 0)
+        std::sort(_records.begin(), _records.end());
+    _descents = 0;
+}
+
+void RawSortBuffer::clear() {
+    _records.clear();
+    _blocks.clear();
+    _contigs.clear();
+    _contigIndex.clear();
+    _lastContig = 0;
+    _arenaBytes = 0;
+    _descents = 0;
+}
+
+uint64_t RawSortBuffer::bytes() const {
+    return _arenaBytes
+        + allocationBytes(_records.capacity() * sizeof(Record))
+        + allocationBytes(_blocks.capacity() * sizeof(std::vector<char>))
+        + heapBytes(_contigs);
+}
+
+void RawSortBuffer::writeRun(std::ostream& out, bool compress, ThreadPool* io) const {
+    SpillRunWriter writer(out, compress, io);
+    SortKey key;
+    for (std::size_t i = 0; i < _records.size(); ++i) {
+        Record const& r = _records[i];
+        if (i == 0 || r.contig != _records[i - 1].contig) {
+            std::string const& chrom = _contigs[r.contig];
+            key.assign(chrom.data(), chrom.data() + chrom.size(), r.start, r.stop);
+        }
+        else {
+            key.assign(r.start, r.stop);
+        }
+
+        StringView line = text(i);
+        writer.add(key, line.begin(), line.end());
+    }
+    writer.close();
+}
@@ -0,0 +1,345 @@
+#pragma once
+
+#include "LoserTree.hpp"
+#include "MergeCascade.hpp"
+#include "SortKey.hpp"
+#include "SpillDirectories.hpp"
+#include "SpillRun.hpp"
+#include "common/LocusCompare.hpp"
+#include "common/RelOps.hpp"
+#include "common/StringView.hpp"
+#include "common/compat.hpp"
+#include "common/cstdint.hpp"
+#include "fileformats/InferFileType.hpp"
+#include "io/InputStream.hpp"
+#include "io/TempFile.hpp"
+
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Buffer of raw record lines for RawSort. Only the sort key of each line
+// (chromosome, start, stop) is extracted. The line itself is copied into
+// an arena and sorted as a compact key/position pair.
+//
+// Chromosomes are numbered in the order they are first seen and only given
+// their version sort ordinals when the buffer is sorted. Ties are broken by
+// position in the arena, i.e., by input order, so sorts are always stable.
+// Lines that are added in order are not sorted again.
+class RawSortBuffer {
+public:
+    // Lines are stored in blocks of this size (or larger, for long lines)
+    static std::size_t const BLOCK_SIZE = 4 << 20;
+
+    explicit RawSortBuffer(FileType type);
+
+    // Extract the key from line and store a copy of it. Throws if the
+    // line does not have the columns the key comes from.
+    void add(StringView const& line);
+
+    void sort();
+    void clear();
+
+    std::size_t size() const;
+    bool empty() const;
+    // The number of ascending runs the lines were added in
+    std::size_t naturalRuns() const;
+    // Memory held by the arena, keys and chromosome names
+    uint64_t bytes() const;
+
+    // Access to the (sorted) lines by index
+    std::string const& chrom(std::size_t idx) const;
+    int64_t start(std::size_t idx) const;
+    int64_t stop(std::size_t idx) const;
+    StringView text(std::size_t idx) const;
+
+    // Write the sorted lines as a SpillRun, on io if it is not 0
+    void writeRun(std::ostream& out, bool compress, ThreadPool* io = 0) const;
+
+protected:
+    struct Record {
+        uint32_t contig;
+        uint32_t length;
+        int64_t start;
+        int64_t stop;
+        // block number in the upper and offset in the lower 32 bits, so
+        // that it also gives the input order
+        uint64_t position;
+
+        bool operator<(Record const& rhs) const {
+            if (contig != rhs.contig)
+                return contig < rhs.contig;
+            if (start != rhs.start)
+                return start < rhs.start;
+            if (stop != rhs.stop)
+                return stop < rhs.stop;
+            return position < rhs.position;
+        }
+    };
+
+    bool descends(Record const& prev, Record const& rec) const;
+    uint32_t contigIndex(char const* first, char const* last);
+    char* allocate(std::size_t len, uint64_t& position);
+
+protected:
+    FileType _type;
+    std::vector<Record> _records;
+    std::vector<std::vector<char>> _blocks;
+    std::vector<std::string> _contigs;
+    boost::unordered_map<std::string, uint32_t> _contigIndex;
+    uint32_t _lastContig;
+    uint64_t _arenaBytes;
+    // lines that were less than the one before them
+    std::size_t _descents;
+};
+
+inline std::size_t RawSortBuffer::size() const {
+    return _records.size();
+}
+
+inline bool RawSortBuffer::empty() const {
+    return _records.empty();
+}
+
+inline std::size_t RawSortBuffer::naturalRuns() const {
+    return _records.empty() ? 0 : _descents + 1;
+}
+
+inline std::string const& RawSortBuffer::chrom(std::size_t idx) const {
+    return _contigs[_records[idx].contig];
+}
+
+inline int64_t RawSortBuffer::start(std::size_t idx) const {
+    return _records[idx].start;
+}
+
+inline int64_t RawSortBuffer::stop(std::size_t idx) const {
+    return _records[idx].stop;
+}
+
+inline StringView RawSortBuffer::text(std::size_t idx) const {
+    Record const& r = _records[idx];
+    char const* p = &_blocks[r.position >> 32][r.position & 0xffffffff];
+    return StringView(p, p + r.length);
+}
+
+// Sorts the data lines of inputs without parsing them into records: only
+// the sort key is extracted from each line and the lines are written to
+// the output byte for byte. Header lines must already have been consumed
+// from the inputs (e.g., by opening them as TypedStreams).
+//
+// Buffers are written to temporary files when they hold maxInMem lines or
+// (if maxBytes is not 0) maxBytes of memory, the runs are merged at the
+// end. The order is the same as that of a stable Sort. Runs are merged
+// at most fanIn at a time as in Sort (0 means there is no limit). tmpDirs
+// and asyncIO are as for Sort.
+template<typename OutputFunc>
+class RawSort {
+public:
+    typedef std::unique_ptr<RawSort> ptr;
+
+    RawSort(RawSort const&) = delete;
+    RawSort& operator=(RawSort const&) = delete;
+
+    RawSort(
+            std::vector<InputStream::ptr> const& inputs,
+            FileType type,
+            OutputFunc& out,
+            uint64_t maxInMem,
+            uint64_t maxBytes = 0,
+            bool compress = false,
+            std::size_t fanIn = 0,
+            std::vector<std::string> const& tmpDirs = std::vector<std::string>(),
+            bool asyncIO = false
+        )
+        : _inputs(inputs)
+        , _out(out)
+        , _maxInMem(maxInMem)
+        , _maxBytes(maxBytes)
+        , _compress(compress)
+        , _spillDirs(tmpDirs, asyncIO)
+        , _buf(type)
+        , _peakBytes(0)
+        , _records(0)
+        , _naturalRuns(0)
+        , _cascade(fanIn)
+    {
+    }
+
+    uint64_t peakBytes() const {
+        return _peakBytes;
+    }
+
+    uint64_t records() const {
+        return _records;
+    }
+
+    uint64_t naturalRuns() const {
+        return _naturalRuns;
+    }
+
+    void execute() {
+        StringView line;
+        for (auto in = _inputs.begin(); in != _inputs.end(); ++in) {
+            while ((*in)->getline(line)) {
+                if (line.empty() || line[0] == '#')
+                    continue;
+
+                _buf.add(line);
+                _peakBytes = std::max(_peakBytes, _buf.bytes());
+                if (_buf.size() >= _maxInMem || (_maxBytes > 0 && _buf.bytes() >= _maxBytes))
+                    spill();
+            }
+        }
+
+        count();
+        _buf.sort();
+        if (_runs.empty()) {
+            for (std::size_t i = 0; i < _buf.size(); ++i)
+                _out(_buf.text(i));
+        }
+        else {
+            std::size_t reserved = _buf.empty() ? 0 : 1;
+            for (auto groups = _cascade.nextPass(_cascade.fanIn() - reserved);
+                !groups.empty();
+                groups = _cascade.nextPass(_cascade.fanIn() - reserved))
+            {
+                mergeRuns(groups);
+            }
+            merge();
+        }
+    }
+
+protected:
+    void count() {
+        _records += _buf.size();
+        _naturalRuns += _buf.naturalRuns();
+    }
+
+    void spill() {
+        count();
+        _buf.sort();
+        SpillDirectories::File spill = _spillDirs.create();
+        _buf.writeRun(spill.file->stream(), _compress, spill.io);
+        _buf.clear();
+        spill.file->stream().seekg(0);
+        _runs.push_back(std::make_unique<SpillRunReader>(spill.file->stream(), spill.io));
+        _tmpfiles.push_back(std::move(spill.file));
+
+        _cascade.add();
+        while (std::size_t n = _cascade.tailMerge()) {
+            std::size_t last = _runs.size();
+            mergeRuns(std::vector<MergeCascade::Group>(
+                1, MergeCascade::Group(last - n, last)));
+        }
+    }
+
+    // Replaces each group of runs with one holding their merged records
+    void mergeRuns(std::vector<MergeCascade::Group> const& groups) {
+        std::vector<MergeCascade::Group> sorted(groups);
+        std::sort(sorted.begin(), sorted.end());
+        for (auto g = sorted.rbegin(); g != sorted.rend(); ++g) {
+            std::vector<SpillRunReader*> runs;
+            for (std::size_t i = g->first; i < g->second; ++i)
+                runs.push_back(_runs[i].get());
+
+            SpillDirectories::File spill = _spillDirs.create();
+            SpillRunWriter writer(spill.file->stream(), _compress, spill.io);
+            mergeSpillRuns(runs, writer);
+            writer.close();
+            spill.file->stream().seekg(0);
+
+            _runs.erase(_runs.begin() + g->first + 1, _runs.begin() + g->second);
+            _tmpfiles.erase(_tmpfiles.begin() + g->first + 1, _tmpfiles.begin() + g->second);
+            _runs[g->first] = std::make_unique<SpillRunReader>(spill.file->stream(), spill.io);
+            _tmpfiles[g->first] = std::move(spill.file);
+        }
+        _cascade.merged(groups);
+    }
+
+    // Moves the in memory buffer on to line _bufPos
+    bool seekBuffer() {
+        if (_bufPos >= _buf.size())
+            return false;
+
+        if (_bufPos == 0 || _buf.chrom(_bufPos) != _bufKey.chrom()) {
+            std::string const& chrom = _buf.chrom(_bufPos);
+            _bufKey.assign(chrom.data(), chrom.data() + chrom.size(),
+                _buf.start(_bufPos), _buf.stop(_bufPos));
+        }
+        else {
+            _bufKey.assign(_buf.start(_bufPos), _buf.stop(_bufPos));
+        }
+        return true;
+    }
+
+    // Merges the runs and the in memory buffer through a LoserTree. The
+    // buffer is the last source, so lines with equal keys come out in
+    // input order.
+    void merge() {
+        std::size_t const memory = _runs.size();
+        LoserTree<SortKey, CompareToLessThan<LocusCompare<>>> heads(memory + 1);
+        for (std::size_t i = 0; i < memory; ++i)
+            heads.set(i, _runs[i]->next() ? &_runs[i]->key() : 0);
+        _bufPos = 0;
+        heads.set(memory, seekBuffer() ? &_bufKey : 0);
+        heads.build();
+
+        while (!heads.done()) {
+            std::size_t idx = heads.top();
+            bool more;
+            if (idx == memory) {
+                _out(_buf.text(_bufPos++));
+                more = seekBuffer();
+            }
+            else {
+                _out(_runs[idx]->text());
+                more = _runs[idx]->next();
+            }
+
+            if (!more)
+                heads.set(idx, 0);
+            heads.replay(idx);
+        }
+    }
+
+protected:
+    std::vector<InputStream::ptr> const& _inputs;
+    OutputFunc& _out;
+    uint64_t _maxInMem;
+    uint64_t _maxBytes;
+    bool _compress;
+    // before the runs so that I/O threads outlive them
+    SpillDirectories _spillDirs;
+    RawSortBuffer _buf;
+    uint64_t _peakBytes;
+    uint64_t _records;
+    uint64_t _naturalRuns;
+    std::vector<TempFile::ptr> _tmpfiles;
+    std::vector<std::unique_ptr<SpillRunReader>> _runs;
+    MergeCascade _cascade;
+    std::size_t _bufPos;
+    SortKey _bufKey;
+};
+
+template<typename OutputFunc>
+typename RawSort<OutputFunc>::ptr makeRawSort(
+          std::vector<InputStream::ptr> const& inputs
+        , FileType type
+        , OutputFunc& out
+        , uint64_t maxInMem
+        , uint64_t maxBytes = 0
+        , bool compress = false
+        , std::size_t fanIn = 0
+        , std::vector<std::string> const& tmpDirs = std::vector<std::string>()
+        , bool asyncIO = false
+        )
+{
+    return std::make_unique<RawSort<OutputFunc>>(
+        inputs, type, out, maxInMem, maxBytes, compress, fanIn, tmpDirs, asyncIO);
+}
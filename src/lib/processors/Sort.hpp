@@ -1,7 +1,10 @@
 #pragma once
 
-#include "MergeSorted.hpp"
+#include "LoserTree.hpp"
+#include "MergeCascade.hpp"
 #include "SortBuffer.hpp"
+#include "SortKey.hpp"
+#include "common/ThreadPool.hpp"
 #include "common/compat.hpp"
 #include "common/cstdint.hpp"
 
@@ -9,13 +12,46 @@
 #include <boost/format.hpp>
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <fstream>
+#include <future>
 #include <iterator>
 #include <memory>
+#include <string>
 #include <vector>
 
+// External merge sort. Inputs are read into buffers of maxInMem records;
+// full buffers are sorted and written to temporary files and the files are
+// merged at the end.
+//
+// If maxBytes is not 0, buffers are also considered full when the memory
+// held by their records (see SortBuffer::bytes) reaches the budget. The
+// budget covers all of the buffers held at once (i.e., it is shared with
+// the in flight buffers described below). peakBytes() reports the most
+// memory held by buffered records at any time.
+//
+// With threads > 0, full buffers are sorted and written out on a pool of
+// that many threads while reading continues into a new buffer. At most
+// maxInFlight full buffers (each holding up to maxInMem records) are
+// waiting for or being handled by the pool at any time; reading blocks
+// when that limit is reached. The last buffer is sorted in parallel.
+//
+// If fanIn is not 0, no more than fanIn runs are merged at once (see
+// MergeCascade): runs are merged into larger intermediate runs as they
+// pile up and, if needed, at the end, so that the final merge reads from at
+// most fanIn sources. Merges of separate groups of runs go on the pool.
+//
+// Buffers keep track of the ascending runs their records arrive in and
+// merge those rather than sorting from scratch (see SortBuffer::sort).
+// records() and naturalRuns() tell how sorted the input was: sorted input
+// has one run per buffer.
+//
+// Runs are written to tmpDirs (the system temp directory if empty) round
+// robin. With asyncIO, each directory has an I/O thread that writes runs
+// and reads them ahead during merges (see SpillDirectories).
 template<typename StreamType, typename StreamOpener, typename OutputFunc>
 class Sort {
 public:
@@ -36,16 +72,46 @@ public:
             HeaderType& outputHeader,
             uint64_t maxInMem,
             bool stable,
-            CompressionType compression = NONE
+            CompressionType compression = NONE,
+            std::size_t threads = 0,
+            std::size_t maxInFlight = 0,
+            uint64_t maxBytes = 0,
+            std::size_t fanIn = 0,
+            std::vector<std::string> const& tmpDirs = std::vector<std::string>(),
+            bool asyncIO = false
         )
         : _inputs(inputs)
         , _streamOpener(streamOpener)
         , _out(out)
         , _outputHeader(outputHeader)
+        , _spillDirs(tmpDirs, asyncIO)
         , _maxInMem(maxInMem)
         , _stable(stable)
         , _compression(compression)
+        , _maxInFlight(maxInFlight > 0 ? maxInFlight : threads)
+        , _maxBufferBytes(maxBytes / (threads > 0 ? _maxInFlight + 1 : 1))
+        , _pendingBytes(0)
+        , _peakBytes(0)
+        , _records(0)
+        , _naturalRuns(0)
+        , _cascade(fanIn)
     {
+        if (threads > 0)
+            _pool = std::make_unique<ThreadPool>(threads);
+        if (maxBytes > 0 && _maxBufferBytes == 0)
+            _maxBufferBytes = 1;
+    }
+
+    uint64_t peakBytes() const {
+        return _peakBytes;
+    }
+
+    uint64_t records() const {
+        return _records;
+    }
+
+    uint64_t naturalRuns() const {
+        return _naturalRuns;
     }
 
     void execute() {
@@ -62,30 +128,160 @@ public:
                     break;
                 }
                 buf->push_back(vptr);
-                if (buf->size() >= _maxInMem) {
-                    buf->sort();
-                    buf->writeTmp();
-                    _buffers.push_back(std::move(buf));
+                _peakBytes = std::max(_peakBytes, _pendingBytes + buf->bytes());
+                if (buf->size() >= _maxInMem
+                    || (_maxBufferBytes > 0 && buf->bytes() >= _maxBufferBytes))
+                {
+                    spill(std::move(buf));
                     buf.reset(new BufferType(_streamOpener, _outputHeader,
                         _stable, _compression));
                 }
             }
         }
 
+        waitForSpills(0);
+        count(*buf);
+        buf->sort(_pool.get());
         if (_buffers.empty()) {
-            buf->sort();
             buf->write(_out);
         } else {
-            if (!buf->empty()) {
-                buf->sort();
+            // the last buffer takes up one of the final merge's sources
+            std::size_t reserved = buf->empty() ? 0 : 1;
+            for (auto groups = _cascade.nextPass(_cascade.fanIn() - reserved);
+                !groups.empty();
+                groups = _cascade.nextPass(_cascade.fanIn() - reserved))
+            {
+                mergeRuns(groups);
+                waitForSpills(0);
+            }
+
+            if (!buf->empty())
                 _buffers.push_back(std::move(buf));
+            merge();
+        }
+    }
+
+protected:
+    struct SpillTask {
+        BufferType* buf;
+        SpillDirectories* dirs;
+
+        void operator()() {
+            buf->sort();
+            buf->writeTmp(*dirs);
+        }
+    };
+
+    // Merges the runs of sources into the (empty) buffer dest
+    struct MergeTask {
+        std::shared_ptr<std::vector<BufferPtr>> sources;
+        BufferType* dest;
+        SpillDirectories* dirs;
+        bool compress;
+
+        void operator()() {
+            std::vector<SpillRunReader*> runs;
+            for (auto i = sources->begin(); i != sources->end(); ++i)
+                runs.push_back(&(*i)->run());
+
+            SpillDirectories::File spill = dirs->create();
+            SpillRunWriter writer(spill.file->stream(), compress, spill.io);
+            mergeSpillRuns(runs, writer);
+            writer.close();
+            // close the inputs' temp files before opening the result
+            sources->clear();
+            dest->assignRun(std::move(spill));
+        }
+    };
+
+    struct PendingSpill {
+        std::future<void> done;
+        uint64_t bytes;
+    };
+
+    void spill(BufferPtr buf) {
+        SpillTask task = {buf.get(), &_spillDirs};
+        uint64_t bytes = buf->bytes();
+        count(*buf);
+        _buffers.push_back(std::move(buf));
+        if (!_pool) {
+            task();
+        }
+        else {
+            waitForSpills(_maxInFlight - 1);
+            PendingSpill pending = {_pool->submit(task), bytes};
+            _spills.push_back(std::move(pending));
+            _pendingBytes += bytes;
+        }
+
+        _cascade.add();
+        while (std::size_t n = _cascade.tailMerge()) {
+            // the runs to merge have to be written out first
+            waitForSpills(0);
+            std::size_t last = _buffers.size();
+            mergeRuns(std::vector<MergeCascade::Group>(
+                1, MergeCascade::Group(last - n, last)));
+        }
+    }
+
+    // Replaces each group of buffers with one holding their merged runs.
+    // The merges are done on the pool if there is one, waitForSpills()
+    // waits for them.
+    void mergeRuns(std::vector<MergeCascade::Group> const& groups) {
+        std::vector<MergeCascade::Group> sorted(groups);
+        std::sort(sorted.begin(), sorted.end());
+        for (auto g = sorted.rbegin(); g != sorted.rend(); ++g) {
+            auto first = _buffers.begin() + g->first;
+            auto last = _buffers.begin() + g->second;
+            auto sources = std::make_shared<std::vector<BufferPtr>>(
+                std::make_move_iterator(first), std::make_move_iterator(last));
+            _buffers.erase(first + 1, last);
+            _buffers[g->first].reset(new BufferType(_streamOpener, _outputHeader,
+                _stable, _compression));
+
+            MergeTask task = {sources, _buffers[g->first].get(), &_spillDirs,
+                _compression == GZIP};
+            if (!_pool) {
+                task();
             }
-            auto merger = makeMergeSorted(_buffers);
-            ValueType e;
-            while (merger.next(e)) {
-                _out(e);
+            else {
+                PendingSpill pending = {_pool->submit(task), 0};
+                _spills.push_back(std::move(pending));
             }
         }
+        _cascade.merged(groups);
+    }
+
+    void count(BufferType const& buf) {
+        _records += buf.size();
+        _naturalRuns += buf.naturalRuns();
+    }
+
+    // Wait until at most maxPending buffers are left to be spilled
+    void waitForSpills(std::size_t maxPending) {
+        while (_spills.size() > maxPending) {
+            PendingSpill spill = std::move(_spills.front());
+            _spills.pop_front();
+            _pendingBytes -= spill.bytes;
+            spill.done.get();
+        }
+    }
+
+    // Merges the buffers through a LoserTree on the key of their current
+    // record, ties going to the buffer that was filled first so that
+    // stable sorts stay stable
+    void merge() {
+        LoserTree<SortKey, CompareToLessThan<LocusCompare<>>> heads(_buffers.size());
+        for (std::size_t i = 0; i < _buffers.size(); ++i)
+            heads.set(i, _buffers[i]->first() ? &_buffers[i]->key() : 0);
+        heads.build();
+
+        while (!heads.done()) {
+            std::size_t idx = heads.top();
+            BufferType& buf = *_buffers[idx];
+            heads.set(idx, buf.writeNext(_out) ? &buf.key() : 0);
+            heads.replay(idx);
+        }
     }
 
 protected:
@@ -93,10 +289,23 @@ protected:
     StreamOpener& _streamOpener;
     OutputFunc& _out;
     HeaderType& _outputHeader;
+    // before _buffers so that I/O threads outlive the runs using them
+    SpillDirectories _spillDirs;
     std::vector<BufferPtr> _buffers;
     uint64_t _maxInMem;
     bool _stable;
     CompressionType _compression;
+    std::size_t _maxInFlight;
+    uint64_t _maxBufferBytes;
+    // memory held by buffers waiting to be spilled
+    uint64_t _pendingBytes;
+    uint64_t _peakBytes;
+    uint64_t _records;
+    uint64_t _naturalRuns;
+    // destroyed before _buffers so that running spills finish first
+    std::unique_ptr<ThreadPool> _pool;
+    std::deque<PendingSpill> _spills;
+    MergeCascade _cascade;
 };
 
 template<typename StreamType, typename StreamOpener, typename OutputFunc>
@@ -108,6 +317,12 @@ typename Sort<StreamType, StreamOpener, OutputFunc>::ptr makeSort(
         , uint64_t maxInMem
         , bool stable
         , CompressionType compression = NONE
+        , std::size_t threads = 0
+        , std::size_t maxInFlight = 0
+        , uint64_t maxBytes = 0
+        , std::size_t fanIn = 0
+        , std::vector<std::string> const& tmpDirs = std::vector<std::string>()
+        , bool asyncIO = false
         )
 {
     return std::make_unique<Sort<StreamType, StreamOpener, OutputFunc>>(
@@ -118,5 +333,11 @@ typename Sort<StreamType, StreamOpener, OutputFunc>::ptr makeSort(
         , maxInMem
         , stable
         , compression
+        , threads
+        , maxInFlight
+        , maxBytes
+        , fanIn
+        , tmpDirs
+        , asyncIO
         );
 }
@@ -1,18 +1,25 @@
 #pragma once
 
+#include "SortKey.hpp"
+#include "SpillDirectories.hpp"
+#include "SpillRun.hpp"
 #include "common/LocusCompare.hpp"
+#include "common/MemoryUsage.hpp"
+#include "common/ParallelSort.hpp"
+#include "common/StringView.hpp"
+#include "common/compat.hpp"
+#include "common/traits.hpp"
 #include "io/TempFile.hpp"
 #include "io/InputStream.hpp"
 
-#include <boost/format.hpp>
-#include <boost/iostreams/filter/gzip.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
-
 #include <algorithm>
 #include <deque>
 #include <iterator>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 template<
           typename StreamType
@@ -25,8 +32,12 @@ public:
     typedef typename std::unique_ptr<StreamType> StreamPtr;
     typedef typename StreamType::ValueType ValueType;
     typedef typename ValueType::HeaderType HeaderType;
+    typedef typename StreamOpener::ParserType ParserType;
     typedef typename std::deque<ValueType*>::size_type size_type;
 
+    // Ascending runs shorter than this are sorted rather than merged
+    static size_type const MIN_RUN_LENGTH = 64;
+
     SortBuffer(
               StreamOpener& streamOpener
             , const HeaderType& h
@@ -38,7 +49,7 @@ public:
         , _header(h)
         , _stable(stable)
         , _compression(compression)
-        , _inputStream("anon", _in)
+        , _bytes(0)
         , _cmp(cmp)
     {}
 
@@ -48,14 +59,70 @@ public:
     }
 
     void push_back(ValueType* value) {
+        if (!_buf.empty() && _cmp(value, _buf.back()))
+            _runStarts.push_back(_buf.size());
         _buf.push_back(value);
+        _bytes += recordBytes(*value);
     }
 
-    void sort() {
-        if (_stable)
-            std::stable_sort(_buf.begin(), _buf.end(), _cmp);
-        else
-            std::sort(_buf.begin(), _buf.end(), _cmp);
+    // Memory held by the buffered records: the records themselves, what
+    // they allocate and their slots in the buffer
+    uint64_t bytes() const {
+        return _bytes;
+    }
+
+    static uint64_t recordBytes(ValueType const& value) {
+        return allocationBytes(sizeof(ValueType)) + heapBytes(value)
+            + sizeof(ValueType*);
+    }
+
+    // The number of ascending runs the records were pushed in (1 if they
+    // were already sorted)
+    size_type naturalRuns() const {
+        return _buf.empty() ? 0 : _runStarts.size() + 1;
+    }
+
+    // Sorts by merging the ascending runs the records came in. Stretches
+    // of short runs are sorted first, on the pool (if any) when there are
+    // enough records to make it worthwhile. Records that are already in
+    // order are left as they are, so sorted input takes linear time.
+    void sort(ThreadPool* pool = 0) {
+        if (_runStarts.empty())
+            return;
+
+        // start of each piece to merge, followed by the end of the buffer
+        std::vector<size_type> bounds(1, 0);
+        size_type runStart = 0;
+        for (std::size_t i = 0; i <= _runStarts.size(); ++i) {
+            size_type runEnd = i < _runStarts.size() ? _runStarts[i] : _buf.size();
+            if (runEnd - runStart >= MIN_RUN_LENGTH) {
+                if (bounds.back() != runStart) {
+                    sortRange(bounds.back(), runStart, pool);
+                    bounds.push_back(runStart);
+                }
+                bounds.push_back(runEnd);
+            }
+            runStart = runEnd;
+        }
+        if (bounds.back() != _buf.size()) {
+            sortRange(bounds.back(), _buf.size(), pool);
+            bounds.push_back(_buf.size());
+        }
+        _runStarts.clear();
+
+        // merge neighboring pieces until there is only one
+        while (bounds.size() > 2) {
+            std::vector<size_type> merged(1, 0);
+            std::size_t i = 0;
+            for (; i + 2 < bounds.size(); i += 2) {
+                std::inplace_merge(_buf.begin() + bounds[i],
+                    _buf.begin() + bounds[i + 1], _buf.begin() + bounds[i + 2], _cmp);
+                merged.push_back(bounds[i + 2]);
+            }
+            if (i + 1 < bounds.size())
+                merged.push_back(bounds.back());
+            bounds.swap(merged);
+        }
     }
 
     size_type size() const {
@@ -63,7 +130,7 @@ public:
     }
 
     bool empty() const {
-        return _buf.empty() && _stream.get() == NULL;
+        return _buf.empty() && _run.get() == NULL;
     }
 
     void write(OutputFunc& out) const {
@@ -71,78 +138,113 @@ public:
             out(**iter);
     }
 
-    void writeTmp() {
-        namespace io = boost::iostreams;
-
+    // Write the (sorted) buffer to a temporary file in one of dirs in the
+    // SpillRun format
+    void writeTmp(SpillDirectories& dirs) {
         if (_tmpfile.get() != NULL)
             throw std::runtime_error("Attempt to re-serialize sort buffer");
 
-        _tmpfile = TempFile::create(TempFile::ANON);
-
-        // data won't be flushed until filtering_stream goes out of scope
-        {
-            io::filtering_stream<io::output> out;
-            io::gzip_compressor gzip;
+        SpillDirectories::File spill = dirs.create();
+        _tmpfile = std::move(spill.file);
 
-            switch (_compression) {
-                case GZIP: out.push(gzip); break;
-                case NONE:
-                default:
-                    break;
-            }
-
-            out.push(_tmpfile->stream());
-            out << _header;
-            for (auto iter = _buf.begin(); iter != _buf.end(); ++iter) {
-                out << **iter << "\n";
-                delete *iter;
-            }
-            _buf.clear();
+        SpillRunWriter writer(_tmpfile->stream(), _compression == GZIP, spill.io);
+        SortKey key;
+        for (auto iter = _buf.begin(); iter != _buf.end(); ++iter) {
+            key.assign(**iter);
+            writer.add(key, **iter);
+            delete *iter;
         }
+        _buf.clear();
+        _runStarts.clear();
+        _bytes = 0;
+        writer.close();
 
         _tmpfile->stream().seekg(0);
+        _run = std::make_unique<SpillRunReader>(_tmpfile->stream(), spill.io);
+    }
 
-        switch (_compression) {
-            case GZIP: _in.push(_gzipDecompressor); break;
-            case NONE:
-            default:
-                break;
-        }
+    // The run of a buffer that was written out by writeTmp()
+    SpillRunReader& run() {
+        return *_run;
+    }
 
-        _in.push(_tmpfile->stream());
+    // Make the buffer hold a run (e.g., several others merged together)
+    // written to spill, in place of records. Used by cascading merges.
+    void assignRun(SpillDirectories::File spill) {
+        if (_tmpfile.get() != NULL || !_buf.empty())
+            throw std::runtime_error("Attempt to assign a run to a non empty sort buffer");
 
-        _stream = _streamOpener(_inputStream);
+        _tmpfile = std::move(spill.file);
+        _tmpfile->stream().seekg(0);
+        _run = std::make_unique<SpillRunReader>(_tmpfile->stream(), spill.io);
     }
 
-    bool peek(ValueType** v) {
-        if (_stream.get() != NULL)
-            return _stream->peek(v);
+    // Merging: first() positions the buffer on its first record (returning
+    // false if there is none), key() is the sort key of the current
+    // record and writeNext() outputs it, returning false when there are no
+    // more records.
+    bool first() {
+        if (_run)
+            return _run->next();
 
         if (_buf.empty())
             return false;
 
-        *v = _buf[0];
+        _key.assign(*_buf.front());
         return true;
     }
 
-    bool next(ValueType& v) {
-        if (_stream.get() != NULL)
-            return _stream->next(v);
+    SortKey const& key() const {
+        return _run ? _run->key() : _key;
+    }
 
-        if (_buf.empty())
-            return false;
+    bool writeNext(OutputFunc& out) {
+        if (_run) {
+            writeRecord(out, _run->text(), RawOutput());
+            return _run->next();
+        }
 
-        v = *_buf[0];
-        delete _buf[0];
+        out(*_buf.front());
+        delete _buf.front();
         _buf.pop_front();
-        return true;
+        return first();
     }
 
-    bool eof() const {
-        if (_stream.get() != NULL)
-            return _stream->eof();
+protected:
+    void sortRange(size_type first, size_type last, ThreadPool* pool) {
+        auto begin = _buf.begin() + first;
+        auto end = _buf.begin() + last;
+        if (pool)
+            parallelSort(begin, end, _cmp, _stable, *pool);
+        else if (_stable)
+            std::stable_sort(begin, end, _cmp);
+        else
+            std::sort(begin, end, _cmp);
+    }
+
+    // Outputs that can take a record's text (e.g., DefaultPrinter) get it
+    // straight from the run, others get the record parsed again.
+    typedef std::integral_constant<bool,
+        traits::is_callable_with<OutputFunc, StringView>::value> RawOutput;
+    typedef std::integral_constant<bool,
+        traits::parses_line<ParserType, StringView>::value> ParsesView;
+
+    void writeRecord(OutputFunc& out, StringView const& text, std::true_type) {
+        out(text);
+    }
 
-        return _buf.empty();
+    void writeRecord(OutputFunc& out, StringView const& text, std::false_type) {
+        parseRecord(text, ParsesView());
+        out(_value);
+    }
+
+    void parseRecord(StringView const& text, std::true_type) {
+        _streamOpener.parser(&_header, text, _value);
+    }
+
+    void parseRecord(StringView const& text, std::false_type) {
+        _line.assign(text.begin(), text.end());
+        _streamOpener.parser(&_header, _line, _value);
     }
 
 protected:
@@ -151,12 +253,13 @@ protected:
     bool _stable;
     CompressionType _compression;
     std::deque<ValueType*> _buf;
+    // indices of records that were less than the one before them
+    std::vector<size_type> _runStarts;
+    uint64_t _bytes;
     TempFile::ptr _tmpfile;
-    StreamPtr _stream;
-
-    // for reading compressed tmp file
-    boost::iostreams::filtering_stream<boost::iostreams::input> _in;
-    boost::iostreams::gzip_decompressor _gzipDecompressor;
-    InputStream _inputStream;
+    std::unique_ptr<SpillRunReader> _run;
+    SortKey _key;
+    std::string _line;
+    ValueType _value;
     LessThanCmp _cmp;
 };
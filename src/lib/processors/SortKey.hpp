@@ -0,0 +1,72 @@
+#pragma once
+
+#include "common/ContigDictionary.hpp"
+#include "common/cstdint.hpp"
+
+#include <string>
+
+// The part of a record that Sort orders by: the same chrom/start/stop
+// triple that LocusCompare<> looks at, so the usual comparators work on
+// keys as well as on the records themselves.
+class SortKey {
+public:
+    SortKey()
+        : _start(0)
+        , _stop(0)
+    {}
+
+    SortKey(std::string const& chrom, int64_t start, int64_t stop)
+        : _chrom(chrom)
+        , _chromRank(ContigDictionary::instance().rank(chrom))
+        , _start(start)
+        , _stop(stop)
+    {}
+
+    template<typename ValueType>
+    void assign(ValueType const& value) {
+        _chrom = value.chrom();
+        _chromRank = contigRankOf(value);
+        _start = value.start();
+        _stop = value.stop();
+    }
+
+    void assign(
+            char const* chromBegin,
+            char const* chromEnd,
+            int64_t start,
+            int64_t stop)
+    {
+        _chrom.assign(chromBegin, chromEnd);
+        _chromRank = ContigDictionary::instance().rank(_chrom);
+        _start = start;
+        _stop = stop;
+    }
+
+    // Update the coordinates, keeping the current chromosome
+    void assign(int64_t start, int64_t stop) {
+        _start = start;
+        _stop = stop;
+    }
+
+    std::string const& chrom() const {
+        return _chrom;
+    }
+
+    ContigRank const& chromRank() const {
+        return _chromRank;
+    }
+
+    int64_t start() const {
+        return _start;
+    }
+
+    int64_t stop() const {
+        return _stop;
+    }
+
+private:
+    std::string _chrom;
+    ContigRank _chromRank;
+    int64_t _start;
+    int64_t _stop;
+};
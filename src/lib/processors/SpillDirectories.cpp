@@ -0,0 +1,25 @@
+#include "SpillDirectories.hpp"
+
+#include "common/compat.hpp"
+
+SpillDirectories::SpillDirectories(std::vector<std::string> const& dirs, bool asyncIO)
+    : _dirs(dirs)
+    , _next(0)
+{
+    if (_dirs.empty())
+        _dirs.push_back(TempFile::sys_tmpdir());
+
+    if (asyncIO) {
+        for (std::size_t i = 0; i < _dirs.size(); ++i)
+            _io.push_back(std::make_unique<ThreadPool>(1));
+    }
+}
+
+SpillDirectories::File SpillDirectories::create() {
+    std::size_t idx = _next++ % _dirs.size();
+    File rv = {
+        TempFile::create(_dirs[idx] + "/tmp.XXXXXX", TempFile::ANON),
+        _io.empty() ? 0 : _io[idx].get()
+    };
+    return rv;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "common/ThreadPool.hpp"
+#include "io/TempFile.hpp"
+
+#include <boost/noncopyable.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The directories an external sort writes its temporary runs to. Files are
+// created round robin across the directories so that several disks share
+// the I/O. With asyncIO, each directory gets a thread of its own for
+// reading and writing runs (see SpillRunWriter/SpillRunReader), so the
+// disks work in parallel with each other and with the sort.
+//
+// With no directories given, TempFile::sys_tmpdir() is used.
+class SpillDirectories : boost::noncopyable {
+public:
+    struct File {
+        TempFile::ptr file;
+        // I/O thread of the file's directory, 0 without asyncIO
+        ThreadPool* io;
+    };
+
+    explicit SpillDirectories(
+            std::vector<std::string> const& dirs = std::vector<std::string>(),
+            bool asyncIO = false);
+
+    // Creates an anonymous temporary file (it is gone once closed) in the
+    // next directory. Safe to call from several threads.
+    File create();
+
+    std::size_t size() const;
+
+private:
+    std::vector<std::string> _dirs;
+    std::vector<std::unique_ptr<ThreadPool>> _io;
+    std::atomic<std::size_t> _next;
+};
+
+inline std::size_t SpillDirectories::size() const {
+    return _dirs.size();
+}
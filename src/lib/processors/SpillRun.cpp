@@ -0,0 +1,283 @@
+#include "SpillRun.hpp"
+#include "LoserTree.hpp"
+
+#include "common/Exceptions.hpp"
+#include "common/LocusCompare.hpp"
+#include "common/RelOps.hpp"
+#include "common/cstdint.hpp"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    template<typename T>
+    void append(std::vector<char>& buf, T value) {
+        char const* p = reinterpret_cast<char const*>(&value);
+        buf.insert(buf.end(), p, p + sizeof(value));
+    }
+
+    void storeBlock(std::ostream& out, std::vector<char> const& block,
+        bool compress, std::vector<char>& compressed)
+    {
+        uint32_t size = block.size();
+        char const* stored = block.data();
+        uint32_t storedSize = size;
+
+        if (compress) {
+            uLongf len = compressBound(size);
+            compressed.resize(len);
+            int rv = compress2(reinterpret_cast<Bytef*>(compressed.data()), &len,
+                reinterpret_cast<Bytef const*>(block.data()), size, Z_BEST_SPEED);
+            // incompressible blocks are stored as they are
+            if (rv == Z_OK && len < size) {
+                stored = compressed.data();
+                storedSize = len;
+            }
+        }
+
+        out.write(reinterpret_cast<char const*>(&size), sizeof(size));
+        out.write(reinterpret_cast<char const*>(&storedSize), sizeof(storedSize));
+        out.write(stored, storedSize);
+        if (!out)
+            throw IOError("Failed to write sort run to temporary file");
+    }
+
+    // Returns false at the end of the run
+    bool loadBlock(std::istream& in, std::vector<char>& block,
+        std::vector<char>& compressed)
+    {
+        uint32_t header[2];
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (in.gcount() == 0 && in.eof())
+            return false;
+        if (in.gcount() != sizeof(header))
+            throw IOError("Truncated block in temporary sort run");
+
+        uint32_t size = header[0];
+        uint32_t storedSize = header[1];
+        block.resize(size);
+        if (storedSize == size) {
+            in.read(block.data(), size);
+            if (uint32_t(in.gcount()) != size)
+                throw IOError("Truncated block in temporary sort run");
+            return true;
+        }
+
+        compressed.resize(storedSize);
+        in.read(compressed.data(), storedSize);
+        if (uint32_t(in.gcount()) != storedSize)
+            throw IOError("Truncated block in temporary sort run");
+
+        uLongf len = size;
+        int rv = uncompress(reinterpret_cast<Bytef*>(block.data()), &len,
+            reinterpret_cast<Bytef const*>(compressed.data()), storedSize);
+        if (rv != Z_OK || len != size)
+            throw IOError("Failed to decompress temporary sort run");
+
+        return true;
+    }
+
+    struct StoreBlockTask {
+        std::ostream* out;
+        std::shared_ptr<std::vector<char>> block;
+        bool compress;
+
+        void operator()() {
+            std::vector<char> compressed;
+            storeBlock(*out, *block, compress, compressed);
+        }
+    };
+
+    struct LoadBlockTask {
+        std::istream* in;
+        std::shared_ptr<std::vector<char>> block;
+
+        bool operator()() {
+            std::vector<char> compressed;
+            return loadBlock(*in, *block, compressed);
+        }
+    };
+}
+
+std::size_t const SpillRunWriter::BLOCK_SIZE;
+std::size_t const SpillRunWriter::MAX_PENDING_BLOCKS;
+
+SpillRunWriter::SpillRunWriter(std::ostream& out, bool compress, ThreadPool* io)
+    : _out(out)
+    , _compress(compress)
+    , _io(io)
+    , _text(boost::iostreams::back_inserter(_block))
+    , _first(true)
+{
+    _block.reserve(BLOCK_SIZE);
+}
+
+SpillRunWriter::~SpillRunWriter() {
+    // the I/O thread must be done with the stream and blocks
+    for (auto i = _writes.begin(); i != _writes.end(); ++i)
+        i->wait();
+}
+
+std::size_t SpillRunWriter::beginRecord(SortKey const& key) {
+    if (_first || key.chrom() != _lastChrom) {
+        append<uint32_t>(_block, key.chrom().size());
+        _block.insert(_block.end(), key.chrom().begin(), key.chrom().end());
+        _lastChrom = key.chrom();
+        _first = false;
+    }
+    else {
+        append<uint32_t>(_block, 0);
+    }
+    append<int64_t>(_block, key.start());
+    append<int64_t>(_block, key.stop());
+
+    std::size_t lengthPos = _block.size();
+    append<uint32_t>(_block, 0);
+    return lengthPos;
+}
+
+void SpillRunWriter::endRecord(std::size_t lengthPos) {
+    uint32_t len = _block.size() - lengthPos - sizeof(uint32_t);
+    memcpy(&_block[lengthPos], &len, sizeof(len));
+    if (_block.size() >= BLOCK_SIZE)
+        writeBlock();
+}
+
+void SpillRunWriter::add(SortKey const& key, char const* first, char const* last) {
+    std::size_t lengthPos = beginRecord(key);
+    _block.insert(_block.end(), first, last);
+    endRecord(lengthPos);
+}
+
+void SpillRunWriter::writeBlock() {
+    if (_block.empty())
+        return;
+
+    if (!_io) {
+        storeBlock(_out, _block, _compress, _compressed);
+        _block.clear();
+        return;
+    }
+
+    waitForWrites(MAX_PENDING_BLOCKS - 1);
+    auto block = std::make_shared<std::vector<char>>();
+    block->swap(_block);
+    _block.reserve(BLOCK_SIZE);
+    StoreBlockTask task = {&_out, block, _compress};
+    _writes.push_back(_io->submit(task));
+}
+
+void SpillRunWriter::waitForWrites(std::size_t maxPending) {
+    while (_writes.size() > maxPending) {
+        std::future<void> write = std::move(_writes.front());
+        _writes.pop_front();
+        write.get();
+    }
+}
+
+void SpillRunWriter::close() {
+    writeBlock();
+    waitForWrites(0);
+    _out.flush();
+    if (!_out)
+        throw IOError("Failed to write sort run to temporary file");
+}
+
+
+SpillRunReader::SpillRunReader(std::istream& in, ThreadPool* io)
+    : _in(in)
+    , _io(io)
+    , _pos(0)
+{
+}
+
+SpillRunReader::~SpillRunReader() {
+    if (_prefetch.valid())
+        _prefetch.wait();
+}
+
+void SpillRunReader::prefetch() {
+    if (!_next)
+        _next = std::make_shared<std::vector<char>>();
+    LoadBlockTask task = {&_in, _next};
+    _prefetch = _io->submit(task);
+}
+
+bool SpillRunReader::readBlock() {
+    bool loaded;
+    if (!_io) {
+        loaded = loadBlock(_in, _block, _compressed);
+    }
+    else {
+        if (!_prefetch.valid())
+            prefetch();
+
+        loaded = _prefetch.get();
+        if (loaded) {
+            _block.swap(*_next);
+            prefetch();
+        }
+    }
+
+    _pos = 0;
+    if (!loaded)
+        _block.clear();
+    return loaded;
+}
+
+void SpillRunReader::read(void* dst, std::size_t len) {
+    if (_block.size() - _pos < len)
+        throw std::runtime_error("Corrupt record in temporary sort run");
+    memcpy(dst, &_block[_pos], len);
+    _pos += len;
+}
+
+bool SpillRunReader::next() {
+    if (_pos >= _block.size() && !readBlock())
+        return false;
+
+    uint32_t chromLen;
+    read(&chromLen, sizeof(chromLen));
+    char const* chrom = 0;
+    if (chromLen > 0) {
+        if (_block.size() - _pos < chromLen)
+            throw std::runtime_error("Corrupt record in temporary sort run");
+        chrom = &_block[_pos];
+        _pos += chromLen;
+    }
+
+    int64_t pos[2];
+    read(pos, sizeof(pos));
+    if (chrom)
+        _key.assign(chrom, chrom + chromLen, pos[0], pos[1]);
+    else
+        _key.assign(pos[0], pos[1]);
+
+    uint32_t textLen;
+    read(&textLen, sizeof(textLen));
+    if (_block.size() - _pos < textLen)
+        throw std::runtime_error("Corrupt record in temporary sort run");
+
+    char const* text = _block.data() + _pos;
+    _text.assign(text, text + textLen);
+    _pos += textLen;
+    return true;
+}
+
+
+void mergeSpillRuns(std::vector<SpillRunReader*> const& runs, SpillRunWriter& out) {
+    LoserTree<SortKey, CompareToLessThan<LocusCompare<>>> heads(runs.size());
+    for (std::size_t i = 0; i < runs.size(); ++i)
+        heads.set(i, runs[i]->next() ? &runs[i]->key() : 0);
+    heads.build();
+
+    while (!heads.done()) {
+        std::size_t idx = heads.top();
+        SpillRunReader& run = *runs[idx];
+        out.add(run.key(), run.text().begin(), run.text().end());
+        heads.set(idx, run.next() ? &run.key() : 0);
+        heads.replay(idx);
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "SortKey.hpp"
+#include "common/StringView.hpp"
+#include "common/ThreadPool.hpp"
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Binary format for the sorted runs Sort writes to temporary files.
+//
+// Each record is stored as its SortKey followed by the record's text (as
+// written by operator<<, without a newline) so that runs can be merged by
+// comparing keys only and the text copied to the output untouched.
+//
+// Records are packed into blocks, optionally compressed with zlib at its
+// fastest setting. A block is: uint32 data size, uint32 stored size (the
+// same as the data size if the block is not compressed), stored bytes. A
+// record is: uint32 chromosome length (0 if it is the same as that of the
+// previous record), chromosome, int64 start, int64 stop, uint32 text
+// length, text. Integers are in host byte order since runs never outlive
+// the process that wrote them.
+//
+// Given an I/O thread (a ThreadPool of one thread), the writer compresses
+// and writes full blocks on it while the caller goes on filling the next
+// ones, and the reader reads the block after the current one ahead of
+// time. A stream must only be used with one I/O thread.
+class SpillRunWriter {
+public:
+    // Blocks are written once they reach this size
+    static std::size_t const BLOCK_SIZE = 256 * 1024;
+    // Blocks that can be waiting for the I/O thread before add() blocks
+    static std::size_t const MAX_PENDING_BLOCKS = 4;
+
+    SpillRunWriter(std::ostream& out, bool compress, ThreadPool* io = 0);
+    ~SpillRunWriter();
+
+    void add(SortKey const& key, char const* first, char const* last);
+
+    template<typename ValueType>
+    void add(SortKey const& key, ValueType const& value) {
+        std::size_t lengthPos = beginRecord(key);
+        _text << value;
+        _text.flush();
+        endRecord(lengthPos);
+    }
+
+    // Write out the last block
+    void close();
+
+private:
+    std::size_t beginRecord(SortKey const& key);
+    void endRecord(std::size_t lengthPos);
+    void writeBlock();
+    void waitForWrites(std::size_t maxPending);
+
+private:
+    std::ostream& _out;
+    bool _compress;
+    ThreadPool* _io;
+    std::deque<std::future<void>> _writes;
+    std::vector<char> _block;
+    std::vector<char> _compressed;
+    boost::iostreams::stream<
+        boost::iostreams::back_insert_device<std::vector<char>>> _text;
+    std::string _lastChrom;
+    bool _first;
+};
+
+class SpillRunReader {
+public:
+    explicit SpillRunReader(std::istream& in, ThreadPool* io = 0);
+    ~SpillRunReader();
+
+    SpillRunReader(SpillRunReader const&) = delete;
+    SpillRunReader& operator=(SpillRunReader const&) = delete;
+
+    // Move on to the next record, returns false at the end of the run
+    bool next();
+
+    // The current record
+    SortKey const& key() const;
+    StringView const& text() const;
+
+private:
+    bool readBlock();
+    void prefetch();
+    void read(void* dst, std::size_t len);
+
+private:
+    std::istream& _in;
+    ThreadPool* _io;
+    // the block being read ahead of time on the I/O thread
+    std::shared_ptr<std::vector<char>> _next;
+    std::future<bool> _prefetch;
+    std::vector<char> _block;
+    std::vector<char> _compressed;
+    std::size_t _pos;
+    SortKey _key;
+    StringView _text;
+};
+
+// Merges runs into one, writing to out (which is not closed). Records
+// with equal keys are written in the order of their runs, so merging
+// neighboring runs of a stable sort keeps it stable. The readers must
+// not have been advanced yet.
+void mergeSpillRuns(std::vector<SpillRunReader*> const& runs, SpillRunWriter& out);
+
+inline SortKey const& SpillRunReader::key() const {
+    return _key;
+}
+
+inline StringView const& SpillRunReader::text() const {
+    return _text;
+}
@@ -87,14 +87,27 @@ void VcfGenotypeMatcher::collectEntry(size_t entryIdx) {
         if (shouldSkip(fileIdx, filtered))
             continue;
 
-        GenotypeCall const& call = sampleData.genotype(sampleIdx);
-        if (call == GenotypeCall::Null || (!includeRefAlleles_ && call.reference()))
-            continue;
+        Vcf::GenotypeIndex packedIndices[Vcf::PackedGenotype::MAX_PLOIDY];
+        Vcf::GenotypeIndex const* indicesBegin = packedIndices;
+        Vcf::GenotypeIndex const* indicesEnd;
+        Vcf::PackedGenotype packed = sampleData.packedGenotype(sampleIdx);
+        if (packed.packed()) {
+            if (packed.empty() || (!includeRefAlleles_ && packed.reference()))
+                continue;
+            indicesEnd = packedIndices + packed.indices(packedIndices);
+        }
+        else {
+            GenotypeCall const& call = sampleData.genotype(sampleIdx);
+            if (!includeRefAlleles_ && call.reference())
+                continue;
+            indicesBegin = call.indices().data();
+            indicesEnd = indicesBegin + call.size();
+        }
 
         // FIXME: try to copy the RawVariants less
         RawVariant::Vector gtvec;
         bool hasNull = false;
-        for (auto idx = call.indices().begin(); idx != call.indices().end(); ++idx) {
+        for (auto idx = indicesBegin; idx != indicesEnd; ++idx) {
             if (*idx == Vcf::GenotypeIndex::Null) {
                 gtvec.push_back(new RawVariant(RawVariant::None));
                 hasNull = true;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/ContigDictionary.hpp"
 #include "common/CoordinateView.hpp"
 #include "common/LocusCompare.hpp"
 #include "common/Region.hpp"
@@ -80,7 +81,10 @@ public:
 
 private:
     bool overlaps(ValueType const& entry) {
-        if (!sequence_.empty() && coordView_.chrom(entry) == sequence_) {
+        if (!sequence_.empty() && ContigDictionary::same(
+                coordView_.chrom(entry), coordView_.chromRank(entry),
+                sequence_, sequenceRank_))
+        {
             Region r{coordView_.start(entry), coordView_.stop(entry)};
             return region_.overlap(r) > 0;
         }
@@ -89,6 +93,7 @@ private:
 
     void assignRegion(ValueType const& entry) {
         sequence_ = coordView_.chrom(entry);
+        sequenceRank_ = coordView_.chromRank(entry);
         region_.begin = coordView_.start(entry);
         region_.end = coordView_.stop(entry);
     }
@@ -100,6 +105,7 @@ private:
     EndFunc endFunc_;
 
     std::string sequence_;
+    ContigRank sequenceRank_;
     Region region_;
     ValuePtrVector bundle_;
 };
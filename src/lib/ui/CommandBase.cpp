@@ -15,6 +15,11 @@ using namespace std;
 
 CommandBase::CommandBase()
     : _optionsParsed(false)
+    , _decompressThreads(0)
+    , _readAhead(0)
+    , _outputCompression("auto")
+    , _compressThreads(0)
+    , _outputIndex("none")
 {
 }
 
@@ -28,6 +33,31 @@ void CommandBase::parseCommandLine(std::vector<std::string> const& args) {
 
     _opts.add_options()
         ("help,h", "this message")
+
+        ("decompress-threads",
+            po::value<uint32_t>(&_decompressThreads)->default_value(_decompressThreads),
+            "number of threads to use for decompressing bgzip'd input files "
+            "(0 = read inputs on the main thread)")
+
+        ("read-ahead",
+            po::value<uint32_t>(&_readAhead)->default_value(_readAhead),
+            "number of chunks of each input file to read ahead on a "
+            "background thread (0 = read inputs on demand)")
+
+        ("output-compression",
+            po::value<std::string>(&_outputCompression)->default_value(_outputCompression),
+            "compression for output files: auto (bgzf for files ending in "
+            ".gz), none, or bgzf")
+
+        ("compress-threads",
+            po::value<uint32_t>(&_compressThreads)->default_value(_compressThreads),
+            "number of threads to use for compressing bgzf output "
+            "(0 = compress on the main thread)")
+
+        ("output-index",
+            po::value<std::string>(&_outputIndex)->default_value(_outputIndex),
+            "write an index next to bgzf compressed, sorted .vcf.gz or "
+            ".bed.gz output files: none, tbi, or csi")
         ;
 
     configureOptions();
@@ -53,6 +83,12 @@ void CommandBase::parseCommandLine(std::vector<std::string> const& args) {
     }
 
     checkHelp();
+    _streams.decompressThreads(_decompressThreads);
+    _streams.readAhead(_readAhead);
+    _streams.outputCompression(
+        StreamHandler::outputCompressionFromString(_outputCompression));
+    _streams.compressThreads(_compressThreads);
+    _streams.outputIndex(StreamHandler::outputIndexFromString(_outputIndex));
     finalizeOptions();
 }
 
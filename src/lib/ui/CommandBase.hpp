@@ -51,5 +51,10 @@ protected:
     boost::program_options::positional_options_description _posOpts;
     std::unique_ptr<boost::program_options::parsed_options> _parsedArgs;
     boost::program_options::variables_map _varMap;
+    uint32_t _decompressThreads;
+    uint32_t _readAhead;
+    std::string _outputCompression;
+    uint32_t _compressThreads;
+    std::string _outputIndex;
     StreamHandler _streams;
 };
@@ -79,6 +79,12 @@ void IntersectCommand::configureOptions() {
         ("adjacent-insertions",
             po::bool_switch(&_adjacentInsertions),
             "count insertions adjacent to other regions as intersecting")
+
+        ("region,r",
+            po::value<vector<string>>(&_regions),
+            "restrict input to records overlapping region seq[:begin[-end]] "
+            "(1-based, inclusive; may be specified multiple times, inputs "
+            "must be bgzip'd and indexed)")
         ;
 
     _posOpts.add("file-a", 1);
@@ -142,11 +148,11 @@ void IntersectCommand::exec() {
     // the outputFormatter!
     unsigned extraFieldsA = max(1u, outputFormatter.extraFields(0));
     unsigned extraFieldsB = max(1u, outputFormatter.extraFields(1));
-    InputStream::ptr inStreamA(_streams.openForReading(_fileA));
+    InputStream::ptr inStreamA(_streams.openForReading(_fileA, _regions));
     BedReader::ptr readerPtrA = openBed(*inStreamA, extraFieldsA);
     auto& fa = *readerPtrA;
 
-    InputStream::ptr inStreamB(_streams.openForReading(_fileB));
+    InputStream::ptr inStreamB(_streams.openForReading(_fileB, _regions));
     BedReader::ptr readerPtrB = openBed(*inStreamB, extraFieldsB);
     auto& fb = *readerPtrB;
 
@@ -3,6 +3,7 @@
 #include "ui/CommandBase.hpp"
 
 #include <string>
+#include <vector>
 
 class IntersectCommand : public CommandBase {
 public:
@@ -24,6 +25,7 @@ protected:
     std::string _missFileB;
     std::string _outputFile;
     std::string _formatString;
+    std::vector<std::string> _regions;
     bool _firstOnly;
     bool _outputBoth;
     bool _exactPos;
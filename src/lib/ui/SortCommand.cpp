@@ -10,11 +10,15 @@
 #include "fileformats/vcf/Header.hpp"
 #include "io/InputStream.hpp"
 #include "processors/BedDeduplicator.hpp"
+#include "processors/RawSort.hpp"
 #include "processors/Sort.hpp"
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/format.hpp>
 #include <boost/program_options.hpp>
+#include <cstdlib>
 #include <functional>
+#include <iostream>
 #include <stdexcept>
 
 namespace po = boost::program_options;
@@ -24,9 +28,16 @@ using namespace std;
 SortCommand::SortCommand()
     : _outputFile("-")
     , _maxInMem(1000000)
+    , _maxMem(0)
     , _mergeOnly(false)
     , _stable(false)
     , _unique(false)
+    , _raw(false)
+    , _sortThreads(0)
+    , _inFlightBuffers(0)
+    , _mergeFanIn(256)
+    , _stats(false)
+    , _syncIO(false)
 {
 }
 
@@ -50,23 +61,114 @@ void SortCommand::configureOptions() {
             po::value<uint64_t>(&_maxInMem)->default_value(_maxInMem),
             "maximum number of lines to hold in memory at once")
 
+        ("max-mem",
+            po::value<string>(&_maxMemString)->default_value(""),
+            "maximum amount of memory to use for buffered records, in bytes "
+            "or with a K, M, G or T suffix (e.g., 8G). applies in addition to "
+            "--max-mem-lines. the peak amount used is reported at the end")
+
         ("stable,s",
             po::bool_switch(&_stable),
             "perform a 'stable' sort (default=false)")
 
         ("compression,C",
             po::value<string>(&_compressionString)->default_value(""),
-            "type of compression to use for temp files, n=none, g=gzip. default=n")
+            "type of compression to use for temp files, n=none, g=zlib. default=n")
+
+        ("sort-threads",
+            po::value<uint32_t>(&_sortThreads)->default_value(_sortThreads),
+            "number of threads to use for sorting and writing temp files "
+            "while input is being read (0 = sort on the main thread)")
+
+        ("in-flight-buffers",
+            po::value<uint32_t>(&_inFlightBuffers)->default_value(_inFlightBuffers),
+            "maximum number of full buffers (of up to --max-mem-lines lines "
+            "each) waiting to be sorted and written when --sort-threads is "
+            "used (0 = same as --sort-threads)")
+
+        ("merge-fan-in",
+            po::value<uint32_t>(&_mergeFanIn)->default_value(_mergeFanIn),
+            "maximum number of temp files to merge at once. when there are "
+            "more, they are merged into larger intermediate files first "
+            "(0 = no limit)")
+
+        ("tmp-dir",
+            po::value<vector<string>>(&_tmpDirs),
+            "directory for temp files (default: $TMPDIR or /tmp). may be "
+            "specified multiple times to spread temp files over several "
+            "disks")
+
+        ("sync-io",
+            po::bool_switch(&_syncIO),
+            "write and read temp files on the sorting threads rather than "
+            "on a background thread per temp directory")
+
+        ("stats",
+            po::bool_switch(&_stats),
+            "report how sorted the input was (the number of records and of "
+            "ascending runs they came in, per buffer) on stderr")
 
         ("unique,u",
             po::bool_switch(&_unique),
             "print only unique entries (bed format only)")
+
+        ("raw",
+            po::bool_switch(&_raw),
+            "sort data lines by their position only, without parsing them "
+            "into records, and write them out unchanged. the sort is always "
+            "stable. vcf inputs must all have the same samples in the same "
+            "order. cannot be used with --unique or --sort-threads")
+
+        ("region,r",
+            po::value<vector<string>>(&_regions),
+            "restrict input to records overlapping region seq[:begin[-end]] "
+            "(1-based, inclusive; may be specified multiple times, inputs "
+            "must be bgzip'd and indexed)")
         ;
 
     _posOpts.add("input-file", -1);
 }
 
 namespace {
+    // "1024", "64K", "8G", ... (powers of 1024), empty means 0
+    uint64_t parseByteCount(string const& value) {
+        if (value.empty())
+            return 0;
+
+        char* end = 0;
+        double count = strtod(value.c_str(), &end);
+        string suffix = boost::to_upper_copy(string(end));
+        uint64_t scale = 1;
+        if (suffix == "K" || suffix == "KB")
+            scale = 1ull << 10;
+        else if (suffix == "M" || suffix == "MB")
+            scale = 1ull << 20;
+        else if (suffix == "G" || suffix == "GB")
+            scale = 1ull << 30;
+        else if (suffix == "T" || suffix == "TB")
+            scale = 1ull << 40;
+        else if (!suffix.empty() && suffix != "B")
+            end = 0;
+
+        if (end == 0 || end == value.c_str() || count < 0)
+            throw runtime_error(str(format("Invalid memory size: %1%") % value));
+
+        return uint64_t(count * scale);
+    }
+
+    template<typename SortPtr>
+    void runSort(SortPtr const& sorter, uint64_t maxMem, bool stats) {
+        sorter->execute();
+        if (maxMem > 0) {
+            cerr << format("Peak memory used by sort buffers: %1% bytes\n")
+                % sorter->peakBytes();
+        }
+        if (stats) {
+            cerr << format("Sorted %1% records found in %2% ascending runs\n")
+                % sorter->records() % sorter->naturalRuns();
+        }
+    }
+
     bool isEmpty(const InputStream::ptr& stream) {
         return inferFileType(*stream) == EMPTY;
     }
@@ -100,12 +202,38 @@ namespace {
 
         return type;
     }
+
+    template<typename OutputFunc>
+    void runRawSort(
+            vector<InputStream::ptr> const& inputStreams,
+            FileType type,
+            OutputFunc& out,
+            uint64_t maxInMem,
+            uint64_t maxMem,
+            CompressionType compression,
+            std::size_t fanIn,
+            vector<string> const& tmpDirs,
+            bool asyncIO,
+            bool stats)
+    {
+        auto sorter = makeRawSort(
+            inputStreams, type, out, maxInMem, maxMem, compression == GZIP, fanIn,
+            tmpDirs, asyncIO);
+        runSort(sorter, maxMem, stats);
+    }
 }
 
 void SortCommand::exec() {
     CompressionType compression = compressionTypeFromString(_compressionString);
+    _maxMem = parseByteCount(_maxMemString);
+    if (_mergeFanIn == 1)
+        throw runtime_error("--merge-fan-in must be at least 2");
+    if (_raw && _unique)
+        throw runtime_error("--raw cannot be used with --unique");
+    if (_raw && _sortThreads > 0)
+        throw runtime_error("--raw cannot be used with --sort-threads");
 
-    vector<InputStream::ptr> inputStreams = _streams.openForReading(_filenames);
+    vector<InputStream::ptr> inputStreams = _streams.openForReading(_filenames, _regions);
     FileType type = detectFormat(inputStreams);
     ostream* out = _streams.get<ostream>(_outputFile);
     if (_streams.cinReferences() > 1)
@@ -120,27 +248,42 @@ void SortCommand::exec() {
         TypedStreamFactory<DefaultParser<ChromPos>> readerFactory;
         auto readers = readerFactory(inputStreams);
         ChromPosHeader hdr;
+        if (_raw) {
+            runRawSort(inputStreams, type, writer, _maxInMem, _maxMem,
+                compression, _mergeFanIn, _tmpDirs, !_syncIO, _stats);
+            return;
+        }
 
         auto sorter = makeSort(
-            readers, readerFactory, writer, hdr, _maxInMem, _stable, compression);
-        sorter->execute();
+            readers, readerFactory, writer, hdr, _maxInMem, _stable, compression,
+            _sortThreads, _inFlightBuffers, _maxMem, _mergeFanIn,
+            _tmpDirs, !_syncIO);
+        runSort(sorter, _maxMem, _stats);
     } else if (type == BED) {
         int extraFields = _unique ? 1 : 0;
         TypedStreamFactory<BedParser> readerFactory{extraFields};
         auto readers = readerFactory(inputStreams);
         BedHeader hdr;
-        if (_unique) {
+        if (_raw) {
+            runRawSort(inputStreams, type, writer, _maxInMem, _maxMem,
+                compression, _mergeFanIn, _tmpDirs, !_syncIO, _stats);
+        }
+        else if (_unique) {
             auto output = BedDeduplicator<DefaultPrinter>(writer);
             auto sorter = makeSort(
-                readers, readerFactory, output, hdr, _maxInMem, _stable, compression
+                readers, readerFactory, output, hdr, _maxInMem, _stable, compression,
+                _sortThreads, _inFlightBuffers, _maxMem, _mergeFanIn,
+                _tmpDirs, !_syncIO
                 );
-            sorter->execute();
+            runSort(sorter, _maxMem, _stats);
         }
         else {
             auto sorter = makeSort(
-                readers, readerFactory, writer, hdr, _maxInMem, _stable, compression
+                readers, readerFactory, writer, hdr, _maxInMem, _stable, compression,
+                _sortThreads, _inFlightBuffers, _maxMem, _mergeFanIn,
+                _tmpDirs, !_syncIO
                 );
-            sorter->execute();
+            runSort(sorter, _maxMem, _stats);
         }
 
     } else if (type == VCF) {
@@ -154,9 +297,26 @@ void SortCommand::exec() {
 
         *out << hdr;
 
+        if (_raw) {
+            // lines are written unchanged, so their sample columns must
+            // already match the merged header
+            for (auto i = readers.begin(); i != readers.end(); ++i) {
+                if ((*i)->header().sampleNames() != hdr.sampleNames()) {
+                    throw runtime_error(str(format(
+                        "--raw requires all vcf inputs to have the same samples, "
+                        "%1% differs") % (*i)->name()));
+                }
+            }
+            runRawSort(inputStreams, type, writer, _maxInMem, _maxMem,
+                compression, _mergeFanIn, _tmpDirs, !_syncIO, _stats);
+            return;
+        }
+
         auto sorter = makeSort(
-              readers, readerFactory, writer, hdr, _maxInMem, _stable, compression);
-        sorter->execute();
+              readers, readerFactory, writer, hdr, _maxInMem, _stable, compression,
+            _sortThreads, _inFlightBuffers, _maxMem, _mergeFanIn,
+            _tmpDirs, !_syncIO);
+        runSort(sorter, _maxMem, _stats);
     } else {
         throw runtime_error("Unknown file type!");
     }
@@ -21,9 +21,19 @@ public:
 protected:
     std::string _outputFile;
     std::vector<std::string> _filenames;
+    std::vector<std::string> _regions;
+    std::vector<std::string> _tmpDirs;
     uint64_t _maxInMem;
+    uint64_t _maxMem;
     bool _mergeOnly;
     bool _stable;
     bool _unique;
+    bool _raw;
+    uint32_t _sortThreads;
+    uint32_t _inFlightBuffers;
+    uint32_t _mergeFanIn;
+    bool _stats;
+    bool _syncIO;
     std::string _compressionString;
+    std::string _maxMemString;
 };
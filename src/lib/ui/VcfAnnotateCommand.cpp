@@ -53,6 +53,12 @@ void VcfAnnotateCommand::configureOptions() {
         ("no-identifiers",
             po::bool_switch(&_noIdents),
             "do not copy identifiers from the annotation file")
+
+        ("region,r",
+            po::value<vector<string>>(&_regions),
+            "restrict input to records overlapping region seq[:begin[-end]] "
+            "(1-based, inclusive; may be specified multiple times, inputs "
+            "must be bgzip'd and indexed)")
         ;
 
     _posOpts.add("input-file", 1);
@@ -121,7 +127,7 @@ void VcfAnnotateCommand::postProcessArguments(Vcf::Header& header, Vcf::Header c
 
 void VcfAnnotateCommand::exec() {
     std::vector<std::string> filenames{_vcfFile, _annoFile};
-    vector<InputStream::ptr> inputStreams = _streams.openForReading(filenames);
+    vector<InputStream::ptr> inputStreams = _streams.openForReading(filenames, _regions);
     auto readers = openStreams<Vcf::Entry>(inputStreams);
 
 
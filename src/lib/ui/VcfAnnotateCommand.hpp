@@ -33,6 +33,7 @@ protected:
     std::string _annoFile;
     std::string _outputFile;
     std::vector<std::string> _infoFields;
+    std::vector<std::string> _regions;
     bool _noIdents;
     bool _noInfo;
 
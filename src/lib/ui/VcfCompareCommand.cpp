@@ -228,7 +228,7 @@ void VcfCompareCommand::exec() {
             bfs::path name(streamNames_[i]);
             outputFiles.push_back(str(format("%1%/%2%-%3%") % outputDir_ % i % name.leaf().string()));
         }
-        entryWriter = std::make_unique<Vcf::MultiWriter>(outputFiles);
+        entryWriter = std::make_unique<Vcf::MultiWriter>(outputFiles, _streams);
 
         entryCb = boost::bind(&Vcf::MultiWriter::write, *entryWriter, _1);
         std::cerr << "Writing output to " << outputDir_ << "\n";
@@ -15,6 +15,7 @@ VcfFilterCommand::VcfFilterCommand()
     : _infile("-")
     , _outputFile("-")
     , _minDepth(0)
+    , _parseThreads(0)
 {
 }
 
@@ -31,6 +32,11 @@ void VcfFilterCommand::configureOptions() {
         ("min-depth,d",
             po::value<uint32_t>(&_minDepth)->default_value(0),
             "minimum depth")
+
+        ("parse-threads",
+            po::value<uint32_t>(&_parseThreads)->default_value(_parseThreads),
+            "number of threads to parse input records on (0 = parse on the "
+            "main thread)")
         ;
 
     _posOpts.add("input-file", -1);
@@ -44,6 +50,12 @@ void VcfFilterCommand::exec() {
 
     DefaultPrinter writer(*out);
     auto reader = openStream<Vcf::Entry>(instream);
+    // only depth and genotypes are looked at, the rest is passed through
+    Vcf::ReaderOptions readerOptions;
+    readerOptions.formatFields = {"GT", "DP"};
+    reader->header().readerOptions(readerOptions);
+    if (_parseThreads > 0)
+        reader->parallel(_parseThreads, Vcf::ParseSampleData());
     Vcf::Entry e;
     *out << reader->header();
     while (reader->next(e)) {
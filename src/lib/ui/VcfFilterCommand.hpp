@@ -20,4 +20,5 @@ protected:
     std::string _infile;
     std::string _outputFile;
     uint32_t _minDepth;
+    uint32_t _parseThreads;
 };
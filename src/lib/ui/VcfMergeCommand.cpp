@@ -98,6 +98,12 @@ void VcfMergeCommand::configureOptions() {
             po::bool_switch(&_allowSameFile)->default_value(false),
             "Allow merging entries from the same file")
 
+        ("region,r",
+            po::value<vector<string>>(&_regions),
+            "restrict input to records overlapping region seq[:begin[-end]] "
+            "(1-based, inclusive; may be specified multiple times, inputs "
+            "must be bgzip'd and indexed)")
+
         ("reject-filter-name",
             po::value<string>(&_rejectFilter)->default_value("MERGE_REJECT"),
             "The name of the filter to apply to entries rejected by the merger")
@@ -202,7 +208,7 @@ void VcfMergeCommand::exec() {
         normalizer = std::make_unique<Vcf::AltNormalizer>(*ref);
     }
 
-    vector<InputStream::ptr> inputStreams = _streams.openForReading(_filenames);
+    vector<InputStream::ptr> inputStreams = _streams.openForReading(_filenames, _regions);
 
     ostream* out = _streams.get<ostream>(_outputFile);
     if (_streams.cinReferences() > 1)
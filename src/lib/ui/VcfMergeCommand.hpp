@@ -5,6 +5,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 class VcfMergeCommand : public CommandBase {
 public:
@@ -22,6 +23,7 @@ public:
 protected:
     std::vector<std::string> _filenames;
     std::vector<std::string> _dupSampleFilenames;
+    std::vector<std::string> _regions;
     std::string _outputFile;
     std::string _fastaFile;
     std::string _mergeStrategyFile;
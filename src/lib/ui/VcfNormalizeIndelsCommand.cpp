@@ -20,6 +20,7 @@ VcfNormalizeIndelsCommand::VcfNormalizeIndelsCommand()
     : _outputFile("-")
     , _clearFilters(false)
     , _mergeSamples(false)
+    , _parseThreads(0)
 {
 }
 
@@ -36,6 +37,11 @@ void VcfNormalizeIndelsCommand::configureOptions() {
         ("output-file,o",
             po::value<string>(&_outputFile),
             "output file (omit or use '-' for stdout)")
+
+        ("parse-threads",
+            po::value<uint32_t>(&_parseThreads)->default_value(_parseThreads),
+            "number of threads to parse input records on (0 = parse on the "
+            "main thread)")
         ;
 
     _posOpts.add("input-file", -1);
@@ -49,6 +55,8 @@ void VcfNormalizeIndelsCommand::exec() {
         throw runtime_error("stdin listed more than once!");
 
     auto reader = openStream<Vcf::Entry>(in);
+    if (_parseThreads > 0)
+        reader->parallel(_parseThreads);
     *out << reader->header();
     Vcf::Entry e;
     Vcf::AltNormalizer norm(ref);
@@ -25,5 +25,6 @@ protected:
     std::string _mergeStrategyFile;
     bool _clearFilters;
     bool _mergeSamples;
+    uint32_t _parseThreads;
 };
 
@@ -30,6 +30,7 @@ VcfReportCommand::VcfReportCommand()
     : _infile("-")
     , _perSampleFile("per_sample_report.txt")
     , _perSiteFile("per_site_report.txt")
+    , _parseThreads(0)
 {
 }
 
@@ -50,6 +51,11 @@ void VcfReportCommand::configureOptions() {
         ("info-fields-from-db,I",
             po::value<vector<string>>(&_infoFields),
             "info fields to use for determining if a variant is known (default: none)")
+
+        ("parse-threads",
+            po::value<uint32_t>(&_parseThreads)->default_value(_parseThreads),
+            "number of threads to parse input records on (0 = parse on the "
+            "main thread)")
         ;
 
     _posOpts.add("input-file", 1);
@@ -63,13 +69,18 @@ void VcfReportCommand::exec() {
         throw runtime_error("stdin listed more than once!");
     uint32_t totalSites = 0;
     auto reader = openStream<Vcf::Entry>(*instream);
+    Vcf::ReaderOptions readerOptions;
+    readerOptions.formatFields = {"GT", "FT"};
+    reader->header().readerOptions(readerOptions);
+    if (_parseThreads > 0)
+        reader->parallel(_parseThreads, Vcf::ParseSampleData());
     Vcf::Entry entry;
     Metrics::SampleMetrics sampleMetrics(reader->header().sampleCount());
 
     *perSiteOut << "Chrom\tPos\tRef\tAlt\tTotalSamples\tNumberFiltered\tNumberMissing\tByAltTransition\tTotalTransitions\tTotalTransversions\tByAltNovel\tTotalNovel\tTotalKnown\tGenotypeDist\tAlleleDistBySample\tAlleleDist\tByAltAlleleFreq\tMAF\n"; 
     while (reader->next(entry)) {
         if (entry.alt().empty() ||
-            (entry.failedFilters().size() >= 1 && entry.failedFilters().find("PASS") == entry.failedFilters().end()))
+            (entry.failedFilters().size() >= 1 && !entry.failedFilters().count(Vcf::Symbol::pass())))
 
             continue;
         totalSites++;
@@ -23,4 +23,5 @@ protected:
     std::string _perSampleFile;
     std::string _perSiteFile;
     std::vector<std::string> _infoFields;
+    uint32_t _parseThreads;
 };
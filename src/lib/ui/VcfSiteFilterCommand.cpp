@@ -70,6 +70,11 @@ void VcfSiteFilterCommand::exec() {
     //create filter entry for header
     reader.header().addFilter(_filterName,_filterDescription);
 
+    // only the per-sample filters are looked at
+    Vcf::ReaderOptions readerOptions;
+    readerOptions.formatFields = {"FT"};
+    reader.header().readerOptions(readerOptions);
+
     Vcf::Entry e;
     *out << reader.header();
     while (reader.next(e)) {
@@ -0,0 +1,52 @@
+#include "common/BoundedQueue.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+    void produce(BoundedQueue<int>* queue, int n) {
+        for (int i = 0; i < n; ++i)
+            queue->push(i);
+        queue->close();
+    }
+}
+
+TEST(BoundedQueue, fifo) {
+    BoundedQueue<int> queue(3);
+    EXPECT_EQ(3u, queue.capacity());
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_TRUE(queue.tryPush(3));
+    EXPECT_FALSE(queue.tryPush(4));
+
+    int value = 0;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(2, value);
+
+    queue.close();
+    EXPECT_FALSE(queue.push(5));
+    // items queued before close are still delivered
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(3, value);
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(BoundedQueue, threads) {
+    BoundedQueue<int> queue(2);
+    std::thread producer(&produce, &queue, 1000);
+
+    std::vector<int> values;
+    int value;
+    while (queue.pop(value))
+        values.push_back(value);
+    producer.join();
+
+    ASSERT_EQ(1000u, values.size());
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(i, values[i]);
+}
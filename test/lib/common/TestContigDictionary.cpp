@@ -0,0 +1,158 @@
+#include "common/ContigDictionary.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    bool versionLess(std::string const& a, std::string const& b) {
+        return strverscmp(a.c_str(), b.c_str()) < 0;
+    }
+
+    int sign(int x) {
+        return x < 0 ? -1 : (x > 0 ? 1 : 0);
+    }
+
+    // names are prefixed so that these tests do not depend on what else
+    // has been put in the (process wide) dictionary
+    std::string name(std::string const& prefix, int i) {
+        std::stringstream ss;
+        ss << prefix << i;
+        return ss.str();
+    }
+
+    // Looks names up repeatedly, keeping the last rank of each
+    struct RankNames {
+        RankNames(std::vector<std::string> const& names, std::vector<ContigRank>& ranks)
+            : names(names)
+            , ranks(ranks)
+        {}
+
+        void operator()() {
+            for (int pass = 0; pass < 100; ++pass) {
+                ranks.clear();
+                for (auto i = names.begin(); i != names.end(); ++i)
+                    ranks.push_back(ContigDictionary::instance().rank(*i));
+            }
+        }
+
+        std::vector<std::string> const& names;
+        std::vector<ContigRank>& ranks;
+    };
+}
+
+TEST(ContigDictionary, ranksFollowVersionOrder) {
+    ContigDictionary& dict = ContigDictionary::instance();
+    std::vector<std::string> names{"ordX", "ord10", "ord2", "ord1", "ordY", "ord22", "ordMT"};
+    dict.add(names);
+
+    std::vector<ContigRank> ranks;
+    for (auto i = names.begin(); i != names.end(); ++i)
+        ranks.push_back(dict.rank(*i));
+
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        for (std::size_t j = 0; j < names.size(); ++j) {
+            ASSERT_TRUE(ranks[i].comparable(ranks[j]));
+            EXPECT_EQ(sign(strverscmp(names[i].c_str(), names[j].c_str())),
+                sign(ContigDictionary::compare(names[i], ranks[i], names[j], ranks[j])))
+                << names[i] << " vs " << names[j];
+            EXPECT_EQ(i == j,
+                ContigDictionary::same(names[i], ranks[i], names[j], ranks[j]));
+        }
+    }
+}
+
+TEST(ContigDictionary, lazyInsertion) {
+    ContigDictionary& dict = ContigDictionary::instance();
+    std::size_t before = dict.size();
+
+    // inserting in this order keeps splitting the same gap and forces the
+    // dictionary to renumber
+    std::vector<std::string> names;
+    for (int i = 0; i < 200; ++i)
+        names.push_back(name("lazy", 1000 - i));
+    std::vector<ContigRank> ranks;
+    for (auto i = names.begin(); i != names.end(); ++i)
+        ranks.push_back(dict.rank(*i));
+
+    EXPECT_EQ(before + names.size(), dict.size());
+    // looking a name up again does not add it twice
+    dict.rank(names[0]);
+    EXPECT_EQ(before + names.size(), dict.size());
+
+    // old and new ranks compare correctly, whether or not their generations
+    // match
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        for (std::size_t j = 0; j < names.size(); j += 7) {
+            ContigRank current = dict.rank(names[j]);
+            EXPECT_EQ(sign(strverscmp(names[i].c_str(), names[j].c_str())),
+                sign(ContigDictionary::compare(names[i], ranks[i], names[j], current)));
+        }
+    }
+
+    std::vector<std::string> sorted(names);
+    std::sort(sorted.begin(), sorted.end(), versionLess);
+    for (std::size_t i = 1; i < sorted.size(); ++i)
+        EXPECT_LT(dict.rank(sorted[i - 1]).key, dict.rank(sorted[i]).key);
+}
+
+TEST(ContigDictionary, unsetRank) {
+    ContigRank unset;
+    ContigRank rank = ContigDictionary::instance().rank("unset1");
+    EXPECT_FALSE(unset.comparable(rank));
+    EXPECT_FALSE(unset.comparable(unset));
+    EXPECT_EQ(-1, sign(ContigDictionary::compare("unset1", rank, "unset2", unset)));
+    EXPECT_TRUE(ContigDictionary::same("unset1", rank, "unset1", unset));
+}
+
+TEST(ContigDictionary, cachedRanksFollowRenumbering) {
+    ContigDictionary& dict = ContigDictionary::instance();
+    ContigRank before = dict.rank("cached1");
+    EXPECT_EQ(before.key, dict.rank("cached1").key);
+
+    // adding names renumbers the dictionary, ranks looked up afterwards
+    // have to come from the new generation
+    std::vector<std::string> names;
+    for (int i = 0; i < 10; ++i)
+        names.push_back(name("cached", i + 2));
+    dict.add(names);
+
+    ContigRank after = dict.rank("cached1");
+    ContigRank other = dict.rank("cached2");
+    EXPECT_NE(before.generation, after.generation);
+    ASSERT_TRUE(after.comparable(other));
+    EXPECT_EQ(-1, sign(ContigDictionary::compare("cached1", after, "cached2", other)));
+}
+
+TEST(ContigDictionary, threads) {
+    std::vector<std::string> names;
+    for (int i = 0; i < 50; ++i)
+        names.push_back(name("threaded", i));
+
+    std::vector<std::vector<ContigRank>> ranks(4);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < ranks.size(); ++t) {
+        threads.push_back(std::thread(RankNames(names, ranks[t])));
+    }
+    for (auto i = threads.begin(); i != threads.end(); ++i)
+        i->join();
+
+    ContigDictionary& dict = ContigDictionary::instance();
+    for (std::size_t t = 0; t < ranks.size(); ++t) {
+        ASSERT_EQ(names.size(), ranks[t].size());
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            ContigRank current = dict.rank(names[i]);
+            EXPECT_TRUE(ContigDictionary::same(names[i], ranks[t][i], names[i], current));
+            if (i > 0) {
+                EXPECT_EQ(sign(strverscmp(names[i - 1].c_str(), names[i].c_str())),
+                    sign(ContigDictionary::compare(
+                        names[i - 1], ranks[t][i - 1], names[i], ranks[t][i])));
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#include "common/DelimiterScan.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+
+namespace {
+    uint64_t naiveMask(string const& s, size_t pos, char delim) {
+        uint64_t rv = 0;
+        for (size_t i = pos; i < s.size() && i - pos < DELIMITER_BLOCK; ++i) {
+            if (s[i] == delim)
+                rv |= uint64_t(1) << (i - pos);
+        }
+        return rv;
+    }
+
+    struct RestoreSimdLevel {
+        RestoreSimdLevel() : level(simdLevel()) {}
+        ~RestoreSimdLevel() { setSimdLevel(level); }
+        SimdLevel level;
+    };
+}
+
+TEST(TestDelimiterScan, levels) {
+    RestoreSimdLevel restore;
+    EXPECT_EQ(SIMD_SCALAR, setSimdLevel(SIMD_SCALAR));
+    EXPECT_EQ(SIMD_SCALAR, simdLevel());
+    EXPECT_EQ(maxSimdLevel(), setSimdLevel(SIMD_AVX2));
+    EXPECT_STREQ("scalar", simdLevelName(SIMD_SCALAR));
+}
+
+TEST(TestDelimiterScan, mask) {
+    RestoreSimdLevel restore;
+    srand(7);
+    string s(1000, 'x');
+    for (size_t i = 0; i < s.size(); ++i) {
+        int r = rand() % 8;
+        s[i] = r == 0 ? '\t' : r == 1 ? '\0' : char('a' + r);
+    }
+    // delimiters at both ends of the blocks
+    s[0] = s[63] = s[64] = s[127] = s[999] = '\t';
+
+    for (int level = SIMD_SCALAR; level <= maxSimdLevel(); ++level) {
+        setSimdLevel(SimdLevel(level));
+        for (size_t pos = 0; pos <= s.size(); ++pos) {
+            char const* end = s.data() + s.size();
+            EXPECT_EQ(naiveMask(s, pos, '\t'), delimiterMask(s.data() + pos, end, '\t'))
+                << simdLevelName(SimdLevel(level)) << " at " << pos;
+            EXPECT_EQ(naiveMask(s, pos, '\0'), delimiterMask(s.data() + pos, end, '\0'))
+                << simdLevelName(SimdLevel(level)) << " at " << pos;
+        }
+    }
+}
+
+TEST(TestDelimiterScan, stopsAtEnd) {
+    // delimiters right after the end are not seen
+    string s("ab\tcd;;;;;;;;");
+    EXPECT_EQ(4u, delimiterMask(s.data(), s.data() + 5, '\t'));
+    EXPECT_EQ(0u, delimiterMask(s.data(), s.data() + 5, ';'));
+    EXPECT_EQ(0u, delimiterMask(s.data(), s.data(), '\t'));
+}
+
+TEST(TestDelimiterScan, lowestBit) {
+    EXPECT_EQ(0u, lowestBit(1));
+    EXPECT_EQ(5u, lowestBit(0x60));
+    EXPECT_EQ(63u, lowestBit(uint64_t(1) << 63));
+}
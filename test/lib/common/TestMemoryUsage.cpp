@@ -0,0 +1,50 @@
+#include "common/MemoryUsage.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Owner {
+        std::size_t heapBytes() const {
+            return 100;
+        }
+    };
+}
+
+TEST(MemoryUsage, scalars) {
+    EXPECT_EQ(0u, heapBytes(1));
+    EXPECT_EQ(0u, heapBytes(1.5));
+    int x = 0;
+    EXPECT_EQ(0u, heapBytes(&x));
+    EXPECT_EQ(0u, allocationBytes(0));
+    EXPECT_EQ(10 + ALLOC_OVERHEAD, allocationBytes(10));
+}
+
+TEST(MemoryUsage, strings) {
+    std::string longer(1000, 'x');
+    EXPECT_GE(heapBytes(longer), 1000u);
+    EXPECT_LE(heapBytes(longer), 1000u + longer.capacity() + 64);
+}
+
+TEST(MemoryUsage, containers) {
+    std::vector<int> ints;
+    ints.reserve(100);
+    EXPECT_EQ(allocationBytes(100 * sizeof(int)), heapBytes(ints));
+
+    std::vector<std::string> strings(3, std::string(1000, 'x'));
+    EXPECT_EQ(allocationBytes(strings.capacity() * sizeof(std::string))
+        + 3 * heapBytes(strings[0]), heapBytes(strings));
+
+    std::set<int> intSet{1, 2, 3};
+    EXPECT_EQ(3 * allocationBytes(TREE_NODE_OVERHEAD + sizeof(int)), heapBytes(intSet));
+
+    std::map<int, Owner> owners;
+    owners[1];
+    owners[2];
+    EXPECT_EQ(2 * (allocationBytes(TREE_NODE_OVERHEAD + sizeof(std::pair<const int, Owner>)) + 100),
+        heapBytes(owners));
+}
@@ -0,0 +1,204 @@
+#include "common/NumberConversion.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+    template<typename T>
+    bool parseInt(string const& s, T& value) {
+        return parseInteger(s.data(), s.data() + s.size(), value);
+    }
+
+    bool parseDbl(string const& s, double& value) {
+        return parseDouble(s.data(), s.data() + s.size(), value);
+    }
+
+    string fmtDouble(double value, int precision = 6) {
+        char buf[MAX_DOUBLE_CHARS];
+        return string(buf, formatDouble(buf, value, precision));
+    }
+
+    string printfDouble(double value, int precision = 6) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*g", precision, value);
+        return buf;
+    }
+
+    double randomDouble() {
+        uint64_t bits = (uint64_t(rand()) << 62) ^ (uint64_t(rand()) << 31) ^ uint64_t(rand());
+        double rv;
+        memcpy(&rv, &bits, sizeof(rv));
+        return rv;
+    }
+}
+
+TEST(TestNumberConversion, parseInteger) {
+    int64_t i64;
+    ASSERT_TRUE(parseInt("0", i64));
+    EXPECT_EQ(0, i64);
+    ASSERT_TRUE(parseInt("+12", i64));
+    EXPECT_EQ(12, i64);
+    ASSERT_TRUE(parseInt("-9223372036854775808", i64));
+    EXPECT_EQ(numeric_limits<int64_t>::min(), i64);
+    ASSERT_TRUE(parseInt("9223372036854775807", i64));
+    EXPECT_EQ(numeric_limits<int64_t>::max(), i64);
+    ASSERT_TRUE(parseInt("000000000000000000000042", i64));
+    EXPECT_EQ(42, i64);
+
+    EXPECT_FALSE(parseInt("9223372036854775808", i64));
+    EXPECT_FALSE(parseInt("-9223372036854775809", i64));
+    EXPECT_FALSE(parseInt("", i64));
+    EXPECT_FALSE(parseInt("-", i64));
+    EXPECT_FALSE(parseInt("1.0", i64));
+    EXPECT_FALSE(parseInt(" 1", i64));
+    EXPECT_FALSE(parseInt("1x", i64));
+
+    uint32_t u32;
+    ASSERT_TRUE(parseInt("4294967295", u32));
+    EXPECT_EQ(4294967295u, u32);
+    EXPECT_FALSE(parseInt("4294967296", u32));
+    EXPECT_FALSE(parseInt("-1", u32));
+
+    int16_t i16;
+    ASSERT_TRUE(parseInt("-32768", i16));
+    EXPECT_EQ(-32768, i16);
+    EXPECT_FALSE(parseInt("32768", i16));
+}
+
+TEST(TestNumberConversion, parseDouble) {
+    double d;
+    ASSERT_TRUE(parseDbl("1.5", d));
+    EXPECT_EQ(1.5, d);
+    ASSERT_TRUE(parseDbl("-.25", d));
+    EXPECT_EQ(-0.25, d);
+    ASSERT_TRUE(parseDbl("5.", d));
+    EXPECT_EQ(5.0, d);
+    ASSERT_TRUE(parseDbl("1e3", d));
+    EXPECT_EQ(1000.0, d);
+    ASSERT_TRUE(parseDbl("+2.5E-3", d));
+    EXPECT_EQ(0.0025, d);
+    ASSERT_TRUE(parseDbl("-0", d));
+    EXPECT_TRUE(d == 0 && signbit(d));
+    ASSERT_TRUE(parseDbl("NaN", d));
+    EXPECT_TRUE(std::isnan(d));
+    ASSERT_TRUE(parseDbl("-inf", d));
+    EXPECT_EQ(-numeric_limits<double>::infinity(), d);
+    ASSERT_TRUE(parseDbl("Infinity", d));
+    EXPECT_EQ(numeric_limits<double>::infinity(), d);
+
+    EXPECT_FALSE(parseDbl("", d));
+    EXPECT_FALSE(parseDbl(".", d));
+    EXPECT_FALSE(parseDbl("-", d));
+    EXPECT_FALSE(parseDbl("1e", d));
+    EXPECT_FALSE(parseDbl("1e+", d));
+    EXPECT_FALSE(parseDbl("0x10", d));
+    EXPECT_FALSE(parseDbl(" 1", d));
+    EXPECT_FALSE(parseDbl("1.2.3", d));
+    EXPECT_FALSE(parseDbl("infinite", d));
+}
+
+TEST(TestNumberConversion, parseDoubleRounding) {
+    // compare with strtod, which rounds correctly, on the shortest and
+    // on the long forms of random values
+    srand(11);
+    double d;
+    for (int i = 0; i < 100000; ++i) {
+        double x = randomDouble();
+        if (!std::isfinite(x))
+            continue;
+
+        for (int precision = 6; precision <= 17; precision += 11) {
+            string s = printfDouble(x, precision);
+            ASSERT_TRUE(parseDbl(s, d)) << s;
+            EXPECT_EQ(strtod(s.c_str(), 0), d) << s;
+        }
+    }
+
+    string const longs[] = {
+        "0.1", "123456789012345678901234567890", "9007199254740993",
+        "2.2250738585072011e-308", "1.7976931348623157e308", "1e400", "1e-400",
+        "0.000000000000000000000000000000000000001234"
+    };
+    for (size_t i = 0; i < sizeof(longs) / sizeof(longs[0]); ++i) {
+        ASSERT_TRUE(parseDbl(longs[i], d)) << longs[i];
+        EXPECT_EQ(strtod(longs[i].c_str(), 0), d) << longs[i];
+    }
+}
+
+TEST(TestNumberConversion, formatInteger) {
+    char buf[MAX_INTEGER_CHARS];
+    EXPECT_EQ("0", string(buf, formatInteger(buf, uint64_t(0))));
+    EXPECT_EQ("7", string(buf, formatInteger(buf, int64_t(7))));
+    EXPECT_EQ("-10", string(buf, formatInteger(buf, int64_t(-10))));
+    EXPECT_EQ("18446744073709551615",
+        string(buf, formatInteger(buf, numeric_limits<uint64_t>::max())));
+    EXPECT_EQ("-9223372036854775808",
+        string(buf, formatInteger(buf, numeric_limits<int64_t>::min())));
+}
+
+TEST(TestNumberConversion, formatDouble) {
+    EXPECT_EQ("0", fmtDouble(0.0));
+    EXPECT_EQ("-0", fmtDouble(-0.0));
+    EXPECT_EQ("30", fmtDouble(30.0));
+    EXPECT_EQ("29.5", fmtDouble(29.5));
+    EXPECT_EQ("0.1", fmtDouble(0.1));
+    EXPECT_EQ("123457", fmtDouble(123456.7));
+    EXPECT_EQ("1.23457e+06", fmtDouble(1234567.0));
+    EXPECT_EQ("1e-05", fmtDouble(1e-5));
+    EXPECT_EQ("0.0001", fmtDouble(1e-4));
+    EXPECT_EQ("1e+100", fmtDouble(1e100));
+    EXPECT_EQ("2", fmtDouble(2.5, 1));
+    EXPECT_EQ("inf", fmtDouble(numeric_limits<double>::infinity()));
+}
+
+TEST(TestNumberConversion, formatDoubleMatchesPrintf) {
+    srand(13);
+    for (int i = 0; i < 200000; ++i) {
+        double x = randomDouble();
+        if (i % 2) {
+            // values with few digits, as in most files
+            x = double(rand() % 200000 - 100000) / (1 << (rand() % 12));
+        }
+        int precision = i % 3 == 0 ? 6 : rand() % (MAX_DOUBLE_PRECISION + 1);
+        ASSERT_EQ(printfDouble(x, precision), fmtDouble(x, precision)) << precision;
+    }
+}
+
+TEST(TestNumberConversion, writeMatchesStream) {
+    double const values[] = {0.1, 1234567.0, 42.0, -3.25e-7};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        for (int precision = 1; precision < 20; precision += 4) {
+            stringstream expected;
+            stringstream actual;
+            expected.precision(precision);
+            actual.precision(precision);
+            expected << values[i];
+            writeDouble(actual, values[i]);
+            EXPECT_EQ(expected.str(), actual.str());
+        }
+    }
+
+    stringstream expected;
+    stringstream actual;
+    expected << hex << std::setw(6) << 255 << " " << -7;
+    actual << hex << std::setw(6);
+    writeInteger(actual, 255);
+    actual << " ";
+    writeInteger(actual, -7);
+    EXPECT_EQ(expected.str(), actual.str());
+
+    stringstream plain;
+    writeInteger(plain, int64_t(-1234567890123));
+    writeInteger(plain, 5u);
+    EXPECT_EQ("-12345678901235", plain.str());
+}
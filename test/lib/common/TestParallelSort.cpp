@@ -0,0 +1,64 @@
+#include "common/ParallelSort.hpp"
+#include "common/ThreadPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace {
+    typedef std::pair<int, int> Item;
+
+    // compares only the first element so that stability can be observed
+    struct FirstLess {
+        bool operator()(Item const& a, Item const& b) const {
+            return a.first < b.first;
+        }
+    };
+
+    std::vector<Item> makeItems(std::size_t n) {
+        std::vector<Item> items;
+        srand(42);
+        for (std::size_t i = 0; i < n; ++i)
+            items.push_back(Item(rand() % 1000, int(i)));
+        return items;
+    }
+}
+
+TEST(ParallelSort, stable) {
+    ThreadPool pool(3);
+    std::vector<Item> items = makeItems(100000);
+    std::vector<Item> expected(items);
+    std::stable_sort(expected.begin(), expected.end(), FirstLess());
+
+    parallelSort(items.begin(), items.end(), FirstLess(), true, pool);
+    EXPECT_EQ(expected, items);
+}
+
+TEST(ParallelSort, unstable) {
+    ThreadPool pool(4);
+    std::vector<Item> items = makeItems(100000);
+    std::vector<Item> expected(items);
+    std::sort(expected.begin(), expected.end());
+
+    parallelSort(items.begin(), items.end(), FirstLess(), false, pool);
+    EXPECT_TRUE(std::is_sorted(items.begin(), items.end(), FirstLess()));
+    std::sort(items.begin(), items.end());
+    EXPECT_EQ(expected, items);
+}
+
+TEST(ParallelSort, small) {
+    ThreadPool pool(4);
+    std::vector<Item> items = makeItems(100);
+    std::vector<Item> expected(items);
+    std::stable_sort(expected.begin(), expected.end(), FirstLess());
+
+    parallelSort(items.begin(), items.end(), FirstLess(), true, pool);
+    EXPECT_EQ(expected, items);
+
+    std::vector<Item> empty;
+    parallelSort(empty.begin(), empty.end(), FirstLess(), true, pool);
+    EXPECT_TRUE(empty.empty());
+}
@@ -0,0 +1,43 @@
+#include "common/ThreadPool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    int square(int x) {
+        return x * x;
+    }
+
+    int fail() {
+        throw std::runtime_error("task failed");
+    }
+}
+
+TEST(ThreadPool, orderedResults) {
+    ThreadPool pool(4);
+    EXPECT_EQ(4u, pool.size());
+
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.push_back(pool.submit(std::bind(&square, i)));
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(i * i, results[i].get());
+    }
+}
+
+TEST(ThreadPool, exceptionPropagates) {
+    ThreadPool pool(2);
+    auto result = pool.submit(&fail);
+    EXPECT_THROW(result.get(), std::runtime_error);
+}
+
+TEST(ThreadPool, zeroThreads) {
+    ThreadPool pool(0);
+    EXPECT_EQ(1u, pool.size());
+    EXPECT_EQ(9, pool.submit(std::bind(&square, 3)).get());
+}
@@ -1,7 +1,11 @@
 #include "common/Tokenizer.hpp"
 
+#include <boost/algorithm/string/join.hpp>
+
+#include <iterator>
 #include <stdexcept>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 
 using namespace std;
@@ -267,3 +271,35 @@ TEST(TestTokenizer, testStringView) {
     }
 
 }
+
+TEST(TestTokenizer, longLines) {
+    // fields that cross the blocks delimiters are searched in
+    SimdLevel level = simdLevel();
+    for (int lvl = SIMD_SCALAR; lvl <= maxSimdLevel(); ++lvl) {
+        setSimdLevel(SimdLevel(lvl));
+        for (size_t width = 0; width < 140; width += 7) {
+            vector<string> expected;
+            string input;
+            for (size_t i = 0; i < 20; ++i) {
+                expected.push_back(string((i * width) % 131, 'a' + i));
+                if (i)
+                    input += ':';
+                input += expected.back();
+            }
+            // empty last field
+            input += ':';
+            expected.push_back("");
+
+            vector<string> fields;
+            Tokenizer<char>::split(input, ':', back_inserter(fields));
+            EXPECT_EQ(expected, fields) << simdLevelName(SimdLevel(lvl)) << " " << width;
+
+            // the rest of the input is not looked at
+            fields.clear();
+            size_t len = std::min<size_t>(70, input.size());
+            Tokenizer<char>::split(input.data(), input.data() + len, ':', back_inserter(fields));
+            EXPECT_EQ(input.substr(0, len), boost::algorithm::join(fields, ":"));
+        }
+    }
+    setSimdLevel(level);
+}
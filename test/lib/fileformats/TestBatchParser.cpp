@@ -0,0 +1,130 @@
+#include "fileformats/TypedStream.hpp"
+
+#include "fileformats/Bed.hpp"
+#include "fileformats/BedReader.hpp"
+#include "fileformats/vcf/Entry.hpp"
+#include "fileformats/vcf/Header.hpp"
+#include "io/InputStream.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    string vcfData(int n) {
+        stringstream ss;
+        ss << "##fileformat=VCFv4.1\n"
+            << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n"
+            << "##FORMAT=<ID=DP,Number=1,Type=Integer,Description=\"Read Depth\">\n"
+            << "##INFO=<ID=DP,Number=1,Type=Integer,Description=\"Total Depth\">\n"
+            << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tS1\tS2\n";
+        for (int i = 0; i < n; ++i) {
+            ss << (i % 3 + 1) << "\t" << i + 1 << "\t.\tA\tC\t" << i % 50
+                << "\tPASS\tDP=" << i << "\tGT:DP\t0/1:" << i % 7 << "\t1/1:3\n";
+            // blank lines and comments are skipped
+            if (i % 1000 == 0)
+                ss << "\n# comment\n";
+        }
+        return ss.str();
+    }
+
+    template<typename Stream>
+    string readAll(Stream& stream, vector<uint64_t>* lineNums = 0) {
+        stringstream out;
+        typename Stream::ValueType value;
+        while (stream.next(value)) {
+            out << value << "\n";
+            if (lineNums)
+                lineNums->push_back(stream.lineNum());
+        }
+        return out.str();
+    }
+}
+
+TEST(TestBatchParser, vcfInOrder) {
+    string data = vcfData(10000);
+
+    stringstream serialIn(data);
+    InputStream serialStream("test", serialIn);
+    auto serial = openStream<Vcf::Entry>(serialStream);
+    vector<uint64_t> serialLines;
+    string expected = readAll(*serial, &serialLines);
+
+    for (size_t threads = 1; threads <= 4; threads += 3) {
+        stringstream in(data);
+        InputStream stream("test", in);
+        auto reader = openStream<Vcf::Entry>(stream);
+        reader->parallel(threads, Vcf::ParseSampleData(), 100);
+
+        vector<uint64_t> lines;
+        EXPECT_EQ(expected, readAll(*reader, &lines));
+        EXPECT_EQ(serialLines, lines);
+        EXPECT_EQ(10000u, reader->valueCount());
+        EXPECT_TRUE(reader->eof());
+    }
+}
+
+TEST(TestBatchParser, peek) {
+    stringstream in("1\t2\t3\n1\t4\t5\n");
+    InputStream stream("test", in);
+    auto reader = openBed(stream);
+    reader->parallel(2);
+
+    Bed* peeked = 0;
+    ASSERT_TRUE(reader->peek(&peeked));
+    EXPECT_EQ(2, peeked->start());
+
+    Bed bed;
+    ASSERT_TRUE(reader->next(bed));
+    EXPECT_EQ(2, bed.start());
+    ASSERT_TRUE(reader->peek(&peeked));
+    EXPECT_EQ(4, peeked->start());
+    ASSERT_TRUE(reader->next(bed));
+    EXPECT_FALSE(reader->peek(&peeked));
+    EXPECT_TRUE(reader->eof());
+}
+
+TEST(TestBatchParser, errorInOrder) {
+    stringstream in("1\t2\t3\n1\t4\t5\n1\tx\t6\n1\t7\t8\n");
+    InputStream stream("test", in);
+    auto reader = openBed(stream);
+    reader->parallel(2, BedReader::BatchParserType::PrepareFunc(), 1);
+
+    Bed bed;
+    ASSERT_TRUE(reader->next(bed));
+    ASSERT_TRUE(reader->next(bed));
+    EXPECT_EQ(4, bed.start());
+    try {
+        reader->next(bed);
+        FAIL() << "Expected an exception";
+    }
+    catch (runtime_error const& e) {
+        EXPECT_EQ(0u, string(e.what()).find("Error at test:3:"));
+    }
+}
+
+TEST(TestBatchParser, afterRead) {
+    stringstream in("1\t2\t3\n1\t4\t5\n");
+    InputStream stream("test", in);
+    auto reader = openBed(stream);
+    Bed bed;
+    ASSERT_TRUE(reader->next(bed));
+    EXPECT_THROW(reader->parallel(2), runtime_error);
+}
+
+TEST(TestBatchParser, earlyExit) {
+    // the consumer stops long before the input is all read
+    string data = vcfData(10000);
+    stringstream in(data);
+    InputStream stream("test", in);
+    auto reader = openStream<Vcf::Entry>(stream);
+    reader->parallel(3, Vcf::ParseSampleData(), 10);
+    Vcf::Entry entry;
+    ASSERT_TRUE(reader->next(entry));
+    EXPECT_EQ(1u, entry.pos());
+}
@@ -35,6 +35,25 @@ TEST(Bed, parse) {
     ASSERT_EQ(Bed::INDEL, snv.type());
 }
 
+TEST(Bed, parseStringView) {
+    string line = "1\t2\t3\ta/t\t44\tx";
+    Bed bed;
+    Bed::parseLine(&hdr, StringView(line.data(), line.data() + line.size()), bed, 2);
+    EXPECT_EQ("1", bed.chrom());
+    EXPECT_EQ(2, bed.start());
+    EXPECT_EQ(3, bed.stop());
+    ASSERT_EQ(2u, bed.extraFields().size());
+    EXPECT_EQ("A/T", bed.extraFields()[0]);
+    EXPECT_EQ("44", bed.extraFields()[1]);
+    EXPECT_EQ(line, bed.toString());
+
+    // extra fields left over from the previous line must not survive
+    line = "2\t5\t6";
+    Bed::parseLine(&hdr, StringView(line.data(), line.data() + line.size()), bed, 2);
+    EXPECT_EQ("2", bed.chrom());
+    EXPECT_TRUE(bed.extraFields().empty());
+}
+
 TEST(Bed, length) {
     Bed snv("1", 2, 3);
     Bed del2bp("1", 2, 4);
@@ -100,13 +119,13 @@ TEST(Bed, cmp) {
     ASSERT_LT(0, cmp(b, a));
 
     b = a;
-    b._chrom = "2";
+    b.chrom("2");
     ASSERT_GT(0, cmp(a, b));
     ASSERT_LT(0, cmp(b, a));
 
-    a._chrom = "22";
+    a.chrom("22");
     b = a;
-    b._chrom = "X";
+    b.chrom("X");
     ASSERT_GT(0, cmp(a, b)) << "bed chromosome sort: 22 < X";
     ASSERT_LT(0, cmp(b, a)) << "bed chromosome sort: X > 22";
 }
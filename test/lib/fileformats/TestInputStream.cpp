@@ -80,3 +80,25 @@ TEST(InputStream, gzipNoNewline) {
     EXPECT_TRUE(in.getline(line));
     EXPECT_EQ("no newline", line);
 }
+
+TEST(InputStream, stringViewCaching) {
+    stringstream ss("1\n\n2\n3\n");
+    StringView line;
+    InputStream stream("test", ss);
+    stream.caching(true);
+
+    ASSERT_TRUE(stream.getline(line));
+    ASSERT_EQ("1", line);
+    ASSERT_TRUE(stream.getline(line));
+    ASSERT_EQ("2", line);
+
+    stream.rewind();
+    ASSERT_TRUE(stream.getline(line));
+    ASSERT_EQ("1", line);
+    ASSERT_TRUE(stream.getline(line));
+    ASSERT_EQ("2", line);
+    ASSERT_TRUE(stream.getline(line));
+    ASSERT_EQ("3", line);
+    ASSERT_FALSE(stream.getline(line));
+    ASSERT_TRUE(stream.eof());
+}
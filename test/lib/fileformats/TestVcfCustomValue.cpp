@@ -238,3 +238,137 @@ TEST(VcfCustomValue, perAltRefList) {
     ASSERT_FALSE(value.get<int64_t>(3));
     ASSERT_FALSE(value.get<int64_t>(4));
 }
+
+TEST(VcfCustomValue, missingValuesInList) {
+    CustomType type("X", CustomType::VARIABLE_SIZE, 0, CustomType::INTEGER, "numbers");
+    CustomValue value(&type, "1,.,3");
+    ASSERT_EQ(3u, value.size());
+    EXPECT_FALSE(value.missing(0));
+    EXPECT_TRUE(value.missing(1));
+    EXPECT_FALSE(value.get<int64_t>(1));
+    EXPECT_TRUE(value.missing(3));
+    EXPECT_EQ("1,.,3", value.toString());
+    EXPECT_EQ(".", value.getString(1));
+
+    int64_t const* data = value.data<int64_t>();
+    EXPECT_EQ(1, data[0]);
+    EXPECT_EQ(3, data[2]);
+
+    EXPECT_EQ(".", CustomValue(&type, ".").toString());
+    EXPECT_TRUE(CustomValue(&type, ".").empty());
+    EXPECT_THROW(CustomValue(&type, "1,,3"), runtime_error);
+}
+
+TEST(VcfCustomValue, inlineScalars) {
+    CustomType type("DP", CustomType::FIXED_SIZE, 1, CustomType::INTEGER, "depth");
+    CustomValue value(&type, "42");
+    EXPECT_EQ(0u, value.heapBytes());
+    EXPECT_EQ(42, *value.get<int64_t>(0));
+
+    // copies and moves of inline values
+    CustomValue copy(value);
+    EXPECT_EQ(value, copy);
+    CustomValue moved(std::move(copy));
+    EXPECT_EQ(value, moved);
+    EXPECT_TRUE(copy.empty());
+
+    CustomType list("X", CustomType::VARIABLE_SIZE, 0, CustomType::FLOAT, "numbers");
+    CustomValue values(&list, "1.5,2.5");
+    EXPECT_GT(values.heapBytes(), 0u);
+    values = value;
+    EXPECT_EQ("42", values.toString());
+    EXPECT_EQ(0u, values.heapBytes());
+}
+
+TEST(VcfCustomValue, manyValues) {
+    // enough values that the missing bits are on the heap too
+    CustomType type("X", CustomType::VARIABLE_SIZE, 0, CustomType::STRING, "strings");
+    CustomValue value(&type);
+    for (int i = 0; i < 200; i += 2) {
+        stringstream ss;
+        ss << "v" << i;
+        value.set<string>(i, ss.str());
+    }
+    ASSERT_EQ(199u, value.size());
+    EXPECT_EQ("v198", *value.get<string>(198));
+    EXPECT_TRUE(value.missing(197));
+
+    CustomValue copy(value);
+    EXPECT_EQ(value.toString(), copy.toString());
+    EXPECT_EQ(value, copy);
+
+    copy.set<string>(197, "x");
+    EXPECT_NE(value, copy);
+}
+
+TEST(VcfCustomValue, setType) {
+    CustomType ints("X", CustomType::VARIABLE_SIZE, 0, CustomType::INTEGER, "numbers");
+    CustomType floats("X", CustomType::VARIABLE_SIZE, 0, CustomType::FLOAT, "numbers");
+    CustomType strings("X", CustomType::VARIABLE_SIZE, 0, CustomType::STRING, "strings");
+
+    CustomValue value(&ints, "1,.,3");
+    value.setType(&floats);
+    EXPECT_EQ(3.0, *value.get<double>(2));
+    EXPECT_TRUE(value.missing(1));
+
+    value.setType(&strings);
+    EXPECT_EQ("3", *value.get<string>(2));
+
+    value.setType(&ints);
+    EXPECT_EQ(1, *value.get<int64_t>(0));
+
+    CustomValue text(&strings, "a");
+    EXPECT_THROW(text.setType(&ints), runtime_error);
+}
+
+TEST(VcfCustomValue, rawValues) {
+    CustomType type("X", CustomType::VARIABLE_SIZE, 0, CustomType::FLOAT, "numbers");
+    std::vector<CustomValue::ValueType> raw;
+    raw.push_back(1.5);
+    raw.push_back(CustomValue::ValueType());
+    raw.push_back(int64_t(2));
+    CustomValue value(&type, std::move(raw));
+    EXPECT_EQ("1.5,.,2", value.toString());
+
+    raw = value.getRaw();
+    ASSERT_EQ(3u, raw.size());
+    EXPECT_EQ(1.5, boost::get<double>(raw[0]));
+    EXPECT_EQ(0, raw[1].which());
+    EXPECT_EQ(2.0, boost::get<double>(value.getAny(2)));
+}
+
+TEST(VcfCustomValue, append) {
+    CustomType type("X", CustomType::VARIABLE_SIZE, 0, CustomType::STRING, "strings");
+    CustomValue value(&type, "a");
+    CustomValue other(&type, "b,.,c");
+    value.append(other);
+    EXPECT_EQ("a,b,.,c", value.toString());
+
+    value.append(other, 1);
+    value.append(other, 0);
+    EXPECT_EQ("a,b,.,c,.,b", value.toString());
+
+    CustomType ints("X", CustomType::VARIABLE_SIZE, 0, CustomType::INTEGER, "numbers");
+    EXPECT_THROW(value.append(CustomValue(&ints, "1")), runtime_error);
+}
+
+TEST(VcfCustomValue, sum) {
+    CustomType type("X", CustomType::FIXED_SIZE, 2, CustomType::INTEGER, "numbers");
+    CustomValue value(&type, "1,.");
+    value += CustomValue(&type, "2,3");
+    EXPECT_EQ("3,3", value.toString());
+
+    CustomType floats("Y", CustomType::FIXED_SIZE, 1, CustomType::FLOAT, "number");
+    CustomValue real(&floats);
+    real += CustomValue(&floats, "0.5");
+    real += CustomValue(&floats, "0.25");
+    EXPECT_EQ(0.75, *real.get<double>(0));
+}
+
+TEST(VcfCustomValue, equality) {
+    CustomType type("X", CustomType::VARIABLE_SIZE, 0, CustomType::FLOAT, "numbers");
+    EXPECT_EQ(CustomValue(&type, "1.5,2"), CustomValue(&type, "1.5,2.0"));
+    EXPECT_NE(CustomValue(&type, "1.5,2"), CustomValue(&type, "1.5,.,2"));
+    EXPECT_EQ(CustomValue(&type, "."), CustomValue(&type));
+    EXPECT_NE(CustomValue(&type, "1"), CustomValue(&type, "2"));
+}
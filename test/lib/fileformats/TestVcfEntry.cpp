@@ -324,7 +324,7 @@ TEST_F(TestVcfEntry, move) {
     // nested sample data addresses
     SampleData const& sd = e.sampleData();
     CustomType const* const* addrFormat = sd.format().data();
-    SampleData::MapType::value_type const* addrSampleValues = &*sd.begin();
+    SampleColumn const* addrSampleValues = &sd.column(0);
 
     // primitive types are copied, not moved. we still check that they get
     // set properly though.
@@ -352,7 +352,7 @@ TEST_F(TestVcfEntry, move) {
     ASSERT_EQ(addrFilter, &*e2.failedFilters().begin());
     ASSERT_EQ(addrInfo, &*e2.info().begin());
     ASSERT_EQ(addrFormat, e2.sampleData().format().data());
-    ASSERT_EQ(addrSampleValues, &*e2.sampleData().begin());
+    ASSERT_EQ(addrSampleValues, &e2.sampleData().column(0));
     ASSERT_EQ(origStart, e2.start());
     ASSERT_EQ(origStop, e2.stop());
 }
@@ -414,7 +414,7 @@ TEST_F(TestVcfEntry, sampleDataPrintCertainSample) {
 TEST_F(TestVcfEntry, multipleFilters) {
     stringstream vcfss(filteredTwiceLine);
     string line;
-    ASSERT_TRUE(getline(vcfss, line));
+    ASSERT_TRUE(bool(getline(vcfss, line)));
     Entry e(&_header, line);
 
     EXPECT_EQ(2u, e.failedFilters().size());
@@ -424,7 +424,7 @@ TEST_F(TestVcfEntry, multipleFilters) {
 TEST_F(TestVcfEntry, multipleFiltersWhitelist) {
     stringstream vcfss(filteredTwiceLine);
     string line;
-    ASSERT_TRUE(getline(vcfss, line));
+    ASSERT_TRUE(bool(getline(vcfss, line)));
     Entry e(&_header, line);
 
     EXPECT_EQ(2u, e.failedFilters().size());
@@ -443,3 +443,120 @@ TEST_F(TestVcfEntry, multipleFiltersWhitelist) {
     whitelist.insert("q10");
     EXPECT_FALSE(e.isFilteredByAnythingExcept(whitelist));
 }
+
+TEST_F(TestVcfEntry, filterSymbols) {
+    stringstream vcfss(filteredTwiceLine);
+    string line;
+    ASSERT_TRUE(bool(getline(vcfss, line)));
+    Entry e(&_header, line);
+
+    auto const& filters = e.failedFilters();
+    EXPECT_EQ(1u, filters.count(_header.filterSymbol("q10")));
+    EXPECT_EQ(1u, filters.count(Symbol("s50")));
+    EXPECT_EQ(0u, filters.count(Symbol::pass()));
+
+    SymbolSet whitelist;
+    whitelist.insert(Symbol("q10"));
+    EXPECT_TRUE(e.isFilteredByAnythingExcept(whitelist));
+    whitelist.insert(Symbol("s50"));
+    EXPECT_FALSE(e.isFilteredByAnythingExcept(whitelist));
+
+    // filters are written in name order whatever order they were added in
+    e.clearFilters();
+    e.addFilter("zz");
+    e.addFilter("aa");
+    std::stringstream ss;
+    e.allButSamplesToStream(ss);
+    EXPECT_NE(std::string::npos, ss.str().find("\taa;zz\t"));
+}
+
+TEST_F(TestVcfEntry, infoSymbols) {
+    Entry e(v[0]);
+    Symbol dp = _header.infoType("DP")->symbol();
+    ASSERT_TRUE(e.info(dp));
+    EXPECT_EQ(e.info("DP"), e.info(dp));
+    EXPECT_EQ(14, *e.info(dp)->get<int64_t>(0));
+    EXPECT_TRUE(e.info(Symbol("FILTER_ONLY_SYMBOL")) == 0);
+    EXPECT_TRUE(e.info("NOT_A_SYMBOL_AT_ALL") == 0);
+
+    // INFO keeps name order when it is written from the parsed values
+    e.setInfo("AA", CustomValue(_header.infoType("AA"), "G"));
+    std::stringstream ss;
+    e.allButSamplesToStream(ss);
+    EXPECT_EQ("20\t14370\trs6054257\tG\tA\t29\t.\tAA=G;AF=0.5;DB;DP=14;H2;NS=3", ss.str());
+
+    // fields missing from the header go through the SymbolTable
+    CustomType undeclared("UNDECLARED_INFO", CustomType::FIXED_SIZE, 1, CustomType::INTEGER, "x");
+    e.setInfo("UNDECLARED_INFO", CustomValue(&undeclared, "3"));
+    ASSERT_TRUE(e.info("UNDECLARED_INFO"));
+    EXPECT_EQ(e.info("UNDECLARED_INFO"), e.info(Symbol("UNDECLARED_INFO")));
+    EXPECT_EQ(3, *e.info("UNDECLARED_INFO")->get<int64_t>(0));
+}
+
+TEST_F(TestVcfEntry, unchangedColumnsPassThrough) {
+    std::string line(
+        "20\t14370\trs2;rs1\tG\tA\t29.50\tq10;PASS\tDP=14;AF=0.50\tGT\t0|0\t1|0\t1/1"
+        );
+    Entry e(&_header, line);
+    EXPECT_EQ(line, e.toString());
+
+    // parsing fields does not change them
+    ASSERT_TRUE(e.info("AF"));
+    EXPECT_DOUBLE_EQ(0.5, *e.info("AF")->get<double>(0));
+    EXPECT_EQ(line, e.toString());
+
+    e.addIdentifier("rs3");
+    EXPECT_EQ(
+        "20\t14370\trs1;rs2;rs3\tG\tA\t29.50\tq10;PASS\tDP=14;AF=0.50\tGT\t0|0\t1|0\t1/1",
+        e.toString());
+
+    e.replaceAlts(14371, "C", std::vector<std::string>{"T"});
+    e.addFilter("s50");
+    EXPECT_EQ(
+        "20\t14371\trs1;rs2;rs3\tC\tT\t29.50\tq10;s50\tDP=14;AF=0.50\tGT\t0|0\t1|0\t1/1",
+        e.toString());
+
+    // copies keep the text, parsing a new line resets it
+    Entry copy(e);
+    EXPECT_EQ(e.toString(), copy.toString());
+    copy.parse(&_header, line);
+    EXPECT_EQ(line, copy.toString());
+}
+
+TEST_F(TestVcfEntry, mutatorsUpdateWrittenLine) {
+    Entry e(&_header,
+        "20\t14370\trs2\tG\tA\t29.50\tq10\tDP=14\tGT:DP\t0|0:3\t1|0:5\t1/1:7");
+
+    e.addIdentifier("rs1");
+    EXPECT_EQ(
+        "20\t14370\trs1;rs2\tG\tA\t29.50\tq10\tDP=14\tGT:DP\t0|0:3\t1|0:5\t1/1:7",
+        e.toString());
+
+    e.clearFilters();
+    EXPECT_EQ(
+        "20\t14370\trs1;rs2\tG\tA\t29.50\t.\tDP=14\tGT:DP\t0|0:3\t1|0:5\t1/1:7",
+        e.toString());
+
+    e.addFilter("s50");
+    EXPECT_EQ(
+        "20\t14370\trs1;rs2\tG\tA\t29.50\ts50\tDP=14\tGT:DP\t0|0:3\t1|0:5\t1/1:7",
+        e.toString());
+
+    e.setInfo("DP", CustomValue(_header.infoType("DP"), "20"));
+    EXPECT_EQ(
+        "20\t14370\trs1;rs2\tG\tA\t29.50\ts50\tDP=20\tGT:DP\t0|0:3\t1|0:5\t1/1:7",
+        e.toString());
+
+    e.replaceAlts(14371, "C", std::vector<std::string>{"T"});
+    EXPECT_EQ(
+        "20\t14371\trs1;rs2\tC\tT\t29.50\ts50\tDP=20\tGT:DP\t0|0:3\t1|0:5\t1/1:7",
+        e.toString());
+
+    stringstream ss(header2Text);
+    Header merged = Header::fromStream(ss);
+    merged.merge(_header, true);
+    e.reheader(&merged);
+    EXPECT_EQ(
+        "20\t14371\trs1;rs2\tC\tT\t29.50\ts50\tDP=20\tGT:DP\t.\t1/1:7\t1|0:5\t0|0:3",
+        e.toString());
+}
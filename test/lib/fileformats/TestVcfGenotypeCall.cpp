@@ -122,3 +122,110 @@ TEST(GenotypeCall, genotypeIndex) {
     EXPECT_EQ("1/.", ss.str());
     EXPECT_TRUE(idx == 1u);
 }
+
+namespace {
+    PackedGenotype parsePacked(std::string const& s) {
+        return PackedGenotype::parse(s.data(), s.data() + s.size());
+    }
+}
+
+TEST(PackedGenotype, empty) {
+    PackedGenotype gt;
+    EXPECT_TRUE(gt.packed());
+    EXPECT_TRUE(gt.empty());
+    EXPECT_EQ(0u, gt.size());
+    EXPECT_FALSE(gt.null());
+    EXPECT_FALSE(gt.reference());
+    EXPECT_EQ(".", gt.toString());
+    EXPECT_EQ(gt, parsePacked("."));
+}
+
+TEST(PackedGenotype, roundTrip) {
+    char const* calls[] = {
+        "0", "1", "0/1", "0|1", "1|0", "./.", "./1", "1|.", "12/345",
+        "0/1/2", "1|2/3", "0|1|2|3", "./././.", "268435454/0", "16382/0/0"
+    };
+    for (auto i = std::begin(calls); i != std::end(calls); ++i) {
+        SCOPED_TRACE(*i);
+        PackedGenotype gt = parsePacked(*i);
+        ASSERT_TRUE(gt.packed());
+        EXPECT_EQ(*i, gt.toString());
+        EXPECT_EQ(*i, GenotypeCall(gt).string());
+    }
+}
+
+TEST(PackedGenotype, notPacked) {
+    char const* calls[] = {
+        "", "0/1/2/3/4", "01/1", "+1/0", "0/", "/1", "a/b", "1//2",
+        "268435455/0", "16383/0/0", "4294967295/0", "99999999999/0"
+    };
+    for (auto i = std::begin(calls); i != std::end(calls); ++i) {
+        SCOPED_TRACE(*i);
+        PackedGenotype gt = parsePacked(*i);
+        EXPECT_FALSE(gt.packed());
+        EXPECT_FALSE(gt.empty());
+        EXPECT_FALSE(gt.diploid());
+    }
+}
+
+TEST(PackedGenotype, matchesGenotypeCall) {
+    char const* calls[] = {
+        ".", "0", "1", "0/0", "0|0", "0/1", "1/0", "1|1", "2/1", "./.",
+        "./1", "0/.", "0/0/0", "0/1/1", ".|.|.", "3/2/1/0"
+    };
+    for (auto i = std::begin(calls); i != std::end(calls); ++i) {
+        SCOPED_TRACE(*i);
+        PackedGenotype packed = parsePacked(*i);
+        GenotypeCall call(*i);
+        ASSERT_TRUE(packed.packed());
+
+        EXPECT_EQ(call.empty(), packed.empty());
+        EXPECT_EQ(call.size(), packed.size());
+        EXPECT_EQ(call.phased(), packed.phased());
+        EXPECT_EQ(call.null(), packed.null());
+        EXPECT_EQ(call.partial(), packed.partial());
+        EXPECT_EQ(call.heterozygous(), packed.heterozygous());
+        EXPECT_EQ(call.homozygous(), packed.homozygous());
+        EXPECT_EQ(call.diploid(), packed.diploid());
+        EXPECT_EQ(call.reference(), packed.reference());
+
+        GenotypeIndex indices[PackedGenotype::MAX_PLOIDY];
+        uint32_t n = packed.indices(indices);
+        EXPECT_EQ(call.indices(), std::vector<GenotypeIndex>(indices, indices + n));
+
+        n = packed.distinctIndices(indices);
+        std::vector<GenotypeIndex> expected(call.indexSet().begin(), call.indexSet().end());
+        EXPECT_EQ(expected, std::vector<GenotypeIndex>(indices, indices + n));
+
+        EXPECT_EQ(call, GenotypeCall(packed));
+        EXPECT_EQ(packed, PackedGenotype::fromCall(call));
+    }
+}
+
+TEST(PackedGenotype, append) {
+    PackedGenotype gt;
+    EXPECT_TRUE(gt.append(GenotypeIndex{1}, false));
+    EXPECT_TRUE(gt.append(GenotypeIndex{1000}, true));
+    EXPECT_EQ("1|1000", gt.toString());
+
+    // the third allele halves the width, repacking the others
+    EXPECT_TRUE(gt.append(GenotypeIndex::Null, false));
+    EXPECT_EQ("1|1000/.", gt.toString());
+    EXPECT_EQ(3u, gt.size());
+    EXPECT_EQ(1000u, gt[1]);
+    EXPECT_TRUE(gt[2].null());
+
+    EXPECT_TRUE(gt.append(GenotypeIndex{2}, true));
+    EXPECT_EQ("1|1000/.|2", gt.toString());
+    EXPECT_FALSE(gt.append(GenotypeIndex{3}, false));
+    EXPECT_EQ("1|1000/.|2", gt.toString());
+
+    PackedGenotype wide;
+    EXPECT_TRUE(wide.append(GenotypeIndex{0}, false));
+    EXPECT_TRUE(wide.append(GenotypeIndex{PackedGenotype::MAX_DIPLOID_INDEX}, false));
+    EXPECT_FALSE(wide.append(GenotypeIndex{0}, false));
+    EXPECT_EQ(2u, wide.size());
+
+    EXPECT_FALSE(PackedGenotype::unpacked().packed());
+    EXPECT_FALSE(PackedGenotype::unpacked().append(GenotypeIndex{0}, false));
+}
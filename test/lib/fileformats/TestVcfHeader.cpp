@@ -303,3 +303,27 @@ TEST(VcfHeader, renameSamples) {
     EXPECT_EQ("S2", *tag->get("ID"));
     EXPECT_EQ("y", *tag->get("Data"));
 }
+
+TEST(VcfHeader, readerOptions) {
+    Header h = Header::fromString(headerText);
+    EXPECT_TRUE(h.parsesFormatField("GQ"));
+    EXPECT_TRUE(h.parsesSample(1));
+
+    ReaderOptions opts;
+    opts.formatFields = {"GT", "DP"};
+    opts.samples = {"NA00002"};
+    h.readerOptions(opts);
+
+    EXPECT_TRUE(h.parsesFormatField("GT"));
+    EXPECT_TRUE(h.parsesFormatField("DP"));
+    EXPECT_FALSE(h.parsesFormatField("GQ"));
+    EXPECT_FALSE(h.parsesSample(0));
+    EXPECT_TRUE(h.parsesSample(1));
+    EXPECT_FALSE(h.parsesSample(2));
+
+    opts.samples = {"nope"};
+    EXPECT_THROW(h.readerOptions(opts), SampleNotFoundError);
+    // unchanged by the failed call
+    EXPECT_TRUE(h.parsesSample(1));
+    EXPECT_FALSE(h.parsesSample(0));
+}
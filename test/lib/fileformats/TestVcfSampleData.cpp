@@ -253,3 +253,185 @@ TEST_F(TestVcfSampleData, addFilterReflectingSamples) {
     EXPECT_EQ("HATE", filterName);
     EXPECT_FALSE(sd.isSampleFiltered(mainIdx));
 }
+
+TEST_F(TestVcfSampleData, columns) {
+    std::string txt = format + "\t0/1:34:120:31,.:1e-06:A,B,C\t.\t./.:.";
+    Vcf::SampleData sd(&header, txt);
+
+    EXPECT_EQ(6, sd.fieldCount(0));
+    EXPECT_EQ(-1, sd.fieldCount(1));
+    EXPECT_EQ(2, sd.fieldCount(2));
+    EXPECT_EQ(-1, sd.fieldCount(3));
+
+    auto const& gq = sd.column(1);
+    ASSERT_EQ(1u, gq.size(0));
+    EXPECT_FALSE(gq.missing(0, 0));
+    EXPECT_EQ(34, gq.integer(0, 0));
+    EXPECT_EQ(0u, gq.size(2));
+
+    auto const& hq = sd.column(3);
+    ASSERT_EQ(2u, hq.size(0));
+    EXPECT_EQ(31, hq.integer(0, 0));
+    EXPECT_TRUE(hq.missing(0, 1));
+
+    EXPECT_DOUBLE_EQ(1e-06, sd.column(4).real(0, 0));
+
+    auto const& vlsl = sd.column(5);
+    ASSERT_EQ(3u, vlsl.size(0));
+    EXPECT_EQ("A", vlsl.string(0, 0));
+    EXPECT_EQ("C", vlsl.string(0, 2));
+    EXPECT_THROW(sd.column(1).string(0, 0), std::runtime_error);
+
+    EXPECT_EQ("./.", sd.column(0).string(2, 0));
+    EXPECT_EQ(0u, sd.column(1).size(2));
+
+    // the CustomValue views agree with the columns
+    Vcf::CustomValue const* hqValue = sd.get(0, "HQ");
+    ASSERT_TRUE(hqValue);
+    ASSERT_EQ(2u, hqValue->size());
+    EXPECT_EQ(31, *hqValue->get<int64_t>(0));
+    EXPECT_FALSE(hqValue->get<int64_t>(1));
+    EXPECT_FALSE(sd.get(2, "HQ"));
+}
+
+TEST_F(TestVcfSampleData, iterateSamplesWithData) {
+    std::string txt = "GT\t.\t0/1\t.\t1/1";
+    Vcf::SampleData sd(&header, txt);
+
+    std::vector<uint32_t> expected{1, 3};
+    std::vector<uint32_t> indices(sd.begin(), sd.end());
+    EXPECT_EQ(expected, indices);
+    EXPECT_EQ(2u, sd.size());
+    EXPECT_EQ(0u, sd.count(0));
+    EXPECT_EQ(1u, sd.count(1));
+}
+
+TEST_F(TestVcfSampleData, roundTrip) {
+    std::string txt = "GT:DP:HQ:FT\t0/1:12:1,.\t.\t1/1\t0/0:.:.,3:PASS\t./.:7";
+    Vcf::SampleData sd(&header, txt);
+
+    std::stringstream ss;
+    ss << sd;
+    EXPECT_EQ(txt, ss.str());
+
+    // copies are independent
+    Vcf::SampleData copy(sd);
+    copy.addFilter(0, "BAD");
+    ss.str("");
+    ss << sd;
+    EXPECT_EQ(txt, ss.str());
+
+    ss.str("");
+    copy.sampleToStream(ss, 0);
+    EXPECT_EQ("0/1:12:1,.:BAD", ss.str());
+}
+
+TEST_F(TestVcfSampleData, invalidValues) {
+    EXPECT_THROW(Vcf::SampleData(&header, "GT:DP\t0/1:x"), std::runtime_error);
+    EXPECT_THROW(Vcf::SampleData(&header, "GT:HQ\t0/1:1,,2"), std::runtime_error);
+    EXPECT_THROW(Vcf::SampleData(&header, "GT:HQ\t0/1:1,2,3"), std::runtime_error);
+    EXPECT_THROW(Vcf::SampleData(&header, "GT:FPV\t0/1:1.5x"), std::runtime_error);
+    EXPECT_THROW(Vcf::SampleData(&header, "GT\t0/1:1"), std::runtime_error);
+}
+
+TEST_F(TestVcfSampleData, mirroredSamplesCopyOnWrite) {
+    std::string txt = format + "\t" + oneSample;
+
+    header.mirrorSample("S1", "S1-COPY");
+    auto mainIdx = header.sampleIndex("S1");
+    auto copyIdx = header.sampleIndex("S1-COPY");
+
+    Vcf::SampleData sd(&header, txt);
+
+    Vcf::CustomValue dp(header.formatType("DP"));
+    dp.set<int64_t>(0, 7);
+    sd.setSampleField(copyIdx, std::move(dp));
+
+    EXPECT_EQ(120, *sd.get(mainIdx, "DP")->get<int64_t>(0));
+    EXPECT_EQ(7, *sd.get(copyIdx, "DP")->get<int64_t>(0));
+    EXPECT_EQ(34, *sd.get(copyIdx, "GQ")->get<int64_t>(0));
+}
+
+TEST_F(TestVcfSampleData, packedGenotypes) {
+    std::string txt = "GT:DP\t0|1:3\t.\t01/1\t0/1/2/3/4\t./2:5";
+    Vcf::SampleData sd(&header, txt);
+
+    EXPECT_EQ("0|1", sd.packedGenotype(0).toString());
+    EXPECT_TRUE(sd.packedGenotype(1).empty());
+    // not in canonical form, but still packs through GenotypeCall
+    EXPECT_EQ("1/1", sd.packedGenotype(2).toString());
+    EXPECT_FALSE(sd.packedGenotype(3).packed());
+    EXPECT_EQ(5u, sd.genotype(3).size());
+    EXPECT_TRUE(sd.packedGenotype(4).partial());
+
+    std::map<size_t, size_t> altMap{{1, 3}, {2, 1}};
+    sd.renumberGT(altMap);
+
+    std::stringstream ss;
+    ss << sd;
+    EXPECT_EQ("GT:DP\t0|3:3\t.\t3/3\t0/3/1/3/4\t./1:5", ss.str());
+    EXPECT_EQ("./1", sd.packedGenotype(4).toString());
+    EXPECT_EQ("./1", sd.genotype(4).string());
+    EXPECT_EQ(5, *sd.get(4, "DP")->get<int64_t>(0));
+}
+
+TEST_F(TestVcfSampleData, readerOptions) {
+    // values that do not round trip through their types show what was
+    // parsed
+    std::string txt = "GT:GQ:DP:FPV\t0/1:+3:007:1.50\t.\t1/1:04:1:2.0";
+    Vcf::ReaderOptions opts;
+    opts.formatFields = {"GT", "DP"};
+    opts.samples = {"S1", "S2"};
+    header.readerOptions(opts);
+
+    Vcf::SampleData sd(&header, txt);
+    std::stringstream ss;
+    ss << sd;
+    EXPECT_EQ("GT:GQ:DP:FPV\t0/1:+3:7:1.50\t.\t1/1:04:1:2.0\t.\t.", ss.str());
+    EXPECT_EQ(4, sd.fieldCount(2));
+
+    // the other fields are parsed on first use
+    EXPECT_EQ(3, *sd.get(0, "GQ")->get<int64_t>(0));
+    EXPECT_EQ(4, sd.column(1).integer(2, 0));
+    EXPECT_EQ("1/1", sd.genotype(2).string());
+    ss.str("");
+    ss << sd;
+    EXPECT_EQ("GT:GQ:DP:FPV\t0/1:3:7:1.50\t.\t1/1:4:1:2.0\t.\t.", ss.str());
+    // all of a sample's values are made by get(sampleIdx)
+    ASSERT_TRUE(sd.get(0));
+    ss.str("");
+    ss << sd;
+    EXPECT_EQ("GT:GQ:DP:FPV\t0/1:3:7:1.5\t.\t1/1:4:1:2\t.\t.", ss.str());
+
+    // bad values that are never looked at pass through
+    Vcf::SampleData bad(&header, "GT:GQ\t0/1:x");
+    ss.str("");
+    ss << bad;
+    EXPECT_EQ("GT:GQ\t0/1:x\t.\t.\t.\t.", ss.str());
+    // reading one field leaves the others as they are
+    ASSERT_TRUE(bad.get(0, "GT"));
+    EXPECT_EQ("0/1", bad.genotype(0).string());
+    EXPECT_THROW(bad.column(1), std::runtime_error);
+    ss.str("");
+    ss << bad;
+    EXPECT_EQ("GT:GQ\t0/1:x\t.\t.\t.\t.", ss.str());
+}
+
+TEST_F(TestVcfSampleData, readerOptionsMirroredSamples) {
+    Vcf::ReaderOptions opts;
+    opts.formatFields = {"GT"};
+    header.readerOptions(opts);
+    header.mirrorSample("S1", "S1-COPY");
+    auto copyIdx = header.sampleIndex("S1-COPY");
+
+    Vcf::SampleData sd(&header, "GT:DP\t0/1:08");
+    sd.addFilter(copyIdx, "BAD");
+    EXPECT_EQ(8, *sd.get(0, "DP")->get<int64_t>(0));
+
+    std::stringstream ss;
+    sd.sampleToStream(ss, 0);
+    EXPECT_EQ("0/1:8", ss.str());
+    ss.str("");
+    sd.sampleToStream(ss, copyIdx);
+    EXPECT_EQ("0/1:8:BAD", ss.str());
+}
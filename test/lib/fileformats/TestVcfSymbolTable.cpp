@@ -0,0 +1,89 @@
+#include "fileformats/vcf/SymbolSet.hpp"
+#include "fileformats/vcf/SymbolTable.hpp"
+
+#include <sstream>
+#include <string>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace Vcf;
+
+TEST(VcfSymbolTable, intern) {
+    SymbolTable& table = SymbolTable::instance();
+    uint32_t id = table.intern("TestVcfSymbolTable_a");
+    EXPECT_EQ(id, table.intern("TestVcfSymbolTable_a"));
+    EXPECT_EQ(id, table.find("TestVcfSymbolTable_a"));
+    EXPECT_EQ("TestVcfSymbolTable_a", table.name(id));
+    EXPECT_NE(id, table.intern("TestVcfSymbolTable_b"));
+
+    EXPECT_EQ(SymbolTable::NO_ID, table.find("TestVcfSymbolTable_missing"));
+    EXPECT_EQ(SymbolTable::PASS_ID, table.find("PASS"));
+}
+
+TEST(VcfSymbolTable, manyNames) {
+    // more than fit in one chunk
+    vector<uint32_t> ids;
+    for (int i = 0; i < 3000; ++i) {
+        stringstream ss;
+        ss << "TestVcfSymbolTable_" << i;
+        ids.push_back(SymbolTable::instance().intern(ss.str()));
+    }
+
+    for (int i = 0; i < 3000; ++i) {
+        stringstream ss;
+        ss << "TestVcfSymbolTable_" << i;
+        EXPECT_EQ(ss.str(), SymbolTable::instance().name(ids[i]));
+    }
+}
+
+TEST(VcfSymbol, compare) {
+    Symbol a("TestVcfSymbol_a");
+    Symbol b("TestVcfSymbol_b");
+    EXPECT_EQ(a, Symbol("TestVcfSymbol_a"));
+    EXPECT_NE(a, b);
+    EXPECT_EQ("TestVcfSymbol_a", a.name());
+    EXPECT_EQ(Symbol::pass(), Symbol("PASS"));
+
+    stringstream ss;
+    ss << b;
+    EXPECT_EQ("TestVcfSymbol_b", ss.str());
+}
+
+TEST(VcfSymbol, empty) {
+    Symbol none;
+    EXPECT_TRUE(none.empty());
+    EXPECT_EQ("", none.name());
+    EXPECT_TRUE(Symbol::find("TestVcfSymbol_missing").empty());
+    EXPECT_FALSE(Symbol::pass().empty());
+}
+
+TEST(VcfSymbolSet, sortedByName) {
+    // interned in the opposite order to their names
+    Symbol z("TestVcfSymbolSet_z");
+    Symbol m("TestVcfSymbolSet_m");
+    Symbol a("TestVcfSymbolSet_a");
+
+    SymbolSet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_TRUE(set.insert(m));
+    EXPECT_TRUE(set.insert(z));
+    EXPECT_TRUE(set.insert(a));
+    EXPECT_FALSE(set.insert(m));
+    ASSERT_EQ(3u, set.size());
+
+    auto i = set.begin();
+    EXPECT_EQ("TestVcfSymbolSet_a", *i++);
+    EXPECT_EQ("TestVcfSymbolSet_m", *i++);
+    EXPECT_EQ("TestVcfSymbolSet_z", *i++);
+    EXPECT_TRUE(i == set.end());
+
+    EXPECT_EQ(1u, set.count(z));
+    EXPECT_EQ(0u, set.count(Symbol::pass()));
+    EXPECT_EQ("TestVcfSymbolSet_m", *set.find(m));
+    EXPECT_TRUE(set.find(Symbol::pass()) == set.end());
+
+    EXPECT_EQ(1u, set.erase(m));
+    EXPECT_EQ(0u, set.erase(m));
+    ASSERT_EQ(2u, set.size());
+    EXPECT_EQ("TestVcfSymbolSet_z", *++set.begin());
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+// Input for the line source tests: nLines lines of varying length, each
+// starting with "line". With blankLines, every 100th line is followed by
+// an empty one.
+inline std::string makeLineData(std::size_t nLines, bool blankLines = false) {
+    std::stringstream ss;
+    for (std::size_t i = 0; i < nLines; ++i) {
+        ss << "line " << i << "\t" << std::string(i % 97, 'x') << "\n";
+        if (blankLines && i % 100 == 0)
+            ss << "\n";
+    }
+    return ss.str();
+}
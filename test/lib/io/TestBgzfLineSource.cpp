@@ -0,0 +1,139 @@
+#include "io/BgzfLineSource.hpp"
+
+#include "LineData.hpp"
+#include "io/Bgzf.hpp"
+#include "io/TempFile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    // Write data to path as BGZF, using blocks of (at most) blockDataSize
+    // uncompressed bytes so that we can force lines to straddle blocks.
+    void writeBgzf(
+            std::string const& path,
+            std::string const& data,
+            std::size_t blockDataSize
+            )
+    {
+        std::ofstream out(path.c_str(), std::ios::binary);
+        std::vector<char> block;
+        for (std::size_t pos = 0; pos < data.size(); pos += blockDataSize) {
+            std::size_t len = std::min(blockDataSize, data.size() - pos);
+            Bgzf::deflateBlock(data.data() + pos, len, block);
+            out.write(block.data(), block.size());
+        }
+        out.write(Bgzf::EOF_BLOCK, sizeof(Bgzf::EOF_BLOCK));
+    }
+}
+
+class TestBgzfLineSource : public ::testing::Test {
+public:
+    void SetUp() {
+        _data = makeLineData(2000);
+        _tmp = TempFile::create(TempFile::CLEANUP);
+        _tmp->stream().close();
+        writeBgzf(_tmp->path(), _data, 1000);
+    }
+
+    std::string readAll(BgzfLineSource& input) {
+        std::string line;
+        std::stringstream ss;
+        while (input.getline(line)) {
+            ss << line << "\n";
+        }
+        return ss.str();
+    }
+
+    std::string _data;
+    TempFile::ptr _tmp;
+};
+
+TEST_F(TestBgzfLineSource, isBgzf) {
+    EXPECT_TRUE(Bgzf::isBgzfFile(_tmp->path()));
+
+    TempFile::ptr gz = TempFile::create(TempFile::CLEANUP);
+    gz->stream().close();
+    auto fp = gzopen(gz->path().c_str(), "wb");
+    gzwrite(fp, _data.data(), _data.size());
+    gzclose(fp);
+    EXPECT_FALSE(Bgzf::isBgzfFile(gz->path()));
+}
+
+TEST_F(TestBgzfLineSource, blockRoundTrip) {
+    std::vector<char> block;
+    std::vector<char> inflated;
+    Bgzf::deflateBlock(_data.data(), Bgzf::DEFAULT_BLOCK_DATA_SIZE, block);
+    EXPECT_TRUE(Bgzf::isBgzfHeader(block.data(), block.size()));
+    EXPECT_LE(block.size(), Bgzf::MAX_BLOCK_SIZE);
+
+    Bgzf::inflateBlock(block, inflated);
+    EXPECT_EQ(_data.substr(0, Bgzf::DEFAULT_BLOCK_DATA_SIZE),
+        std::string(inflated.begin(), inflated.end()));
+}
+
+TEST_F(TestBgzfLineSource, corruptBlock) {
+    std::vector<char> block;
+    std::vector<char> inflated;
+    Bgzf::deflateBlock(_data.data(), 100, block);
+    // flip a bit in the crc
+    block[block.size() - 8] ^= 1;
+    EXPECT_THROW(Bgzf::inflateBlock(block, inflated), std::runtime_error);
+}
+
+TEST_F(TestBgzfLineSource, singleThread) {
+    BgzfLineSource input(_tmp->path(), 1);
+    EXPECT_TRUE(input);
+    EXPECT_EQ(_data, readAll(input));
+    EXPECT_TRUE(input.eof());
+}
+
+TEST_F(TestBgzfLineSource, multipleThreads) {
+    BgzfLineSource input(_tmp->path(), 4);
+    EXPECT_TRUE(input);
+    EXPECT_EQ('l', input.peek());
+    EXPECT_EQ(_data, readAll(input));
+    EXPECT_TRUE(input.eof());
+    EXPECT_EQ(EOF, input.peek());
+}
+
+TEST_F(TestBgzfLineSource, stringView) {
+    // lines straddling the 1000 byte blocks are copied, the rest are not
+    BgzfLineSource input(_tmp->path(), 2);
+    StringView line;
+    std::stringstream ss;
+    while (input.getline(line)) {
+        ss << line << "\n";
+    }
+    EXPECT_EQ(_data, ss.str());
+    EXPECT_TRUE(input.eof());
+}
+
+TEST_F(TestBgzfLineSource, noTrailingNewline) {
+    TempFile::ptr tmp = TempFile::create(TempFile::CLEANUP);
+    tmp->stream().close();
+    writeBgzf(tmp->path(), "a\nbb\nccc", 3);
+
+    BgzfLineSource input(tmp->path(), 2);
+    std::string line;
+    EXPECT_TRUE(input.getline(line));
+    EXPECT_EQ("a", line);
+    EXPECT_TRUE(input.getline(line));
+    EXPECT_EQ("bb", line);
+    EXPECT_TRUE(input.getline(line));
+    EXPECT_EQ("ccc", line);
+    EXPECT_FALSE(input.getline(line));
+    EXPECT_TRUE(input.eof());
+}
+
+TEST_F(TestBgzfLineSource, invalidPath) {
+    BgzfLineSource input("/this/path/does/not/exist.gz", 2);
+    EXPECT_FALSE(input);
+}
@@ -0,0 +1,110 @@
+#include "io/BgzfOutputStream.hpp"
+
+#include "LineData.hpp"
+#include "io/Bgzf.hpp"
+#include "io/BgzfLineSource.hpp"
+#include "io/StreamHandler.hpp"
+#include "io/TempFile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    std::string readAll(std::string const& path, std::size_t nThreads) {
+        BgzfLineSource input(path, nThreads);
+        std::string line;
+        std::stringstream ss;
+        while (input.getline(line)) {
+            ss << line << "\n";
+        }
+        return ss.str();
+    }
+}
+
+class TestBgzfOutputStream : public ::testing::Test {
+public:
+    void SetUp() {
+        // large enough to span several blocks
+        _data = makeLineData(20000);
+        _tmp = TempFile::create(TempFile::CLEANUP);
+        _tmp->stream().close();
+    }
+
+    std::string _data;
+    TempFile::ptr _tmp;
+};
+
+TEST_F(TestBgzfOutputStream, roundTrip) {
+    std::size_t const threads[] = {0, 1, 4};
+    for (std::size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); ++i) {
+        SCOPED_TRACE(threads[i]);
+        {
+            std::ofstream file(_tmp->path().c_str(), std::ios::binary);
+            BgzfOutputStream out(file, threads[i]);
+            out << _data;
+        }
+
+        EXPECT_TRUE(Bgzf::isBgzfFile(_tmp->path()));
+        EXPECT_EQ(_data, readAll(_tmp->path(), 0));
+        EXPECT_EQ(_data, readAll(_tmp->path(), 2));
+    }
+}
+
+TEST_F(TestBgzfOutputStream, flushKeepsPartialBlock) {
+    std::stringstream ss;
+    BgzfOutputStream out(ss, 2);
+
+    out << "small amount of data\n";
+    out.flush();
+    EXPECT_TRUE(ss.str().empty());
+
+    out.close();
+    std::string result = ss.str();
+    ASSERT_GT(result.size(), sizeof(Bgzf::EOF_BLOCK));
+    EXPECT_TRUE(Bgzf::isBgzfHeader(result.data(), result.size()));
+    EXPECT_EQ(0, memcmp(Bgzf::EOF_BLOCK,
+        result.data() + result.size() - sizeof(Bgzf::EOF_BLOCK),
+        sizeof(Bgzf::EOF_BLOCK)));
+
+    // closing again is a no-op
+    out.close();
+    EXPECT_EQ(result, ss.str());
+}
+
+TEST_F(TestBgzfOutputStream, emptyStream) {
+    std::stringstream ss;
+    {
+        BgzfOutputStream out(ss, 0);
+    }
+    EXPECT_EQ(std::string(Bgzf::EOF_BLOCK, sizeof(Bgzf::EOF_BLOCK)), ss.str());
+}
+
+TEST_F(TestBgzfOutputStream, streamHandlerCompression) {
+    EXPECT_EQ(StreamHandler::AUTO_COMPRESSION,
+        StreamHandler::outputCompressionFromString("auto"));
+    EXPECT_EQ(StreamHandler::NO_COMPRESSION,
+        StreamHandler::outputCompressionFromString("none"));
+    EXPECT_EQ(StreamHandler::BGZF_COMPRESSION,
+        StreamHandler::outputCompressionFromString("bgzf"));
+    EXPECT_THROW(StreamHandler::outputCompressionFromString("bz2"), std::runtime_error);
+
+    TempFile::ptr tmp = TempFile::create(TempFile::CLEANUP);
+    tmp->stream().close();
+    std::string path = tmp->path() + ".gz";
+    {
+        StreamHandler streams;
+        streams.compressThreads(2);
+        std::ostream* out = streams.get<std::ostream>(path);
+        *out << "hello\n";
+        EXPECT_EQ(out, streams.get<std::ostream>(path));
+        *out << "world\n";
+    }
+    EXPECT_TRUE(Bgzf::isBgzfFile(path));
+    EXPECT_EQ("hello\nworld\n", readAll(path, 0));
+    remove(path.c_str());
+}
@@ -125,6 +125,38 @@ TEST_F(TestGZLineSourceRandom, noTrailingNewline) {
     EXPECT_EQ(_data[NO_TRAILING_NEWLINE], result);
 }
 
+TEST_F(TestGZLineSourceRandom, stringView) {
+    GZipLineSource input(_tmpFiles[TRAILING_NEWLINE]->path());
+    StringView line;
+    std::stringstream ss;
+    while (input.getline(line)) {
+        ss << line << "\n";
+    }
+
+    EXPECT_EQ(_data[TRAILING_NEWLINE], ss.str());
+}
+
+TEST(TestGZLineSource, stringViewStraddlesBuffer) {
+    TempFile::ptr tmp = TempFile::create(TempFile::CLEANUP);
+    size_t sz = GZipLineSource::bufferSize();
+    std::string first(sz / 2, 'a');
+    std::string second(sz, 'b');
+    std::string data = first + "\n" + second + "\nc";
+    tmp->stream().write(data.data(), data.size());
+    tmp->stream().close();
+
+    GZipLineSource input(tmp->path());
+    StringView line;
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ(first, line);
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ(second, line);
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ("c", line);
+    EXPECT_FALSE(input.getline(line));
+    EXPECT_TRUE(input.eof());
+}
+
 TEST(TestGZLineSource, exactBufferFill) {
     TempFile::ptr tmp = TempFile::create(TempFile::CLEANUP);
     size_t sz = GZipLineSource::bufferSize();
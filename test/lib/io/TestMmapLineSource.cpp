@@ -0,0 +1,98 @@
+#include "io/MmapLineSource.hpp"
+
+#include "io/InputStream.hpp"
+#include "io/StreamHandler.hpp"
+#include "io/TempFile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+class TestMmapLineSource : public ::testing::Test {
+public:
+    TempFile::ptr writeTemp(std::string const& data) {
+        TempFile::ptr tmp = TempFile::create(TempFile::CLEANUP);
+        tmp->stream().write(data.data(), data.size());
+        tmp->stream().close();
+        return tmp;
+    }
+};
+
+TEST_F(TestMmapLineSource, trailingNewline) {
+    TempFile::ptr tmp = writeTemp("a\n\nbb\nccc\n");
+    MmapLineSource input(tmp->path());
+    EXPECT_TRUE(input);
+    EXPECT_EQ('a', input.peek());
+
+    std::string line;
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ("a", line);
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ("", line);
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ("bb", line);
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ("ccc", line);
+    EXPECT_FALSE(input.eof());
+    EXPECT_EQ(EOF, input.peek());
+    EXPECT_FALSE(input.getline(line));
+    EXPECT_TRUE(input.eof());
+    EXPECT_FALSE(input);
+}
+
+TEST_F(TestMmapLineSource, stringView) {
+    TempFile::ptr tmp = writeTemp("a\nbb\nccc");
+    MmapLineSource input(tmp->path());
+    StringView line;
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ("a", line);
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ("bb", line);
+    ASSERT_TRUE(input.getline(line));
+    EXPECT_EQ("ccc", line);
+    EXPECT_FALSE(input.getline(line));
+    EXPECT_TRUE(input.eof());
+}
+
+TEST_F(TestMmapLineSource, emptyFile) {
+    TempFile::ptr tmp = writeTemp("");
+    MmapLineSource input(tmp->path());
+    EXPECT_FALSE(input.eof());
+    std::string line;
+    EXPECT_FALSE(input.getline(line));
+    EXPECT_TRUE(input.eof());
+}
+
+TEST_F(TestMmapLineSource, invalidPath) {
+    TempFile::ptr tmp = writeTemp("");
+    std::string path = tmp->path() + ".missing";
+    MmapLineSource input(path);
+    EXPECT_FALSE(input);
+    EXPECT_FALSE(MmapLineSource::canMap(path));
+}
+
+TEST_F(TestMmapLineSource, canMap) {
+    TempFile::ptr plain = writeTemp("x\n");
+    EXPECT_TRUE(MmapLineSource::canMap(plain->path()));
+    EXPECT_FALSE(MmapLineSource::canMap(TempFile::sys_tmpdir()));
+
+    TempFile::ptr gz = writeTemp("");
+    auto fp = gzopen(gz->path().c_str(), "wb");
+    gzwrite(fp, "x\n", 2);
+    gzclose(fp);
+    EXPECT_FALSE(MmapLineSource::canMap(gz->path()));
+
+    // both are read the same way through the stream handler
+    StreamHandler streams;
+    std::string line;
+    InputStream::ptr in = streams.openForReading(plain->path());
+    ASSERT_TRUE(in->getline(line));
+    EXPECT_EQ("x", line);
+    in = streams.openForReading(gz->path());
+    ASSERT_TRUE(in->getline(line));
+    EXPECT_EQ("x", line);
+}
@@ -0,0 +1,106 @@
+#include "io/ReadAheadLineSource.hpp"
+
+#include "LineData.hpp"
+#include "common/compat.hpp"
+#include "io/StreamLineSource.hpp"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+    // Produces a few lines and then fails
+    class FailingLineSource : public ILineSource {
+    public:
+        FailingLineSource()
+            : _lines(0)
+        {}
+
+        using ILineSource::getline;
+        operator bool() const { return true; }
+        char peek() { return 'x'; }
+        bool eof() const { return false; }
+        bool good() const { return true; }
+
+        bool getline(std::string& line) {
+            if (++_lines > 3)
+                throw std::runtime_error("read failed");
+            line = "x";
+            return true;
+        }
+
+    private:
+        int _lines;
+    };
+}
+
+class TestReadAheadLineSource : public ::testing::Test {
+public:
+    void SetUp() {
+        _data = makeLineData(5000, true);
+        _in.str(_data);
+    }
+
+    std::string _data;
+    std::stringstream _in;
+};
+
+TEST_F(TestReadAheadLineSource, read) {
+    ReadAheadLineSource input(std::make_unique<StreamLineSource>(_in), 2, 100);
+    EXPECT_TRUE(input);
+    EXPECT_EQ('l', input.peek());
+
+    std::string line;
+    std::stringstream ss;
+    while (input.getline(line))
+        ss << line << "\n";
+
+    EXPECT_EQ(_data, ss.str());
+    EXPECT_TRUE(input.eof());
+    EXPECT_EQ(EOF, input.peek());
+}
+
+TEST_F(TestReadAheadLineSource, stringView) {
+    ReadAheadLineSource input(std::make_unique<StreamLineSource>(_in), 4);
+    StringView line;
+    std::stringstream ss;
+    while (input.getline(line)) {
+        ss << line << "\n";
+        // peek() may refill the buffer line points into, so it is not
+        // used after this
+        if (line.empty()) {
+            EXPECT_EQ('l', input.peek());
+        }
+    }
+    EXPECT_EQ(_data, ss.str());
+}
+
+TEST_F(TestReadAheadLineSource, readerStalls) {
+    // the reader fills the single slot and has to wait for us
+    ReadAheadLineSource input(std::make_unique<StreamLineSource>(_in), 1, 10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::string line;
+    while (input.getline(line))
+        ;
+    EXPECT_LT(0u, input.readerStalls());
+}
+
+TEST_F(TestReadAheadLineSource, stopEarly) {
+    // destroying the source before reading everything must not hang
+    ReadAheadLineSource input(std::make_unique<StreamLineSource>(_in), 1, 10);
+    std::string line;
+    EXPECT_TRUE(input.getline(line));
+}
+
+TEST_F(TestReadAheadLineSource, exceptionPropagates) {
+    ReadAheadLineSource input(std::make_unique<FailingLineSource>(), 2, 1);
+    std::string line;
+    EXPECT_TRUE(input.getline(line));
+    EXPECT_TRUE(input.getline(line));
+    EXPECT_TRUE(input.getline(line));
+    EXPECT_THROW(input.getline(line), std::runtime_error);
+}
@@ -0,0 +1,277 @@
+#include "io/RegionLineSource.hpp"
+
+#include "common/compat.hpp"
+#include "common/Exceptions.hpp"
+#include "io/Bgzf.hpp"
+#include "io/BgzfLineSource.hpp"
+#include "io/StreamHandler.hpp"
+#include "io/TabixIndex.hpp"
+#include "io/TempFile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Record {
+        std::string seq;
+        int64_t begin;
+        int64_t end;
+
+        std::string line() const {
+            std::stringstream ss;
+            ss << seq << "\t" << begin << "\t" << end;
+            return ss.str();
+        }
+    };
+
+    void appendInt32(std::string& s, int32_t v) {
+        for (int i = 0; i < 4; ++i)
+            s.push_back(char((uint32_t(v) >> (8 * i)) & 0xff));
+    }
+
+    void appendUint64(std::string& s, uint64_t v) {
+        for (int i = 0; i < 8; ++i)
+            s.push_back(char((v >> (8 * i)) & 0xff));
+    }
+
+    void writeBgzfBlocks(std::ofstream& out, std::string const& data) {
+        std::vector<char> block;
+        for (std::size_t pos = 0; pos < data.size(); pos += Bgzf::DEFAULT_BLOCK_DATA_SIZE) {
+            std::size_t len = std::min(data.size() - pos, Bgzf::DEFAULT_BLOCK_DATA_SIZE);
+            Bgzf::deflateBlock(data.data() + pos, len, block);
+            out.write(block.data(), block.size());
+        }
+        out.write(Bgzf::EOF_BLOCK, sizeof(Bgzf::EOF_BLOCK));
+    }
+
+    // Writes sorted bed records as BGZF with linesPerBlock lines in each
+    // block along with a minimal tabix index.
+    void writeIndexedBed(
+            std::string const& path,
+            std::string const& header,
+            std::vector<Record> const& records,
+            std::size_t linesPerBlock
+            )
+    {
+        std::vector<std::string> seqNames;
+        std::vector<std::map<uint32_t, std::vector<TabixIndex::Chunk>>> bins;
+        std::vector<std::vector<uint64_t>> intervals;
+
+        std::ofstream out(path.c_str(), std::ios::binary);
+        std::vector<char> block;
+        Bgzf::deflateBlock(header.data(), header.size(), block);
+        out.write(block.data(), block.size());
+
+        for (std::size_t i = 0; i < records.size(); i += linesPerBlock) {
+            uint64_t blockOffset = out.tellp();
+            std::string data;
+            for (std::size_t j = i; j < records.size() && j < i + linesPerBlock; ++j) {
+                Record const& r = records[j];
+                if (seqNames.empty() || seqNames.back() != r.seq) {
+                    seqNames.push_back(r.seq);
+                    bins.resize(seqNames.size());
+                    intervals.resize(seqNames.size());
+                }
+
+                uint64_t begin = (blockOffset << 16) | data.size();
+                data += r.line() + "\n";
+                uint64_t end = (blockOffset << 16) | data.size();
+
+                uint32_t bin = TabixIndex::reg2bin(r.begin, r.end,
+                    TabixIndex::TBI_MIN_SHIFT, TabixIndex::TBI_DEPTH);
+                bins.back()[bin].push_back(TabixIndex::Chunk(begin, end));
+
+                auto& iv = intervals.back();
+                std::size_t last = (r.end - 1) >> TabixIndex::TBI_MIN_SHIFT;
+                if (iv.size() <= last)
+                    iv.resize(last + 1, 0);
+                for (std::size_t w = r.begin >> TabixIndex::TBI_MIN_SHIFT; w <= last; ++w) {
+                    if (iv[w] == 0)
+                        iv[w] = begin;
+                }
+            }
+            Bgzf::deflateBlock(data.data(), data.size(), block);
+            out.write(block.data(), block.size());
+        }
+        out.write(Bgzf::EOF_BLOCK, sizeof(Bgzf::EOF_BLOCK));
+
+        std::string idx("TBI\1");
+        appendInt32(idx, seqNames.size());
+        appendInt32(idx, TabixIndex::GENERIC | TabixIndex::UCSC_FLAG);
+        appendInt32(idx, 1);
+        appendInt32(idx, 2);
+        appendInt32(idx, 3);
+        appendInt32(idx, '#');
+        appendInt32(idx, 0);
+        std::string names;
+        for (auto i = seqNames.begin(); i != seqNames.end(); ++i)
+            names += *i + '\0';
+        appendInt32(idx, names.size());
+        idx += names;
+
+        for (std::size_t i = 0; i < seqNames.size(); ++i) {
+            appendInt32(idx, bins[i].size());
+            for (auto b = bins[i].begin(); b != bins[i].end(); ++b) {
+                appendInt32(idx, b->first);
+                appendInt32(idx, b->second.size());
+                for (auto c = b->second.begin(); c != b->second.end(); ++c) {
+                    appendUint64(idx, c->begin);
+                    appendUint64(idx, c->end);
+                }
+            }
+            auto& iv = intervals[i];
+            for (std::size_t w = 1; w < iv.size(); ++w) {
+                if (iv[w] == 0)
+                    iv[w] = iv[w - 1];
+            }
+            appendInt32(idx, iv.size());
+            for (auto w = iv.begin(); w != iv.end(); ++w)
+                appendUint64(idx, *w);
+        }
+
+        std::ofstream idxOut((path + ".tbi").c_str(), std::ios::binary);
+        writeBgzfBlocks(idxOut, idx);
+    }
+}
+
+class TestRegionLineSource : public ::testing::Test {
+public:
+    void SetUp() {
+        _header = "#chrom\tstart\tend\n";
+        char const* seqs[] = {"1", "2", "10"};
+        for (std::size_t s = 0; s < 3; ++s) {
+            for (int64_t pos = 0; pos < 200000; pos += 1000) {
+                Record r = {seqs[s], pos, pos + 100};
+                _records.push_back(r);
+                // a few long records that span several regions
+                if (pos % 50000 == 0) {
+                    r.end = pos + 40000;
+                    _records.push_back(r);
+                }
+            }
+        }
+
+        _tmp = TempFile::create(TempFile::CLEANUP);
+        _tmp->stream().close();
+        _path = _tmp->path() + ".bed.gz";
+        writeIndexedBed(_path, _header, _records, 17);
+    }
+
+    void TearDown() {
+        remove(_path.c_str());
+        remove((_path + ".tbi").c_str());
+    }
+
+    std::string query(std::vector<std::string> const& regions, std::size_t nThreads = 1) {
+        RegionLineSource in(
+            std::make_unique<BgzfLineSource>(_path, nThreads),
+            TabixIndex::loadForFile(_path),
+            regions);
+        std::string line;
+        std::stringstream ss;
+        while (in.getline(line))
+            ss << line << "\n";
+        return ss.str();
+    }
+
+    // records overlapping [begin, end) on seq, the hard way
+    std::string expected(std::string const& seq, int64_t begin, int64_t end) {
+        std::string rv;
+        for (auto i = _records.begin(); i != _records.end(); ++i) {
+            if (i->seq == seq && i->begin < end && i->end > begin)
+                rv += i->line() + "\n";
+        }
+        return rv;
+    }
+
+    std::string _header;
+    std::vector<Record> _records;
+    TempFile::ptr _tmp;
+    std::string _path;
+};
+
+TEST_F(TestRegionLineSource, index) {
+    TabixIndex::ptr index = TabixIndex::loadForFile(_path);
+    ASSERT_TRUE(index.get());
+    ASSERT_EQ(3u, index->sequenceNames().size());
+    EXPECT_EQ(1, index->sequenceId("2"));
+    EXPECT_EQ(-1, index->sequenceId("3"));
+    EXPECT_EQ('#', index->config().metaChar);
+    EXPECT_TRUE(index->chunks(0, 1000000, 2000000).empty());
+    EXPECT_FALSE(index->chunks(0, 0, 1).empty());
+
+    EXPECT_FALSE(TabixIndex::loadForFile(_tmp->path()).get());
+}
+
+TEST_F(TestRegionLineSource, reg2bin) {
+    EXPECT_EQ(4681u, TabixIndex::reg2bin(0, 1, 14, 5));
+    EXPECT_EQ(4682u, TabixIndex::reg2bin(1 << 14, (1 << 14) + 1, 14, 5));
+    EXPECT_EQ(585u, TabixIndex::reg2bin(0, 1 << 17, 14, 5));
+    EXPECT_EQ(0u, TabixIndex::reg2bin(0, 1 << 29, 14, 5));
+
+    std::vector<uint32_t> bins;
+    TabixIndex::reg2bins(0, 1, 14, 5, bins);
+    std::vector<uint32_t> expected{0, 1, 9, 73, 585, 4681};
+    EXPECT_EQ(expected, bins);
+}
+
+TEST_F(TestRegionLineSource, singleRegion) {
+    EXPECT_EQ(_header + expected("1", 5000, 5100), query({"1:5001-5100"}));
+    EXPECT_EQ(_header + expected("2", 49999, 50001), query({"2:50000-50001"}));
+    EXPECT_EQ(_header + expected("10", 60050, 200000), query({"10:60,051"}));
+}
+
+TEST_F(TestRegionLineSource, wholeSequence) {
+    EXPECT_EQ(_header + expected("2", 0, 1000000), query({"2"}));
+    EXPECT_EQ(_header, query({"3"}));
+    EXPECT_EQ(_header, query({"3:1-100"}));
+}
+
+TEST_F(TestRegionLineSource, multipleRegions) {
+    // regions are given out of order and some records span both of the
+    // regions on sequence 1, those must only be reported once
+    std::string rv = query({"10:1-10", "1:60001-60010", "1:70001-70010"});
+
+    std::string exp = _header;
+    for (auto i = _records.begin(); i != _records.end(); ++i) {
+        if (i->seq == "1" && ((i->begin < 60010 && i->end > 60000)
+            || (i->begin < 70010 && i->end > 70000)))
+        {
+            exp += i->line() + "\n";
+        }
+    }
+    exp += expected("10", 0, 10);
+
+    EXPECT_EQ(exp, rv);
+    EXPECT_EQ(std::string::npos, rv.find("1\t65000\t65100\n"));
+}
+
+TEST_F(TestRegionLineSource, threads) {
+    EXPECT_EQ(query({"2:100000-150000"}, 1), query({"2:100000-150000"}, 4));
+}
+
+TEST_F(TestRegionLineSource, invalidRegion) {
+    EXPECT_THROW(query({"1:abc"}), std::runtime_error);
+    EXPECT_THROW(query({"1:100-50"}), std::runtime_error);
+}
+
+TEST_F(TestRegionLineSource, streamHandler) {
+    StreamHandler streams;
+    std::vector<std::string> regions{"1:1-1"};
+    InputStream::ptr in = streams.openForReading(_path, regions);
+    std::string line;
+    ASSERT_TRUE(in->getline(line));
+    EXPECT_EQ("#chrom\tstart\tend", line);
+    ASSERT_TRUE(in->getline(line));
+    EXPECT_EQ("1\t0\t100", line);
+
+    EXPECT_THROW(streams.openForReading(_tmp->path(), regions), IOError);
+    EXPECT_THROW(streams.openForReading("-", regions), IOError);
+}
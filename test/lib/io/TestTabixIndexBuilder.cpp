@@ -0,0 +1,143 @@
+#include "io/TabixIndexBuilder.hpp"
+
+#include "common/Exceptions.hpp"
+#include "common/compat.hpp"
+#include "io/Bgzf.hpp"
+#include "io/BgzfLineSource.hpp"
+#include "io/BgzfOutputStream.hpp"
+#include "io/RegionLineSource.hpp"
+#include "io/StreamHandler.hpp"
+#include "io/TempFile.hpp"
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Record {
+        std::string seq;
+        int64_t begin;
+        int64_t end;
+
+        std::string line() const {
+            std::stringstream ss;
+            ss << seq << "\t" << begin << "\t" << end << "\tsome\tpadding";
+            return ss.str();
+        }
+    };
+}
+
+class TestTabixIndexBuilder : public ::testing::TestWithParam<StreamHandler::OutputIndex> {
+public:
+    void SetUp() {
+        _header = "#chrom\tstart\tend\n";
+        char const* seqs[] = {"1", "2", "X"};
+        for (std::size_t s = 0; s < 3; ++s) {
+            for (int64_t pos = 0; pos < 3000000; pos += 700) {
+                Record r = {seqs[s], pos, pos + 50 + pos % 300};
+                _records.push_back(r);
+                if (pos % 100000 == 0) {
+                    r.end = pos + 250000;
+                    _records.push_back(r);
+                }
+            }
+        }
+
+        _tmp = TempFile::create(TempFile::CLEANUP);
+        _tmp->stream().close();
+        _path = _tmp->path() + ".bed.gz";
+        _indexPath = _path + (GetParam() == StreamHandler::CSI_INDEX ? ".csi" : ".tbi");
+    }
+
+    void TearDown() {
+        remove(_path.c_str());
+        remove(_indexPath.c_str());
+    }
+
+    void writeRecords() {
+        StreamHandler streams;
+        streams.compressThreads(2);
+        streams.outputIndex(GetParam());
+        std::ostream* out = streams.get<std::ostream>(_path);
+        *out << _header;
+        for (auto i = _records.begin(); i != _records.end(); ++i)
+            *out << i->line() << "\n";
+    }
+
+    std::string query(std::vector<std::string> const& regions) {
+        RegionLineSource in(
+            std::make_unique<BgzfLineSource>(_path, 2),
+            TabixIndex::loadForFile(_path),
+            regions);
+        std::string line;
+        std::stringstream ss;
+        while (in.getline(line))
+            ss << line << "\n";
+        return ss.str();
+    }
+
+    std::string expected(std::string const& seq, int64_t begin, int64_t end) {
+        std::string rv = _header;
+        for (auto i = _records.begin(); i != _records.end(); ++i) {
+            if (i->seq == seq && i->begin < end && i->end > begin)
+                rv += i->line() + "\n";
+        }
+        return rv;
+    }
+
+    std::string _header;
+    std::vector<Record> _records;
+    TempFile::ptr _tmp;
+    std::string _path;
+    std::string _indexPath;
+};
+
+TEST_P(TestTabixIndexBuilder, regions) {
+    writeRecords();
+    ASSERT_EQ(0, access(_indexPath.c_str(), R_OK));
+
+    TabixIndex::ptr index = TabixIndex::loadForFile(_path);
+    ASSERT_TRUE(index.get());
+    std::vector<std::string> names{"1", "2", "X"};
+    EXPECT_EQ(names, index->sequenceNames());
+    EXPECT_EQ(TabixIndex::GENERIC | TabixIndex::UCSC_FLAG, index->config().format);
+
+    EXPECT_EQ(expected("1", 0, 1), query({"1:1-1"}));
+    EXPECT_EQ(expected("2", 1234566, 1250000), query({"2:1234567-1250000"}));
+    EXPECT_EQ(expected("X", 2999999, 4000000), query({"X:3000000"}));
+    EXPECT_EQ(expected("X", 0, 4000000), query({"X"}));
+    EXPECT_EQ(expected("1", 4000000, 5000000), query({"1:4000001-5000000"}));
+}
+
+TEST_P(TestTabixIndexBuilder, unsorted) {
+    std::swap(_records[10], _records[20]);
+    // the output itself is still written, but the index is not
+    EXPECT_NO_THROW(writeRecords());
+    EXPECT_NE(0, access(_indexPath.c_str(), R_OK));
+    EXPECT_TRUE(Bgzf::isBgzfFile(_path));
+
+    std::stringstream data;
+    BgzfOutputStream out(data, 0);
+    out.writeIndex(_indexPath, std::make_unique<TabixIndexBuilder>(
+        TabixIndex::Config::bed(), TabixIndexBuilder::TBI));
+    out << "1\t10\t20\n1\t5\t10\n";
+    EXPECT_THROW(out.close(), IOError);
+}
+
+INSTANTIATE_TEST_CASE_P(IndexTypes, TestTabixIndexBuilder,
+    ::testing::Values(StreamHandler::TBI_INDEX, StreamHandler::CSI_INDEX));
+
+TEST(TestTabixIndexConfig, fromPath) {
+    TabixIndex::Config config;
+    ASSERT_TRUE(TabixIndex::Config::fromPath("x.vcf.gz", config));
+    EXPECT_EQ(TabixIndex::VCF, config.format);
+    EXPECT_EQ(0, config.endCol);
+    ASSERT_TRUE(TabixIndex::Config::fromPath("dir/x.bed.gz", config));
+    EXPECT_EQ(TabixIndex::GENERIC | TabixIndex::UCSC_FLAG, config.format);
+    EXPECT_FALSE(TabixIndex::Config::fromPath("x.txt.gz", config));
+}
@@ -0,0 +1,89 @@
+#include "processors/MergeCascade.hpp"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    typedef MergeCascade::Group Group;
+
+    // Adds runs as a sort would, merging the tail when asked to. Returns
+    // the largest number of runs there ever were.
+    size_t addRuns(MergeCascade& cascade, size_t n) {
+        size_t most = 0;
+        for (size_t i = 0; i < n; ++i) {
+            cascade.add();
+            most = max(most, cascade.size());
+            while (size_t k = cascade.tailMerge()) {
+                size_t last = cascade.size();
+                cascade.merged(vector<Group>(1, Group(last - k, last)));
+            }
+        }
+        return most;
+    }
+}
+
+TEST(TestMergeCascade, unlimited) {
+    MergeCascade cascade(0);
+    EXPECT_EQ(1000u, addRuns(cascade, 1000));
+    EXPECT_EQ(1000u, cascade.size());
+    EXPECT_TRUE(cascade.nextPass(1).empty());
+}
+
+TEST(TestMergeCascade, badFanIn) {
+    EXPECT_THROW(MergeCascade(1), runtime_error);
+}
+
+TEST(TestMergeCascade, tailMerges) {
+    MergeCascade cascade(4);
+    EXPECT_LE(addRuns(cascade, 3), 4u);
+    EXPECT_EQ(3u, cascade.size());
+
+    // the 4th run makes a level 1 run out of the first 4
+    addRuns(cascade, 1);
+    EXPECT_EQ(1u, cascade.size());
+
+    // 4 level 1 runs become one level 2 run
+    addRuns(cascade, 12);
+    EXPECT_EQ(1u, cascade.size());
+
+    // 100 = 1 * 64 + 2 * 16 + 1 * 4 runs
+    MergeCascade big(4);
+    EXPECT_LE(addRuns(big, 100), 4u * 3);
+    EXPECT_EQ(4u, big.size());
+}
+
+TEST(TestMergeCascade, finalPasses) {
+    MergeCascade cascade(3);
+    for (int i = 0; i < 2; ++i)
+        cascade.add();
+    EXPECT_TRUE(cascade.nextPass(3).empty());
+    EXPECT_TRUE(cascade.nextPass(2).empty());
+
+    // merging the last 2 runs is enough to leave 1
+    vector<Group> groups = cascade.nextPass(1);
+    ASSERT_EQ(1u, groups.size());
+    EXPECT_EQ(Group(0, 2), groups[0]);
+
+    MergeCascade wide(3);
+    for (int i = 0; i < 8; ++i)
+        wide.add();
+    // 8 -> 2 needs 6 fewer runs: 3 groups of 3 from the end would take 9
+    groups = wide.nextPass(2);
+    ASSERT_EQ(3u, groups.size());
+    EXPECT_EQ(Group(5, 8), groups[0]);
+    EXPECT_EQ(Group(2, 5), groups[1]);
+    EXPECT_EQ(Group(0, 2), groups[2]);
+    wide.merged(groups);
+    EXPECT_EQ(3u, wide.size());
+
+    groups = wide.nextPass(2);
+    ASSERT_EQ(1u, groups.size());
+    EXPECT_EQ(Group(1, 3), groups[0]);
+    wide.merged(groups);
+    EXPECT_EQ(2u, wide.size());
+    EXPECT_TRUE(wide.nextPass(2).empty());
+}
@@ -4,6 +4,7 @@
 #include "fileformats/TypedStream.hpp"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
@@ -27,6 +28,43 @@ namespace {
 
         vector<Bed> beds;
     };
+
+    // Minimal sorted stream of (key, tag) pairs ordered on key alone
+    struct PairStream {
+        typedef pair<int, int> ValueType;
+
+        struct KeyLess {
+            bool operator()(ValueType const& a, ValueType const& b) const {
+                return a.first < b.first;
+            }
+        };
+
+        explicit PairStream(vector<ValueType> const& values)
+            : values(values)
+            , pos(0)
+        {}
+
+        bool eof() const {
+            return pos == values.size();
+        }
+
+        bool peek(ValueType** value) {
+            if (eof())
+                return false;
+            *value = &values[pos];
+            return true;
+        }
+
+        bool next(ValueType& value) {
+            if (eof())
+                return false;
+            value = values[pos++];
+            return true;
+        }
+
+        vector<ValueType> values;
+        size_t pos;
+    };
 }
 
 class TestMergeSorted : public ::testing::Test {
@@ -85,3 +123,36 @@ TEST_F(TestMergeSorted, execute) {
         ASSERT_EQ(_expectedBeds[i], c.beds[i]);
 }
 
+
+TEST_F(TestMergeSorted, manyStreams) {
+    // some streams are empty and the count is not a power of two
+    const int nStreams = 37;
+    vector<unique_ptr<PairStream>> streams;
+    vector<PairStream::ValueType> expected;
+    for (int i = 0; i < nStreams; ++i) {
+        vector<PairStream::ValueType> values;
+        for (int key = i % 5; i % 4 != 0 && key < 200; key += 1 + i % 3) {
+            values.push_back(make_pair(key, i));
+            expected.push_back(values.back());
+        }
+        streams.push_back(std::make_unique<PairStream>(values));
+    }
+    std::stable_sort(expected.begin(), expected.end(), PairStream::KeyLess());
+
+    auto merger = makeMergeSorted(streams, PairStream::KeyLess());
+    vector<PairStream::ValueType> observed;
+    PairStream::ValueType value;
+    while (merger.next(value))
+        observed.push_back(value);
+
+    // equal keys come out in input order
+    EXPECT_EQ(expected, observed);
+    EXPECT_FALSE(merger.next(value));
+}
+
+TEST_F(TestMergeSorted, noStreams) {
+    vector<unique_ptr<PairStream>> streams;
+    auto merger = makeMergeSorted(streams, PairStream::KeyLess());
+    PairStream::ValueType value;
+    EXPECT_FALSE(merger.next(value));
+}
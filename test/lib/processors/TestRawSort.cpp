@@ -0,0 +1,167 @@
+#include "processors/RawSort.hpp"
+#include "io/InputStream.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    struct Collector {
+        void operator()(StringView const& line) {
+            out << line << "\n";
+        }
+        stringstream out;
+    };
+
+    string chromName(int chrom) {
+        stringstream ss;
+        if (chrom == 23)
+            ss << "X";
+        else
+            ss << chrom;
+        return ss.str();
+    }
+}
+
+class TestRawSort : public ::testing::Test {
+protected:
+    void SetUp() {
+        // the 4th column gives the input order of lines with equal keys
+        vector<string> lines;
+        for (int chrom = 1; chrom <= 23; ++chrom) {
+            for (int start = 1; start <= 5; ++start) {
+                for (int end = start; end <= start + 3; ++end) {
+                    for (int dup = 0; dup < 2; ++dup) {
+                        stringstream ss;
+                        ss << chromName(chrom) << "\t" << start << "\t" << end << "\t" << dup;
+                        lines.push_back(ss.str());
+                    }
+                }
+            }
+        }
+
+        for (auto i = lines.begin(); i != lines.end(); ++i)
+            _expected << *i << "\n";
+
+        // shuffle, keeping duplicates in order
+        vector<string> shuffled(lines.begin(), lines.end());
+        random_shuffle(shuffled.begin(), shuffled.end());
+        stable_partition(shuffled.begin(), shuffled.end(), IsFirstDup());
+        _nLines = shuffled.size();
+
+        // inputs are read one after the other
+        for (auto i = shuffled.begin(); i != shuffled.end(); ++i)
+            _data[(i - shuffled.begin()) * 3 / _nLines] << *i << "\n";
+        for (int i = 0; i < 3; ++i)
+            _inputs.push_back(InputStream::ptr(new InputStream("test", _data[i])));
+    }
+
+    struct IsFirstDup {
+        bool operator()(string const& s) const {
+            return s[s.size() - 1] == '0';
+        }
+    };
+
+    stringstream _data[3];
+    stringstream _expected;
+    size_t _nLines;
+    vector<InputStream::ptr> _inputs;
+};
+
+TEST_F(TestRawSort, inMemory) {
+    Collector out;
+    auto sorter = makeRawSort(_inputs, BED, out, _nLines);
+    sorter->execute();
+    EXPECT_EQ(_expected.str(), out.out.str());
+}
+
+TEST_F(TestRawSort, spill) {
+    Collector out;
+    auto sorter = makeRawSort(_inputs, BED, out, _nLines / 7);
+    sorter->execute();
+    EXPECT_EQ(_expected.str(), out.out.str());
+}
+
+TEST_F(TestRawSort, spillCompressed) {
+    Collector out;
+    auto sorter = makeRawSort(_inputs, BED, out, _nLines, 16 << 10, true);
+    sorter->execute();
+    EXPECT_EQ(_expected.str(), out.out.str());
+    EXPECT_GE(sorter->peakBytes(), uint64_t(16 << 10));
+}
+
+TEST_F(TestRawSort, fanIn) {
+    Collector out;
+    auto sorter = makeRawSort(_inputs, BED, out, _nLines / 40, 0, false, 3);
+    sorter->execute();
+    EXPECT_EQ(_expected.str(), out.out.str());
+}
+
+TEST(TestRawSortBuffer, vcfKey) {
+    RawSortBuffer buf(VCF);
+    buf.add(StringView("2\t10\t.\tACGT\tA\t.\t.\t."));
+    buf.add(StringView("10\t5\trs1\tA\tC\t.\t.\t."));
+    buf.add(StringView("2\t10\t.\tA\tT\t.\t.\t."));
+    buf.sort();
+
+    ASSERT_EQ(3u, buf.size());
+    EXPECT_EQ("2", buf.chrom(0));
+    EXPECT_EQ(9, buf.start(0));
+    EXPECT_EQ(10, buf.stop(0));
+    EXPECT_TRUE(buf.text(0) == "2\t10\t.\tA\tT\t.\t.\t.");
+
+    EXPECT_EQ(9, buf.start(1));
+    EXPECT_EQ(13, buf.stop(1));
+
+    EXPECT_EQ("10", buf.chrom(2));
+    EXPECT_EQ(4, buf.start(2));
+    EXPECT_EQ(5, buf.stop(2));
+}
+
+TEST(TestRawSortBuffer, chromPosKey) {
+    RawSortBuffer buf(CHROMPOS);
+    buf.add(StringView("1\t20"));
+    buf.add(StringView("1\t3"));
+    buf.sort();
+    EXPECT_EQ(3, buf.start(0));
+    EXPECT_EQ(3, buf.stop(0));
+    EXPECT_TRUE(buf.text(1) == "1\t20");
+}
+
+TEST(TestRawSortBuffer, malformed) {
+    RawSortBuffer buf(BED);
+    EXPECT_THROW(buf.add(StringView("1")), runtime_error);
+    EXPECT_THROW(buf.add(StringView("1\tx\t3")), runtime_error);
+    EXPECT_THROW(buf.add(StringView("1\t2")), runtime_error);
+    EXPECT_THROW(buf.add(StringView("1\t2\t")), runtime_error);
+    EXPECT_EQ(0u, buf.size());
+
+    RawSortBuffer vcf(VCF);
+    EXPECT_THROW(vcf.add(StringView("1\t2\t.")), runtime_error);
+}
+
+TEST(TestRawSortBuffer, naturalRuns) {
+    RawSortBuffer buf(BED);
+    EXPECT_EQ(0u, buf.naturalRuns());
+    buf.add(StringView("2\t1\t2"));
+    buf.add(StringView("10\t1\t2"));
+    buf.add(StringView("10\t1\t3"));
+    EXPECT_EQ(1u, buf.naturalRuns());
+    buf.add(StringView("9\t1\t3"));
+    EXPECT_EQ(2u, buf.naturalRuns());
+    buf.add(StringView("9\t1\t1"));
+    EXPECT_EQ(3u, buf.naturalRuns());
+
+    buf.sort();
+    EXPECT_EQ("2", buf.chrom(0));
+    EXPECT_EQ("9", buf.chrom(1));
+    EXPECT_EQ(1, buf.stop(1));
+    EXPECT_EQ(3, buf.stop(2));
+    EXPECT_EQ("10", buf.chrom(3));
+}
@@ -2,6 +2,7 @@
 #include "fileformats/Bed.hpp"
 #include "io/InputStream.hpp"
 #include "fileformats/BedReader.hpp"
+#include "io/TempFile.hpp"
 
 #include <boost/ptr_container/ptr_vector.hpp>
 
@@ -30,6 +31,21 @@ namespace {
         stringstream out;
     };
 
+    // takes the text of spilled records as is
+    struct RawCollector {
+        template<typename T>
+        void operator()(const T& value) {
+            out << value << "\n";
+        }
+        stringstream out;
+    };
+
+    struct StartStopLess {
+        bool operator()(Bed const& a, Bed const& b) const {
+            return a.start() < b.start() || (a.start() == b.start() && a.stop() < b.stop());
+        }
+    };
+
     BedHeader hdr;
     TypedStreamFactory<BedParser> readerFactory;
 }
@@ -117,3 +133,143 @@ TEST_F(TestSort, stable) {
     ASSERT_EQ(_expectedStr.str(), out.out.str());
 }
 
+TEST_F(TestSort, rawOutput) {
+    RawCollector out;
+    auto sorter = makeSort<BedReader>(_bedReaders, readerFactory, out, hdr, _expectedBeds.size()/10, false, GZIP);
+    sorter->execute();
+    ASSERT_EQ(_expectedStr.str(), out.out.str());
+}
+
+TEST_F(TestSort, threaded) {
+    Collector<Bed> out;
+    auto sorter = makeSort<BedReader>(_bedReaders, readerFactory, out, hdr, _expectedBeds.size()/10, true, NONE, 4, 2);
+    sorter->execute();
+    ASSERT_EQ(_expectedStr.str(), out.out.str());
+}
+
+TEST_F(TestSort, byteBudget) {
+    typedef SortBuffer<BedReader, TypedStreamFactory<BedParser>, Collector<Bed>> BufferType;
+    uint64_t recordBytes = BufferType::recordBytes(_expectedBeds[0]);
+    uint64_t budget = recordBytes * _expectedBeds.size() / 10;
+
+    Collector<Bed> out;
+    auto sorter = makeSort<BedReader>(_bedReaders, readerFactory, out, hdr,
+        _expectedBeds.size(), true, NONE, 0, 0, budget);
+    sorter->execute();
+    ASSERT_EQ(_expectedStr.str(), out.out.str());
+    // the records did not all fit in the budget, so some had to be spilled
+    EXPECT_GE(sorter->peakBytes(), budget);
+    EXPECT_LT(sorter->peakBytes(), budget + 2 * recordBytes);
+}
+
+TEST_F(TestSort, fanIn) {
+    Collector<Bed> out;
+    auto sorter = makeSort<BedReader>(_bedReaders, readerFactory, out, hdr,
+        _expectedBeds.size() / 50, true, GZIP, 0, 0, 0, 3);
+    sorter->execute();
+    ASSERT_EQ(_expectedStr.str(), out.out.str());
+}
+
+TEST_F(TestSort, fanInThreaded) {
+    Collector<Bed> out;
+    auto sorter = makeSort<BedReader>(_bedReaders, readerFactory, out, hdr,
+        _expectedBeds.size() / 50, true, NONE, 4, 2, 0, 2);
+    sorter->execute();
+    ASSERT_EQ(_expectedStr.str(), out.out.str());
+}
+
+TEST_F(TestSort, presorted) {
+    stringstream data;
+    for (auto i = _expectedBeds.begin(); i != _expectedBeds.end(); ++i)
+        data << *i << "\n";
+    InputStream in("test", data);
+    vector<BedReader::ptr> readers;
+    readers.push_back(openBed(in, 0));
+
+    Collector<Bed> out;
+    auto sorter = makeSort<BedReader>(readers, readerFactory, out, hdr, _expectedBeds.size() / 5, true);
+    sorter->execute();
+    ASSERT_EQ(_expectedStr.str(), out.out.str());
+    EXPECT_EQ(_expectedBeds.size(), sorter->records());
+    // one run per buffer
+    EXPECT_EQ(5u, sorter->naturalRuns());
+}
+
+TEST_F(TestSort, nearlySorted) {
+    // long sorted stretches with a few records moved around, and a
+    // stretch of short runs at the end
+    vector<Bed> beds(_expectedBeds);
+    for (size_t i = 0; i + 100 < beds.size() * 3 / 4; i += 97)
+        swap(beds[i], beds[i + 100]);
+    random_shuffle(beds.begin() + beds.size() * 3 / 4, beds.end());
+
+    for (int stable = 0; stable < 2; ++stable) {
+        stringstream data;
+        for (auto i = beds.begin(); i != beds.end(); ++i)
+            data << *i << "\n";
+        InputStream in("test", data);
+        vector<BedReader::ptr> readers;
+        readers.push_back(openBed(in, 0));
+
+        Collector<Bed> out;
+        auto sorter = makeSort<BedReader>(readers, readerFactory, out, hdr, beds.size(), stable);
+        sorter->execute();
+        ASSERT_EQ(_expectedStr.str(), out.out.str());
+        EXPECT_LT(1u, sorter->naturalRuns());
+        EXPECT_GT(beds.size() / 2, sorter->naturalRuns());
+    }
+}
+
+TEST_F(TestSort, asyncIO) {
+    TempDir::ptr dirs[2] = {TempDir::create(TempDir::CLEANUP), TempDir::create(TempDir::CLEANUP)};
+    vector<string> tmpDirs{dirs[0]->path(), dirs[1]->path()};
+
+    Collector<Bed> out;
+    auto sorter = makeSort<BedReader>(_bedReaders, readerFactory, out, hdr,
+        _expectedBeds.size() / 20, true, GZIP, 2, 0, 0, 4, tmpDirs, true);
+    sorter->execute();
+    ASSERT_EQ(_expectedStr.str(), out.out.str());
+}
+
+TEST_F(TestSort, badTmpDir) {
+    vector<string> tmpDirs{"/no/such/directory"};
+    Collector<Bed> out;
+    auto sorter = makeSort<BedReader>(_bedReaders, readerFactory, out, hdr,
+        _expectedBeds.size() / 10, true, NONE, 0, 0, 0, 0, tmpDirs);
+    EXPECT_THROW(sorter->execute(), runtime_error);
+}
+
+TEST_F(TestSort, stableManyRuns) {
+    // records with equal loci, told apart by name, spread over many runs;
+    // the merges have to keep them in input order
+    vector<Bed> beds;
+    for (int i = 0; i < 60; ++i) {
+        Bed::ExtraFieldsType extra;
+        stringstream name;
+        name << "r" << i;
+        extra.push_back(name.str());
+        beds.push_back(Bed("1", (i * 7) % 4 + 1, (i * 7) % 4 + 2, extra));
+    }
+
+    vector<Bed> expected(beds);
+    stable_sort(expected.begin(), expected.end(), StartStopLess());
+    stringstream expectedStr;
+    for (auto i = expected.begin(); i != expected.end(); ++i)
+        expectedStr << *i << "\n";
+
+    for (size_t fanIn = 0; fanIn < 4; fanIn += 3) {
+        stringstream data;
+        for (auto i = beds.begin(); i != beds.end(); ++i)
+            data << *i << "\n";
+        InputStream in("test", data);
+        vector<BedReader::ptr> readers;
+        readers.push_back(openBed(in, 1));
+
+        Collector<Bed> out;
+        // 4 records per buffer gives 15 runs
+        auto sorter = makeSort<BedReader>(readers, readerFactory, out, hdr,
+            4, true, NONE, 0, 0, 0, fanIn);
+        sorter->execute();
+        EXPECT_EQ(expectedStr.str(), out.out.str()) << "fan in " << fanIn;
+    }
+}
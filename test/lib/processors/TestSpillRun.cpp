@@ -0,0 +1,149 @@
+#include "processors/SpillRun.hpp"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    void writeRun(std::stringstream& ss, bool compress, int n, ThreadPool* io = 0) {
+        SpillRunWriter writer(ss, compress, io);
+        for (int i = 0; i < n; ++i) {
+            std::stringstream chrom;
+            chrom << (i / 1000 + 1);
+            SortKey key(chrom.str(), i, i + 10);
+            if (i % 2)
+                writer.add(key, i);
+            else {
+                std::string text = "record\t" + chrom.str();
+                writer.add(key, text.data(), text.data() + text.size());
+            }
+        }
+        writer.close();
+    }
+
+    void checkRun(std::stringstream& ss, int n, ThreadPool* io = 0) {
+        SpillRunReader reader(ss, io);
+        for (int i = 0; i < n; ++i) {
+            ASSERT_TRUE(reader.next());
+            std::stringstream chrom;
+            chrom << (i / 1000 + 1);
+            EXPECT_EQ(chrom.str(), reader.key().chrom());
+            EXPECT_EQ(i, reader.key().start());
+            EXPECT_EQ(i + 10, reader.key().stop());
+
+            std::stringstream text;
+            if (i % 2)
+                text << i;
+            else
+                text << "record\t" << chrom.str();
+            EXPECT_EQ(text.str(), reader.text());
+        }
+        EXPECT_FALSE(reader.next());
+    }
+}
+
+TEST(SpillRun, roundTrip) {
+    // enough records to span several blocks
+    std::stringstream ss;
+    writeRun(ss, false, 50000);
+    EXPECT_LT(SpillRunWriter::BLOCK_SIZE, ss.str().size());
+    checkRun(ss, 50000);
+}
+
+TEST(SpillRun, compressed) {
+    std::stringstream plain;
+    writeRun(plain, false, 50000);
+    std::stringstream ss;
+    writeRun(ss, true, 50000);
+    EXPECT_GT(plain.str().size(), ss.str().size());
+    checkRun(ss, 50000);
+}
+
+TEST(SpillRun, asyncIO) {
+    ThreadPool io(1);
+    for (int compress = 0; compress < 2; ++compress) {
+        std::stringstream sync;
+        writeRun(sync, compress, 50000);
+        std::stringstream async;
+        writeRun(async, compress, 50000, &io);
+        EXPECT_EQ(sync.str(), async.str());
+        checkRun(async, 50000, &io);
+    }
+
+    // errors from the I/O thread come out of next()
+    std::stringstream ss;
+    writeRun(ss, false, 50000);
+    std::string data = ss.str();
+    std::stringstream truncated(data.substr(0, data.size() - 3));
+    SpillRunReader reader(truncated, &io);
+    EXPECT_THROW(while (reader.next()) {}, std::runtime_error);
+}
+
+TEST(SpillRun, empty) {
+    std::stringstream ss;
+    SpillRunWriter writer(ss, true);
+    writer.close();
+    EXPECT_TRUE(ss.str().empty());
+
+    SpillRunReader reader(ss);
+    EXPECT_FALSE(reader.next());
+}
+
+TEST(SpillRun, truncated) {
+    std::stringstream ss;
+    writeRun(ss, false, 10);
+    std::string data = ss.str();
+    std::stringstream truncated(data.substr(0, data.size() - 3));
+    SpillRunReader reader(truncated);
+    EXPECT_THROW(reader.next(), std::runtime_error);
+}
+
+TEST(SpillRun, merge) {
+    // the even and odd records of a run, plus one of equal keys
+    std::stringstream parts[3];
+    {
+        SpillRunWriter even(parts[0], false);
+        SpillRunWriter odd(parts[1], true);
+        SpillRunWriter same(parts[2], false);
+        std::string text = "same";
+        for (int i = 0; i < 5000; ++i) {
+            std::stringstream chrom;
+            chrom << (i / 1000 + 1);
+            SortKey key(chrom.str(), i, i + 10);
+            if (i % 2)
+                odd.add(key, i);
+            else {
+                std::string text = "record\t" + chrom.str();
+                even.add(key, text.data(), text.data() + text.size());
+            }
+        }
+        same.add(SortKey("1", 4, 14), text.data(), text.data() + text.size());
+        even.close();
+        odd.close();
+        same.close();
+    }
+
+    SpillRunReader even(parts[0]);
+    SpillRunReader odd(parts[1]);
+    SpillRunReader same(parts[2]);
+    std::vector<SpillRunReader*> runs{&even, &odd, &same};
+    std::stringstream ss;
+    SpillRunWriter writer(ss, false);
+    mergeSpillRuns(runs, writer);
+    writer.close();
+
+    SpillRunReader reader(ss);
+    for (int i = 0; i < 5000; ++i) {
+        ASSERT_TRUE(reader.next());
+        EXPECT_EQ(i, reader.key().start());
+        if (i == 4) {
+            // ties go to the earlier run
+            ASSERT_TRUE(reader.next());
+            EXPECT_EQ(4, reader.key().start());
+            EXPECT_EQ("same", reader.text());
+        }
+    }
+    EXPECT_FALSE(reader.next());
+}